@@ -0,0 +1,208 @@
+#!/bin/bash
+
+# This script will compile the standalone benchmark drivers once per override file, run each benchmark and write
+# the throughput and per-operation timings of each one to a single CSV file which may be compared between releases.
+# The size of each benchmark can be changed with the environment variables below without recompiling.
+# If you run "this_script.sh > out.dat &" it will run it in the background and print stdout to out.dat file
+
+
+# Compiler flags and directories (should change this to suit system)
+DIR_HDF5=${DIR_HDF5:-/usr/lib/x86_64-linux-gnu/hdf5/mpich}  # Must set this yourself to where the HDF5 library is installed on your system
+CC=${CC:-mpicxx}								# Compiler command
+CFLAGS=${CFLAGS:-"-std=c++0x -O3"}				# Compiler flags
+EXE=LUMABench									# Executable
+DIR_INC=${DIR_HDF5}/include						# Include directory
+DIR_LIB=${DIR_HDF5}/lib							# Library path
+LIB="-lhdf5 -llapack"							# Libraries
+
+
+# Benchmark sizes (may be overridden from the environment)
+BENCH_STEPS=${BENCH_STEPS:-200}					# Time steps timed by the kernel benchmark
+BENCH_REPEATS=${BENCH_REPEATS:-100}				# Calls of each operation timed by the halo, IBM and FEM benchmarks
+BENCH_KERNEL_RES=${BENCH_KERNEL_RES:-64}		# Lattice sites per side of the periodic box (kernel, halo and HDF5 benchmarks)
+BENCH_HALO_CORES=${BENCH_HALO_CORES:-"2 2 1"}	# Rank topology (X Y Z) of the halo exchange benchmark
+BENCH_IBM_RES=${BENCH_IBM_RES:-200}				# Lattice sites per side of the 2D box (IBM and FEM benchmarks)
+BENCH_IBM_MARKERS=${BENCH_IBM_MARKERS:-1000}	# Approximate number of IBM markers
+BENCH_FEM_ELEMENTS=${BENCH_FEM_ELEMENTS:-100}	# Number of FEM elements
+BENCH_HDF5_WRITES=${BENCH_HDF5_WRITES:-5}		# Number of HDF5 writes timed
+
+
+# Set up the variables containing the paths to directories we need
+DIR_WORKING=..							# Working directory
+DIR_DEF=${DIR_WORKING}/defs				# Override files applied to a copy of the LUMA definitions file
+DIR_RES=${DIR_WORKING}/results			# Results directory where the data will be written out
+DIR_SRC=${DIR_WORKING}/src				# Benchmark driver which replaces main_lbm.cpp
+DIR_LUMA=${DIR_WORKING}/../..			# LUMA directory containing the source files to compile
+
+# Master log file and results file
+LOG_FILE=benchmarks.log
+CSV_FILE=benchmarks.csv
+
+# Filament length used in the IBM and FEM benchmarks
+FIL_LENGTH=0.8
+
+
+# If running with the clean option it will just delete the results folder
+while [ ! $# -eq 0 ]
+do
+	case "$1" in
+		--clean | clean | -c)
+			rm -rf ${DIR_RES}
+			rm -f ${DIR_WORKING}/${LOG_FILE} ${DIR_WORKING}/${CSV_FILE}
+			exit
+			;;
+	esac
+	shift
+done
+
+
+# Benchmarks to run (name, override file, number of timed calls)
+BENCHMARKS=(
+	"kernel 000 ${BENCH_STEPS}"
+	"halo 001 ${BENCH_REPEATS}"
+	"ibm 002 ${BENCH_REPEATS}"
+	"fem 002 ${BENCH_REPEATS}"
+	"hdf5 003 ${BENCH_HDF5_WRITES}"
+)
+
+
+# Delete results directory if it already exists and create it again
+rm -rf ${DIR_RES}
+mkdir ${DIR_RES}
+rm -f ${DIR_WORKING}/${LOG_FILE}
+
+printf "\n********** LUMA BENCHMARKS **********\n"
+printf "Beginning benchmarks -> there are ${#BENCHMARKS[@]} benchmarks to run\n\n"
+
+# Print header for master log file and results file
+DATE=`date +%Y-%m-%d:%H:%M:%S`
+REV=`git -C ${DIR_LUMA} rev-parse --short HEAD 2> /dev/null`
+printf "\n********** LUMA BENCHMARKS - ${DATE} **********\n\n" > ${DIR_WORKING}/${LOG_FILE}
+printf "# LUMA benchmarks ${DATE} revision ${REV:-unknown} compiler `${CC} -dumpversion 2> /dev/null`\n" > ${DIR_WORKING}/${CSV_FILE}
+printf "benchmark,metric,value,unit\n" >> ${DIR_WORKING}/${CSV_FILE}
+
+
+# Write a result line to the results file
+write_result () {
+	printf "%s,%s,%s,%s\n" $1 $2 $3 $4 >> ${DIR_WORKING}/${CSV_FILE}
+}
+
+# Apply an override file to a definitions file and write the result (fails if an override is not found)
+make_definitions () {
+	awk -v ovr=$2 '
+	BEGIN {
+		while ((getline line < ovr) > 0) {
+			sub(/#.*/, "", line); gsub(/^[ \t]+|[ \t]+$/, "", line)
+			if (line == "") continue
+			name = line; val = ""
+			if (match(line, /[ \t]/)) { name = substr(line, 1, RSTART - 1); val = substr(line, RSTART + 1); sub(/^[ \t]+/, "", val) }
+			if (substr(name, 1, 1) == "!") { name = substr(name, 2); off[name] = 1 }
+			set[name] = 1; value[name] = val
+		}
+	}
+	match($0, /^[ \t]*(\/\/)?[ \t]*#define[ \t]+[A-Za-z0-9_]+/) {
+		name = substr($0, RSTART, RLENGTH); sub(/.*#define[ \t]+/, "", name)
+		if ((name in set) && !(name in done)) {
+			done[name] = 1
+			comment = ""
+			if (match($0, /\/\/\/<.*/)) comment = "\t\t" substr($0, RSTART)
+			if (name in off) { line = $0; sub(/^[ \t]*(\/\/)?[ \t]*/, "", line); print "//" line }
+			else if (value[name] != "") print "#define " name " " value[name] comment
+			else { line = $0; sub(/^[ \t]*(\/\/)?[ \t]*/, "", line); print line }
+			next
+		}
+	}
+	{ print }
+	END {
+		for (name in set) if (!(name in done)) { print "Override " name " not found in definitions file" > "/dev/stderr"; bad = 1 }
+		exit bad
+	}' $1 > $3
+}
+
+# Loop through all benchmarks
+for BENCH in "${BENCHMARKS[@]}"
+do
+	read NAME DEF_NUM REPEATS <<< "${BENCH}"
+	printf "Starting benchmark ${NAME}...\n"
+
+	# Create a directory for this benchmark and its input
+	BENCH_RES_PATH=${DIR_RES}/${NAME}
+	mkdir -p ${BENCH_RES_PATH}/input
+	if ! make_definitions ${DIR_LUMA}/inc/definitions.h ${DIR_DEF}/overrides_${DEF_NUM}.txt ${BENCH_RES_PATH}/definitions.h 2> ${BENCH_RES_PATH}/compile.log; then
+		printf "overrides do not match the LUMA definitions file (check compile log file)...skipping benchmark\n\n"
+		printf "BENCHMARK ${NAME} -> FAILED ON OVERRIDES\n" >> ${DIR_WORKING}/${LOG_FILE}
+		continue
+	fi
+
+	# Benchmark specific run-time parameters and geometry (periodic box)
+	NPROCS=1
+	PARAMS="L_TIMESTEP 0.001\nL_WALL_LEFT eFluid\nL_WALL_RIGHT eFluid\nL_WALL_BOTTOM eFluid\nL_WALL_TOP eFluid\nL_WALL_FRONT eFluid\nL_WALL_BACK eFluid\n"
+	case ${NAME} in
+		kernel | hdf5)
+			PARAMS+="L_RESOLUTION ${BENCH_KERNEL_RES}\n"
+			;;
+		halo)
+			read XCORES YCORES ZCORES <<< "${BENCH_HALO_CORES}"
+			NPROCS=$((XCORES * YCORES * ZCORES))
+			PARAMS+="L_RESOLUTION ${BENCH_KERNEL_RES}\nL_MPI_XCORES ${XCORES}\nL_MPI_YCORES ${YCORES}\nL_MPI_ZCORES ${ZCORES}\n"
+			;;
+		ibm)
+			# Rigid filaments spread across the box
+			PARAMS+="L_RESOLUTION ${BENCH_IBM_RES}\n"
+			MARKERS_PER_FIL=`awk -v l=${FIL_LENGTH} -v r=${BENCH_IBM_RES} 'BEGIN { printf "%d", l * r + 1 }'`
+			NFIL=$(( (BENCH_IBM_MARKERS + MARKERS_PER_FIL - 1) / MARKERS_PER_FIL ))
+			SPACE=`awk -v n=${NFIL} 'BEGIN { printf "%.6f", 0.8 / n }'`
+			printf "FILAMENT_ARRAY\tIBM\t0\t0\t${NFIL}\t0.1\t0.1\t0.0\t${SPACE}\t0.0\t0.0\t${FIL_LENGTH}\t0.02\t0\t90\t0\tRIGID\t1\tCLAMPED\t1.0\t1.0\n" > ${BENCH_RES_PATH}/input/geometry.config
+			;;
+		fem)
+			# Single flexible filament
+			PARAMS+="L_RESOLUTION ${BENCH_IBM_RES}\n"
+			printf "FILAMENT_ARRAY\tIBM\t0\t0\t1\t0.1\t0.5\t0.0\t0.0\t0.0\t0.0\t${FIL_LENGTH}\t0.02\t0\t0\t0\tFLEXIBLE\t${BENCH_FEM_ELEMENTS}\tCLAMPED\t10000.0\t1.4e6\n" > ${BENCH_RES_PATH}/input/geometry.config
+			;;
+	esac
+	printf "${PARAMS}" > ${BENCH_RES_PATH}/input/params.in
+
+	# Compile once per override file in a scratch copy of the sources so the LUMA tree is never modified
+	DEF_EXE=${DIR_RES}/${EXE}${DEF_NUM}
+	if [ ! -f ${DEF_EXE} ]; then
+		printf "Compiling..."
+		DIR_BUILD=${DIR_RES}/build_${DEF_NUM}
+		mkdir -p ${DIR_BUILD}
+		cp -r ${DIR_LUMA}/inc ${DIR_LUMA}/src ${DIR_BUILD}/.
+		cp ${BENCH_RES_PATH}/definitions.h ${DIR_BUILD}/inc/definitions.h
+		rm ${DIR_BUILD}/src/main_lbm.cpp
+		cp ${DIR_SRC}/bench_main.cpp ${DIR_BUILD}/src/.
+		if ${CC} ${CFLAGS} -I${DIR_INC} ${DIR_BUILD}/src/*.cpp -o ${DEF_EXE} -L${DIR_LIB} ${LIB} &>> ${BENCH_RES_PATH}/compile.log; then
+			printf "success!\n"
+		else
+			printf "failed (check compile log file)...skipping benchmark\n\n"
+			printf "BENCHMARK ${NAME} -> FAILED ON COMPILE\n" >> ${DIR_WORKING}/${LOG_FILE}
+			continue
+		fi
+	fi
+	cp ${DEF_EXE} ${BENCH_RES_PATH}/${EXE}
+
+	# Run the driver from the benchmark directory so that it picks up its input and writes its output there
+	printf "Running ${NAME} on ${NPROCS} process(es)..."
+	if ! (cd ${BENCH_RES_PATH} && mpirun -np ${NPROCS} ./${EXE} ${NAME} ${REPEATS} > results.csv 2> driver.log); then
+		printf "failed (check driver log file)...skipping benchmark\n\n"
+		printf "BENCHMARK ${NAME} -> FAILED ON RUN\n" >> ${DIR_WORKING}/${LOG_FILE}
+		continue
+	fi
+	printf "success!\n"
+
+	# Size of the IBM and FEM problems (set by the geometry written above)
+	if [ ${NAME} == "ibm" ]; then
+		write_result ${NAME} markers $((NFIL * MARKERS_PER_FIL)) markers
+	elif [ ${NAME} == "fem" ]; then
+		write_result ${NAME} elements ${BENCH_FEM_ELEMENTS} elements
+	fi
+	write_result ${NAME} repeats ${REPEATS} calls
+	cat ${BENCH_RES_PATH}/results.csv >> ${DIR_WORKING}/${CSV_FILE}
+
+	printf "Benchmark ${NAME} complete\n\n"
+	printf "BENCHMARK ${NAME} -> COMPLETE\n" >> ${DIR_WORKING}/${LOG_FILE}
+	sed 's/^/\t/' ${BENCH_RES_PATH}/results.csv >> ${DIR_WORKING}/${LOG_FILE}
+done
+
+printf "Finished benchmarks -> results written to ${CSV_FILE}\n\n"
@@ -0,0 +1,246 @@
+/*
+* --------------------------------------------------------------
+*
+* ------ Lattice Boltzmann @ The University of Manchester ------
+*
+* -------------------------- L-U-M-A ---------------------------
+*
+* Copyright 2019 The University of Manchester
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.*
+*/
+
+/// \file bench_main.cpp
+///
+///	Standalone benchmark drivers. Replaces main_lbm.cpp when the benchmark
+///	suite is compiled. Sets up the grid (and bodies) from the usual input
+///	files, then times a single component a given number of times and writes
+///	one "benchmark,metric,value,unit" line per result to stdout.
+///
+///	Usage: LUMABench <kernel|halo|ibm|fem|hdf5> <repeats>
+
+#include "../inc/stdafx.h"			// Precompiled header
+#include "../inc/GridObj.h"			// Grid class definition
+#include "../inc/GridManager.h"		// Grid manager class definition
+#include "../inc/ObjectManager.h"	// Object manager class definition
+
+// Static variable declarations
+std::string GridUtils::path_str;
+
+/// Write a result line in the format of benchmarks.csv (rank 0 only)
+static void writeResult(const std::string &bench, const std::string &metric, double value, const std::string &unit)
+{
+	if (GridUtils::safeGetRank() != 0) return;
+	std::cout << bench << "," << metric << "," << value << "," << unit << std::endl;
+}
+
+/// Synchronise the ranks before a timed section
+static void barrier()
+{
+#ifdef L_BUILD_FOR_MPI
+	MPI_Barrier(MpiManager::getInstance()->world_comm);
+#endif
+}
+
+/// Reduce a value over the ranks (maximum or sum)
+static double reduce(double val, bool bSum = false)
+{
+#ifdef L_BUILD_FOR_MPI
+	MPI_Allreduce(MPI_IN_PLACE, &val, 1, MPI_DOUBLE, bSum ? MPI_SUM : MPI_MAX, MpiManager::getInstance()->world_comm);
+#endif
+	return val;
+}
+
+/// Time an operation after one warm up call and return the time per call of the slowest rank
+template <typename F>
+static double timeOp(int repeats, F op)
+{
+	op();
+	barrier();
+	double t_start = Profiler::now();
+	for (int r = 0; r < repeats; r++) op();
+	return reduce(Profiler::now() - t_start) / repeats;
+}
+
+/// Time per call (ms) of a phase recorded by the profiler since a previous reading (slowest rank)
+static double phaseTime(eProfPhase phase, double before, int repeats)
+{
+	return 1000.0 * reduce(Profiler::elapsed(phase, 0, 0) - before) / repeats;
+}
+
+/// Size of a file in bytes
+static double fileSize(const std::string &fileName)
+{
+	std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+	return file.is_open() ? static_cast<double>(file.tellg()) : 0.0;
+}
+
+/// Entry point for the benchmark drivers
+int main(int argc, char* argv[])
+{
+
+#ifdef L_BUILD_FOR_MPI
+	MPI_Init(&argc, &argv);
+#endif
+
+	std::string bench = (argc > 1) ? argv[1] : "";
+	int repeats = (argc > 2) ? std::atoi(argv[2]) : 0;
+
+	// Read the run-time parameters from the default file
+	RuntimeParams::read(1, argv);
+
+	// Output directory and log file
+	time_t curr_time = time(NULL);
+	struct tm* timeinfo = localtime(&curr_time);
+	char timeout_char[80];
+	std::strftime(timeout_char, 80, "./output_%Y-%m-%d_%H-%M-%S", timeinfo);
+	GridUtils::path_str = std::string(timeout_char);
+#ifdef L_BUILD_FOR_MPI
+	MpiManager* mpim = MpiManager::getInstance();
+#else
+	GridUtils::createOutputDirectory(GridUtils::path_str);
+#endif
+	std::ofstream logfile;
+	GridUtils::logfile = &logfile;
+	Logger::attach(logfile, "log");
+	L_INFO("Running LUMA benchmark driver -- Version " + std::string(LUMA_VERSION), GridUtils::logfile);
+	RuntimeParams::report();
+
+	if (repeats < 1)
+		L_ERROR("Usage: LUMABench <kernel|halo|ibm|fem|hdf5> <repeats>. Exiting.", GridUtils::logfile);
+
+	// Build the grid and the bodies as main_lbm.cpp does
+	GridManager *gm = GridManager::getInstance();
+#ifdef L_BUILD_FOR_MPI
+	mpim->mpi_gridbuild(gm);
+#endif
+	GridObj *const Grids = new GridObj(0);
+	for (int reg = 0; reg < L_NUM_REGIONS && L_NUM_LEVELS != 0; reg++) Grids->LBM_addSubGrid(reg);
+	gm->setGridHierarchy(Grids);
+#ifdef L_BUILD_FOR_MPI
+	mpim->mpi_setSubGridDepth();
+#endif
+	ObjectManager* objMan = ObjectManager::getInstance(Grids);
+#ifdef L_GEOMETRY_FILE
+	objMan->io_readInGeomConfig();
+#endif
+#ifdef L_IBM_ON
+	objMan->ibm_initialise();
+#endif
+	Grids->LBM_initStreamMask();
+	Grids->LBM_initRefinedMaps();
+#ifdef L_BUILD_FOR_MPI
+	mpim->mpi_buffer_size();
+	mpim->mpi_buildCommunicators(gm);
+	mpim->mpi_updateLoadInfo(gm);
+#endif
+	writeResult(bench, "ranks", reduce(1.0, true), "ranks");
+	L_INFO("Timing " + bench + " over " + std::to_string(repeats) + " repeats...", GridUtils::logfile);
+
+	// LBM kernel (time step on the whole hierarchy including any halo exchange)
+	if (bench == "kernel")
+	{
+		double secs = timeOp(repeats, [&]() { Grids->LBM_multi_opt(); });
+		double mlups = gm->activeCellOps / secs / 1e6;
+		writeResult(bench, "cells", static_cast<double>(gm->activeCellCount), "sites");
+		writeResult(bench, "step", 1000.0 * secs, "ms");
+		writeResult(bench, "mlups", mlups, "MLUPS");
+		writeResult(bench, "bandwidth", mlups * 1e6 * 2 * L_NUM_VELS * sizeof(popType) / 1e9, "GB/s");
+	}
+
+#ifdef L_BUILD_FOR_MPI
+	// Halo exchange of the populations on L0
+	else if (bench == "halo")
+	{
+		double pack = Profiler::elapsed(eProfMPIPack, 0, 0);
+		double wait = Profiler::elapsed(eProfMPIWait, 0, 0);
+		double unpack = Profiler::elapsed(eProfMPIUnpack, 0, 0);
+		double secs = timeOp(repeats, [&]() { mpim->mpi_communicate(0, 0); });
+		double bytes = 0.0;
+		for (int dir = 0; dir < L_MPI_DIRS; dir++) bytes += mpim->f_buffer_send[dir].size() * sizeof(popType);
+		bytes = reduce(bytes, true);
+		writeResult(bench, "cells", static_cast<double>(gm->activeCellCount), "sites");
+		writeResult(bench, "bytes", bytes, "B");
+		writeResult(bench, "exchange", 1000.0 * secs, "ms");
+		writeResult(bench, "bandwidth", bytes / secs / 1e9, "GB/s");
+		writeResult(bench, "mpi/pack", phaseTime(eProfMPIPack, pack, repeats + 1), "ms");
+		writeResult(bench, "mpi/wait", phaseTime(eProfMPIWait, wait, repeats + 1), "ms");
+		writeResult(bench, "mpi/unpack", phaseTime(eProfMPIUnpack, unpack, repeats + 1), "ms");
+	}
+#endif
+
+#ifdef L_IBM_ON
+	// IBM operations on the bodies of the geometry file (after one step so the markers see a flow field)
+	else if (bench == "ibm")
+	{
+		Grids->LBM_multi_opt();
+		writeResult(bench, "interpolate", 1000.0 * timeOp(repeats, [&]() { objMan->ibm_interpolate(0); }), "ms");
+		writeResult(bench, "spread", 1000.0 * timeOp(repeats, [&]() { objMan->ibm_spread(0); }), "ms");
+		writeResult(bench, "epsilon", 1000.0 * timeOp(repeats, [&]() { objMan->ibm_findEpsilon(0); }), "ms");
+	}
+
+	// FEM update of the flexible bodies of the geometry file (after a few steps so they are loaded)
+	else if (bench == "fem")
+	{
+		for (int s = 0; s < 10; s++) Grids->LBM_multi_opt();
+		double fem = Profiler::elapsed(eProfFEM, 0, 0);
+		double support = Profiler::elapsed(eProfIBMSupport, 0, 0);
+		double epsilon = Profiler::elapsed(eProfIBMEpsilon, 0, 0);
+		double secs = timeOp(repeats, [&]() { objMan->ibm_moveBodies(Grids); });
+		writeResult(bench, "move", 1000.0 * secs, "ms");
+		writeResult(bench, "fem", phaseTime(eProfFEM, fem, repeats + 1), "ms");
+		writeResult(bench, "support", phaseTime(eProfIBMSupport, support, repeats + 1), "ms");
+		writeResult(bench, "epsilon", phaseTime(eProfIBMEpsilon, epsilon, repeats + 1), "ms");
+	}
+#endif
+
+#ifdef L_HDF5_OUTPUT
+	// HDF5 write of L0 (the warm up call writes the mesh so the timed calls write data only)
+	else if (bench == "hdf5")
+	{
+		std::string fileName = GridUtils::path_str + "/hdf_R0N0.h5";
+		Grids->io_hdf5(Grids->t);
+		barrier();
+		double bytes = fileSize(fileName);
+		double t_start = Profiler::now();
+		for (int r = 0; r < repeats; r++)
+		{
+			Grids->t++;
+			Grids->io_hdf5(Grids->t);
+		}
+		double secs = reduce(Profiler::now() - t_start) / repeats;
+		bytes = (fileSize(fileName) - bytes) / repeats;
+		writeResult(bench, "cells", static_cast<double>(gm->activeCellCount), "sites");
+		writeResult(bench, "bytes", bytes, "B");
+		writeResult(bench, "write", 1000.0 * secs, "ms");
+		writeResult(bench, "bandwidth", bytes / secs / 1e9, "GB/s");
+	}
+#endif
+
+	else
+		L_ERROR("Benchmark " + bench + " is unknown or not compiled in this build. Exiting.", GridUtils::logfile);
+
+	// Close up
+	Logger::close();
+	logfile.close();
+	ObjectManager::destroyInstance();
+	MpiManager::destroyInstance();
+	GridManager::destroyInstance();
+	delete Grids;
+
+#ifdef L_BUILD_FOR_MPI
+	MPI_Finalize();
+#endif
+
+	return 0;
+}
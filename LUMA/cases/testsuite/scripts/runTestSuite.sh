@@ -25,8 +25,13 @@ DIR_LUMA=${DIR_WORKING}/../..			# LUMA directory containing the source files to
 # Master log file
 LOG_FILE=testsuite.log
 
-# File for diff comparison
-DIFF_FILE=io_lite.Lev0.Reg0.Rnk0.100.dat
+# Time step of the io_lite files to compare and the tolerances of the comparison (see tools/post_processors/litetool/README)
+DIFF_TIME=100
+DIFF_TOL="tol=all:1e-8"
+
+# Merge and diff tool for io_lite files
+DIR_LITETOOL=${DIR_LUMA}/tools/post_processors/litetool
+LITETOOL=${DIR_LITETOOL}/litetool
 
 
 # If running with the clean option it will just delete the results folder
@@ -49,6 +54,16 @@ mkdir ${DIR_RES}
 rm -f ${DIR_WORKING}/${LOG_FILE}
 
 
+# Build the diff tool
+printf "\nBuilding litetool..."
+if make -C ${DIR_LITETOOL} > /dev/null; then
+	printf "success!\n"
+else
+	printf "failed...cannot check results\n"
+	exit 1
+fi
+
+
 # Get the number of cases to test and print to screen
 NCASES=`find ${DIR_DEF} -maxdepth 1 -type f | wc -l`
 printf "\n********** LUMA TEST SUITE **********\n"
@@ -154,8 +169,8 @@ do
 			# Checking results
 			printf "Runnning a diff on the results..."
 
-			# Perform the diff and collect the output
-			if diff -q ${DIR_BASE}/case${CASE_NUM}/${DIFF_FILE} ${DIR_OUT}/${DIFF_FILE} > /dev/null; then
+			# Merge the files of all ranks and grids and compare them with the base results (report written to the diff log)
+			if ${LITETOOL} diff ${DIR_BASE}/case${CASE_NUM} ${DIR_OUT} ${DIFF_TIME} ${DIFF_TOL} > ${CASE_RES_PATH}/diff.log; then
 
 				# Check passed
 				printf "success!\n"
@@ -169,10 +184,6 @@ do
 				# Check failed
 				printf "failed (check diff log file)\n"
 
-				# Write out the diff log
-				printf "Writing diff log in case folder..."
-				diff -y -W 500 ${DIR_BASE}/case${CASE_NUM}/${DIFF_FILE} ${DIR_OUT}/${DIFF_FILE} > ${CASE_RES_PATH}/diff.log
-
 				# Print status
 				printf "Case ${CASE_NUM_INT} failed!\n\n"
 
@@ -68,6 +68,12 @@ protected:
 	///			ID.
 	std::vector<double>	Q;
 
+	/// \brief	Marker owning each BFL voxel.
+	///
+	///			Keyed by the local site index of the voxel. Only populated while
+	///			Q is being computed.
+	std::unordered_map<int, int> voxelMarkers;
+
 
 	/************** Member Methods **************/
 private :
@@ -79,6 +85,10 @@ private :
 	void computeQ(int i, int j, int k, GridObj* g);
 	void computeQ(int i, int j, GridObj* g);
 
+	// Voxel to marker lookup used by the Q computation
+	void buildVoxelMarkers();
+	int getVoxelMarker(int i, int j, int k);
+
 	// Surface closure
 	void enforceSurfaceClosure();
 
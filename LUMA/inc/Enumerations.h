@@ -80,8 +80,8 @@ enum eEdgeMinMax
 };
 
 /// \enum  eType
-/// \brief Lattice typing labels
-enum eType
+/// \brief Lattice typing labels (stored as a single byte per site)
+enum eType : unsigned char
 {
 	eSolid,					///< Rigid, solid site with no-slip BC
 	eFluid,					///< Fluid site
@@ -95,6 +95,92 @@ enum eType
 	eExtrapolateRight			///< Extrapolation boundary
 };
 
+/// \enum eCollisionModel
+/// \brief Collision operators which may be selected at run time.
+enum eCollisionModel
+{
+	eBGK,			///< LBGK collision
+	eBGKSmag,		///< LBGK collision with Smagorinsky turbulence model
+	eKBC			///< KBC entropic collision
+};
+
+/// \enum eLogLevel
+/// \brief Severity of log messages. Messages below the level selected at run
+///			time are not formatted or written.
+enum eLogLevel
+{
+	eLogDebug,		///< Debugging information
+	eLogInfo,		///< General information
+	eLogWarn,		///< Warnings
+	eLogError		///< Fatal errors (always written)
+};
+
+/// \enum eProfPhase
+/// \brief Phases timed by the profiler. The names written to the report 
+///			(Profiler.cpp) give the hierarchy, e.g. step/ibm/spread is within step.
+enum eProfPhase
+{
+	eProfInitMPI,			///< MPI topology and decomposition set up
+	eProfInitGrids,			///< Grid hierarchy and object initialisation
+	eProfStep,				///< LBM step on a grid (excluding sub-grids and halo exchange)
+	eProfLBM,				///< Fused stream, macroscopic and collide loop
+	eProfStreamMacro,		///< Stream and macroscopic loop (when split for IBM)
+	eProfCollide,			///< Collide loop (when split for IBM)
+	eProfIBMInterpolate,	///< IBM velocity interpolation
+	eProfIBMForce,			///< IBM force computation
+	eProfIBMSpread,			///< IBM force spreading
+	eProfIBMMacro,			///< IBM update of the macroscopic quantities
+	eProfIBMSupport,		///< IBM marker update and support search for moving bodies
+	eProfIBMEpsilon,		///< IBM epsilon calculation for moving bodies
+	eProfFEM,				///< FEM solution of flexible bodies
+	eProfMPIPack,			///< Halo buffer packing
+	eProfMPIWait,			///< Halo receive and send completion
+	eProfMPIUnpack,			///< Halo buffer unpacking
+	eProfIOText,			///< Text grid writer
+	eProfIOFga,				///< FGA writer
+	eProfIOLite,			///< IO lite writer
+	eProfIOHDF5,			///< HDF5 writer
+	eProfIOBodies,			///< Body and FEM VTK/VTU writers
+	eProfIOBodyPosition,	///< IB body position writer
+	eProfIOTips,			///< Filament tip position writer
+	eProfIOForces,			///< Lift and drag writers
+	eProfIOProbes,			///< Probe writer
+	eProfIORestart,			///< Restart writer
+	eProfPhases				///< Number of phases
+};
+
+/// \enum eBodySeries
+/// \brief	Body time series buffered by the Object Manager for output.
+enum eBodySeries
+{
+	eSeriesPosition,	///< IB body marker positions
+	eSeriesTips,		///< Flexible filament tip positions
+	eSeriesLiftDrag,	///< Forces on IB body markers
+	eSeriesForces,		///< Forces on bounce-back and BFL objects
+	eSeriesCount		///< Number of series
+};
+
+/// \enum eHwCounter
+/// \brief Hardware counters read by the profiler in each timed phase.
+enum eHwCounter
+{
+	eHwCycles,			///< CPU cycles
+	eHwInstructions,	///< Instructions retired
+	eHwCacheMisses,		///< Last level cache misses (each moves one cache line from memory)
+	eHwCounters			///< Number of counters
+};
+
+/// \enum eSiteCost
+/// \brief Enumeration of the site classes used by the decomposition cost model.
+enum eSiteCost
+{
+	eCostFluid,		///< Fluid site (including transition layers)
+	eCostSolid,		///< Site skipped by the kernel (solid or refined)
+	eCostBoundary,	///< Boundary site (BFL, velocity, pressure, slip or extrapolation)
+	eCostIBM,		///< IBM support site (in addition to the cost of its type)
+	eCostTypes		///< Number of cost classes
+};
+
 /// \enum eWallLocation
 /// \brief Enumeration to describe locations in terms of domain walls.
 enum eWallLocation
@@ -162,6 +248,25 @@ enum eHdf5SlabType {
 	ePosZ			///< 1D data	-- Single L_dim vector per dimension
 };
 
+/// \enum  eDerivedField
+/// \brief	Derived fields computed on output steps by the HDF5 writer.
+enum eDerivedField {
+	eDerivedVortX,			///< X-component of vorticity
+	eDerivedVortY,			///< Y-component of vorticity
+	eDerivedVortZ,			///< Z-component of vorticity
+	eDerivedQ,				///< Q-criterion
+	eDerivedStrainRate,		///< Magnitude of the strain rate tensor
+	eDerivedWallShear,		///< Magnitude of the wall shear stress (fluid sites next to solid only)
+	eDerivedFields			///< Number of derived fields
+};
+
+/// \enum  eRegridCriterion
+/// \brief	Quantity used to flag sites for refinement when regridding.
+enum eRegridCriterion {
+	eRegridVorticity,		///< Magnitude of the vorticity
+	eRegridStrainRate		///< Magnitude of the strain rate tensor
+};
+
 /// \enum  eMoveableType
 /// \brief Specifies the whether body is movable, flexible or rigid.
 enum eMoveableType {
@@ -37,6 +37,7 @@ class FEMBody {
 	friend class IBBody;
 	friend class ObjectManager;
 	friend class FEMElement;
+	friend class MpiManager;
 
 
 	/************** Nested classes **************/
@@ -101,6 +102,12 @@ class FEMBody {
 	std::vector<double> Udotdot;				///< Vector of accelerations
 	std::vector<double> Udotdot_n;				///< Vector of accelerations at start of current time step
 
+	// Aitken relaxation of the FSI coupling
+	int subIt;									///< Number of FEM solves performed in the current time step
+	double omega;								///< Current Aitken relaxation factor
+	std::vector<double> U_km1;					///< Relaxed displacements from previous coupling iteration
+	std::vector<double> res_km1;				///< Displacement residual from previous coupling iteration
+
 	// Vector of parent elements for each IBM node
 	std::vector<IBMParentElements> IBNodeParents;
 
@@ -114,10 +121,15 @@ class FEMBody {
 	void finishNewmark();										// Newmark-Beta scheme for getting FEM velocities and accelerations
 	void updateFEMValues();										// Update the FEM node data using the new displacements
 	void updateIBMarkers();										// Update the IBM markers using new FEM node vales
+	void aitkenRelaxation();									// Relax displacements using dynamic Aitken factor
 
 	// Helper methods
 	double checkNRConvergence();								// Check convergence of the Newton-Raphson scheme
 	void computeNodeMapping(int nIBMNodes, int nFEMNodes);		// Compute mapping between FEM and IBM nodes
+
+	// Migration between ranks
+	void packState(std::vector<double> &records);				// Append the structural state to a buffer
+	const double* unpackState(const double *records);			// Read the structural state back from a buffer
 };
 
 #endif
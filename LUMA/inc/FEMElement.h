@@ -47,6 +47,7 @@ class FEMElement {
 		// Set friend class
 		friend class FEMElement;
 		friend class ObjectManager;
+		friend class FEMBody;
 
 		// Constructor and destructor
 	public:
@@ -86,12 +86,53 @@ protected:
 	/// Vector indicating periodicity of grid
 	bool periodic_flags[3][L_NUM_LEVELS * L_NUM_REGIONS + 1];
 
+	/// \brief	Region of the parent of each sub-grid.
+	///
+	///			Accessed in the same way as the global edges. Sub-grids on L1 
+	///			are children of L0 (region 0). Deeper sub-grids start as children 
+	///			of the same region on the level above but a block built by the 
+	///			regrid (L_BLOCK_AMR) may have any block of that level as parent.
+	///
+	int parent_region[L_NUM_LEVELS * L_NUM_REGIONS + 1];
+
 	/// Dimensions of coarsest lattice represented on this rank (includes halo if using MPI).
 	std::vector<int> local_size;
 
 	/// Vector of structures containing writable region descriptors for block writing (HDF5)
 	std::vector<HDFstruct> p_data;
 
+	/// Relative cost of each site class used by the decomposition cost model
+	double costWeights[eCostTypes];
+
+	/// \brief	Measured cost map from a calibration run.
+	///
+	///			Sub-cycle weighted count of each cost class for every L0 site 
+	///			(accessed as [eSiteCost + id * eCostTypes] with L0 global site id). 
+	///			Empty if no cost map was provided.
+	///
+	std::vector<float> costMap;
+
+	/// \brief	Summed-volume table of the decomposition cost.
+	///
+	///			Element (i,j,k) holds the cost of all L0 sites with indices 
+	///			below i, j and k so the cost of any block is found from its 
+	///			eight corners. Built from the cost map if there is one or the 
+	///			analytical estimate if not.
+	///
+	std::vector<double> costTable;
+
+	/// \brief	IB support sites for the analytical cost estimate.
+	///
+	///			Position (x, y, z) and sub-cycle weight of every support site 
+	///			on all ranks stored as consecutive groups of four. Empty unless 
+	///			gathered before a decomposition. Binned into the cost table when 
+	///			there is no cost map.
+	///
+	std::vector<double> ibmCostSites;
+
+	/// Flag indicating whether the cost model input files have been read
+	bool bCostModelLoaded;
+
 	// METHODS //
 
 public:
@@ -105,6 +146,15 @@ private:
 	// Set the local size (MpiManager can set local size)
 	void setLocalCoarseSize(const std::vector<int>& size_vector);
 
+	// Move, create or remove a refined block at run time
+	void moveSubGrid(int lev, int reg, int parentReg, const double *edges);
+	bool isActive(int lev, int reg);
+	int getRegion(int lev, const double *pos);
+
+	// Record and restore the refined regions of a restart
+	void writeRestartRegions();
+	void readRestartRegions();
+
 	// Allow grid initialisation to store its writable data information
 	void createWritableDataStore(HDFstruct *& datastruct);
 	bool createWritableDataStore(GridObj const * const targetGrid);
@@ -113,6 +163,14 @@ private:
 	void updateGlobalCellCount();
 	long getActiveCellCount(double *bounds, bool bCountAsOps);
 	long getCellCount(int targetLevel, int targetRegion, double *bounds);
+	double getUnionVolume(int targetLevel, int targetRegion, double *bounds);
+
+	// Decomposition cost model
+	void loadCostModel();
+	void buildCostTable();
+	double getBlockCost(double *bounds);
+	double getAnalyticCost(double *bounds);
+	static eSiteCost getCostClass(eType type);
 
 
 private:
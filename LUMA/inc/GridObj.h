@@ -77,13 +77,10 @@ private :
 
 	// Vector nodal properties
 	// Flattened 4D arrays (i,j,k,vel)
-	IVector<double> f;				///< Distribution functions
-	IVector<double> feq;			///< Equilibrium distribution functions
-	IVector<double> fNew;			///< Copy of distribution functions
+	IVector<popType> f;				///< Distribution functions
+	IVector<popType> fNew;			///< Copy of distribution functions
 	IVector<double> u;				///< Macropscopic velocity components
-	IVector<double> u_n;			///< Macropscopic velocity components at start of current time step
 	IVector<double> force_xyz;		///< Macroscopic body force components
-	IVector<double> force_i;		///< Mesoscopic body force components
 
 	// Scalar nodal properties
 	// Flattened 3D arrays (i,j,k)
@@ -97,10 +94,42 @@ private :
 	// Grid scale parameter
 	double refinement_ratio;	///< Equivalent to (1 / pow(2, level))
 
+	// Probe data (only used on L0 which owns the probe output)
+	std::vector<int> probeIdx;				///< Global indices of the probes owned by this rank
+	std::vector<GridObj*> probeGrid;		///< Grid from which each owned probe is sampled
+	std::vector<int> probeSiteID;			///< Local flattened site index of each owned probe
+	std::vector<double> probeBuffer;		///< Buffered probe values awaiting write out
+	std::vector<int> probeBufferTimes;		///< Time steps of the buffered probe records
+	std::vector<int> probeCounts;			///< Number of probes owned by each rank (writer rank only)
+	std::vector<int> probeSlots;			///< Output slot of each gathered probe (writer rank only)
+	int probeNumWritten = 0;				///< Number of probe slots in each file record (writer rank only)
+	bool probeFileStarted = false;			///< Flag to indicate probe file header has been written
+
+	// Coarse-fine mappings (only used when there is refinement)
+	std::vector<int> refineChild;			///< Index in subGrid of the child under each transition-to-finer site (-1 elsewhere)
+	std::vector<int> refineChildBase;		///< Flattened index of the first child site of the cluster under each transition-to-finer site
+	std::vector<int> refineParent;			///< Flattened index of the parent site above each transition-to-coarser site (-1 elsewhere)
+	std::vector<int> coalesceDst;			///< Index in the parent fNew of each population coalesced from this grid
+	std::vector<int> coalesceSrc;			///< Index in f of the first population of the cluster averaged for each coalesced population (of every site of the cluster with a sparse lattice)
+
+#ifdef L_SPARSE_LATTICE
+	// Sparse lattice storage (only used when populations are stored for non-solid sites only)
+	IVector<int> popSite;					///< Flattened 3D array of the position of the populations of each site in f (solid sites share a scratch entry)
+	std::vector<int> sparseSites;			///< Flattened index of each site whose populations are stored, in storage order
+	IVector<int> sparseSrc;					///< Index in f of the population pulled by each stored population (-1 where the stream needs the source label)
+#endif
+
+	void (GridObj::*_LBM_kernel)(int) = nullptr;	///< Optimised kernel instantiated for the run-time collision model
+
+	bool bMeshChanged = false;				///< Flag to indicate the grid has been rebuilt so positions must be written out again
+
 	// Public data members
 public :
 
 	IVector<eType> LatTyp;			///< Flattened 3D array of site labels
+#ifdef L_STREAM_MASK
+	IVector<maskType> streamMask;	///< Flattened 3D array of bits set where the source site in direction v is not plain fluid
+#endif
 
 	// Grid Scalars
 	double dh;						///< Dimensionless lattice spacing (same for x, y and z)
@@ -140,39 +169,84 @@ public :
 	void LBM_initPositionVector(double start_pos, double end_pos, eCartesianDirection dir);	// Initialise position vector
 	void LBM_initBoundLab();					// Initialise labels for walls
 	void LBM_initRefinedLab(GridObj& pGrid);	// Initialise labels for refined regions
-	eType LBM_setBCPrecedence(eType currentBC, eType desiredBC);		// Determine BC based on any existing BC
+	static eType LBM_setBCPrecedence(eType currentBC, eType desiredBC);	// Determine BC based on any existing BC
+	void LBM_initStreamMask();					// Build the streaming mask (or sparse lattice) from the site labels
+	void LBM_initRefinedMaps();					// Build the coarse-fine index maps and coalesce lists from the site labels
+
+	/// Index in f and fNew of population v of the site with flattened index id
+	inline int popIdx(int id, int v = 0) const
+	{
+#ifdef L_SPARSE_LATTICE
+		return v + popSite[id] * L_NUM_VELS;
+#else
+		return v + id * L_NUM_VELS;
+#endif
+	}
+
+	/// Index in f and fNew of population v of site (i,j,k)
+	inline int popIdx(int i, int j, int k, int v) const
+	{
+		return popIdx(k + j * K_lim + i * K_lim * M_lim, v);
+	}
 
 	// LBM operations
-	DEPRECATED void LBM_kbcCollide(int i, int j, int k, IVector<double>& f_new);		// KBC collision operator
+	DEPRECATED void LBM_kbcCollide(int i, int j, int k, IVector<popType>& f_new);		// KBC collision operator
 	void LBM_macro(int i, int j, int k);
 	DEPRECATED void LBM_resetForces();								// Resets the force vectors on the grid
 
 	// Multi-grid operations
 	void LBM_addSubGrid(int RegionNumber);				// Add and initialise subgrid structure for a given region number
+	void LBM_rebuildHierarchy();						// Rebuild this grid and its sub-grids after a change of decomposition
+	bool LBM_regrid();									// Refine and coarsen the blocks to follow the flow features
+	static int LBM_siteRecordSize();					// Number of values in the record of a migrated site
+	void LBM_packSites(std::vector<double>& records);	// Pack the core sites of this grid and its sub-grids into records
+	void LBM_unpackSites(const double *records, int numRecords, bool bRegrid);	// Unpack site records into this grid and its sub-grids
 
 	// IO methods
 	void io_textout(std::string output_tag);	// Writes out the contents of the class as well as any subgrids to a text file
 	void io_fgaout();							// Wrapper for _io_fgaout with 2/3D checking 
 	void io_restart(eIOFlag IO_flag);			// Reads/writes data from/to the global restart file
-	void io_probeOutput();						// Output routine for point probes
+	size_t io_memoryReport();					// Writes the memory footprint of the grid fields to the log
+	void io_initProbes(bool bWriteHeader = true);	// Builds the probe to grid site mapping once
+	void io_probeOutput();						// Buffers probe data and writes when buffer is full
+	void io_probeFlush();						// Gathers buffered probe data and writes it to file
 	void io_lite(double tval, std::string Tag);	// Generic writer to individual files with Tag
 	int io_hdf5(double tval);					// HDF5 writer returning integer to indicate success or failure
+	void io_hdf5InitVelocity();					// Reads and interpolates the initial velocity from an HDF5 file
 
 private :
 
 	void _LBM_initGetInletProfileFromFile();		// Set inlet profile data from file
 	void _LBM_initSetInletProfile();				// Set the inlet profile data used for velocity BCs
+	void _LBM_initPopulations();					// Allocate and set f and fNew to equilibrium (deferred with a sparse lattice)
+#ifdef L_SPARSE_LATTICE
+	void _LBM_initSparseLattice();					// Allocate or compact f and fNew for the non-solid sites and build the neighbour table
+#endif
+	void _io_computeDerived(std::vector<double> *fields);	// Compute the derived fields written by io_hdf5
+	void _LBM_regridFlag(std::vector<long long>& tags);	// Tag the tiles of the child level which require refinement
+	void _LBM_regridCoalesce();						// Average the sub-grid data onto all refined sites of this grid
+	void _LBM_regridFill(const std::vector<char>& bSet);	// Fill sites of a changed block which were not on the old block
+	static void _LBM_regridTileCount(int lev, int *numTiles);	// Number of regrid tiles of a level in each direction
+	static void _LBM_regridTileOf(int lev, const double *pos, int *tile);	// Tile of a level which holds a position
+	static void _LBM_regridTileIndices(int lev, long long key, int *tile);	// Tile of a level with a given key
+	static void _LBM_regridTagBox(int lev, const int *box, std::vector<long long>& tags);	// Tag every tile of a level in a box of tiles
+	static void _LBM_regridCluster(int lev, const std::vector<long long>& tags, std::vector<int>& blocks);	// Cluster the tagged tiles of a level into blocks
 	void _LBM_updateReynolds(double newReynolds);		// Updates the reynolds number at run time
 	void _io_fgaout(int timeStepL0);		// Writes out the macroscopic velocity components for the class as well as any subgrids 
 											// to a different .fga file for each subgrid. .fga format is the one used for Unreal 
 											// Engine 4 VectorField object.
 	// Private optimised LBM functions
+	void _LBM_initKernel_opt();
+	template <eCollisionModel C> void _LBM_kernel_opt(int subcycle);
+#ifdef L_SPARSE_LATTICE
+	template <eCollisionModel C> void _LBM_sparseKernel_opt(int subcycle);
+#endif
 	void _LBM_stream_opt(int i, int j, int k, int id, eType type_local, int subcycle);
-	void _LBM_coalesce_opt(int i, int j, int k, int id, int v);
-	void _LBM_explode_opt(int id, int v, int src_x, int src_y, int src_z);
-	void _LBM_collide_opt(int id);
+	void _LBM_coalesce_opt();
+	void _LBM_explode_opt(int id, int v, int src_id);
+	template <eCollisionModel C> void _LBM_collide_opt(int id);
 	void _LBM_macro_opt(int i, int j, int k, int id, eType type_local);
-	void _LBM_forceGrid_opt(int id);
+	double _LBM_forceGrid_opt(int id, int v);
 	double _LBM_equilibrium_opt(int id, int v);
 	bool _LBM_applyBFL_opt(int id, int src_id, int v, int i, int j, int k, int src_x, int src_y, int src_z);
 	bool _LBM_applySpecReflect_opt(int i, int j, int k, int id, int v);
@@ -44,6 +44,7 @@ class IBBody : public Body<IBMarker> {
 	friend class FEMBody;
 	friend class FEMElement;
 	friend class MpiManager;
+	friend class GridObj;
 
 public:
 
@@ -25,6 +25,48 @@
 
 #include "stdafx.h"
 
+/// \brief	Allocator which can leave new elements default-initialised.
+///
+///			std::vector zeroes the elements added by resize() on the calling
+///			thread which touches every page of the array there. While 
+///			bDefaultInit is set on a thread, elements constructed without a 
+///			value are default-initialised instead so the pages of arithmetic 
+///			types are not touched until they are first written. Otherwise it
+///			behaves as std::allocator. Only set through 
+///			IVector::resizeUninitialised().
+template <typename T>
+class IVectorAllocator : public std::allocator<T>
+{
+public:
+	static thread_local bool bDefaultInit;	///< Default-initialise new elements on this thread
+
+	/// Rebind to an allocator of another type
+	template <typename U>
+	struct rebind { typedef IVectorAllocator<U> other; };
+
+	/// Default constructor
+	IVectorAllocator() {}
+
+	/// Converting constructor
+	template <typename U>
+	IVectorAllocator(const IVectorAllocator<U>&) {}
+
+	/// Value-initialise unless default initialisation has been requested
+	template <typename U>
+	void construct(U *p)
+	{
+		if (bDefaultInit) ::new (static_cast<void*>(p)) U;
+		else ::new (static_cast<void*>(p)) U();
+	}
+
+	/// Construct from arguments
+	template <typename U, typename... Args>
+	void construct(U *p, Args&&... args) { ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...); }
+};
+
+template <typename T>
+thread_local bool IVectorAllocator<T>::bDefaultInit = false;
+
 /// \brief	Index-collapsing vector class.
 ///
 ///			This class has all the behaviour of std::vector but 
@@ -32,7 +74,7 @@
 ///			before returning a reference of value at indexed location.
 ///			Needs to be able to accept different datatypes so templated.
 template <typename GenTyp>
-class IVector :	public std::vector<GenTyp>		// Define IVector class which inherits from std::vector
+class IVector :	public std::vector<GenTyp, IVectorAllocator<GenTyp>>		// Define IVector class which inherits from std::vector
 {
 	
 public:
@@ -71,6 +113,28 @@ public:
 	
 
 
+	/// \brief	Resize leaving any new elements uninitialised.
+	///
+	///			Used for the large lattice arrays so that their pages are first
+	///			touched by the threaded initialisation loops and placed on the 
+	///			NUMA node of the thread which later computes on them. The new 
+	///			elements must be written before they are read.
+	///
+	/// \param size the desired size of vector
+	void resizeUninitialised(size_t size) {
+
+		IVectorAllocator<GenTyp>::bDefaultInit = true;
+		try {
+			this->resize(size);
+		}
+		catch (...) {
+			IVectorAllocator<GenTyp>::bDefaultInit = false;
+			throw;
+		}
+		IVectorAllocator<GenTyp>::bDefaultInit = false;
+
+	}
+
 	/*	
 	 * :::: USE OF REFERENCES ::::
 	 * Return reference (not the same as a pointer but similar) of the particular element in the 1D array.
@@ -0,0 +1,118 @@
+/*
+* --------------------------------------------------------------
+*
+* ------ Lattice Boltzmann @ The University of Manchester ------
+*
+* -------------------------- L-U-M-A ---------------------------
+*
+* Copyright 2019 The University of Manchester
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.*
+*/
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <mpi.h>
+
+#define L_LOG_BUFFER_BYTES (1 << 20)	///< Buffered bytes per log above which it is handed off before the flush interval
+
+/// \brief	In-memory buffer standing in for the file buffer of a log stream.
+///
+///			Text written to the stream, including std::endl, only appends to
+///			memory. At the end of each line the Logger decides whether the
+///			buffered text should be handed off for writing.
+class LogBuffer : public std::streambuf
+{
+	friend class Logger;
+
+public:
+	LogBuffer(std::ostream &stream, std::streambuf *sink, const std::string &prefix);
+
+private:
+	std::ostream &stream;		///< Stream this buffer is installed in
+	std::streambuf *original;	///< Buffer the stream had before (restored on detach)
+	std::streambuf *sink;		///< File buffer the text is written to (nullptr when aggregated)
+	std::string prefix;			///< Prefix added to each line (identifies the rank when aggregated)
+	std::string pending;		///< Text not yet handed off
+	bool bLineStart;			///< Next character starts a new line
+
+protected:
+	int overflow(int ch) override;
+	std::streamsize xsputn(const char *s, std::streamsize n) override;
+	int sync() override;
+};
+
+/// \brief	Buffered logging backend.
+///
+///			Static class owning the buffers of the log streams (the application
+///			log and the MPI log). Each rank keeps its log text in memory and
+///			hands it off when L_LOG_FLUSH_INTERVAL seconds have passed since the
+///			last hand off, when L_LOG_BUFFER_BYTES are buffered, on an error
+///			and at exit. The per-rank files are written by a background thread
+///			so the time stepping never waits on the file system. With
+///			L_LOG_AGGREGATE set in an MPI build all ranks instead write to a
+///			single log_all.log through non-blocking MPI-IO on the shared file
+///			pointer with each line prefixed by the rank.
+///
+///			Messages written with L_DEBUG, L_INFO and L_WARN below L_LOG_LEVEL
+///			are discarded before they are formatted.
+class Logger
+{
+
+	// Properties //
+
+private:
+	static std::vector<LogBuffer*> buffers;	///< Buffers of the attached streams
+	static double lastHandOff;				///< Time of the last hand off (s)
+	static bool bAggregate;					///< Writing to the single aggregated log
+
+	// Writer thread (per-rank logs)
+	static std::thread writer;						///< Thread writing handed off text to file
+	static std::mutex queueMutex;					///< Protects the queue and writer state
+	static std::condition_variable queueCond;		///< Signals new text, completion and stop
+	static std::deque<std::pair<std::streambuf*, std::string>> queue;	///< Text waiting to be written and its file
+	static bool bWriting;							///< Writer is busy with text taken off the queue
+	static bool bStop;								///< Writer should exit once the queue is empty
+
+	// Aggregated log (MPI builds)
+	static MPI_File file;				///< Shared log file
+	static MPI_Request request;			///< Outstanding write
+	static std::string inFlight;		///< Text being written by the outstanding request
+
+
+	// Methods //
+
+private:
+	/// Private constructor since class is static
+	Logger();
+	/// Private destructor
+	~Logger();
+
+public:
+	static bool attach(std::ofstream &stream, const std::string &name);
+	static void lineEnded(LogBuffer &buffer);
+	static void flush();
+	static void close(bool bCollective = true);
+
+private:
+	static void _handOff();
+	static void _write();
+	static void _closeAtExit();
+};
+
+#endif
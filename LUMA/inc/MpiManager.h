@@ -54,7 +54,7 @@ class MpiManager
 		// Copy constructor
 		SDData(SDData& other)
 			: XSol(other.XSol), YSol(other.YSol), ZSol(other.ZSol),
-			theta(other.theta), thetaNew(other.thetaNew), delta(other.delta)
+			theta(other.theta), delta(other.delta), thetaNew(other.thetaNew)
 		{ };
 
 		// Solution vectors
@@ -73,15 +73,14 @@ class MpiManager
 	{
 	public:
 		LoadImbalanceData()
-		{
-			heaviestBlock.resize(3);
-		};
+			: loadImbalance(0.0), uniImbalance(0.0), heaviestOps(0), heaviestBlock(3)
+		{ };
 		~LoadImbalanceData() {};
 
 		// Copy constructor
 		LoadImbalanceData(LoadImbalanceData& other)
 			: loadImbalance(other.loadImbalance), uniImbalance(other.uniImbalance),
-			heaviestBlock(other.heaviestBlock), heaviestOps(other.heaviestOps)
+			heaviestOps(other.heaviestOps), heaviestBlock(other.heaviestBlock)
 		{ };
 
 		double loadImbalance;		///< Imbalance assocaited with smart decomposition.
@@ -149,6 +148,9 @@ public :
 	/// Vector of size num_ranks which indicates how many sub-grids each rank has access to
 	std::vector<int> rankGrids;
 
+	/// Kernel time, MPI time and time step of each grid when load measurement last started
+	std::vector<double> loadTimeMarks;
+
 	/// \struct HaloEdgeStruct
 	/// \brief	Structure containing absolute positions of the edges of halos.
 	///
@@ -166,8 +168,8 @@ public :
 	
 
 	// Buffer data
-	std::vector< std::vector<double>> f_buffer_send;	///< Array of resizeable outgoing buffers used for data transfer
-	std::vector< std::vector<double>> f_buffer_recv;	///< Array of resizeable incoming buffers used for data transfer
+	std::vector< std::vector<popType>> f_buffer_send;	///< Array of resizeable outgoing buffers used for data transfer
+	std::vector< std::vector<popType>> f_buffer_recv;	///< Array of resizeable incoming buffers used for data transfer
 	MPI_Status recv_stat;					///< Status structure for Receive return information
 	MPI_Request send_requests[L_MPI_DIRS];	///< Array of request structures for handles to posted ISends
 	MPI_Status send_stat[L_MPI_DIRS];		///< Array of statuses for each ISend
@@ -195,6 +197,29 @@ public :
 	std::vector<std::vector<SupportCommMarkerSideClass>> supportCommMarkerSide;		///< Marker-side marker-support comm
 	std::vector<std::vector<SupportCommSupportSideClass>> supportCommSupportSide;	///< Support-side marker-support comm
 
+	/// \struct NeighbourCommStruct
+	/// \brief	Persistent neighbourhood for the FEM exchanges on a level.
+	///
+	///			Wraps a distributed graph communicator built over the level 
+	///			communicator whose out-neighbours are the ranks this rank sends 
+	///			to. Buffers are kept between calls so are only reallocated when
+	///			the messages grow.
+	struct NeighbourCommStruct
+	{
+		MPI_Comm comm = MPI_COMM_NULL;					///< Distributed graph communicator
+		std::vector<int> destSet;						///< Sorted world ranks the graph was built for
+		std::vector<int> destinations;					///< World ranks of out-neighbours in graph order
+		std::vector<int> sources;						///< World ranks of in-neighbours in graph order
+		std::unordered_map<int, int> destIdx;			///< Out-neighbour index of a world rank
+		std::unordered_map<int, int> srcIdx;			///< In-neighbour index of a world rank
+		std::vector<int> sendCounts, sendDisps;			///< Per out-neighbour counts and displacements
+		std::vector<int> recvCounts, recvDisps;			///< Per in-neighbour counts and displacements
+		std::vector<int> cursor;						///< Packing / unpacking position per neighbour
+		std::vector<double> sendBuffer, recvBuffer;		///< Message buffers
+	};
+	std::vector<NeighbourCommStruct> forceNeighbours;	///< Marker ranks to body owner neighbourhood for each level
+	std::vector<NeighbourCommStruct> markerNeighbours;	///< Body owner to marker ranks neighbourhood for each level
+
 
 
 	/************** Member Methods **************/
@@ -206,6 +231,7 @@ public :
 	// Initialisation
 	void mpi_init();												// Initialisation of MpiManager & Cartesian topology
 	void mpi_gridbuild(GridManager* const grid_man);				// Do domain decomposition to build local grid dimensions
+	void mpi_setBlockLayout(GridManager* const grid_man);			// Set local grid size and edge positions from block sizes
 	void mpi_communicateBlockEdges();								// Get the positional limits of all ranks
 	int mpi_buildCommunicators(GridManager* const grid_man);		// Create a new communicator for each sub-grid and region combo
 	void mpi_updateLoadInfo(GridManager* const grid_man);			// Method to compute the number of active cells on the rank and pass to master
@@ -217,6 +243,16 @@ public :
 	void mpi_SDComputeImbalance(LoadImbalanceData& load, SDData& solutionData, std::vector<int>& numCores);
 	bool mpi_SDCheckDelta(SDData& solutionData, double dh, std::vector<int>& numCores);
 	void mpi_SDCommunicateSolution(SDData& solutionData, double imbalance, double dh);
+	void mpi_SDCalibrate(bool bWriteFiles = true);					// Method to calibrate the decomposition cost model from timings
+	void mpi_SDGatherIBMSites();									// Method to share the IB support sites with all ranks for the cost model
+	void mpi_getStepTimes(double& lbmTime, double& mpiTime, bool bReset);	// Method to get the measured time per coarse time step
+	bool mpi_rebalance(GridObj* const Grids);						// Method to redistribute the grid if the measured load is imbalanced
+	void mpi_redistribute(GridObj* const Grids, bool bRegrid = false);	// Method to send all sites to the ranks holding them in a new layout
+	void mpi_exchangeRecords(std::vector<std::vector<double>>& sendBuffer,
+		std::vector<double>& recvData);								// Method to send a buffer of records to each rank
+	void mpi_redistributeBFLBodies(std::vector<double>& markers);	// Method to rebuild the BFL bodies on the grids of a new layout
+	void mpi_redistributeIBBodies(GridObj* const Grids, const std::vector<int>& bodyLev,
+		const std::vector<int>& bodyReg);							// Method to move the IB bodies onto the ranks holding their grids
 	void mpi_setSubGridDepth();										// Method to initialise the rankGrids variable
 
 	// Helper functions
@@ -252,8 +288,12 @@ public :
 	void mpi_ptCloudMarkerScatter(IBBody *iBody, std::vector<int> &recvIDBuffer, std::vector<int> &recvSizeBuffer, std::vector<int> &recvDisps);	// Scatter info for pt cloud sorter
 
 	// FEM
+	void mpi_updateNeighbourComm(int level, NeighbourCommStruct& nc, std::vector<int>& destinations);	// Rebuild a neighbourhood if any destinations have changed
+	void mpi_freeNeighbourComms();																		// Release all neighbourhoods
+	void mpi_updateForceNeighbours(int level);															// Update the force neighbourhood from the marker-side comms
+	int mpi_getNeighbourIdx(const std::unordered_map<int, int>& idxMap, int rank, int level);			// Get the neighbour index of a world rank
 	void mpi_forceCommGather(int level);
-	void mpi_spreadNewMarkers(int level, std::vector<std::vector<int>> &markerIDs, std::vector<std::vector<std::vector<double>>> &positions, std::vector<std::vector<std::vector<double>>> &vels);
+	void mpi_spreadNewMarkers(int level, std::vector<std::vector<int>> &markerIDs, std::vector<std::vector<std::vector<double>>> &positions, std::vector<std::vector<std::vector<double>>> &vels, bool bAllBodies = false);
 };
 
 #endif
@@ -86,10 +86,29 @@ class ObjectManager
 
 	};
 
+	/// \brief	Time series of body data buffered for output.
+	///
+	///			Records of (time step, ID, number of items, items) are stored as
+	///			doubles until L_BODY_BUFFER_STEPS write outs have been buffered
+	///			and are then appended to a single binary file for the run.
+	class BodySeries
+	{
+	public:
+		std::string fileName;			///< File name in the output directory
+		int stride = 0;					///< Values per item
+		bool bSum = false;				///< Records with the same time step and ID are summed over ranks
+		bool bFileStarted = false;		///< File header has been written (writer rank only)
+		int numSteps = 0;				///< Write outs held in the buffer
+		std::vector<double> buffer;		///< Records awaiting write out
+	};
+
 	/* Members */
 
 private:
 
+	// Buffered body output
+	BodySeries bodySeries[eSeriesCount];	///< Body time series awaiting write out
+
 	// Private file stream for debugging momentum exchange
 	std::ofstream debugstream;
 
@@ -124,6 +143,11 @@ private:
 	double timeav_subResidual;
 	double timeav_subIterations;
 
+	// Support sites modified by IBM during the current time step (per grid indexed as in the GridManager) and their start-of-step velocities
+	std::vector<std::vector<int>> subSupportSites;
+	std::vector<std::vector<double>> subSupportVel;
+	std::vector<std::unordered_map<int, size_t>> subSupportSlot;
+
 	/* Methods */
 
 private:
@@ -150,12 +174,14 @@ public:
 	void ibm_computeForce(int level);												// Compute restorative force at each marker in ib-th body.
 	void ibm_findEpsilon(int level);												// Method to find epsilon weighting parameter for ib-th body.
 	void ibm_computeDs(int level);
-	void ibm_moveBodies(int level);													// Update all IBBody positions and support.
+	void ibm_moveBodies(GridObj *g);												// Update all IBBody positions and support.
 	void ibm_finaliseReadIn(int iBodyID);											// Do some house-keeping after geometry read in
 	void ibm_universalEpsilonGather(int level, IBBody &iBodyTmp);					// Gather all the markers into the temporary iBody vector
 	void ibm_universalEpsilonScatter(int level, IBBody &iBodyTmp);					// Gather all the markers into the temporary iBody vector
 	void ibm_subIterate(GridObj *g);												// Subiterate to enforce correct kinematic conditions at interface
 	double ibm_checkVelDiff(int level);												// Check residual from sub-iteration step
+	void ibm_recordSupportSite(GridObj *g, int id);									// Store start-of-step velocity at a support site on first touch
+	void ibm_resetSupportSites(GridObj *g);											// Restore velocity and reset force at recorded support sites
 
 	// IBM Debug methods //
 	void ibm_debug_epsilon(int ib);
@@ -170,7 +196,7 @@ public:
 	void ibm_updateMPIComms(int level);
 	void ibm_interpolateOffRankVels(int level);
 	void ibm_spreadOffRankForces(int level);
-	void ibm_updateMarkers(int level);
+	void ibm_updateMarkers(int level, bool bAllBodies = false);
 
 	// Bounceback Body Methods
 	void addBouncebackObject(GeomPacked *geom, PCpts *_PCpts);				// Override method to add BBB from cloud reader.
@@ -178,9 +204,12 @@ public:
 	void computeLiftDrag(int i, int j, int k, GridObj *g);			// Compute force using Momentum Exchange for BBB on supplied grid.
 	void computeLiftDrag(int v, int id, GridObj *g, int markerID);	// Compute force using Momentum Exchange for BFL on supplied grid.
 	void resetMomexBodyForces(GridObj * grid);						// Reset the force stores for Momentum Exchange
+	void bfl_packMarkers(std::vector<double>& markers);			// Store the BFL markers before the grids are rebuilt
+	void bfl_buildFromMarkers(std::vector<double>& markers);		// Rebuild the BFL bodies on new grids from their markers
 
 	// IO methods //
 	void io_vtkBodyWriter(int tval);						// VTK body writer wrapper
+	void io_vtuBodyWriter(int tval);						// Aggregated binary VTU body writer (all bodies, one file)
 	void io_vtkFEMWriter(int tval);							// VTK FEM writer
 	void io_writeBodyPosition(int timestep);				// Write out IBBody positions at specified timestep to text files
 	void io_writeLiftDrag();								// Write out IBBody lift and drag at specified timestep
@@ -189,6 +218,14 @@ public:
 	void io_writeForcesOnObjects(double tval);				// Method to write object forces to a csv file
 	void io_readInGeomConfig();								// Read in geometry configuration file
 	void io_writeTipPositions(int t);						// Write out tip positions of flexible filaments
+	void io_bodySeriesFlush();								// Write out all buffered body time series
+
+private:
+	void _io_bodySeriesRecord(eBodySeries s, int t, int id, size_t numItems);	// Start a record in a body series
+	void _io_bodySeriesEndStep(eBodySeries s);				// Count a write out and flush the series if full
+	void _io_bodySeriesFlush(eBodySeries s);				// Gather a series and append it to its file
+
+public:
 
 	// Debug
 	void toggleDebugStream(GridObj *g);		// Method to open/close a debugging file
@@ -0,0 +1,114 @@
+/*
+* --------------------------------------------------------------
+*
+* ------ Lattice Boltzmann @ The University of Manchester ------
+*
+* -------------------------- L-U-M-A ---------------------------
+*
+* Copyright 2019 The University of Manchester
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.*
+*/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#define L_PROF_GRIDS (1 + L_NUM_LEVELS * L_NUM_REGIONS)	///< Number of grids which may be timed
+
+#define L_HW_STREAM_SIZE (1 << 23)	///< Elements of each array of the bandwidth measurement (should exceed the caches)
+
+// Phase timing shorthand (compiled out unless timings are logged)
+#if defined L_HW_COUNTERS
+#define L_PROF_START(tvar) ProfMark tvar; Profiler::mark(tvar)	///< Start a phase timer and read the counters
+#define L_PROF_STOP(tvar, phase, lev, reg) Profiler::add(phase, lev, reg, tvar)	///< Stop a phase timer and record it with the counters
+#elif defined L_LOG_TIMINGS
+#define L_PROF_START(tvar) double tvar = Profiler::now()	///< Start a phase timer
+#define L_PROF_STOP(tvar, phase, lev, reg) Profiler::add(phase, lev, reg, Profiler::now() - tvar)	///< Stop a phase timer and record it
+#else
+#define L_PROF_START(tvar)
+#define L_PROF_STOP(tvar, phase, lev, reg)
+#endif
+
+#ifdef L_HW_COUNTERS
+/// \brief	Time and hardware counter values at the start of a phase.
+struct ProfMark
+{
+	double t;					///< Wall-clock time (s)
+	long long hw[eHwCounters];	///< Counter values
+};
+#endif
+
+/// \brief	Wall-clock phase profiler.
+///
+///			Static class accumulating the wall-clock time and number of calls
+///			of each phase (eProfPhase) on each grid. Phases not tied to a grid
+///			(initialisation and I/O) are recorded against L0. At the end of
+///			the run the totals are gathered and the min / mean / max across
+///			the ranks which recorded each timer are written to timings.json
+///			and timings.csv in the output directory.
+///
+///			With L_HW_COUNTERS the cycles, instructions and last level cache
+///			misses of each phase are also read from Linux perf events and
+///			written to hwcounters.csv alongside the memory bandwidth measured
+///			by a STREAM triad at start up.
+class Profiler
+{
+
+	// Properties //
+
+private:
+	static double total[L_PROF_GRIDS][eProfPhases];	///< Accumulated time of each phase on each grid (s)
+	static long calls[L_PROF_GRIDS][eProfPhases];	///< Number of calls of each phase on each grid
+	static const char *names[eProfPhases];			///< Names of the phases in the report
+#ifdef L_HW_COUNTERS
+	static long long hwTotal[L_PROF_GRIDS][eProfPhases][eHwCounters];	///< Accumulated counts of each phase on each grid
+	static std::vector<int> hwFd[eHwCounters];		///< perf event file descriptors of each thread which could open them
+	static double streamBandwidth;					///< Memory bandwidth measured at start up (bytes/s)
+#endif
+
+
+	// Methods //
+
+private:
+	/// Private constructor since class is static
+	Profiler();
+	/// Private destructor
+	~Profiler();
+
+public:
+	/// \brief	Returns the wall-clock time.
+	/// \return	time in seconds from an arbitrary origin.
+	static double now()
+	{
+#ifdef L_BUILD_FOR_MPI
+		return MPI_Wtime();
+#else
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+
+	static void add(eProfPhase phase, int level, int region, double dt);
+	static double elapsed(eProfPhase phase, int level, int region);
+	static void writeReport();
+#ifdef L_HW_COUNTERS
+	static void initCounters();
+	static void mark(ProfMark &m);
+	static void add(eProfPhase phase, int level, int region, const ProfMark &start);
+
+private:
+	static void _measureBandwidth();
+	static void _writeCounterReport(const std::vector<double> &allTotal, int nRanks);
+#endif
+};
+
+#endif
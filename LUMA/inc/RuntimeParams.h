@@ -0,0 +1,216 @@
+/*
+* --------------------------------------------------------------
+*
+* ------ Lattice Boltzmann @ The University of Manchester ------
+*
+* -------------------------- L-U-M-A ---------------------------
+*
+* Copyright 2019 The University of Manchester
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.*
+*/
+
+#ifndef RUNTIMEPARAMS_H
+#define RUNTIMEPARAMS_H
+
+/// Compile-time values of the run-time parameters. These are captured here
+/// before the macros are redirected below and are used as the defaults.
+namespace L_defaults
+{
+	const int totalTimesteps = L_TOTAL_TIMESTEPS;
+	const int gridOutFreq = L_GRID_OUT_FREQ;
+	const int extraOutFreq = L_EXTRA_OUT_FREQ;
+	const int restartOutFreq = L_RESTART_OUT_FREQ;
+	const int probeOutFreq = L_PROBE_OUT_FREQ;
+	const int outputPrecision = L_OUTPUT_PRECISION;
+	const double resolution = L_RESOLUTION;
+	const double timestep = L_TIMESTEP;
+	const double physicalU = L_PHYSICAL_U;
+	const double physicalRho = L_PHYSICAL_RHO;
+	const double ux0 = L_UX0;
+	const double uy0 = L_UY0;
+	const double uz0 = L_UZ0;
+	const double rhoIn = L_RHOIN;
+	const double re = L_RE;
+	const double relax = L_RELAX;
+	const double cSmag = L_CSMAG;
+	const double gravityForce = L_GRAVITY_FORCE;
+	const eType wall[6] = { L_WALL_LEFT, L_WALL_RIGHT, L_WALL_BOTTOM, L_WALL_TOP, L_WALL_FRONT, L_WALL_BACK };
+	const int mpiCores[3] = { L_MPI_XCORES, L_MPI_YCORES, L_MPI_ZCORES };
+	const int mpiSDMaxIter = L_MPI_SD_MAX_ITER;
+	const int mpiRebalanceFreq = L_MPI_REBALANCE_FREQ;
+	const double mpiRebalanceThreshold = L_MPI_REBALANCE_THRESHOLD;
+	const int regridFreq = L_REGRID_FREQ;
+	const double regridThreshold = L_REGRID_THRESHOLD;
+	const eLogLevel logLevel = L_LOG_LEVEL;
+	const double logFlushInterval = L_LOG_FLUSH_INTERVAL;
+	const int logAggregate = L_LOG_AGGREGATE;
+#if defined L_USE_KBC_COLLISION
+	const eCollisionModel collisionModel = eKBC;
+#elif defined L_USE_BGKSMAG
+	const eCollisionModel collisionModel = eBGKSmag;
+#else
+	const eCollisionModel collisionModel = eBGK;
+#endif
+}
+
+/// \brief	Run-time parameters.
+///
+///			Static class holding the parameters which do not change the
+///			structure of the code and so may be changed without recompiling.
+///			The values in definitions.h are the defaults and may be overridden
+///			by "NAME value" lines in ./input/params.in (or a file given as the
+///			first command line argument). The macros are redirected to the
+///			members of this class so they may be used as before.
+///
+///			The collision model is the only kernel choice made at run time.
+///			The lattice (L_DIMS and the velocity set) is still fixed at 
+///			compile time since it sizes arrays and selects code throughout,
+///			so a binary runs one lattice only and the test suite compiles
+///			each case. L_LATTICE in the parameter file is only checked 
+///			against the compiled lattice so a job given the wrong binary 
+///			stops at start up.
+class RuntimeParams
+{
+
+	// Properties //
+
+public:
+	static int totalTimesteps;				///< Number of time steps to run simulation for
+	static int gridOutFreq;					///< Timesteps between grid output
+	static int extraOutFreq;				///< Timesteps between extra (forces, probes) output
+	static int restartOutFreq;				///< Timesteps between restart files
+	static int probeOutFreq;				///< Timesteps between probe output
+	static int outputPrecision;				///< Precision of text output
+	static double resolution;				///< Coarse lattice sites per unit length
+	static double timestep;					///< Non-dimensional time step
+	static double physicalU;				///< Reference velocity in physical units
+	static double physicalRho;				///< Reference density in physical units
+	static double ux0;						///< Initial/inlet x-velocity
+	static double uy0;						///< Initial/inlet y-velocity
+	static double uz0;						///< Initial/inlet z-velocity
+	static double rhoIn;					///< Initial density in lattice units
+	static double re;						///< Reynolds number
+	static double relax;					///< Under-relaxation for FSI coupling
+	static double cSmag;					///< Smagorinsky constant
+	static double gravityForce;				///< Magnitude of the gravity force
+	static eType wall[6];					///< Boundary condition on each side of the domain
+	static int mpiCores[3];					///< Number of MPI ranks in each direction
+	static int mpiSDMaxIter;				///< Max iterations of the smart decomposition
+	static int mpiRebalanceFreq;			///< Coarse time steps between load balance checks
+	static double mpiRebalanceThreshold;	///< Imbalance (%) above which the grid is redistributed
+	static int regridFreq;				///< Coarse time steps between regrids
+	static double regridThreshold;		///< Scaled criterion above which sites are refined
+	static eCollisionModel collisionModel;	///< Collision operator used by the optimised kernel
+	static eLogLevel logLevel;				///< Lowest severity written to the log
+	static double logFlushInterval;			///< Seconds between writes of the buffered log
+	static int logAggregate;				///< Write all ranks to a single log file (1) or one per rank (0)
+
+private:
+	static std::string fileName;					///< Name of the parameter file read
+	static std::vector<std::string> changed;		///< Parameters changed from their defaults
+	static std::vector<std::string> unknown;		///< Unrecognised lines in the parameter file
+	static std::vector<std::string> ignored;		///< Parameters ignored for this build
+	static std::string lattice;						///< Lattice requested in the parameter file (empty if not given)
+
+
+	// Methods //
+
+private:
+	/// Private constructor since class is static
+	RuntimeParams();
+	/// Private destructor
+	~RuntimeParams();
+
+public:
+	static void read(int argc, char* argv[]);
+	static void report();
+	static std::string collisionModelName();
+	static std::string latticeName();
+	static std::string logLevelName();
+};
+
+
+// Redirect the parameter macros to the run-time values
+#undef L_TOTAL_TIMESTEPS
+#define L_TOTAL_TIMESTEPS RuntimeParams::totalTimesteps
+#undef L_GRID_OUT_FREQ
+#define L_GRID_OUT_FREQ RuntimeParams::gridOutFreq
+#undef L_EXTRA_OUT_FREQ
+#define L_EXTRA_OUT_FREQ RuntimeParams::extraOutFreq
+#undef L_RESTART_OUT_FREQ
+#define L_RESTART_OUT_FREQ RuntimeParams::restartOutFreq
+#undef L_PROBE_OUT_FREQ
+#define L_PROBE_OUT_FREQ RuntimeParams::probeOutFreq
+#undef L_OUTPUT_PRECISION
+#define L_OUTPUT_PRECISION RuntimeParams::outputPrecision
+#undef L_RESOLUTION
+#define L_RESOLUTION RuntimeParams::resolution
+#undef L_TIMESTEP
+#define L_TIMESTEP RuntimeParams::timestep
+#undef L_PHYSICAL_U
+#define L_PHYSICAL_U RuntimeParams::physicalU
+#undef L_PHYSICAL_RHO
+#define L_PHYSICAL_RHO RuntimeParams::physicalRho
+#undef L_UX0
+#define L_UX0 RuntimeParams::ux0
+#undef L_UY0
+#define L_UY0 RuntimeParams::uy0
+#undef L_UZ0
+#define L_UZ0 RuntimeParams::uz0
+#undef L_RHOIN
+#define L_RHOIN RuntimeParams::rhoIn
+#undef L_RE
+#define L_RE RuntimeParams::re
+#undef L_RELAX
+#define L_RELAX RuntimeParams::relax
+#undef L_CSMAG
+#define L_CSMAG RuntimeParams::cSmag
+#undef L_GRAVITY_FORCE
+#define L_GRAVITY_FORCE RuntimeParams::gravityForce
+#undef L_WALL_LEFT
+#define L_WALL_LEFT RuntimeParams::wall[eLeftWall]
+#undef L_WALL_RIGHT
+#define L_WALL_RIGHT RuntimeParams::wall[eRightWall]
+#undef L_WALL_BOTTOM
+#define L_WALL_BOTTOM RuntimeParams::wall[eBottomWall]
+#undef L_WALL_TOP
+#define L_WALL_TOP RuntimeParams::wall[eTopWall]
+#undef L_WALL_FRONT
+#define L_WALL_FRONT RuntimeParams::wall[eFrontWall]
+#undef L_WALL_BACK
+#define L_WALL_BACK RuntimeParams::wall[eBackWall]
+#undef L_MPI_XCORES
+#define L_MPI_XCORES RuntimeParams::mpiCores[eXDirection]
+#undef L_MPI_YCORES
+#define L_MPI_YCORES RuntimeParams::mpiCores[eYDirection]
+#undef L_MPI_ZCORES
+#define L_MPI_ZCORES RuntimeParams::mpiCores[eZDirection]
+#undef L_MPI_SD_MAX_ITER
+#define L_MPI_SD_MAX_ITER RuntimeParams::mpiSDMaxIter
+#undef L_MPI_REBALANCE_FREQ
+#define L_MPI_REBALANCE_FREQ RuntimeParams::mpiRebalanceFreq
+#undef L_MPI_REBALANCE_THRESHOLD
+#define L_MPI_REBALANCE_THRESHOLD RuntimeParams::mpiRebalanceThreshold
+#undef L_REGRID_FREQ
+#define L_REGRID_FREQ RuntimeParams::regridFreq
+#undef L_REGRID_THRESHOLD
+#define L_REGRID_THRESHOLD RuntimeParams::regridThreshold
+#undef L_LOG_LEVEL
+#define L_LOG_LEVEL RuntimeParams::logLevel
+#undef L_LOG_FLUSH_INTERVAL
+#define L_LOG_FLUSH_INTERVAL RuntimeParams::logFlushInterval
+#undef L_LOG_AGGREGATE
+#define L_LOG_AGGREGATE RuntimeParams::logAggregate
+
+#endif
@@ -66,7 +66,8 @@
 //#define L_IBBODY_TRACER			///< Write out IBBody positions
 //#define L_BFL_DEBUG				///< Write out BFL marker positions and Q values out to files
 //#define L_CLOUD_DEBUG				///< Write out to a file the cloud that has been read in
-//#define L_LOG_TIMINGS				///< Write out the initialisation, time step and mpi timings to an output file
+//#define L_LOG_TIMINGS				///< Time each phase on each grid and write a summary across ranks to timings.json / timings.csv
+//#define L_HW_COUNTERS				///< Also read hardware counters (Linux perf events) in each timed phase and write hwcounters.csv (implies L_LOG_TIMINGS)
 //#define L_HDF_DEBUG				///< Write some HDF5 debugging information
 //#define L_TEXTOUT					///< Verbose ASCII output of grid information
 //#define L_MOMEX_DEBUG				///< Debug momentum exchange by writing out F contributions verbosely
@@ -92,9 +93,17 @@
 #define L_RESTART_OUT_FREQ (100*L_GRID_OUT_FREQ)			///< Frequency of write out of restart file
 #define L_PROBE_OUT_FREQ 1000000				///< Write out frequency of probe output
 
+// Logging
+#define L_LOG_LEVEL eLogInfo				///< Lowest severity written to the log (eLogDebug, eLogInfo, eLogWarn, eLogError)
+#define L_LOG_FLUSH_INTERVAL 10.0			///< Wall-clock seconds between writes of the buffered log to file (0 hands off every line)
+#define L_LOG_AGGREGATE 0					///< Write all ranks to a single log_all.log rather than one log file per rank (MPI builds)
+
 // Types of output
 //#define L_IO_LITE				///< ASCII dump on output
+//#define L_IO_LITE_BINARY		///< Write the IO lite dump as fixed-width binary records (.bin) rather than ASCII
 #define L_HDF5_OUTPUT				///< HDF5 dump on output
+//#define L_HDF5_DERIVED			///< Also write vorticity, Q-criterion, strain rate and wall shear stress to HDF5 (computed on output steps only)
+//#define L_HDF5_NO_VELOCITY		///< Leave the raw velocity out of the HDF5 output (e.g. when only the derived fields are needed)
 #define L_LD_OUT				///< Write out lift and drag (all bodies)
 //#define L_IO_FGA				///< Write the components of the macroscopic velocity in a .fga file. (To be used in Unreal Engine 4).
 //#define L_PROBE_OUTPUT			///< Write out probe data
@@ -109,6 +118,8 @@
 #define L_PROBE_MAX_X 1.5					///< End position of probe array in X direction
 #define L_PROBE_MAX_Y (1.6 + L_WALL_THICKNESS_BOTTOM)		///< End position of probe array in Y direction
 #define L_PROBE_MAX_Z 0.0					///< End position of probe array in Z direction
+#define L_PROBE_BUFFER_STEPS 100			///< Number of probe write outs buffered in memory before writing to file
+#define L_BODY_BUFFER_STEPS 100				///< Number of body position, tip and force write outs buffered in memory before writing to file
 
 // Forcing
 //#define L_GRAVITY_ON						///< Turn on gravity force
@@ -119,12 +130,22 @@
 // Initialisation
 #define L_NO_FLOW							///< Initialise the domain with no flow
 //#define L_INIT_VELOCITY_FROM_FILE			///< Read initial velocity from file
+//#define L_INIT_VELOCITY_FROM_HDF5			///< Read initial velocity from an HDF5 file written by LUMA and interpolate it onto every grid
+#define L_INIT_VELOCITY_HDF5_FILE "./input/initial_velocity.h5"	///< HDF5 file to read the initial velocity from (e.g. hdf_R0N0.h5 of a precursor run)
+#define L_INIT_VELOCITY_HDF5_TIME -1		///< Time step to read from the HDF5 file (negative reads the last one written)
 //#define L_RESTARTING					///< Initialise the GridObj with quantities read from a restart file
 
-// LBM configuration
-//#define L_USE_KBC_COLLISION					///< Use KBC collision operator instead of LBGK by default
-//#define L_USE_BGKSMAG
+// LBM configuration (the collision model may also be changed at run time in ./input/params.in but the lattice may not)
+//#define L_USE_KBC_COLLISION					///< Use KBC collision operator instead of LBGK by default (selects D3Q27 in 3D)
+//#define L_USE_BGKSMAG						///< Use the Smagorinsky turbulence model with LBGK by default
 #define L_CSMAG 0.3
+//#define L_STREAM_MASK						///< Precompute a per-site mask of source sites needing special treatment when streaming (2 B/site in 2D, 4 B/site in 3D)
+//#define L_SPARSE_LATTICE					///< Store populations for non-solid sites only and stream through a neighbour table (replaces the stream mask)
+// The sparse lattice only saves memory when more than about a quarter of the sites are solid (a third with float 
+// populations). Each stored site adds 4 B per velocity for the neighbour table, each site adds 4 B for the position of 
+// its populations and u, rho and force_xyz are still held for every site. Check the memory report in the log.
+//#define L_FLOAT_POPULATIONS				///< Store populations in single precision (collision arithmetic stays in double)
+//#define L_SHIFTED_POPULATIONS				///< Store populations as f - w to retain precision in single precision storage
 
 /// Compute the time-averaged values of velocity, density and the velocity products.
 //#define L_COMPUTE_TIME_AVERAGED_QUANTITIES
@@ -154,6 +175,19 @@
 #define L_MPI_SMART_DECOMPOSE		///< Use smart decomposition to improve load balancing
 #define L_MPI_SD_MAX_ITER 1600		///< Max number of iterations to be used for smart decomposition algorithm
 
+// Decomposition cost model (weights are overridden by ./input/sdweights.in and a cost map read from ./input/sdcostmap.in if present)
+#define L_SD_WEIGHT_FLUID 1.0		///< Relative cost of a fluid site
+#define L_SD_WEIGHT_SOLID 0.1		///< Relative cost of a solid or refined site (skipped by the kernel)
+#define L_SD_WEIGHT_BOUNDARY 2.0	///< Relative cost of a boundary (BFL, velocity, pressure, slip or outlet) site
+#define L_SD_WEIGHT_IBM 2.0			///< Additional relative cost of an IBM support site
+//#define L_SD_CALIBRATE			///< Write out measured cost map and calibrated weights after a warm-up
+#define L_SD_CALIBRATE_STEPS 100	///< Number of warm-up time steps before calibration
+
+// Dynamic load balancing (requires smart decomposition)
+//#define L_MPI_REBALANCE				///< Measure load imbalance during the run and redistribute the grid if required
+#define L_MPI_REBALANCE_FREQ 500		///< Frequency (in coarse time steps) at which load imbalance is checked
+#define L_MPI_REBALANCE_THRESHOLD 10.0	///< Measured imbalance (%) above which the grid is redistributed
+
 // Topology report
 //#define L_MPI_TOPOLOGY_REPORT		///< Have the MPI Manager report on different combinations of X Y Z cores
 #define L_MPI_TOP_XCORES 12			///< Max number of X MPI ranks to use for the topology report
@@ -212,7 +246,8 @@
 
 // General //
 #define L_GEOMETRY_FILE					///< If defined LUMA will read for geometry config file
-#define L_VTK_BODY_WRITE				///< Write out the bodies to a VTK file
+#define L_VTK_BODY_WRITE				///< Write out the bodies to a VTK file (ASCII, one file per body per rank)
+//#define L_VTU_BODY_WRITE				///< Write out all bodies to a single binary VTU file per output step
 //#define L_VTK_FEM_WRITE				///< Write out the FEM bodies to a VTK file
 
 // IBM //
@@ -223,6 +258,8 @@
 #define L_NB_ALPHA 0.25					///< Parameter for Newmark-Beta time integration (0.25 for 2nd order)
 #define L_NB_DELTA 0.5					///< Parameter for Newmark-Beta time integration (0.5 for 2nd order)
 #define L_RELAX 0.5						///< Under-relaxation for FSI coupling
+//#define L_FSI_AITKEN					///< Use Aitken dynamic relaxation of FEM displacements during sub-iterations instead of fixed L_RELAX
+#define L_FSI_AITKEN_OMEGA0 0.5			///< Initial Aitken relaxation factor for each time step
 #define L_WRITE_TIP_POSITIONS			///< Turn on writing out filament tip positions (only works on flexible filaments)
 
 /*
@@ -271,6 +308,16 @@
 #define L_PADDING_Z_MIN (-2.0 * dh)		///< Padding between Z start of each sub-grid and its child edge
 #define L_PADDING_Z_MAX (2.0 * dh)		///< Padding between Z end of each sub-grid and its child edge
 
+// Block-structured adaptive refinement (regions below give the initial blocks of each level)
+// Each level holds up to L_NUM_REGIONS blocks and a region with its X end before its start starts empty
+//#define L_BLOCK_AMR					///< Refine and coarsen the blocks of each level during the run to follow the flow features
+#define L_REGRID_FREQ 200				///< Frequency (in coarse time steps) at which the blocks are regridded
+#define L_REGRID_CRITERION eRegridVorticity	///< Quantity used to flag sites for refinement (see eRegridCriterion)
+#define L_REGRID_THRESHOLD 0.02			///< Criterion scaled by the site width above which a site is flagged for refinement
+#define L_REGRID_COARSEN_FRACTION 0.5	///< Fraction of the threshold below which already refined sites are coarsened
+#define L_REGRID_BLOCK_SIZE 8			///< Width in parent sites of the tiles blocks are built from (at least 4)
+#define L_REGRID_BUFFER 1				///< Number of tiles added around the tagged tiles
+
 #if L_NUM_LEVELS != 0
 // Position of each refined region
 
@@ -292,9 +339,6 @@ static double cRefEndZ[L_NUM_LEVELS][L_NUM_REGIONS] = {2.0};
 
 // Set probes
 const static int cNumProbes[3] = { L_PROBE_NUM_X, L_PROBE_NUM_Y, L_PROBE_NUM_Z };
-const static double cProbeLimsX[2] = { L_PROBE_MIN_X, L_PROBE_MAX_X };	///< Limits of X plane for array of probes
-const static double cProbeLimsY[2] = { L_PROBE_MIN_Y, L_PROBE_MAX_Y };	///< Limits of Y plane for array of probes
-const static double cProbeLimsZ[2] = { L_PROBE_MIN_Z, L_PROBE_MAX_Z };	///< Limits of Z plane for array of probes
 
 // Set dependent options
 #if (L_DIMS == 3)
@@ -336,6 +380,27 @@ const static double cProbeLimsZ[2] = { L_PROBE_MIN_Z, L_PROBE_MAX_Z };	///< Limi
 
 #endif
 
+// Hardware counters are read by the phase profiler
+#if (defined L_HW_COUNTERS && !defined L_LOG_TIMINGS)
+#define L_LOG_TIMINGS
+#endif
+
+// The neighbour table of the sparse lattice marks the links the stream mask would
+#if (defined L_SPARSE_LATTICE && defined L_STREAM_MASK)
+#undef L_STREAM_MASK
+#endif
+
+// Nothing to regrid without refinement
+#if (defined L_BLOCK_AMR && L_NUM_LEVELS == 0)
+#undef L_BLOCK_AMR
+#endif
+
+// Tiles must hold a block of the minimum width
+#if (L_REGRID_BLOCK_SIZE < 4)
+#undef L_REGRID_BLOCK_SIZE
+#define L_REGRID_BLOCK_SIZE 4
+#endif
+
 #if L_NUM_LEVELS == 0
 // Set region info to default as no refinement
 static double cRefStartX[1][1] = { 0.0 };
@@ -431,6 +431,47 @@ void hdf5_writeDataSet(hid_t& memspace, hid_t& filespace, hid_t& dataset_id,
 
 };
 
+// ************************************************************************** //
+/// \brief	Callback for H5Literate() finding the last time group in a file.
+///
+///	The group and link information arguments required by H5Literate() are not used.
+///
+///	\param	name	name of the link.
+///	\param	data	pointer to an int holding the last time found so far.
+///	\return	0 to continue iterating.
+herr_t hdf5_findLastTime(hid_t, const char *name, const H5L_info_t *, void *data)
+{
+	int *lastTime = static_cast<int*>(data);
+	if (std::strncmp(name, "Time_", 5) == 0) *lastTime = std::max(*lastTime, std::atoi(name + 5));
+	return 0;
+}
+
+// ************************************************************************** //
+/// \brief	Reads a block of a structured double dataset.
+///
+///	\param	file_id		file id.
+///	\param	name		path of the dataset in the file.
+///	\param	offset		indices of the first value of the block in the file.
+///	\param	count		size of the block in each dimension.
+///	\param	buffer		buffer the block is read into (X slowest).
+///	\return	true if the block was read.
+bool hdf5_readBlock(hid_t file_id, const std::string &name, const hsize_t *offset, const hsize_t *count, double *buffer)
+{
+	hid_t dataset_id = H5Dopen(file_id, name.c_str(), H5P_DEFAULT);
+	if (dataset_id < 0) return false;
+
+	// Select the block in the file and read it into a buffer of the same shape
+	hid_t filespace = H5Dget_space(dataset_id);
+	hid_t memspace = H5Screate_simple(L_DIMS, count, NULL);
+	herr_t status = H5Sselect_hyperslab(filespace, H5S_SELECT_SET, offset, NULL, count, NULL);
+	if (status >= 0) status = H5Dread(dataset_id, H5T_NATIVE_DOUBLE, memspace, filespace, H5P_DEFAULT, buffer);
+
+	H5Sclose(memspace);
+	H5Sclose(filespace);
+	H5Dclose(dataset_id);
+	return (status >= 0);
+}
+
 #endif
 
 #ifdef L_BUILD_FOR_MPI
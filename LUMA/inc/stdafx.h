@@ -71,6 +71,8 @@
 #include <valarray>
 #include <assert.h>
 #include <functional>
+#include <unordered_map>
+#include <chrono>
 
 // Check OS is Windows or not
 #ifdef _WIN32
@@ -95,6 +97,12 @@
 
 #include "Enumerations.h"
 
+/****************************************************/
+// Logging backend (used by the logging functions below) //
+/****************************************************/
+
+#include "Logger.h"
+
 
 /****************************************************/
 // Our definitions //
@@ -128,6 +136,7 @@
 /// \brief Fatal Error function.
 ///
 ///			Writes error to the user and further information to the supplied logfile.
+///			All buffered log text is written out before exiting.
 ///			Inlined since this header is included everywhere.
 ///
 ///	\param	msg			string to be printed to the log file.
@@ -140,6 +149,7 @@ inline void errorfcn(const std::string &msg, std::ofstream *logfile)
 
 	std::cout << " Error: See Log File" << std::endl;
 	*logfile << "ERROR: " << msg << std::endl;
+	Logger::close(false);
 	logfile->close();
 
 #ifdef L_BUILD_FOR_MPI
@@ -148,8 +158,8 @@ inline void errorfcn(const std::string &msg, std::ofstream *logfile)
 	exit(LUMA_FAILED);
 }
 
-/// Regular writer
-#define L_INFO infofcn	///< Info function shorthand
+/// Regular writer (skipped without formatting the message if below the log level)
+#define L_INFO(msg, logfile) do { if (L_LOG_LEVEL <= eLogInfo) infofcn(msg, logfile); } while (0)	///< Info function shorthand
 /// \brief Info / logger function.
 ///
 ///			Writes string to the supplied logfile.
@@ -163,8 +173,8 @@ inline void infofcn(const std::string &msg, std::ofstream *logfile)
 	*logfile << "Info: " << msg << std::endl;
 }
 
-/// Regular writer
-#define L_WARN warnfcn	///< Warning function shorthand
+/// Regular writer (skipped without formatting the message if below the log level)
+#define L_WARN(msg, logfile) do { if (L_LOG_LEVEL <= eLogWarn) warnfcn(msg, logfile); } while (0)	///< Warning function shorthand
 /// \brief Warning function.
 ///
 ///			Writes string to the supplied logfile.
@@ -178,8 +188,8 @@ inline void warnfcn(const std::string &msg, std::ofstream *logfile)
 	*logfile << "WARNING: " << msg << std::endl;
 }
 
-/// Regular writer
-#define L_DEBUG debugfcn	///< Debug function shorthand
+/// Regular writer (skipped without formatting the message if below the log level)
+#define L_DEBUG(msg, logfile) do { if (L_LOG_LEVEL <= eLogDebug) debugfcn(msg, logfile); } while (0)	///< Debug function shorthand
 /// \brief Debug logging function.
 ///
 ///			Writes string to the supplied logfile.
@@ -201,8 +211,38 @@ inline void debugfcn(const std::string &msg, std::ofstream *logfile)
 
 // Include definitions, singletons and headers to be made available everywhere for convenience.
 #include "definitions.h"
+#include "RuntimeParams.h"		// Redirects the non-structural parameters to their run-time values
+
+// Population storage type (arithmetic on populations is always in double)
+#ifdef L_FLOAT_POPULATIONS
+typedef float popType;					///< Storage type of the distribution functions
+#define L_MPI_POP_TYPE MPI_FLOAT		///< MPI datatype of the distribution functions
+#else
+typedef double popType;					///< Storage type of the distribution functions
+#define L_MPI_POP_TYPE MPI_DOUBLE		///< MPI datatype of the distribution functions
+#endif
+
+// Stream mask storage type (one bit per velocity)
+#ifdef L_STREAM_MASK
+#if (L_NUM_VELS <= 16)
+typedef unsigned short maskType;		///< Storage type of the stream mask
+#else
+typedef unsigned int maskType;			///< Storage type of the stream mask
+#endif
+#endif
+
+// Shifted population storage (stored value is f - w)
+#ifdef L_SHIFTED_POPULATIONS
+#define L_POP_GET(fs, v) ((fs) + w[v])	///< Population from its stored value
+#define L_POP_SET(f, v) ((f) - w[v])	///< Stored value of a population
+#else
+#define L_POP_GET(fs, v) (fs)			///< Population from its stored value
+#define L_POP_SET(f, v) (f)				///< Stored value of a population
+#endif
+
 #include "GridManager.h"
 #include <mpi.h>
+#include "Profiler.h"
 #include "MpiManager.h"
 #include "GridUtils.h"
 #include "GridUnits.h"
@@ -228,7 +268,7 @@ testout << "\nNEW TIME STEP" << std::endl; \
 for (size_t j = 1; j < M_lim - 1; j++) { \
 	for (size_t i = 0; i < N_lim; i++) { \
 		for (size_t v = 0; v < L_NUM_VELS; v++) { \
-			testout << force_i(i, j, 0, v, M_lim, K_lim, L_NUM_VELS) << "\t"; \
+			testout << _LBM_forceGrid_opt(j * K_lim + i * K_lim * M_lim, static_cast<int>(v)) << "\t"; \
 		} \
 		testout << std::endl; \
 	} \
@@ -65,7 +65,6 @@ void BFLBody::initialise()
 	// Labelling //
 	*GridUtils::logfile << "ObjectManagerBFL: Labelling lattice voxels..." << std::endl;
 
-	int N_lim = _Owner->N_lim;
 	int M_lim = _Owner->M_lim;
 	int K_lim = _Owner->K_lim;
 
@@ -99,26 +98,38 @@ void BFLBody::initialise()
 	// Initialise Q stores to the "invalid" value
 	Q.resize(L_NUM_VELS * markers.size(), -1.0);
 
-	// Loop over local grid and inspect the streaming operations
-	for (int i = 0; i < N_lim; i++) {
-		for (int j = 0; j < M_lim; j++) {
-			for (int k = 0; k < K_lim; k++) {
+	// Build voxel to marker lookup
+	buildVoxelMarkers();
 
-				// If site is a BFL voxel
-				if (_Owner->LatTyp(i, j, k, M_lim, K_lim) == eBFL) {
+	/* Loop over the voxels of this body and inspect the streaming operations.
+	 * Each voxel only writes the Q values of its own marker so can be done 
+	 * concurrently. */
+	int numMarkers = static_cast<int>(markers.size());
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+	for (int m = 0; m < numMarkers; m++) {
+
+		int i = markers[m].supp_i[0];
+		int j = markers[m].supp_j[0];
+		int k = markers[m].supp_k[0];
 
-					// Compute Q for all stream vectors storing on source voxel BFL marker
+		// If site is a BFL voxel owned by this marker
+		if (_Owner->LatTyp(i, j, k, M_lim, K_lim) == eBFL && getVoxelMarker(i, j, k) == m) {
+
+			// Compute Q for all stream vectors storing on source voxel BFL marker
 #if (L_DIMS == 3)
-					computeQ(i, j, k, _Owner);
+			computeQ(i, j, k, _Owner);
 #else
-					computeQ(i, j, _Owner);
+			computeQ(i, j, _Owner);
 #endif
 
-				}
-			}
 		}
 	}
 
+	// Lookup no longer required
+	std::unordered_map<int, int>().swap(voxelMarkers);
+
 	// Computation of Q complete
 	*GridUtils::logfile << "ObjectManagerBFL: Q computation complete." << std::endl;
 
@@ -213,13 +224,46 @@ BFLBody::BFLBody(GridObj* g, int bodyID, std::vector<double> &centre_point,
 	initialise();
 }
 
+/******************************************************************************/
+/// \brief	Build the lookup of the marker owning each voxel.
+///
+///			Replaces a search of the marker list for each voxel during the Q
+///			computation. If more than one marker is in a voxel the first is 
+///			kept as is the case for getMarkerData().
+void BFLBody::buildVoxelMarkers()
+{
+	int M_lim = _Owner->M_lim;
+	int K_lim = _Owner->K_lim;
+
+	voxelMarkers.clear();
+	voxelMarkers.reserve(markers.size());
+	for (int m = 0; m < static_cast<int>(markers.size()); m++) {
+		int id = markers[m].supp_k[0] + markers[m].supp_j[0] * K_lim + markers[m].supp_i[0] * K_lim * M_lim;
+		voxelMarkers.emplace(id, m);
+	}
+}
+
+/******************************************************************************/
+/// \brief	Get the marker owning a voxel.
+/// \param i local i-index of voxel
+/// \param j local j-index of voxel
+/// \param k local k-index of voxel
+/// \returns marker ID or -1 if there is no marker in the voxel
+int BFLBody::getVoxelMarker(int i, int j, int k)
+{
+	auto it = voxelMarkers.find(k + j * _Owner->K_lim + i * _Owner->K_lim * _Owner->M_lim);
+	if (it == voxelMarkers.end()) return -1;
+	return it->second;
+}
+
 /******************************************************************************/
 /// \brief	Routine to compute wall distance Q.
 ///
 ///			Computes Q values in 3D at a given local voxel for each application of 
 ///			the BFL BC. Performs a line-plane intersection algorithm for every 
 ///			possible triangular plane constructed out of the marker in the voxel
-///			and its nearest neighbours.
+///			and its nearest neighbours. Uses the voxel marker lookup and works
+///			on the stack so may be called concurrently for different voxels.
 ///
 /// \param i local i-index of BFL voxel
 /// \param j local j-index of BFL voxel
@@ -230,7 +274,6 @@ void BFLBody::computeQ(int i, int j, int k, GridObj* g)
 
 	// Declarations
 	int dest_i, dest_j, dest_k, storeID;
-	MarkerData* m_data;
 
 	/* Get voxel IDs of self and stencil required to specify planes
 	 *
@@ -246,14 +289,13 @@ void BFLBody::computeQ(int i, int j, int k, GridObj* g)
 
 	// TODO: Update under the restrictions we have done for 2D //
 
-	// Get marker data associated with this local site
-	m_data = getMarkerData(g->XPos[i], g->YPos[j], g->ZPos[k]);
-
-	storeID = m_data->ID;
-	delete m_data;
+	// Get marker associated with this local site
+	storeID = getVoxelMarker(i, j, k);
+	if (storeID < 0) return;
 
 	// Get list of IDs of neighbour vertices for plane construction
-	std::vector<int> V;
+	int V[27];
+	int nV = 0;
 	for (int ii = i - 1; ii <= i + 1; ii++) {
 		for (int jj = j - 1; jj <= j + 1; jj++) {
 			for (int kk = k - 1; kk <= k + 1; kk++) {
@@ -265,11 +307,9 @@ void BFLBody::computeQ(int i, int j, int k, GridObj* g)
 					)
 				{
 
-					// Fetch data if available
-					m_data = getMarkerData(g->XPos[ii], g->YPos[jj], g->ZPos[kk]);
-
-					// If data valid, then store ID
-					if (m_data->isValid()) V.push_back(m_data->ID);
+					// If voxel has a marker, then store ID
+					int id = getVoxelMarker(ii, jj, kk);
+					if (id >= 0) V[nV++] = id;
 				}
 
 			}
@@ -280,121 +320,103 @@ void BFLBody::computeQ(int i, int j, int k, GridObj* g)
 	// Build a triangular plane for each combination of vertices //
 
 	// Cannot compute Q if not enough neighbour markers to make a triangle
-	if (V.size() < 3) return;
-
-	// Get unique combinations of vertex IDs
-	std::vector< std::vector<int> > combo;
+	if (nV < 3) return;
 
 	// Sort IDs in ascending order
-	std::sort(V.begin(), V.end());
-
-	// Loop over sorted array and store ID combinations
-	std::vector<int> tmp;
-	std::vector<bool> flags(V.size());
-	std::fill(flags.begin(), flags.end() - V.size() + 3, true);
-
-	// Loop over permutations
-	do {
-
-		// Reset tmp array
-		tmp.clear();
-
-		// Loop over permutation and pull corresponding 
-		// values from V into combo array
-		for (size_t i = 0; i < V.size(); ++i) {
-			if (flags[i]) {
-				tmp.push_back(V[i]);
-			}
-		}
-		if (tmp.size() == 3) combo.push_back(tmp);
-
-	} while (std::prev_permutation(flags.begin(), flags.end()));
-
-	// Loop over each triangle
-	for (std::vector<int>& tri : combo) {
-
-		// Perform 3D line-triangle intersection test to get Q //
-
-		// Define vectors for triangle vertices
-		std::vector<double> u, v, local_origin;
-		u.push_back(markers[tri[1]].position[0] - markers[tri[0]].position[0]);
-		u.push_back(markers[tri[1]].position[1] - markers[tri[0]].position[1]);
-		u.push_back(markers[tri[1]].position[2] - markers[tri[0]].position[2]);
-		v.push_back(markers[tri[2]].position[0] - markers[tri[0]].position[0]);
-		v.push_back(markers[tri[2]].position[1] - markers[tri[0]].position[1]);
-		v.push_back(markers[tri[2]].position[2] - markers[tri[0]].position[2]);
-		local_origin.push_back(markers[tri[0]].position[0]);
-		local_origin.push_back(markers[tri[0]].position[1]);
-		local_origin.push_back(markers[tri[0]].position[2]);
-
-		// Create global position of start of streaming vector
-		std::vector<double> src;
-		src.push_back(_Owner->XPos[i]);
-		src.push_back(_Owner->YPos[j]);
-		src.push_back(_Owner->ZPos[k]);
-
-		// Loop over even velocities and ignore rest distribution to save computing Q twice
-		for (int vel = 0; vel < L_NUM_VELS - 1; vel+=2) {
-
-			// Compute destination coordinates
-			dest_i = (i + c[0][vel] + g->N_lim) % g->N_lim;
-			dest_j = (j + c[1][vel] + g->M_lim) % g->M_lim;
-			dest_k = (k + c[2][vel] + g->K_lim) % g->K_lim;
-
-			// Cross product gives normal vector to plane
-			std::vector<double> n = GridUtils::crossprod(u,v);
-
-			if (GridUtils::vecnorm(n) == 0) continue; // Triangle degenerate
-
-			// Global position of end of streaming vector
-			std::vector<double> dest;
-			dest.push_back(_Owner->XPos[dest_i]);
-			dest.push_back(_Owner->YPos[dest_j]);
-			dest.push_back(_Owner->ZPos[dest_k]);
-
-			std::vector<double> dir = GridUtils::subtract(dest, src);
-			std::vector<double> w0 = GridUtils::subtract(src,local_origin);
-			double a = -GridUtils::dotprod(n,w0);
-			double b = GridUtils::dotprod(n,dir);
-
-			if (abs(b) < L_SMALL_NUMBER) {
-				if (a == 0) continue;	// Triangle and line are in the same plane
-				else continue;			// Triangle and line are disjoint
-			}
-
-
-			// Get intersect point
-			double r = a / b;
-
-			if (r < 0 || r > 1) continue; // No intersect
-
-			std::vector<double> intersect = GridUtils::add(src, GridUtils::vecmultiply(r,dir) );    // Intersect point
-
-			double uu = GridUtils::dotprod(u,u);
-			double uv = GridUtils::dotprod(u,v);
-			double vv = GridUtils::dotprod(v,v);
-			std::vector<double> w = GridUtils::subtract(intersect, local_origin);
-			double wu = GridUtils::dotprod(w,u);
-			double wv = GridUtils::dotprod(w,v);
-			double D = uv * uv - uu * vv;
-
-			double s = (uv * wv - vv * wu) / D;
-			double t = (uv * wu - uu * wv) / D;
-
-			if (s < 0.0 || s > 1.0)	continue;			
-			else if (t < 0.0 || (s + t) > 1.0) continue;
-			else {
-				// Inside so compute Q
-				double q = GridUtils::vecnorm( GridUtils::subtract(intersect,src) ) / GridUtils::vecnorm(dir);
-
-				// On first pass, set to valid value
-				if (Q[vel + L_NUM_VELS * storeID] == -1) Q[vel + L_NUM_VELS * storeID] = std::numeric_limits<double>::max();
-
-				if (q < Q[vel + L_NUM_VELS * storeID]) {
+	std::sort(V, V + nV);
+
+	// Global position of start of streaming vector
+	double src[3] = { _Owner->XPos[i], _Owner->YPos[j], _Owner->ZPos[k] };
+
+	// Loop over each unique combination of vertices
+	for (int t0 = 0; t0 < nV - 2; t0++) {
+		for (int t1 = t0 + 1; t1 < nV - 1; t1++) {
+			for (int t2 = t1 + 1; t2 < nV; t2++) {
+
+				// Perform 3D line-triangle intersection test to get Q //
+				const Marker& m0 = markers[V[t0]];
+				const Marker& m1 = markers[V[t1]];
+				const Marker& m2 = markers[V[t2]];
+
+				// Define vectors for triangle vertices
+				double u[3], v[3], local_origin[3];
+				for (int d = 0; d < 3; d++) {
+					u[d] = m1.position[d] - m0.position[d];
+					v[d] = m2.position[d] - m0.position[d];
+					local_origin[d] = m0.position[d];
+				}
 
-					// Set outgoing Q value
-					Q[vel + L_NUM_VELS * storeID] = q;
+				// Cross product gives normal vector to plane
+				double n[3] = {
+					u[1] * v[2] - u[2] * v[1],
+					u[2] * v[0] - u[0] * v[2],
+					u[0] * v[1] - u[1] * v[0]
+				};
+				if (GridUtils::vecnorm(n[0], n[1], n[2]) == 0) continue; // Triangle degenerate
+
+				// Triangle quantities independent of the streaming vector
+				double uu = u[0] * u[0] + u[1] * u[1] + u[2] * u[2];
+				double uv = u[0] * v[0] + u[1] * v[1] + u[2] * v[2];
+				double vv = v[0] * v[0] + v[1] * v[1] + v[2] * v[2];
+				double D = uv * uv - uu * vv;
+				double w0[3] = { src[0] - local_origin[0], src[1] - local_origin[1], src[2] - local_origin[2] };
+				double a = -(n[0] * w0[0] + n[1] * w0[1] + n[2] * w0[2]);
+
+				// Loop over even velocities and ignore rest distribution to save computing Q twice
+				for (int vel = 0; vel < L_NUM_VELS - 1; vel += 2) {
+
+					// Compute destination coordinates
+					dest_i = (i + c[0][vel] + g->N_lim) % g->N_lim;
+					dest_j = (j + c[1][vel] + g->M_lim) % g->M_lim;
+					dest_k = (k + c[2][vel] + g->K_lim) % g->K_lim;
+
+					// Streaming vector
+					double dir[3] = {
+						_Owner->XPos[dest_i] - src[0],
+						_Owner->YPos[dest_j] - src[1],
+						_Owner->ZPos[dest_k] - src[2]
+					};
+					double b = n[0] * dir[0] + n[1] * dir[1] + n[2] * dir[2];
+
+					if (abs(b) < L_SMALL_NUMBER) {
+						if (a == 0) continue;	// Triangle and line are in the same plane
+						else continue;			// Triangle and line are disjoint
+					}
+
+
+					// Get intersect point
+					double r = a / b;
+
+					if (r < 0 || r > 1) continue; // No intersect
+
+					double intersect[3], w[3];
+					for (int d = 0; d < 3; d++) {
+						intersect[d] = src[d] + dir[d] * r;
+						w[d] = intersect[d] - local_origin[d];
+					}
+					double wu = w[0] * u[0] + w[1] * u[1] + w[2] * u[2];
+					double wv = w[0] * v[0] + w[1] * v[1] + w[2] * v[2];
+
+					double s = (uv * wv - vv * wu) / D;
+					double t = (uv * wu - uu * wv) / D;
+
+					if (s < 0.0 || s > 1.0)	continue;			
+					else if (t < 0.0 || (s + t) > 1.0) continue;
+					else {
+						// Inside so compute Q
+						double q = GridUtils::vecnorm(intersect[0] - src[0], intersect[1] - src[1], intersect[2] - src[2]) / 
+							GridUtils::vecnorm(dir[0], dir[1], dir[2]);
+
+						// On first pass, set to valid value
+						if (Q[vel + L_NUM_VELS * storeID] == -1) Q[vel + L_NUM_VELS * storeID] = std::numeric_limits<double>::max();
+
+						if (q < Q[vel + L_NUM_VELS * storeID]) {
+
+							// Set outgoing Q value
+							Q[vel + L_NUM_VELS * storeID] = q;
 
+						}
+					}
 				}
 			}
 		}
@@ -424,17 +446,15 @@ void BFLBody::computeQ(int i, int j, GridObj* g)
 	// Declarations
 	int dest_i, dest_j;
 	double s, t, s1_x, s1_y, s2_x, s2_y;
-	MarkerData* m_data;
 	
-	// Get marker data associated with this local site
-	m_data = getMarkerData(g->XPos[i], g->YPos[j], g->ZPos[0]);
-
-	int storeID = m_data->ID;
-	delete m_data;
+	// Get marker associated with this local site
+	int storeID = getVoxelMarker(i, j, 0);
+	if (storeID < 0) return;
 
 
 	// Get IDs of vertical and horizontal neighbour vertices for line construction
-	std::vector< std::pair<int, int> > combo;
+	int combo[4];
+	int nCombo = 0;
 	for (int ii = i - 1; ii <= i + 1; ii++) {
 		for (int jj = j - 1; jj <= j + 1; jj++) {
 
@@ -446,14 +466,9 @@ void BFLBody::computeQ(int i, int j, GridObj* g)
 				)
 			{			
 
-				// Fetch data if available
-				m_data = getMarkerData(g->XPos[ii], g->YPos[jj], g->ZPos[0]);
-
-				// If data valid, then store ID
-				if (m_data->isValid()) combo.push_back(std::pair<int,int>(storeID, m_data->ID));
-
-				// Clean-up after getMarkerData call
-				delete m_data;
+				// If voxel has a marker, then store ID
+				int id = getVoxelMarker(ii, jj, 0);
+				if (id >= 0) combo[nCombo++] = id;
 
 			}
 
@@ -461,30 +476,23 @@ void BFLBody::computeQ(int i, int j, GridObj* g)
 	}
 
 	// Can only continue at least 1 pair
-	if (combo.size() == 0) return;
+	if (nCombo == 0) return;
 
 	// Get position of marker in this cell
-	std::vector<double> q;
-	q.push_back(markers[storeID].position[0]);
-	q.push_back(markers[storeID].position[1]);
-	q.push_back(markers[storeID].position[2]);
+	double q[2] = { markers[storeID].position[0], markers[storeID].position[1] };
+
+	// Position of source site
+	double p[2] = { _Owner->XPos[i], _Owner->YPos[j] };
 
 	// Loop through valid marker combinations
-	for (std::pair<int,int>& line : combo) {
+	for (int line = 0; line < nCombo; line++) {
 
 		/* Perform line intersection test according to 2nd answer on:
 		 * http://stackoverflow.com/questions/563198/how-do-you-detect-where-two-line-segments-intersect
 		 */
 
-		std::vector<double> qps;	// Position of next marker
-		qps.push_back(markers[line.second].position[0]);
-		qps.push_back(markers[line.second].position[1]);
-		qps.push_back(markers[line.second].position[2]);
-
-		std::vector<double> p;	// Position of source site
-		p.push_back(_Owner->XPos[i]);
-		p.push_back(_Owner->YPos[j]);
-		p.push_back(markers[line.first].position[2]);	// In 2D must be in the same plane
+		// Position of next marker
+		double qps[2] = { markers[combo[line]].position[0], markers[combo[line]].position[1] };
 
 		// Loop over velocities (ignore rest distribution)
 		for (int vel = 0; vel < L_NUM_VELS - 1; vel++) {
@@ -493,15 +501,9 @@ void BFLBody::computeQ(int i, int j, GridObj* g)
 			dest_i = (i + c[0][vel] + g->N_lim) % g->N_lim;
 			dest_j = (j + c[1][vel] + g->M_lim) % g->M_lim;
 
-			// Position of destination site
-			std::vector<double> ppr;
-			ppr.push_back(_Owner->XPos[dest_i]);
-			ppr.push_back(_Owner->YPos[dest_j]);
-			ppr.push_back(markers[line.first].position[2]);
-
-			// Compute lengths of lines
-			s1_x = ppr[0] - p[0];
-			s1_y = ppr[1] - p[1];
+			// Compute lengths of lines (destination site in the same plane in 2D)
+			s1_x = _Owner->XPos[dest_i] - p[0];
+			s1_y = _Owner->YPos[dest_j] - p[1];
 			s2_x = qps[0] - q[0];
 			s2_y = qps[1] - q[1];
 
@@ -512,14 +514,9 @@ void BFLBody::computeQ(int i, int j, GridObj* g)
 			// Test for intersection
 			if (s >= 0 && s <= 1 && t >= 0 && t <= 1)
 			{
-				// Lines intersect at p + ts_1
-				std::vector<double> intersect;
-				intersect.push_back(p[0] + t * s1_x);
-				intersect.push_back(p[1] + t * s1_y);
-				intersect.push_back(p[2]);	// Again same plane in 2D
-        
-				// Compute Q (normalised)
-				double wall_distance = GridUtils::vecnorm(GridUtils::subtract(intersect, p)) / GridUtils::vecnorm(GridUtils::subtract(ppr, p));
+				// Lines intersect at p + ts_1 so compute Q (normalised)
+				double wall_distance = GridUtils::vecnorm((p[0] + t * s1_x) - p[0], (p[1] + t * s1_y) - p[1], 0.0) / 
+					GridUtils::vecnorm(s1_x, s1_y, 0.0);
 
 				// On first pass, set to valid value
 				if (Q[vel + L_NUM_VELS * storeID] == -1)
@@ -38,6 +38,8 @@ FEMBody::FEMBody () {
 	res = 0.0;
 	timeav_FEMIterations = 0.0;
 	timeav_FEMResidual = 0.0;
+	subIt = 0;
+	omega = L_FSI_AITKEN_OMEGA0;
 	BC_DOFs = 0;
 }
 
@@ -71,6 +73,8 @@ FEMBody::FEMBody (IBBody *iBody, std::vector<double> &start_position, double len
 	res = 0.0;
 	timeav_FEMIterations = 0.0;
 	timeav_FEMResidual = 0.0;
+	subIt = 0;
+	omega = L_FSI_AITKEN_OMEGA0;
 
 	// Set number of DOFs to remove in BC
 	if (clamped == true)
@@ -128,6 +132,8 @@ FEMBody::FEMBody (IBBody *iBody, std::vector<double> &start_position, double len
 	Udot_n.resize(systemDOFs, 0.0);
 	Udotdot.resize(systemDOFs, 0.0);
 	Udotdot_n.resize(systemDOFs, 0.0);
+	U_km1.resize(systemDOFs, 0.0);
+	res_km1.resize(systemDOFs, 0.0);
 }
 
 
@@ -171,6 +177,11 @@ void FEMBody::dynamicFEM () {
 
 	} while (res > TOL && it < MAXIT);
 
+#ifdef L_FSI_AITKEN
+	// Relax displacements against previous coupling iteration
+	aitkenRelaxation();
+#endif
+
 	// Calculate velocities and accelerations
 	finishNewmark();
 
@@ -178,6 +189,47 @@ void FEMBody::dynamicFEM () {
 	updateIBMarkers();
 }
 
+// *****************************************************************************
+///	\brief	Aitken dynamic relaxation of the FEM displacements
+///
+///			The first solve of a time step is accepted as it is. Later solves 
+///			are relaxed against the previous coupling iterate, starting from 
+///			L_FSI_AITKEN_OMEGA0 and then updating the factor from successive 
+///			displacement residuals.
+void FEMBody::aitkenRelaxation() {
+
+	// Accept the first solve of the time step
+	if (subIt == 0) {
+		U_km1 = U;
+		omega = L_FSI_AITKEN_OMEGA0;
+		subIt++;
+		return;
+	}
+
+	// Get the residual
+	std::vector<double> resK = GridUtils::subtract(U, U_km1);
+
+	// Update relaxation factor
+	if (subIt > 1) {
+		std::vector<double> resDiff = GridUtils::subtract(resK, res_km1);
+		double denom = GridUtils::dotprod(resDiff, resDiff);
+		if (denom > 0.0)
+			omega = -omega * GridUtils::dotprod(res_km1, resDiff) / denom;
+	}
+
+	// Relax the displacements
+	for (int i = 0; i < systemDOFs; i++)
+		U[i] = U_km1[i] + omega * resK[i];
+
+	// Store for next coupling iteration
+	U_km1 = U;
+	res_km1 = resK;
+	subIt++;
+
+	// Update FEM positions
+	updateFEMValues();
+}
+
 // *****************************************************************************
 ///	\brief	Newton-Raphson routine for solving non-linear FEM
 void FEMBody::newtonRaphsonIterator () {
@@ -364,7 +416,11 @@ void FEMBody::updateIBMarkers() {
 		for (int d = 0; d < L_DIMS; d++) {
 			iBodyPtr->markers[node].position[d] = iBodyPtr->markers[node].position0[d] + dashU[d];
 			iBodyPtr->markers[node].markerVel_km1[d] = iBodyPtr->markers[node].markerVel[d];
+#ifdef L_FSI_AITKEN
+			iBodyPtr->markers[node].markerVel[d] = dashUdot[d];
+#else
 			iBodyPtr->markers[node].markerVel[d] = L_RELAX * dashUdot[d] + (1.0 - L_RELAX) * iBodyPtr->markers[node].markerVel_km1[d];
+#endif
 		}
 	}
 }
@@ -423,6 +479,188 @@ void FEMBody::computeNodeMapping (int nIBMNodes, int nFEMNodes) {
 	}
 }
 
+// *****************************************************************************
+///	\brief	Append the structural state of the body to a buffer
+///
+///			Used to move the body to a new owning rank. Everything except the
+///			pointers is packed as doubles in a fixed order and read back by
+///			unpackState().
+///
+///	\param	records	buffer to which the state is appended.
+void FEMBody::packState (std::vector<double> &records) {
+
+	// Vectors are packed as their size followed by their values
+	auto packVec = [&records](const std::vector<double> &vec) {
+		records.push_back(static_cast<double>(vec.size()));
+		records.insert(records.end(), vec.begin(), vec.end());
+	};
+	auto packMat = [&records, &packVec](const std::vector<std::vector<double>> &mat) {
+		records.push_back(static_cast<double>(mat.size()));
+		for (size_t i = 0; i < mat.size(); i++)
+			packVec(mat[i]);
+	};
+
+	// System values
+	records.push_back(DOFsPerNode);
+	records.push_back(DOFsPerElement);
+	records.push_back(systemDOFs);
+	records.push_back(BC_DOFs);
+	records.push_back(it);
+	records.push_back(res);
+	records.push_back(timeav_FEMIterations);
+	records.push_back(timeav_FEMResidual);
+	records.push_back(subIt);
+	records.push_back(omega);
+
+	// Nodes
+	records.push_back(static_cast<double>(nodes.size()));
+	for (size_t n = 0; n < nodes.size(); n++) {
+		records.push_back(nodes[n].ID);
+		packVec(nodes[n].position0);
+		packVec(nodes[n].position);
+		records.push_back(nodes[n].angles0);
+		records.push_back(nodes[n].angles);
+	}
+
+	// Elements
+	records.push_back(static_cast<double>(elements.size()));
+	for (size_t el = 0; el < elements.size(); el++) {
+		records.push_back(elements[el].ID);
+		records.push_back(elements[el].length0);
+		records.push_back(elements[el].length);
+		records.push_back(elements[el].angles);
+		records.push_back(elements[el].area);
+		records.push_back(elements[el].I);
+		records.push_back(elements[el].E);
+		records.push_back(elements[el].density);
+		packMat(elements[el].T);
+		packVec(elements[el].F);
+		records.push_back(static_cast<double>(elements[el].DOFs.size()));
+		records.insert(records.end(), elements[el].DOFs.begin(), elements[el].DOFs.end());
+		records.push_back(static_cast<double>(elements[el].IBChildNodes.size()));
+		for (size_t c = 0; c < elements[el].IBChildNodes.size(); c++) {
+			records.push_back(elements[el].IBChildNodes[c].nodeID);
+			records.push_back(elements[el].IBChildNodes[c].zeta1);
+			records.push_back(elements[el].IBChildNodes[c].zeta2);
+		}
+	}
+
+	// System matrices
+	packMat(M);
+	packMat(K);
+	packVec(R);
+	packVec(F);
+	packVec(U);
+	packVec(U_n);
+	packVec(delU);
+	packVec(Udot);
+	packVec(Udot_n);
+	packVec(Udotdot);
+	packVec(Udotdot_n);
+	packVec(U_km1);
+	packVec(res_km1);
+
+	// Parent elements of the IBM nodes
+	records.push_back(static_cast<double>(IBNodeParents.size()));
+	for (size_t n = 0; n < IBNodeParents.size(); n++) {
+		records.push_back(IBNodeParents[n].elementID);
+		records.push_back(IBNodeParents[n].zeta);
+	}
+}
+
+// *****************************************************************************
+///	\brief	Read the structural state of the body from a buffer
+///
+///			Reverses packState(). The owning IBBody pointer is not set here as
+///			the body may still move within the iBody vector.
+///
+///	\param	records	pointer to the start of the packed state.
+///	\returns		pointer to the first value after the packed state.
+const double* FEMBody::unpackState (const double *records) {
+
+	// Vectors are read as their size followed by their values
+	auto unpackVec = [&records](std::vector<double> &vec) {
+		vec.assign(records + 1, records + 1 + static_cast<size_t>(records[0]));
+		records += vec.size() + 1;
+	};
+	auto unpackMat = [&records, &unpackVec](std::vector<std::vector<double>> &mat) {
+		mat.resize(static_cast<size_t>(*records++));
+		for (size_t i = 0; i < mat.size(); i++)
+			unpackVec(mat[i]);
+	};
+
+	// System values
+	DOFsPerNode = static_cast<int>(*records++);
+	DOFsPerElement = static_cast<int>(*records++);
+	systemDOFs = static_cast<int>(*records++);
+	BC_DOFs = static_cast<int>(*records++);
+	it = static_cast<int>(*records++);
+	res = *records++;
+	timeav_FEMIterations = *records++;
+	timeav_FEMResidual = *records++;
+	subIt = static_cast<int>(*records++);
+	omega = *records++;
+
+	// Nodes
+	nodes.resize(static_cast<size_t>(*records++));
+	for (size_t n = 0; n < nodes.size(); n++) {
+		nodes[n].ID = static_cast<int>(*records++);
+		unpackVec(nodes[n].position0);
+		unpackVec(nodes[n].position);
+		nodes[n].angles0 = *records++;
+		nodes[n].angles = *records++;
+	}
+
+	// Elements
+	elements.resize(static_cast<size_t>(*records++));
+	for (size_t el = 0; el < elements.size(); el++) {
+		elements[el].fPtr = this;
+		elements[el].ID = static_cast<int>(*records++);
+		elements[el].length0 = *records++;
+		elements[el].length = *records++;
+		elements[el].angles = *records++;
+		elements[el].area = *records++;
+		elements[el].I = *records++;
+		elements[el].E = *records++;
+		elements[el].density = *records++;
+		unpackMat(elements[el].T);
+		unpackVec(elements[el].F);
+		elements[el].DOFs.resize(static_cast<size_t>(*records++));
+		for (size_t d = 0; d < elements[el].DOFs.size(); d++)
+			elements[el].DOFs[d] = static_cast<int>(*records++);
+		elements[el].IBChildNodes.resize(static_cast<size_t>(*records++));
+		for (size_t c = 0; c < elements[el].IBChildNodes.size(); c++) {
+			elements[el].IBChildNodes[c].nodeID = static_cast<int>(*records++);
+			elements[el].IBChildNodes[c].zeta1 = *records++;
+			elements[el].IBChildNodes[c].zeta2 = *records++;
+		}
+	}
+
+	// System matrices
+	unpackMat(M);
+	unpackMat(K);
+	unpackVec(R);
+	unpackVec(F);
+	unpackVec(U);
+	unpackVec(U_n);
+	unpackVec(delU);
+	unpackVec(Udot);
+	unpackVec(Udot_n);
+	unpackVec(Udotdot);
+	unpackVec(Udotdot_n);
+	unpackVec(U_km1);
+	unpackVec(res_km1);
+
+	// Parent elements of the IBM nodes
+	IBNodeParents.resize(static_cast<size_t>(*records++));
+	for (size_t n = 0; n < IBNodeParents.size(); n++) {
+		IBNodeParents[n].elementID = static_cast<int>(*records++);
+		IBNodeParents[n].zeta = *records++;
+	}
+
+	return records;
+}
+
 // *****************************************************************************
 ///	\brief	Default constructor for parent element class
 FEMBody::IBMParentElements::IBMParentElements() {
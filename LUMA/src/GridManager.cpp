@@ -54,10 +54,18 @@ GridManager::GridManager()
 	if (global_edges[eYMax][0] - L_BY > L_SMALL_NUMBER) L_WARN("Due to selected resolution, domain has been resized in the Y-Direction to maintain cubic cells.", GridUtils::logfile);
 	if (global_edges[eZMax][0] - L_BZ > L_SMALL_NUMBER) L_WARN("Due to selected resolution, domain has been resized in the Z-Direction to maintain cubic cells.", GridUtils::logfile);
 
+	// Default decomposition cost model
+	costWeights[eCostFluid] = L_SD_WEIGHT_FLUID;
+	costWeights[eCostSolid] = L_SD_WEIGHT_SOLID;
+	costWeights[eCostBoundary] = L_SD_WEIGHT_BOUNDARY;
+	costWeights[eCostIBM] = L_SD_WEIGHT_IBM;
+	bCostModelLoaded = false;
+
 	// Set periodic flag vector (not used on L0)
 	periodic_flags[eXDirection][0] = true;
 	periodic_flags[eYDirection][0] = true;
 	periodic_flags[eZDirection][0] = true;
+	parent_region[0] = 0;
 
 	/* Store global sizes for all sub-grids:
 	* This is an initialisation before any grids are built so cannot use any
@@ -89,6 +97,9 @@ GridManager::GridManager()
 			periodic_flags[eYDirection][idx] = false;
 			periodic_flags[eZDirection][idx] = false;
 
+			// Parent is L0 or the same region on the level above
+			parent_region[idx] = (lev == 1) ? 0 : reg;
+
 			/* If using auto sub-grid generation, the padding from the definitions 
 			 * file will be used to define the grid edges. */
 #ifdef L_AUTO_SUBGRIDS
@@ -122,6 +133,22 @@ GridManager::GridManager()
 
 			}
 
+#ifdef L_BLOCK_AMR
+			/* A block with its X end before its start is left empty until the 
+			 * regrid flags sites for it. Blocks nested in an empty block are 
+			 * empty too. */
+			if (cRefEndX[lev - 1][reg] < cRefStartX[lev - 1][reg] || 
+				(lev > 1 && global_size[eXDirection][idx_parent] == 0))
+			{
+				for (int e = 0; e < 6; e++) global_edges[e][idx] = 0.0;
+				global_size[eXDirection][idx] = 0;
+				global_size[eYDirection][idx] = 0;
+				global_size[eZDirection][idx] = 0;
+				dh /= 2.0;
+				continue;
+			}
+#endif
+
 			// Print warnings for grids sizes that are coincident with parent edge
 			if (lev > 0)
 			{
@@ -226,10 +253,23 @@ GridManager::GridManager()
 					" sub-grid has size < 0 in Z-direction -- not enough base resolution to support this level!", GridUtils::logfile);
 			}
 
+#ifdef L_BLOCK_AMR
+			// Blocks are boxes inside their parent
+			if (periodic_flags[eXDirection][idx] || periodic_flags[eYDirection][idx] || 
+				(L_DIMS == 3 && periodic_flags[eZDirection][idx]))
+				L_ERROR("Level " + std::to_string(lev) + " Region " + std::to_string(reg) +
+					" sub-grid cannot be periodic when using L_BLOCK_AMR.", GridUtils::logfile);
+#endif
+
 			// Get resolution for next level
 			dh /= 2.0;
 		}
 	}
+
+#if (defined L_BLOCK_AMR && defined L_RESTARTING)
+	// Blocks may have changed before the restart files were written
+	readRestartRegions();
+#endif
 	
 	// Print out grid edges to file
 	std::string msg("Global Grid Edges computed and stored as:\n");
@@ -301,6 +341,130 @@ void GridManager::setLocalCoarseSize(const std::vector<int>& size_vector)
 	this->local_size = size_vector;
 }
 
+/// \brief	Method to move, create or remove a refined block.
+///
+///			Sets the edges and parent of the sub-grid and updates its global 
+///			size. Used when regridding so the edges must already lie on the 
+///			sites of the parent level and nest properly. A block is removed by
+///			passing edges which enclose no sites. Grids must be rebuilt 
+///			afterwards.
+///
+///	\param	lev			level of the sub-grid.
+///	\param	reg			region of the sub-grid.
+///	\param	parentReg	region of the parent of the sub-grid.
+///	\param	edges		new edges accessed using the eCartMinMax enumeration.
+void GridManager::moveSubGrid(int lev, int reg, int parentReg, const double *edges)
+{
+	int idx = lev + reg * L_NUM_LEVELS;
+	double dh = L_COARSE_SITE_WIDTH / pow(2.0, lev - 1);	// Parent spacing
+
+	parent_region[idx] = parentReg;
+	for (int e = 0; e < 6; e++) global_edges[e][idx] = edges[e];
+	global_size[eXDirection][idx] = static_cast<int>(2.0 * std::round((edges[eXMax] - edges[eXMin]) / dh));
+	global_size[eYDirection][idx] = static_cast<int>(2.0 * std::round((edges[eYMax] - edges[eYMin]) / dh));
+#if (L_DIMS == 3)
+	global_size[eZDirection][idx] = static_cast<int>(2.0 * std::round((edges[eZMax] - edges[eZMin]) / dh));
+#else
+	global_size[eZDirection][idx] = 1;
+#endif
+	if (global_size[eXDirection][idx] <= 0 || global_size[eYDirection][idx] <= 0 || global_size[eZDirection][idx] <= 0)
+	{
+		global_size[eXDirection][idx] = 0;
+		global_size[eYDirection][idx] = 0;
+		global_size[eZDirection][idx] = 0;
+	}
+}
+
+/// \brief	Checks whether a sub-grid encloses any sites.
+///
+///	\param	lev		level of the sub-grid.
+///	\param	reg		region of the sub-grid.
+///	\returns		false if the block is empty.
+bool GridManager::isActive(int lev, int reg)
+{
+	if (lev == 0) return true;
+	return (global_size[eXDirection][lev + reg * L_NUM_LEVELS] > 0);
+}
+
+/// \brief	Finds the sub-grid on a given level which contains a position.
+///
+///	\param	lev		level of the sub-grid.
+///	\param	pos		position (x, y, z).
+///	\returns		region of the sub-grid or -1 if no sub-grid on this level 
+///					contains the position.
+int GridManager::getRegion(int lev, const double *pos)
+{
+	if (lev == 0) return 0;
+
+	for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+	{
+		if (!isActive(lev, reg)) continue;
+
+		int idx = lev + reg * L_NUM_LEVELS;
+		bool bInside = true;
+		for (int d = 0; d < L_DIMS; d++)
+		{
+			if (pos[d] < global_edges[2 * d][idx] || pos[d] > global_edges[2 * d + 1][idx])
+				bInside = false;
+		}
+		if (bInside) return reg;
+	}
+	return -1;
+}
+
+/// \brief	Writes the edges of the refined regions to the restart output.
+///
+///			Written with the restart files since regridding may have changed 
+///			the blocks from those in definitions.h. Each line holds the level,
+///			region and parent region followed by the edges. Only rank 0 writes.
+void GridManager::writeRestartRegions()
+{
+	if (GridUtils::safeGetRank() != 0) return;
+
+	std::ofstream file(GridUtils::path_str + "/restart_regions.out", std::ios::out);
+	file.precision(17);
+	for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+	{
+		for (int lev = 1; lev <= L_NUM_LEVELS; ++lev)
+		{
+			int idx = lev + reg * L_NUM_LEVELS;
+			file << lev << "\t" << reg << "\t" << parent_region[idx];
+			for (int e = 0; e < 6; e++) file << "\t" << global_edges[e][idx];
+			file << std::endl;
+		}
+	}
+	file.close();
+}
+
+/// \brief	Restores the refined blocks present when the restart files were
+///			written.
+///
+///			Reads ./input/restart_regions.out so the grids are built with the
+///			same sites as the restart files. Exits if the file is missing or 
+///			does not list every region since the restart data would then not
+///			match the grids.
+void GridManager::readRestartRegions()
+{
+	std::ifstream file("./input/restart_regions.out", std::ios::in);
+	if (!file.is_open())
+		L_ERROR("Error opening refined region restart file ./input/restart_regions.out. Exiting.", GridUtils::logfile);
+
+	int lev, reg, parentReg, count = 0;
+	double edges[6];
+	while (file >> lev >> reg >> parentReg >> edges[eXMin] >> edges[eXMax] >> edges[eYMin] >> edges[eYMax] >> edges[eZMin] >> edges[eZMax])
+	{
+		if (lev < 1 || lev > L_NUM_LEVELS || reg < 0 || reg >= L_NUM_REGIONS || parentReg < 0 || parentReg >= L_NUM_REGIONS)
+			L_ERROR("Refined region restart file lists level " + std::to_string(lev) + " region " + 
+				std::to_string(reg) + " which does not exist. Exiting.", GridUtils::logfile);
+		moveSubGrid(lev, reg, parentReg, edges);
+		count++;
+	}
+	if (count != L_NUM_LEVELS * L_NUM_REGIONS)
+		L_ERROR("Refined region restart file does not list every region. Exiting.", GridUtils::logfile);
+
+	L_INFO("Refined blocks restored to those in the restart files.", GridUtils::logfile);
+}
+
 /// \brief	Method to create a blank store which holds the writable region 
 ///			information for a given grid.
 ///
@@ -330,7 +494,9 @@ bool GridManager::createWritableDataStore(GridObj const * const targetGrid)
 		// Get local L0 grid sizes
 		int N_lim = static_cast<int>(targetGrid->N_lim);
 		int M_lim = static_cast<int>(targetGrid->M_lim);
+#if (L_DIMS == 3)
 		int K_lim = static_cast<int>(targetGrid->K_lim);
+#endif
 
 		p_data->k_start = 0;
 		p_data->k_end = 0;
@@ -408,7 +574,9 @@ bool GridManager::createWritableDataStore(GridObj const * const targetGrid)
 		// Get local grid sizes (halo included)
 		int N_lim = static_cast<int>(targetGrid->N_lim);
 		int M_lim = static_cast<int>(targetGrid->M_lim);
+#if (L_DIMS == 3)
 		int K_lim = static_cast<int>(targetGrid->K_lim);
+#endif
 		int lev = targetGrid->level;
 		int reg = targetGrid->region_number;
 
@@ -643,7 +811,6 @@ long GridManager::getActiveCellCount(double *bounds, bool bCountAsOps)
 {
 
 	// Get count on course grid
-	unsigned int idx = 0;
 	long activeCells = 0;
 	long cells_on_this_grid = 0;
 
@@ -691,6 +858,25 @@ long GridManager::getActiveCellCount(double *bounds, bool bCountAsOps)
 ///	\param	bounds			pointer to an array containing the bounds of the region to be checked.
 ///	\returns				number of cells in the union.
 long GridManager::getCellCount(int targetLevel, int targetRegion, double *bounds)
+{
+	// Use knowledge of discretisation to return the number of cells in union
+	double base_cell_size = L_COARSE_SITE_WIDTH;
+	double local_cell_size = base_cell_size / pow(2, targetLevel);
+#if (L_DIMS == 3)
+	return static_cast<long>(getUnionVolume(targetLevel, targetRegion, bounds) / (local_cell_size * local_cell_size * local_cell_size));
+#else
+	return static_cast<long>(getUnionVolume(targetLevel, targetRegion, bounds) / (local_cell_size * local_cell_size));
+#endif
+}
+
+/// \brief	Returns the area / volume of the union between the target grid 
+///			and the bounds.
+///
+///	\param	targetLevel		grid level on which to check for union.
+///	\param	targetRegion	grid region on which to check for union.
+///	\param	bounds			pointer to an array containing the bounds of the region to be checked.
+///	\returns				area / volume of the union.
+double GridManager::getUnionVolume(int targetLevel, int targetRegion, double *bounds)
 {
 	// Access edge array using idx
 	unsigned int idx = 0;
@@ -703,7 +889,7 @@ long GridManager::getCellCount(int targetLevel, int targetRegion, double *bounds
 #if (L_DIMS == 3)
 		|| bounds[eZMin] > global_edges[eZMax][idx]
 #endif
-		) return 0;
+		) return 0.0;
 
 	// If end of bounds is before the start of the grid, no union
 	if (
@@ -712,7 +898,7 @@ long GridManager::getCellCount(int targetLevel, int targetRegion, double *bounds
 #if (L_DIMS == 3)
 		|| bounds[eZMax] < global_edges[eZMin][idx]
 #endif
-		) return 0;
+		) return 0.0;
 
 	// All other scenarios can produce a union //
 
@@ -734,12 +920,279 @@ long GridManager::getCellCount(int targetLevel, int targetRegion, double *bounds
 	volume *= (union_bounds[eZMax] - union_bounds[eZMin]);
 #endif
 
-	// Use knowledge of discretisation to return the number of cells in union
-	double base_cell_size = L_COARSE_SITE_WIDTH;
-	double local_cell_size = base_cell_size / pow(2, targetLevel);
+	return volume;
+}
+
+/// \brief	Reads the decomposition cost model inputs if available.
+///
+///			Weights are read from ./input/sdweights.in as lines of the form 
+///			"FLUID 1.0" and a cost map from ./input/sdcostmap.in. Both are 
+///			written by a calibration run (L_SD_CALIBRATE). Missing files leave 
+///			the defaults from the definitions file in place.
+void GridManager::loadCostModel()
+{
+	if (bCostModelLoaded) return;
+	bCostModelLoaded = true;
+
+	// Weights
+	std::ifstream weightfile("./input/sdweights.in", std::ios::in);
+	if (weightfile.is_open())
+	{
+		std::string name;
+		double value;
+		while (weightfile >> name >> value)
+		{
+			if (name == "FLUID") costWeights[eCostFluid] = value;
+			else if (name == "SOLID") costWeights[eCostSolid] = value;
+			else if (name == "BOUNDARY") costWeights[eCostBoundary] = value;
+			else if (name == "IBM") costWeights[eCostIBM] = value;
+		}
+		L_INFO("Decomposition cost weights read from file: fluid = " + std::to_string(costWeights[eCostFluid]) + 
+			", solid = " + std::to_string(costWeights[eCostSolid]) + 
+			", boundary = " + std::to_string(costWeights[eCostBoundary]) + 
+			", IBM = " + std::to_string(costWeights[eCostIBM]), GridUtils::logfile);
+	}
+
+	// Cost map (header of L0 sizes then counts for each site)
+	std::ifstream mapfile("./input/sdcostmap.in", std::ios::in | std::ios::binary);
+	if (mapfile.is_open())
+	{
+		int sizes[3];
+		mapfile.read(reinterpret_cast<char*>(sizes), 3 * sizeof(int));
+		if (sizes[0] != global_size[eXDirection][0] || sizes[1] != global_size[eYDirection][0] || 
+			sizes[2] != global_size[eZDirection][0])
+		{
+			L_WARN("Decomposition cost map does not match the grid size and will be ignored.", GridUtils::logfile);
+			return;
+		}
+
+		costMap.resize(static_cast<size_t>(sizes[0]) * sizes[1] * sizes[2] * eCostTypes);
+		mapfile.read(reinterpret_cast<char*>(costMap.data()), costMap.size() * sizeof(float));
+		if (!mapfile)
+		{
+			L_WARN("Decomposition cost map could not be read and will be ignored.", GridUtils::logfile);
+			costMap.clear();
+			return;
+		}
+		L_INFO("Decomposition cost map read from file.", GridUtils::logfile);
+	}
+}
+
+/// \brief	Builds the summed-volume table of the decomposition cost.
+///
+///			Must be called whenever the cost map, the weights, the refined 
+///			regions or the IB support sites change. The cost of each L0 site 
+///			is taken from the cost map if there is one, or else estimated from 
+///			the grid hierarchy and walls with the gathered IB support sites 
+///			added to the sites containing them. The cost is then accumulated 
+///			along Z, then Y, then X so no differences are taken while building.
+void GridManager::buildCostTable()
+{
+	double dh = L_COARSE_SITE_WIDTH;
+	int n[3] = { global_size[eXDirection][0], global_size[eYDirection][0], 1 };
 #if (L_DIMS == 3)
-	return static_cast<long>(volume / (local_cell_size * local_cell_size * local_cell_size));
-#else
-	return static_cast<long>(volume / (local_cell_size * local_cell_size));
+	n[eZDirection] = global_size[eZDirection][0];
 #endif
-}
\ No newline at end of file
+	size_t sj = n[eZDirection] + 1;
+	size_t si = (n[eYDirection] + 1) * sj;
+	costTable.assign((n[eXDirection] + 1) * si, 0.0);
+
+	// Weighted cost of each site
+	double bounds[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+	for (int i = 0; i < n[eXDirection]; ++i)
+	{
+		for (int j = 0; j < n[eYDirection]; ++j)
+		{
+			for (int k = 0; k < n[eZDirection]; ++k)
+			{
+				double cost = 0.0;
+				if (costMap.size())
+				{
+					size_t id = k + j * global_size[eZDirection][0] + 
+						static_cast<size_t>(i) * global_size[eZDirection][0] * global_size[eYDirection][0];
+					for (int c = 0; c < eCostTypes; ++c)
+						cost += costWeights[c] * costMap[c + id * eCostTypes];
+				}
+				else
+				{
+					bounds[eXMin] = i * dh;
+					bounds[eXMax] = (i + 1) * dh;
+					bounds[eYMin] = j * dh;
+					bounds[eYMax] = (j + 1) * dh;
+					bounds[eZMin] = k * dh;
+					bounds[eZMax] = (k + 1) * dh;
+					cost = getAnalyticCost(&bounds[0]);
+				}
+				costTable[(k + 1) + (j + 1) * sj + (i + 1) * si] = cost;
+			}
+		}
+	}
+
+#ifdef L_IBM_ON
+	// IB support sites gathered before the decomposition (already in a measured map)
+	if (costMap.empty())
+	{
+		for (size_t p = 0; p < ibmCostSites.size(); p += 4)
+		{
+			int idx[3] = { 0, 0, 0 };
+			for (int d = 0; d < L_DIMS; d++)
+				idx[d] = std::min(n[d] - 1, std::max(0, static_cast<int>(std::floor(ibmCostSites[p + d] / dh))));
+			costTable[(idx[eZDirection] + 1) + (idx[eYDirection] + 1) * sj + (idx[eXDirection] + 1) * si] += 
+				costWeights[eCostIBM] * ibmCostSites[p + 3];
+		}
+	}
+#endif
+
+	// Accumulate along each direction in turn
+	for (size_t t = 1; t < costTable.size(); ++t)
+		if (t % sj) costTable[t] += costTable[t - 1];
+	for (size_t t = sj; t < costTable.size(); ++t)
+		if (t % si >= sj) costTable[t] += costTable[t - sj];
+	for (size_t t = si; t < costTable.size(); ++t)
+		costTable[t] += costTable[t - si];
+}
+
+/// \brief	Returns the estimated cost of a block for decomposition.
+///
+///			The cost of the L0 sites in the block is looked up from the eight 
+///			corners of the summed-volume table built by buildCostTable() so 
+///			does not depend on the block size. Bounds are snapped to the 
+///			nearest L0 site edges.
+///
+///	\param	bounds		pointer to an array containing the bounds of the block.
+///	\returns			estimated cost of the block.
+double GridManager::getBlockCost(double *bounds)
+{
+	double dh = L_COARSE_SITE_WIDTH;
+	double cost = 0.0;
+	if (costTable.empty()) buildCostTable();
+
+	int lims[3][2];
+	for (int d = 0; d < 3; d++)
+	{
+		lims[d][0] = std::max(0, static_cast<int>(std::round(bounds[2 * d] / dh)));
+		lims[d][1] = std::min(global_size[d][0], static_cast<int>(std::round(bounds[2 * d + 1] / dh)));
+	}
+#if (L_DIMS != 3)
+	lims[eZDirection][0] = 0;
+	lims[eZDirection][1] = 1;
+#endif
+	for (int d = 0; d < 3; d++)
+		if (lims[d][1] < lims[d][0]) return 0.0;
+	size_t sj = (L_DIMS == 3) ? global_size[eZDirection][0] + 1 : 2;
+	size_t si = (global_size[eYDirection][0] + 1) * sj;
+	for (int a = 0; a < 2; ++a)
+	{
+		for (int b = 0; b < 2; ++b)
+		{
+			for (int c = 0; c < 2; ++c)
+			{
+				// Upper corner added, alternating signs towards the lower corner
+				double corner = costTable[lims[eZDirection][c] + lims[eYDirection][b] * sj + lims[eXDirection][a] * si];
+				cost += ((a + b + c) % 2 == 1) ? corner : -corner;
+			}
+		}
+	}
+	return cost;
+}
+
+/// \brief	Returns the analytical cost estimate of a region without a cost map.
+///
+///			Fluid operations of every grid in the hierarchy covering the region 
+///			(weighted by sub-cycles, less the coarse sites they refine) with a 
+///			correction for the L0 walls. IB support sites are not included.
+///
+///	\param	bounds		pointer to an array containing the bounds of the region.
+///	\returns			estimated cost of the region.
+double GridManager::getAnalyticCost(double *bounds)
+{
+	double dh = L_COARSE_SITE_WIDTH;
+	double cost = 0.0;
+
+	// Fluid operations on each grid covering the region
+	for (int lev = 0; lev < L_NUM_LEVELS + 1; ++lev)
+	{
+		double correction = pow(2, lev);
+		double cellVolume = pow(dh / correction, L_DIMS);
+		for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+		{
+			// L0 can only be region 0
+			if (lev == 0 && reg != 0) continue;
+
+			double cells = getUnionVolume(lev, reg, bounds) / cellVolume;
+			cost += cells * correction;
+			if (lev != 0) cost -= cells / pow(2, L_DIMS) * correction;
+		}
+	}
+	cost *= costWeights[eCostFluid];
+
+	/* Split each axis into the low wall, the interior and the high wall so 
+	 * sites where walls meet are only counted once. The type of each 
+	 * combination of segments is found by applying the walls in the same 
+	 * order as LBM_initBoundLab (X, then Z, then Y). */
+	eType wallType[6] = { L_WALL_LEFT, L_WALL_RIGHT, L_WALL_BOTTOM, L_WALL_TOP, L_WALL_FRONT, L_WALL_BACK };
+	double wallThickness[6] = { L_WALL_THICKNESS_LEFT, L_WALL_THICKNESS_RIGHT, L_WALL_THICKNESS_BOTTOM, 
+		L_WALL_THICKNESS_TOP, L_WALL_THICKNESS_FRONT, L_WALL_THICKNESS_BACK };
+	double overlap[3][3] = { { 0.0, 1.0, 0.0 }, { 0.0, 1.0, 0.0 }, { 0.0, 1.0, 0.0 } };
+	for (int d = 0; d < L_DIMS; d++)
+	{
+		double seg[4] = { global_edges[2 * d][0], global_edges[2 * d][0] + std::max(0.0, wallThickness[2 * d]),
+			global_edges[2 * d + 1][0] - std::max(0.0, wallThickness[2 * d + 1]), global_edges[2 * d + 1][0] };
+		for (int s = 0; s < 3; s++)
+			overlap[d][s] = std::max(0.0, std::min(seg[s + 1], bounds[2 * d + 1]) - std::max(seg[s], bounds[2 * d]));
+	}
+
+	const int order[3] = { eXDirection, eZDirection, eYDirection };
+	int s[3];
+	for (s[eXDirection] = 0; s[eXDirection] < 3; s[eXDirection]++)
+	{
+		for (s[eYDirection] = 0; s[eYDirection] < 3; s[eYDirection]++)
+		{
+			for (s[eZDirection] = 0; s[eZDirection] < 3; s[eZDirection]++)
+			{
+				double volume = overlap[eXDirection][s[eXDirection]] * 
+					overlap[eYDirection][s[eYDirection]] * overlap[eZDirection][s[eZDirection]];
+				if (volume <= 0.0) continue;
+
+				eType type = eFluid;
+				bool bWall = false;
+				for (int o = 0; o < 3; o++)
+				{
+					int d = order[o];
+					if (d >= L_DIMS || s[d] == 1) continue;
+					type = GridObj::LBM_setBCPrecedence(type, wallType[2 * d + s[d] / 2]);
+					bWall = true;
+				}
+				if (!bWall) continue;
+
+				cost += (costWeights[getCostClass(type)] - costWeights[eCostFluid]) * volume / pow(dh, L_DIMS);
+			}
+		}
+	}
+
+	return cost;
+}
+
+/// \brief	Returns the cost model class of a site type.
+///
+///	\param	type	site type.
+///	\returns		cost class.
+eSiteCost GridManager::getCostClass(eType type)
+{
+	switch (type)
+	{
+	case eSolid:
+	case eRefined:
+		return eCostSolid;
+
+	case eBFL:
+	case eVelocity:
+	case ePressure:
+	case eSlip:
+	case eExtrapolateRight:
+		return eCostBoundary;
+
+	default:
+		return eCostFluid;
+	}
+}
@@ -111,10 +111,76 @@ void GridObj::LBM_addSubGrid(int RegionNumber)
 	GridManager::getInstance()->createWritableDataStore(subGrid.back());
 #endif
 
-	// Try to add another subgrid beneath the one just created if necessary
-	if (this->subGrid.back()->level < L_NUM_LEVELS)
-		this->subGrid.back()->LBM_addSubGrid(this->subGrid.back()->region_number);
+	// Try to add the subgrids whose parent is the one just created if necessary
+	GridObj *child = this->subGrid.back();
+	if (child->level < L_NUM_LEVELS)
+	{
+		GridManager *gm = GridManager::getInstance();
+		for (int reg = 0; reg < L_NUM_REGIONS; reg++)
+		{
+			if (gm->parent_region[(child->level + 1) + reg * L_NUM_LEVELS] == RegionNumber)
+				child->LBM_addSubGrid(reg);
+		}
+	}
+
+}
+
+// ****************************************************************************
+/// \brief	Rebuild the grid hierarchy on this rank.
+///
+///			Called on L0 after the local grid size and layer positions have 
+///			been changed by a new decomposition or the refined regions have 
+///			been moved. Existing sub-grids are destroyed and the whole 
+///			hierarchy is rebuilt for the new block in place so that pointers 
+///			to L0 remain valid. Sub-grid clocks are set consistently with L0. 
+///			Site data is initialised as for a new grid and must be overwritten 
+///			by the caller.
+void GridObj::LBM_rebuildHierarchy()
+{
+	// Destroy existing sub-grids
+	for (GridObj *g : subGrid) if (g) delete g;
+	subGrid.clear();
+
+	// Clear containers which are not simply resized on initialisation
+	XPos.clear(); YPos.clear(); ZPos.clear();
+	ux_in.clear(); uy_in.clear(); uz_in.clear();
+	f.clear(); fNew.clear();
+	u.clear(); rho.clear(); LatTyp.clear();
+#ifdef L_STREAM_MASK
+	streamMask.clear();
+#endif
+#ifdef L_SPARSE_LATTICE
+	popSite.clear(); sparseSites.clear(); sparseSrc.clear();
+#endif
+	refineChild.clear(); refineChildBase.clear(); refineParent.clear();
+	coalesceDst.clear(); coalesceSrc.clear();
+	force_xyz.clear();
+	rho_timeav.clear(); ui_timeav.clear(); uiuj_timeav.clear();
 
+	// Re-initialise L0 on the new block
+	L_INFO("Rebuilding Grid level " + std::to_string(level) + "...", GridUtils::logfile);
+	this->LBM_initGrid();
+	bMeshChanged = true;
+
+	// Add sub-grids
+	for (int reg = 0; reg < L_NUM_REGIONS && L_NUM_LEVELS != 0; reg++)
+		LBM_addSubGrid(reg);
+
+	// Bring their clocks in line with this grid
+	for (int reg = 0; reg < L_NUM_REGIONS && L_NUM_LEVELS != 0; reg++) {
+		for (int lev = 1; lev <= L_NUM_LEVELS; lev++) {
+			GridObj *g = nullptr;
+			GridUtils::getGrid(this, lev, reg, g);
+			if (!g) continue;
+			g->t = t * static_cast<int>(pow(2, lev));
+			g->bMeshChanged = true;
+		}
+	}
+
+#ifdef L_SPARSE_LATTICE
+	// Allocate the populations so the site data may be written to them
+	LBM_initStreamMask();
+#endif
 }
 
 // ****************************************************************************
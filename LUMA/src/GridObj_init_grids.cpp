@@ -32,15 +32,20 @@ using namespace std;
 /// \brief	Method to initialise the lattice velocity.
 ///
 ///			If the L_NO_FLOW macro is defined, velocity set to zero everywhere.
-///			If L_INIT_VELOCITY_FROM_FILE defined, velocity read from file.
-///			Otherwise set from stored profile.
+///			If L_INIT_VELOCITY_FROM_HDF5 defined, velocity interpolated from an
+///			HDF5 file. If L_INIT_VELOCITY_FROM_FILE defined, velocity read from
+///			an ASCII file. Otherwise set from stored profile.
 void GridObj::LBM_initVelocity()
 {
 
 	// Setup the inlet profile data on this grid
 	_LBM_initSetInletProfile();
 
-#ifdef L_INIT_VELOCITY_FROM_FILE
+#if (defined L_INIT_VELOCITY_FROM_HDF5)
+
+	io_hdf5InitVelocity();
+
+#elif (defined L_INIT_VELOCITY_FROM_FILE)
 
 	*GridUtils::logfile << "Loading initial velocity..." << std::endl;
 
@@ -60,6 +65,16 @@ void GridObj::LBM_initVelocity()
 			GridUtils::logfile);
 	}
 
+	// Sites not in the file start at rest
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
+#endif
+	for (int i = 0; i < N_lim; i++)
+	{
+		for (int id = i * M_lim * K_lim * L_DIMS; id < (i + 1) * M_lim * K_lim * L_DIMS; id++)
+			u[id] = 0.0;
+	}
+
 	// Loop over the data and assign the part that corresponds to the current processor. 
 	for (int i = 0; i < gridSize; i++)
 	{
@@ -77,9 +92,15 @@ void GridObj::LBM_initVelocity()
 
 	}
 
-#else    // L_INIT_VELOCITY_FROM_FILE is not defined
+#else    // Neither L_INIT_VELOCITY_FROM_HDF5 nor L_INIT_VELOCITY_FROM_FILE is defined
 
-	// Loop over grid
+	// If doing a ramp velocity then initial velocity should be set to ramp at t = 0
+	double rampCoefficient = GridUtils::getVelocityRampCoefficient(0.0);
+
+	// Loop over grid (threaded over i as in the kernel so pages are first touched there)
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
+#endif
 	for (int i = 0; i < N_lim; i++) {
 		for (int j = 0; j < M_lim; j++) {
 			for (int k = 0; k < K_lim; k++) {
@@ -103,9 +124,6 @@ void GridObj::LBM_initVelocity()
 					* have either been read in from an input file or defined by an expression
 					* given in the definitions. */
 
-					// If doing a ramp velocity then initial velocity should be set to ramp at t = 0
-					double rampCoefficient = GridUtils::getVelocityRampCoefficient(0.0);
-
 					// Get velocity from profile store
 					u(i, j, k, eXDirection, M_lim, K_lim, L_DIMS) = ux_in[j] * rampCoefficient;
 					u(i, j, k, eYDirection, M_lim, K_lim, L_DIMS) = uy_in[j] * rampCoefficient;
@@ -128,7 +146,7 @@ void GridObj::LBM_initVelocity()
 		}
 	}
 
-#endif	// L_INIT_VELOCITY_FROM_FILE
+#endif	// L_INIT_VELOCITY_FROM_HDF5 / L_INIT_VELOCITY_FROM_FILE
 
 }
 
@@ -138,6 +156,9 @@ void GridObj::LBM_initVelocity()
 void GridObj::LBM_initRho() {
 
 	// Loop over grid
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
+#endif
 	for (int i = 0; i < N_lim; i++) {
 		for (int j = 0; j < M_lim; j++) {		
 			for (int k = 0; k < K_lim; k++) {
@@ -150,6 +171,49 @@ void GridObj::LBM_initRho() {
 
 }
 
+// ****************************************************************************
+/// \brief	Method to allocate the populations and set them to equilibrium.
+///
+///			f and fNew are written together in a loop threaded over i as in the
+///			kernel so each thread first touches the pages it later computes on.
+///			With a sparse lattice nothing is allocated here as the solid sites 
+///			are not all labelled yet. The populations are allocated for the 
+///			non-solid sites only by _LBM_initSparseLattice().
+void GridObj::_LBM_initPopulations()
+{
+#ifdef L_SPARSE_LATTICE
+	IVector<popType>().swap(f);
+	IVector<popType>().swap(fNew);
+	IVector<int>().swap(popSite);
+	std::vector<int>().swap(sparseSites);
+	IVector<int>().swap(sparseSrc);
+#else
+	f.resizeUninitialised(N_lim * M_lim * K_lim * L_NUM_VELS);
+	fNew.resizeUninitialised(N_lim * M_lim * K_lim * L_NUM_VELS);
+
+	// Loop over grid
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
+#endif
+	for (int i = 0; i < N_lim; i++)
+	{
+		for (int j = 0; j < M_lim; j++)
+		{
+			for (int k = 0; k < K_lim; k++)
+			{
+				int id = k + j * K_lim + i * M_lim * K_lim;
+				for (int v = 0; v < L_NUM_VELS; v++)
+				{
+					// Initialise f to feq
+					f[popIdx(id, v)] = fNew[popIdx(id, v)] =
+						L_POP_SET(_LBM_equilibrium_opt(id, v), v);
+				}
+			}
+		}
+	}
+#endif
+}
+
 // ****************************************************************************
 /// \brief	Method to initialise all L0 lattice quantities.
 void GridObj::LBM_initGrid() {
@@ -259,78 +323,52 @@ void GridObj::LBM_initGrid() {
 	
 
 	// Define TYPING MATRICES
-	LatTyp.resize(N_lim * M_lim * K_lim);
-
-	// Label as coarse site
-	std::fill(LatTyp.begin(), LatTyp.end(), eFluid);
+	LatTyp.resizeUninitialised(N_lim * M_lim * K_lim);
 
 	// Can't use regularised boundaries with D3Q27 because of the corners
 #if (defined L_REGULARISED_BOUNDARIES && L_NUM_VELS == 27)
 	L_ERROR("Cannot use regularised boundaries with D3Q27 because of the corner treatment. Exiting.", GridUtils::logfile);
 #endif
 
-	// Add boundary-specific labels
+	// Label as coarse sites and add boundary-specific labels
 	LBM_initBoundLab();
 
 	// Initialise L0 MACROSCOPIC quantities
 
 	// Velocity field
-	u.resize(N_lim * M_lim * K_lim * L_DIMS);
+	u.resizeUninitialised(N_lim * M_lim * K_lim * L_DIMS);
 	LBM_initVelocity();
-	
-#ifdef L_IBM_ON
-	// Set start-of-timestep-velocity
-	u_n.resize(N_lim * M_lim * K_lim * L_DIMS);
-	u_n = u;
-#endif
 
 	// Density field
-	rho.resize(N_lim * M_lim * K_lim);
+	rho.resizeUninitialised(N_lim * M_lim * K_lim);
 	LBM_initRho();
 
 #if (defined L_GRAVITY_ON || defined L_IBM_ON)
 	// Cartesian force vector
-	force_xyz.resize(N_lim * M_lim * K_lim * L_DIMS, 0.0);
+	force_xyz.resizeUninitialised(N_lim * M_lim * K_lim * L_DIMS);
 
 	// Initialise with gravity
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
+#endif
 	for (int id = 0; id < N_lim * M_lim * K_lim; ++id)
+	{
+		for (int d = 0; d < L_DIMS; ++d)
+			force_xyz[d + id * L_DIMS] = 0.0;
 		force_xyz[L_GRAVITY_DIRECTION + id * L_DIMS] = rho[id] * gravity * refinement_ratio;
-
-	// Lattice force vector
-	force_i.resize(N_lim * M_lim * K_lim * L_NUM_VELS, 0.0);
+	}
 #endif
 
 	// Time averaged quantities
+#ifdef L_COMPUTE_TIME_AVERAGED_QUANTITIES
 	rho_timeav.resize(N_lim * M_lim * K_lim, 0.0);
 	ui_timeav.resize(N_lim * M_lim * K_lim * L_DIMS, 0.0);
 	uiuj_timeav.resize(N_lim * M_lim * K_lim * (3 * L_DIMS - 3), 0.0);
+#endif
 
 
-	// Initialise L0 POPULATION matrices (f, feq)
-	f.resize(N_lim * M_lim * K_lim * L_NUM_VELS);
-	feq.resize(N_lim * M_lim * K_lim * L_NUM_VELS);
-	fNew.resize(N_lim * M_lim * K_lim * L_NUM_VELS);
-
-
-	// Loop over grid
-	for (int i = 0; i < N_lim; i++)
-	{
-		for (int j = 0; j < M_lim; j++)
-		{
-			for (int k = 0; k < K_lim; k++)
-			{
-				for (int v = 0; v < L_NUM_VELS; v++)
-				{
-					// Initialise f to feq
-					f(i, j, k, v, M_lim, K_lim, L_NUM_VELS) = 
-						_LBM_equilibrium_opt(k + j * K_lim + i * M_lim * K_lim, v);
-
-				}
-			}
-		}
-	}
-	feq = f; // Make feq = feq too
-	fNew = f;
+	// Initialise L0 POPULATION matrices (f, fNew)
+	_LBM_initPopulations();
 
 
 #ifdef L_NU
@@ -350,10 +388,11 @@ void GridObj::LBM_initGrid() {
 	/* Check that the relaxation frequency is within acceptable values. 
 	 * Suggest a better value for dt to the user if omega is not within 
 	 * acceptable limits. Note that the use of BGKSMAG allows for omega >=2. */
-#ifndef L_USE_BGKSMAG
-	if (omega >= 2.0)
+	if (omega >= 2.0 && RuntimeParams::collisionModel != eBGKSmag)
 		L_ERROR("LBM relaxation frequency omega too large. Change L_TIMESTEP or L_RESOLUTION. Exiting.", GridUtils::logfile);
-#endif
+
+	// Select the kernel for the collision model
+	_LBM_initKernel_opt();
 
 	// Check if there are incompressibility issues and warn the user if so
 	if (uref > (0.17 * cs))
@@ -447,43 +486,38 @@ void GridObj::LBM_initSubGrid (GridObj& pGrid)
 	// Generate TYPING MATRICES
 
 	// Resize
-	LatTyp.resize(N_lim * M_lim * K_lim);
-
-	// Default labelling of coarse
-	std::fill(LatTyp.begin(), LatTyp.end(), eFluid);
+	LatTyp.resizeUninitialised(N_lim * M_lim * K_lim);
 	
-	// Call refined labelling routine passing parent grid
+	// Call refined labelling routine passing parent grid (labels every site)
 	LBM_initRefinedLab(pGrid);
 
 	
 	// Assign MACROSCOPIC quantities
 
 	// Velocity
-	u.resize(N_lim * M_lim * K_lim * L_DIMS);
+	u.resizeUninitialised(N_lim * M_lim * K_lim * L_DIMS);
 	LBM_initVelocity();
 
-	// Set start-of-timestep-velocity
-#ifdef L_IBM_ON
-	u_n.resize(N_lim * M_lim * K_lim * L_DIMS);
-	u_n = u;
-#endif
-
 	// Density
-	rho.resize(N_lim * M_lim * K_lim);
+	rho.resizeUninitialised(N_lim * M_lim * K_lim);
 	LBM_initRho();
 
 
 #if (defined L_GRAVITY_ON || defined L_IBM_ON)
 
 	// Cartesian force vector
-	force_xyz.resize(N_lim * M_lim * K_lim * L_DIMS, 0.0);
+	force_xyz.resizeUninitialised(N_lim * M_lim * K_lim * L_DIMS);
 
 	// Initialise with gravity
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
+#endif
 	for (int id = 0; id < N_lim * M_lim * K_lim; ++id)
+	{
+		for (int d = 0; d < L_DIMS; ++d)
+			force_xyz[d + id * L_DIMS] = 0.0;
 		force_xyz[L_GRAVITY_DIRECTION + id * L_DIMS] = rho[id] * gravity * refinement_ratio;
-
-	// Lattice force vector
-	force_i.resize(N_lim * M_lim * K_lim * L_NUM_VELS, 0.0);
+	}
 
 #endif
 
@@ -496,32 +530,7 @@ void GridObj::LBM_initSubGrid (GridObj& pGrid)
 
 
 	// Generate POPULATION MATRICES for lower levels
-	// Resize
-	f.resize(N_lim * M_lim * K_lim * L_NUM_VELS);
-	feq.resize(N_lim * M_lim * K_lim * L_NUM_VELS);
-	fNew.resize(N_lim * M_lim * K_lim * L_NUM_VELS);
-
-
-	// Loop over grid
-	for (int i = 0; i < N_lim; ++i)
-	{
-		for (int j = 0; j < M_lim; ++j)
-		{
-			for (int k = 0; k < K_lim; ++k)
-			{
-				for (int v = 0; v < L_NUM_VELS; v++)
-				{
-					
-					// Initialise f to feq
-					f(i, j, k, v, M_lim, K_lim, L_NUM_VELS) = 
-						_LBM_equilibrium_opt(k + j * K_lim + i * M_lim * K_lim, v);
-
-				}
-			}
-		}
-	}
-	feq = f; // Set feq to feq
-	fNew = f;
+	_LBM_initPopulations();
 
 	// Compute relaxation time from coarser level assume refinement by factor of 2
 	omega = 1.0 / ( ( (1.0 / pGrid.omega - 0.5) * 2.0) + 0.5);
@@ -529,6 +538,9 @@ void GridObj::LBM_initSubGrid (GridObj& pGrid)
 	// Lattice viscosity is constant across subgrids
 	nu = pGrid.nu;
 
+	// Select the kernel for the collision model
+	_LBM_initKernel_opt();
+
 #ifdef L_INIT_VERBOSE
 	*GridUtils::logfile << "Initialisation Complete." << std::endl;
 #endif
@@ -980,117 +992,56 @@ void GridObj::LBM_initPositionVector(double start_pos, double end_pos, eCartesia
 /// \brief	Method to initialise wall and object labels on L0.
 ///
 ///			The virtual wind tunnel definitions are implemented by this method.
+///			Every site is labelled so the labels need not be initialised first.
 void GridObj::LBM_initBoundLab ( )
 {
-	// Declarations
-	int i, j, k;
-
-	// LEFT WALL //
+	GridManager *gm = GridManager::getInstance();
 
-	// Search position vector to see if left hand wall on this rank
-	for (i = 0; i < N_lim; i++)
+	/* Each wall is a slab normal to an axis so whether a site is in it only
+	 * depends on its position along that axis. Find the planes in each wall
+	 * from the position vectors (which may wrap when periodic under MPI) and
+	 * then label the sites in one pass. */
+	std::vector<char> bLeft(N_lim), bRight(N_lim), bBottom(M_lim), bTop(M_lim);
+	for (int i = 0; i < N_lim; i++)
 	{
-		// Wall found
-		if (XPos[i] <= L_WALL_THICKNESS_LEFT)
-		{
-			// Label boundary
-			for (j = 0; j < M_lim; j++)
-			{
-				for (k = 0; k < K_lim; k++)
-				{
-					LatTyp(i, j, k, M_lim, K_lim) = 
-						LBM_setBCPrecedence(LatTyp(i, j, k, M_lim, K_lim), L_WALL_LEFT);
-				}
-			}
-		}
+		bLeft[i] = (XPos[i] <= L_WALL_THICKNESS_LEFT);
+		bRight[i] = (XPos[i] >= gm->global_edges[eXMax][0] - L_WALL_THICKNESS_RIGHT);
 	}
-
-	// RIGHT WALL //
-
-	// Search index vector to see if right hand wall on this rank
-	for (i = 0; i < N_lim; i++)
+	for (int j = 0; j < M_lim; j++)
 	{
-		if (XPos[i] >= GridManager::getInstance()->global_edges[eXMax][0] - L_WALL_THICKNESS_RIGHT)
-		{
-			// Label boundary
-			for (j = 0; j < M_lim; j++)
-			{
-				for (k = 0; k < K_lim; k++)
-				{
-					LatTyp(i, j, k, M_lim, K_lim) = 
-						LBM_setBCPrecedence(LatTyp(i, j, k, M_lim, K_lim), L_WALL_RIGHT);
-				}
-			}
-		}
+		bBottom[j] = (YPos[j] <= L_WALL_THICKNESS_BOTTOM);
+		bTop[j] = (YPos[j] >= gm->global_edges[eYMax][0] - L_WALL_THICKNESS_TOP);
 	}
-
 #if (L_DIMS == 3)
-
-	// FRONT WALL //
-
-	for (k = 0; k < K_lim; k++)
-	{
-		if (ZPos[k] <= L_WALL_THICKNESS_FRONT)
-		{
-			for (i = 0; i < N_lim; i++)
-			{
-				for (j = 0; j < M_lim; j++)
-				{
-					LatTyp(i, j, k, M_lim, K_lim) = 
-						LBM_setBCPrecedence(LatTyp(i, j, k, M_lim, K_lim), L_WALL_FRONT);
-				}
-			}
-		}
-	}
-
-	// BACK WALL //
-
-	for (k = 0; k < K_lim; k++)
+	std::vector<char> bFront(K_lim), bBack(K_lim);
+	for (int k = 0; k < K_lim; k++)
 	{
-		if (ZPos[k] >= GridManager::getInstance()->global_edges[eZMax][0] - L_WALL_THICKNESS_BACK)
-		{
-			for (i = 0; i < N_lim; i++)
-			{
-				for (j = 0; j < M_lim; j++)
-				{
-					LatTyp(i, j, k, M_lim, K_lim) = 
-						LBM_setBCPrecedence(LatTyp(i, j, k, M_lim, K_lim), L_WALL_BACK);
-				}
-			}
-		}
+		bFront[k] = (ZPos[k] <= L_WALL_THICKNESS_FRONT);
+		bBack[k] = (ZPos[k] >= gm->global_edges[eZMax][0] - L_WALL_THICKNESS_BACK);
 	}
 #endif
 
-	// BOTTOM WALL //
-
-	for (j = 0; j < M_lim; j++)
-	{
-		if (YPos[j] <= L_WALL_THICKNESS_BOTTOM)
-		{
-			for (i = 0; i < N_lim; i++)
-			{
-				for (k = 0; k < K_lim; k++)
-				{
-					LatTyp(i, j, k, M_lim, K_lim) = 
-						LBM_setBCPrecedence(LatTyp(i, j, k, M_lim, K_lim), L_WALL_BOTTOM);
-				}
-			}
-		}
-	}
-
-	// TOP WALL //
-
-	for (j = 0; j < M_lim; j++)
+	/* Label as coarse site then apply the walls in the order left, right, 
+	 * front, back, bottom, top so the precedence where they meet is kept. */
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
+#endif
+	for (int i = 0; i < N_lim; i++)
 	{
-		if (YPos[j] >= GridManager::getInstance()->global_edges[eYMax][0] - L_WALL_THICKNESS_TOP)
+		for (int j = 0; j < M_lim; j++)
 		{
-			for (i = 0; i < N_lim; i++)
+			for (int k = 0; k < K_lim; k++)
 			{
-				for (k = 0; k < K_lim; k++)
-				{
-					LatTyp(i, j, k, M_lim, K_lim) = 
-						LBM_setBCPrecedence(LatTyp(i, j, k, M_lim, K_lim), L_WALL_TOP);
-				}
+				eType type = eFluid;
+				if (bLeft[i]) type = LBM_setBCPrecedence(type, L_WALL_LEFT);
+				if (bRight[i]) type = LBM_setBCPrecedence(type, L_WALL_RIGHT);
+#if (L_DIMS == 3)
+				if (bFront[k]) type = LBM_setBCPrecedence(type, L_WALL_FRONT);
+				if (bBack[k]) type = LBM_setBCPrecedence(type, L_WALL_BACK);
+#endif
+				if (bBottom[j]) type = LBM_setBCPrecedence(type, L_WALL_BOTTOM);
+				if (bTop[j]) type = LBM_setBCPrecedence(type, L_WALL_TOP);
+				LatTyp(i, j, k, M_lim, K_lim) = type;
 			}
 		}
 	}
@@ -1124,51 +1075,58 @@ void GridObj::LBM_initRefinedLab (GridObj& pGrid) {
 		TL_present[d] = gm->subgrid_tlayer_key[d][gm_idx - 1];
 	}
 
-	// Loop over parent lattice and add "refined" and "TL to lower" labels
-	for (i = 0; i < Np_lim; ++i)
+	/* The sub-grid is a box so whether a parent site is inside it, or within
+	 * a single cell width of an edge with a TL, depends only on its position
+	 * along each axis. Evaluate these per axis first. */
+	std::vector<char> bInX(Np_lim), bInY(Mp_lim), bInZ(Kp_lim, 1);
+	std::vector<char> bTLX(Np_lim), bTLY(Mp_lim), bTLZ(Kp_lim, 0);
+	for (i = 0; i < static_cast<int>(Np_lim); ++i)
 	{
-		for (j = 0; j < Mp_lim; ++j)
-		{
-			for (k = 0; k < Kp_lim; ++k)
-			{
-				// If this parent site is within the bounds of the sub-grid
-				if (
-					pGrid.XPos[i] > edges[eXMin] && pGrid.XPos[i] < edges[eXMax] &&
-					pGrid.YPos[j] > edges[eYMin] && pGrid.YPos[j] < edges[eYMax]
+		double x = pGrid.XPos[i];
+		bInX[i] = (x > edges[eXMin] && x < edges[eXMax]);
+		bTLX[i] = (x > edges[eXMin] && x < edges[eXMin] + pGrid.dh && TL_present[eXMin]) ||
+			(x < edges[eXMax] && x > edges[eXMax] - pGrid.dh && TL_present[eXMax]);
+	}
+	for (j = 0; j < static_cast<int>(Mp_lim); ++j)
+	{
+		double y = pGrid.YPos[j];
+		bInY[j] = (y > edges[eYMin] && y < edges[eYMax]);
+		bTLY[j] = (y > edges[eYMin] && y < edges[eYMin] + pGrid.dh && TL_present[eYMin]) ||
+			(y < edges[eYMax] && y > edges[eYMax] - pGrid.dh && TL_present[eYMax]);
+	}
 #if (L_DIMS == 3)
-					&&
-					pGrid.ZPos[k] > edges[eZMin] && pGrid.ZPos[k] < edges[eZMax]
+	for (k = 0; k < static_cast<int>(Kp_lim); ++k)
+	{
+		double z = pGrid.ZPos[k];
+		bInZ[k] = (z > edges[eZMin] && z < edges[eZMax]);
+		bTLZ[k] = (z > edges[eZMin] && z < edges[eZMin] + pGrid.dh && TL_present[eZMin]) ||
+			(z < edges[eZMax] && z > edges[eZMax] - pGrid.dh && TL_present[eZMax]);
+	}
 #endif
-					)
-				{
 
-					// If within single cell width of sub-grid edge and TL is present then it is TL to lower
-					if (
-						(pGrid.XPos[i] > edges[eXMin] && pGrid.XPos[i] < edges[eXMin] + pGrid.dh && TL_present[eXMin]) ||
-						(pGrid.XPos[i] < edges[eXMax] && pGrid.XPos[i] > edges[eXMax] - pGrid.dh && TL_present[eXMax]) ||
-						(pGrid.YPos[j] > edges[eYMin] && pGrid.YPos[j] < edges[eYMin] + pGrid.dh && TL_present[eYMin]) ||
-						(pGrid.YPos[j] < edges[eYMax] && pGrid.YPos[j] > edges[eYMax] - pGrid.dh && TL_present[eYMax])
-#if (L_DIMS == 3)
-						||
-						(pGrid.ZPos[k] > edges[eZMin] && pGrid.ZPos[k] < edges[eZMin] + pGrid.dh && TL_present[eZMin]) ||
-						(pGrid.ZPos[k] < edges[eZMax] && pGrid.ZPos[k] > edges[eZMax] - pGrid.dh && TL_present[eZMax])
+	// Loop over parent sites within the sub-grid and add "refined" and "TL to lower" labels
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for private(j, k)
 #endif
-						)
-					{
+	for (i = 0; i < static_cast<int>(Np_lim); ++i)
+	{
+		if (!bInX[i]) continue;
+		for (j = 0; j < static_cast<int>(Mp_lim); ++j)
+		{
+			if (!bInY[j]) continue;
+			for (k = 0; k < static_cast<int>(Kp_lim); ++k)
+			{
+				if (!bInZ[k]) continue;
 
-						// If parent site is fluid site then correct label
-						if (pGrid.LatTyp(i, j, k, Mp_lim, Kp_lim) == eFluid) {
-							// Change to "TL to lower" label
-							pGrid.LatTyp(i, j, k, Mp_lim, Kp_lim) = eTransitionToFiner;
-						}
+				// Only fluid sites are relabelled
+				eType &par_label = pGrid.LatTyp(i, j, k, Mp_lim, Kp_lim);
+				if (par_label != eFluid) continue;
 
-					}
-					else if (pGrid.LatTyp(i, j, k, Mp_lim, Kp_lim) == eFluid) {
-						// Label it a "refined" site
-						pGrid.LatTyp(i, j, k, Mp_lim, Kp_lim) = eRefined;
-					}
+				// If within single cell width of sub-grid edge and TL is present then it is TL to lower
+				if (bTLX[i] || bTLY[j] || bTLZ[k]) par_label = eTransitionToFiner;
 
-				}
+				// Otherwise label it a "refined" site
+				else par_label = eRefined;
 			}
 		}
 	}
@@ -1176,28 +1134,27 @@ void GridObj::LBM_initRefinedLab (GridObj& pGrid) {
 
 	// Generate grid type matrices for this level //
 
-	// Declare array for parent site indices
-	std::vector<int> p;
-	eType par_label;
-    
-    // Loop over sub-grid and add labels based on parent site labels
-    for (int i = 0; i < N_lim; i++) {
-		for (int j = 0; j < M_lim; j++) {
+	/* Loop over sub-grid and add labels based on parent site labels. The parent
+	 * of a site is the coarse site covering the pair of fine sites it is in,
+	 * as given by GridUtils::getCoarseIndices(). */
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for private(j, k)
+#endif
+	for (i = 0; i < N_lim; i++)
+	{
+		int pi = i / 2 + CoarseLimsX[eMinimum];
+		for (j = 0; j < M_lim; j++)
+		{
+			int pj = j / 2 + CoarseLimsY[eMinimum];
+			for (k = 0; k < K_lim; k++)
+			{
 #if (L_DIMS == 3)
-			for (int k = 0; k < K_lim; k++)
+				int pk = k / 2 + CoarseLimsZ[eMinimum];
 #else
-			int k = 0;
+				int pk = 0;
 #endif
-			{
-				// Get parent site indices as locals for the current sub-grid local site
-				p = GridUtils::getCoarseIndices(
-					i, CoarseLimsX[eMinimum], 
-					j, CoarseLimsY[eMinimum], 
-					k, CoarseLimsZ[eMinimum]
-				);
-				
 				// Get parent site label using local indices
-				par_label = pGrid.LatTyp(p[eXDirection], p[eYDirection], p[eZDirection], Mp_lim, Kp_lim);
+				eType par_label = pGrid.LatTyp(pi, pj, pk, Mp_lim, Kp_lim);
 								
 				// If parent is a "TL to lower" then add "TL to upper" label
 				if (par_label == eTransitionToFiner)
@@ -1217,9 +1174,9 @@ void GridObj::LBM_initRefinedLab (GridObj& pGrid) {
 				{ 
 					LatTyp(i, j, k, M_lim, K_lim) = par_label;
 				}
-            }
-        }
-    }
+			}
+		}
+	}
 
 }
 
@@ -1242,7 +1199,7 @@ void GridObj::_LBM_initGetInletProfileFromFile()
 	// Indicate to log
 	*GridUtils::logfile << "Loading inlet profile..." << std::endl;
 
-	IVector<double> xbuffer, ybuffer, zbuffer, uxbuffer, uybuffer, uzbuffer;
+	std::vector<double> xbuffer, ybuffer, zbuffer, uxbuffer, uybuffer, uzbuffer;
 	GridUtils::readVelocityFromFile("./input/inlet_profile.in", xbuffer, ybuffer, zbuffer, uxbuffer, uybuffer, uzbuffer);
 
 	// Loop over site positions (for left hand inlet, y positions)
@@ -1376,4 +1333,296 @@ eType GridObj::LBM_setBCPrecedence(eType currentBC, eType desiredBC)
 	else return desiredBC;
 }
 
+// *****************************************************************************
+/// \brief	Builds the streaming mask from the site labels.
+///
+///			For each site, bit v is set if the source site in direction v has a
+///			label which needs more than a plain pull when streaming. Sites with
+///			a clear bit can then be streamed without reading the source label.
+///			With a sparse lattice, the populations are compacted and the 
+///			neighbour table which replaces the mask is built instead. Must be 
+///			called again whenever the labels change. Calls recursively for any 
+///			sub-grids.
+void GridObj::LBM_initStreamMask()
+{
+#if defined L_SPARSE_LATTICE
+
+	_LBM_initSparseLattice();
+
+#elif defined L_STREAM_MASK
+
+	streamMask.resizeUninitialised(N_lim * M_lim * K_lim);
+
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
+#endif
+	for (int i = 0; i < N_lim; ++i)
+	{
+		for (int j = 0; j < M_lim; ++j)
+		{
+			for (int k = 0; k < K_lim; ++k)
+			{
+				maskType mask = 0;
+				for (int v = 0; v < L_NUM_VELS; ++v)
+				{
+					// Source site as found by the stream (periodic by default)
+					int src_x = (i - c_opt[v][0] + N_lim) % N_lim;
+					int src_y = (j - c_opt[v][1] + M_lim) % M_lim;
+					int src_z = (k - c_opt[v][2] + K_lim) % K_lim;
+
+					switch (LatTyp(src_x, src_y, src_z, M_lim, K_lim))
+					{
+					case eFluid:
+					case eTransitionToFiner:
+					case ePressure:
+					case eSlip:
+						break;
+
+					default:
+						mask |= static_cast<maskType>(1u << v);
+						break;
+					}
+				}
+				streamMask(i, j, k, M_lim, K_lim) = mask;
+			}
+		}
+	}
+
+#endif
+
+	// Build the mask on the sub-grids
+	for (GridObj *g : subGrid)
+		g->LBM_initStreamMask();
+}
+
+#ifdef L_SPARSE_LATTICE
+// *****************************************************************************
+/// \brief	Compacts the populations to the non-solid sites.
+///
+///			Solid sites are never streamed or collided so their populations 
+///			are not stored. They all share one scratch entry at the end of f 
+///			and fNew which absorbs writes to them (halo exchange, restart or 
+///			site migration) and whose values have no meaning. The stored sites
+///			keep the order of the dense arrays. On the first call the 
+///			populations are allocated and set to equilibrium. On later calls 
+///			the populations held are carried over and sites which were solid 
+///			start from equilibrium, so it may be called again whenever the 
+///			labels change. For each stored population, the entry of f pulled 
+///			by the stream is stored in the neighbour table where the link is a 
+///			plain pull (a clear bit of the stream mask) and -1 otherwise.
+void GridObj::_LBM_initSparseLattice()
+{
+	const int nSites = N_lim * M_lim * K_lim;
+
+	// Sites to store and the first solid site whose values seed the scratch entry
+	std::vector<int> stored;
+	int firstSolid = -1;
+	for (int id = 0; id < nSites; ++id)
+	{
+		if (LatTyp[id] != eSolid) stored.push_back(id);
+		else if (firstSolid < 0) firstSolid = id;
+	}
+	stored.shrink_to_fit();
+	const int nStored = static_cast<int>(stored.size());
+
+	// Populations are only moved if the stored sites have changed
+	const bool bAllocated = !popSite.empty();
+	if (!bAllocated || stored != sparseSites)
+	{
+		const int oldScratch = static_cast<int>(sparseSites.size());
+
+		/* Allocate the stored sites only (threaded as in the kernel so each 
+		 * thread first touches its part) and copy any populations held. */
+		IVector<popType> fSparse, fNewSparse;
+		fSparse.resizeUninitialised((nStored + 1) * L_NUM_VELS);
+		fNewSparse.resizeUninitialised((nStored + 1) * L_NUM_VELS);
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
+#endif
+		for (int s = 0; s <= nStored; ++s)
+		{
+			int id = (s < nStored) ? stored[s] : firstSolid;
+			bool bHeld = bAllocated && id >= 0 && (popSite[id] != oldScratch || s == nStored);
+			for (int v = 0; v < L_NUM_VELS; ++v)
+			{
+				if (bHeld)
+				{
+					fSparse[v + s * L_NUM_VELS] = f[popIdx(id, v)];
+					fNewSparse[v + s * L_NUM_VELS] = fNew[popIdx(id, v)];
+				}
+				else
+				{
+					fSparse[v + s * L_NUM_VELS] = fNewSparse[v + s * L_NUM_VELS] = (id < 0) ? 
+						static_cast<popType>(0) : L_POP_SET(_LBM_equilibrium_opt(id, v), v);
+				}
+			}
+		}
+		f.swap(fSparse);
+		fNew.swap(fNewSparse);
+
+		// New position of each site
+		sparseSites.swap(stored);
+		IVector<int> site(nSites, nStored);
+		for (int s = 0; s < nStored; ++s) site[sparseSites[s]] = s;
+		popSite.swap(site);
+	}
+
+	// Neighbour table
+	IVector<int>().swap(sparseSrc);
+	sparseSrc.resizeUninitialised(nStored * L_NUM_VELS);
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
+#endif
+	for (int s = 0; s < nStored; ++s)
+	{
+		int id = sparseSites[s];
+		int i = id / (K_lim * M_lim);
+		int j = (id / K_lim) % M_lim;
+		int k = id % K_lim;
+
+		// All links of BFL and slip sites need the full stream
+		bool bSpecial = (LatTyp[id] == eBFL || LatTyp[id] == eSlip);
+
+		for (int v = 0; v < L_NUM_VELS; ++v)
+		{
+			// Source site as found by the stream (periodic by default)
+			int src_x = (i - c_opt[v][0] + N_lim) % N_lim;
+			int src_y = (j - c_opt[v][1] + M_lim) % M_lim;
+			int src_z = (k - c_opt[v][2] + K_lim) % K_lim;
+			int src_id = src_z + src_y * K_lim + src_x * K_lim * M_lim;
+
+			int src = -1;
+			switch (LatTyp[src_id])
+			{
+			case eFluid:
+			case eTransitionToFiner:
+			case ePressure:
+			case eSlip:
+				if (!bSpecial) src = popIdx(src_id, v);
+				break;
+
+			default:
+				break;
+			}
+			sparseSrc[v + s * L_NUM_VELS] = src;
+		}
+	}
+
+	// Report the saving
+	L_INFO("Grid L" + std::to_string(level) + " R" + std::to_string(region_number) + ": populations stored for " +
+		std::to_string(nStored) + " of " + std::to_string(nSites) + " sites.", GridUtils::logfile);
+}
+#endif
+
+// *****************************************************************************
+/// \brief	Builds the coarse-fine index maps from the site labels.
+///
+///			Stores the child grid and first child site under each
+///			transition-to-finer site and the parent site above each
+///			transition-to-coarser site so that the explode and the child
+///			macroscopic update do not search for them every time step. The
+///			populations which the coalesce must average are listed on the child
+///			so they can be written to this grid in one pass once the child has
+///			completed its sub-cycles. Must be called again whenever the labels
+///			change and, as the lists index the populations, after 
+///			LBM_initStreamMask(). Calls recursively for any sub-grids.
+void GridObj::LBM_initRefinedMaps()
+{
+#if (L_NUM_LEVELS > 0)
+
+	int nSites = N_lim * M_lim * K_lim;
+
+	// Explode map (parent site above each transition-to-coarser site)
+	refineParent.assign(parentGrid ? nSites : 0, -1);
+	if (parentGrid)
+	{
+		for (int i = 0; i < N_lim; ++i)
+		{
+			for (int j = 0; j < M_lim; ++j)
+			{
+				for (int k = 0; k < K_lim; ++k)
+				{
+					int id = k + j * K_lim + i * K_lim * M_lim;
+					if (LatTyp[id] != eTransitionToCoarser) continue;
+
+					std::vector<int> pInd =
+						GridUtils::getCoarseIndices(
+						i, CoarseLimsX[eMinimum],
+						j, CoarseLimsY[eMinimum],
+						k, CoarseLimsZ[eMinimum]);
+					refineParent[id] = pInd[2] + pInd[1] * parentGrid->K_lim + pInd[0] * parentGrid->K_lim * parentGrid->M_lim;
+				}
+			}
+		}
+	}
+
+	// Coalesce lists (on the children) and child map
+	refineChild.assign(subGrid.empty() ? 0 : nSites, -1);
+	refineChildBase.assign(subGrid.empty() ? 0 : nSites, -1);
+	for (GridObj *g : subGrid)
+	{
+		g->coalesceDst.clear();
+		g->coalesceSrc.clear();
+	}
+
+	if (!subGrid.empty())
+	{
+		for (int i = 0; i < N_lim; ++i)
+		{
+			for (int j = 0; j < M_lim; ++j)
+			{
+				for (int k = 0; k < K_lim; ++k)
+				{
+					int id = k + j * K_lim + i * K_lim * M_lim;
+					if (LatTyp[id] != eTransitionToFiner) continue;
+
+					// Get pointer to appropriate child grid
+					GridObj *childGrid = GridUtils::getSubGrid(i, j, k, this);
+					if (!childGrid) L_ERROR("Could not get correct grid for coalesce operation.", GridUtils::logfile);
+
+					// Index of first site of child cluster
+					std::vector<int> cInd =
+						GridUtils::getFineIndices(
+						i, childGrid->CoarseLimsX[eMinimum],
+						j, childGrid->CoarseLimsY[eMinimum],
+						k, childGrid->CoarseLimsZ[eMinimum]);
+					int cBase = cInd[2] + cInd[1] * childGrid->K_lim + cInd[0] * childGrid->K_lim * childGrid->M_lim;
+
+					refineChild[id] = static_cast<int>(std::find(subGrid.begin(), subGrid.end(), childGrid) - subGrid.begin());
+					refineChildBase[id] = cBase;
+
+					// Directions pulled from refined sites (periodic by default)
+					for (int v = 0; v < L_NUM_VELS; ++v)
+					{
+						int src_x = (i - c_opt[v][0] + N_lim) % N_lim;
+						int src_y = (j - c_opt[v][1] + M_lim) % M_lim;
+						int src_z = (k - c_opt[v][2] + K_lim) % K_lim;
+
+						if (LatTyp(src_x, src_y, src_z, M_lim, K_lim) == eRefined)
+						{
+							childGrid->coalesceDst.push_back(popIdx(id, v));
+#ifdef L_SPARSE_LATTICE
+							// Every site of the cluster in the order of the dense offsets
+							for (int ci = 0; ci < 2; ++ci)
+								for (int cj = 0; cj < 2; ++cj)
+									for (int ck = 0; ck < ((L_DIMS == 3) ? 2 : 1); ++ck)
+										childGrid->coalesceSrc.push_back(childGrid->popIdx(
+										cBase + ck + cj * childGrid->K_lim + ci * childGrid->K_lim * childGrid->M_lim, v));
+#else
+							childGrid->coalesceSrc.push_back(v + cBase * L_NUM_VELS);
+#endif
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// Build the maps on the sub-grids
+	for (GridObj *g : subGrid)
+		g->LBM_initRefinedMaps();
+
+#endif
+}
+
 // ***************************************************************************************************
@@ -142,7 +142,7 @@ void GridObj::io_textout(std::string output_tag) {
 				for (size_t i = 0; i < N_lim; i++) {
 
 					// Output
-					gridoutput << LatTyp(i,j,k,M_lim,K_lim) << "\t";
+					gridoutput << static_cast<int>(LatTyp(i,j,k,M_lim,K_lim)) << "\t";
 
 				}
 			}
@@ -165,7 +165,7 @@ void GridObj::io_textout(std::string output_tag) {
 					for (size_t i = 0; i < N_lim; i++) {
 
 						// Output
-						gridoutput << f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) << "\t";
+						gridoutput << L_POP_GET(f[popIdx(i, j, k, v)], v) << "\t";
 
 					}
 				}
@@ -188,7 +188,7 @@ void GridObj::io_textout(std::string output_tag) {
 					for (size_t i = 0; i < N_lim; i++) {
 
 						// Output
-						gridoutput << feq(i,j,k,v,M_lim,K_lim,L_NUM_VELS) << "\t";
+						gridoutput << _LBM_equilibrium_opt(k + j * K_lim + i * K_lim * M_lim, static_cast<int>(v)) << "\t";
 
 					}
 				}
@@ -386,6 +386,49 @@ void GridObj::_io_fgaout(int timeStepL0) {
 
 }
 
+// *****************************************************************************
+/// \brief	Memory report writer.
+///
+///			Writes the memory held by the per-site field arrays of this grid to 
+///			the log and calls recursively for any sub-grids. The stream tables 
+///			are the stream mask or the index arrays of the sparse lattice.
+///
+///	\return	bytes held by this grid and its sub-grids.
+size_t GridObj::io_memoryReport() {
+
+	// Bytes held by each group of per-site arrays
+	size_t popBytes = (f.capacity() + fNew.capacity()) * sizeof(popType);
+	size_t macroBytes = (u.capacity() + rho.capacity()) * sizeof(double);
+	size_t forceBytes = force_xyz.capacity() * sizeof(double);
+	size_t timeavBytes = (rho_timeav.capacity() + ui_timeav.capacity() + uiuj_timeav.capacity()) * sizeof(double);
+	size_t typeBytes = LatTyp.capacity() * sizeof(eType);
+	size_t streamBytes = 0;
+#ifdef L_STREAM_MASK
+	streamBytes += streamMask.capacity() * sizeof(maskType);
+#endif
+#ifdef L_SPARSE_LATTICE
+	streamBytes += (popSite.capacity() + sparseSites.capacity() + sparseSrc.capacity()) * sizeof(int);
+#endif
+	size_t totalBytes = popBytes + macroBytes + forceBytes + timeavBytes + typeBytes + streamBytes;
+	size_t sites = static_cast<size_t>(N_lim) * M_lim * K_lim;
+
+	// Write to log
+	const double MB = 1024.0 * 1024.0;
+	std::stringstream ss;
+	ss << "Grid L" << level << " R" << region_number << " memory = " << totalBytes / MB << " MB for " <<
+		sites << " sites (" << (sites ? totalBytes / sites : 0) << " bytes/site): populations " << popBytes / MB <<
+		" MB, macroscopic " << macroBytes / MB << " MB, forces " << forceBytes / MB <<
+		" MB, time-averaged " << timeavBytes / MB << " MB, labels " << typeBytes / MB << " MB, stream tables " <<
+		streamBytes / MB << " MB";
+	L_INFO(ss.str(), GridUtils::logfile);
+
+	// Call recursively for sub-grids
+	for (GridObj *g : subGrid)
+		totalBytes += g->io_memoryReport();
+
+	return totalBytes;
+}
+
 // *****************************************************************************
 /// \brief	Restart file read-writer.
 ///
@@ -426,6 +469,11 @@ void GridObj::io_restart(eIOFlag IO_flag) {
 		if (level == 0) {
 			// New file
 			file.open(GridUtils::path_str + "/restart_LBM_Rnk" + rnk_str + ".out", std::ios::out);
+
+#if (L_NUM_LEVELS > 0)
+			// Refined blocks may have changed so record them
+			gm->writeRestartRegions();
+#endif
 		}
 		else {
 			// Append
@@ -463,7 +511,7 @@ void GridObj::io_restart(eIOFlag IO_flag) {
 					// time - scaled fneq values
 					for (v = 0; v < L_NUM_VELS; v++) {
 						double f_eq = _LBM_equilibrium_opt(id, v);
-						double f_neq_restart = ((f(i, j, k, v, M_lim, K_lim, L_NUM_VELS) - f_eq) * omega) / (f_eq*dt);
+						double f_neq_restart = ((L_POP_GET(f[popIdx(i, j, k, v)], v) - f_eq) * omega) / (f_eq*dt);
 						file << f_neq_restart << "\t";
 					}
 
@@ -529,8 +577,8 @@ void GridObj::io_restart(eIOFlag IO_flag) {
 			iss.str(line_in);
 			iss.seekg(0); // Reset buffer position to start of buffer
 
-			// Read in level and region
-			iss >> in_level >> in_regnum;
+			// Read in level and region (skipping the empty line at the end)
+			if (!(iss >> in_level >> in_regnum)) continue;
 
 			// Get grid
 			GridObj *g = nullptr;
@@ -548,7 +596,7 @@ void GridObj::io_restart(eIOFlag IO_flag) {
 			i = ijk[0];
 			j = ijk[1];
 			k = ijk[2];
-			int id = k + j * K_lim + i * K_lim * M_lim;
+			int id = k + j * g->K_lim + i * g->K_lim * g->M_lim;
 
 			// Read in u values and convert them to lbm units
 			for (v = 0; v < L_DIMS; v++) {
@@ -563,10 +611,10 @@ void GridObj::io_restart(eIOFlag IO_flag) {
 			// Read in f values and convert them to the new dt
 			for (v = 0; v < L_NUM_VELS; v++) {
 				double f_temp;
-				double f_eq = _LBM_equilibrium_opt(id, v);
+				double f_eq = g->_LBM_equilibrium_opt(id, v);
 				iss >> f_temp;
-				g->f(i, j, k, v, g->M_lim, g->K_lim, L_NUM_VELS) = f_eq*(1 + (g->dt*f_temp) / omega);
-				g->fNew(i, j, k, v, g->M_lim, g->K_lim, L_NUM_VELS) = g->f(i, j, k, v, g->M_lim, g->K_lim, L_NUM_VELS);
+				g->f[g->popIdx(i, j, k, v)] = L_POP_SET(f_eq*(1 + (g->dt*f_temp) / g->omega), v);
+				g->fNew[g->popIdx(i, j, k, v)] = g->f[g->popIdx(i, j, k, v)];
 			}
 
 		}
@@ -590,70 +638,79 @@ void GridObj::io_restart(eIOFlag IO_flag) {
 }
 
 // *****************************************************************************
-/// \brief	Probe writer.
+/// \brief	Probe initialiser.
 ///
-///			This routine writes the quantities at the probe locations to a single 
-///			file.
-void GridObj::io_probeOutput() {
-
-	int rank = GridUtils::safeGetRank();
+///			Computes the mapping from each probe to the owning rank, grid and 
+///			local site once so that subsequent writes are simple lookups. The 
+///			finest non-halo site which is not a transition to a finer grid is 
+///			used for each probe. The writer rank is also told once how many 
+///			probes each rank owns so that buffered data can be gathered in a 
+///			single collective when the buffer is flushed. Every probe has a 
+///			slot in the file given by its global index, whether or not it could 
+///			be located, so if the mapping is rebuilt after a change in 
+///			decomposition the existing file header remains valid and is not 
+///			rewritten.
+///
+///	\param	bWriteHeader	flag to write the probe file header.
+void GridObj::io_initProbes(bool bWriteHeader) {
 
 	// Declarations
-	std::ofstream probefile;
-	int i, j, d;
+	int i, j, p;
 	double x, y, z;
-
-	if (t == 0 && rank == 0) {
-		// Overwrite existing first time through
-		probefile.open(GridUtils::path_str + "/probe.out", std::ios::out);
-	} else {
-		// Append to existing
-		probefile.open(GridUtils::path_str + "/probe.out", std::ios::out | std::ios::app);
-	}
-	probefile.precision(L_OUTPUT_PRECISION);
-
-	// Start a new line if first rank
-	if (rank == 0 && t != 0) probefile << std::endl;
-
-	// Declarations
 	eLocationOnRank loc = eNone;
 	GridObj *g = nullptr;
 	std::vector<int> ijk;
 
+	// Reset any existing mapping
+	probeIdx.clear();
+	probeGrid.clear();
+	probeSiteID.clear();
+	probeBuffer.clear();
+	probeBufferTimes.clear();
+
+	// Probe limits (evaluated here since the wall thickness depends on the run-time resolution)
+	const double probeLimsX[2] = { L_PROBE_MIN_X, L_PROBE_MAX_X };
+	const double probeLimsY[2] = { L_PROBE_MIN_Y, L_PROBE_MAX_Y };
+#if (L_DIMS == 3)
+	const double probeLimsZ[2] = { L_PROBE_MIN_Z, L_PROBE_MAX_Z };
+#endif
+
 	// Probe spacing in each direction
-	double pspace[L_DIMS];
+	double pspace[L_DIMS] = { 0.0 };
 	if (cNumProbes[0] > 1)
-		pspace[0] = abs(cProbeLimsX[1] - cProbeLimsX[0]) / (cNumProbes[0] - 1);
+		pspace[0] = abs(probeLimsX[1] - probeLimsX[0]) / (cNumProbes[0] - 1);
 	if (cNumProbes[1] > 1)
-		pspace[1] = abs(cProbeLimsY[1] - cProbeLimsY[0]) / (cNumProbes[1] - 1);
+		pspace[1] = abs(probeLimsY[1] - probeLimsY[0]) / (cNumProbes[1] - 1);
 #if (L_DIMS == 3)
 	if (cNumProbes[2] > 1)
-		pspace[2] = abs(cProbeLimsZ[1] - cProbeLimsZ[0]) / (cNumProbes[2] - 1);
+		pspace[2] = abs(probeLimsZ[1] - probeLimsZ[0]) / (cNumProbes[2] - 1);
 #endif
 
 	// Loop over probe points to compute positions
+	p = 0;
 	for (i = 0; i < cNumProbes[0]; i++) {
-		x = cProbeLimsX[0] + i*pspace[0];
+		x = probeLimsX[0] + i*pspace[0];
 
 		for (j = 0; j < cNumProbes[1]; j++) {
-			y = cProbeLimsY[0] + j*pspace[1];
+			y = probeLimsY[0] + j*pspace[1];
 
 #if (L_DIMS == 3)
-			for (int k = 0; k < cNumProbes[2]; k++) {
-				z = cProbeLimsZ[0] + k*pspace[2];
+			for (int k = 0; k < cNumProbes[2]; k++, p++) {
+				z = probeLimsZ[0] + k*pspace[2];
 #else
 			z = 0.0; {
 #endif
-				// Set written flag
-				bool bProbeWritten = false;
+				// Set found flag
+				bool bProbeFound = false;
 
 				// Get each grid available on this rank in reverse order
-				for (int lev = L_NUM_LEVELS; lev >= 0; --lev)
+				for (int lev = L_NUM_LEVELS; lev >= 0 && !bProbeFound; --lev)
 				{
 					for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
 					{
 
 						// Get grid if available
+						g = nullptr;
 						GridUtils::getGrid(GridManager::getInstance()->Grids, lev, reg, g);
 						if (g == nullptr) continue;
 
@@ -666,40 +723,201 @@ void GridObj::io_probeOutput() {
 						// As long as not on a TL to finer we can use it
 						if (g->LatTyp(ijk[0], ijk[1], ijk[2], g->M_lim, g->K_lim) == eTransitionToFiner) continue;
 
-						// Write out velocity components and add tab
-						for (d = 0; d < L_DIMS; d++)
-						{
-							probefile << g->u(ijk[0], ijk[1], ijk[2], d, g->M_lim, g->K_lim, L_DIMS) << "\t";
-						}
+						// Store mapping
+						probeIdx.push_back(p);
+						probeGrid.push_back(g);
+						probeSiteID.push_back(ijk[2] + ijk[1] * g->K_lim + ijk[0] * g->K_lim * g->M_lim);
+
+						bProbeFound = true;
+						break;
+					}
+				}
 #if (L_DIMS != 3)
-						probefile << 0 << "\t";
+				p++;
 #endif
+			}
+		}
+	}
 
-						// Write out density
-						probefile << g->rho(ijk[0], ijk[1], ijk[2], g->M_lim, g->K_lim) << "\t";
+	// Tell the writer rank how many probes each rank owns
+	int numOwned = static_cast<int>(probeIdx.size());
+	std::vector<int> gatheredIdx;
+#ifdef L_BUILD_FOR_MPI
+	MpiManager *mpim = MpiManager::getInstance();
+	if (mpim->my_rank == 0) probeCounts.resize(mpim->num_ranks, 0);
+	MPI_Gather(&numOwned, 1, MPI_INT, probeCounts.data(), 1, MPI_INT, 0, mpim->world_comm);
+
+	std::vector<int> disps;
+	if (mpim->my_rank == 0) {
+		disps.resize(mpim->num_ranks, 0);
+		for (int r = 1; r < mpim->num_ranks; r++)
+			disps[r] = disps[r - 1] + probeCounts[r - 1];
+		gatheredIdx.resize(std::accumulate(probeCounts.begin(), probeCounts.end(), 0));
+	}
+	MPI_Gatherv(probeIdx.data(), numOwned, MPI_INT, gatheredIdx.data(),
+		probeCounts.data(), disps.data(), MPI_INT, 0, mpim->world_comm);
+	if (mpim->my_rank != 0) return;
+#else
+	probeCounts.assign(1, numOwned);
+	gatheredIdx = probeIdx;
+#endif
 
-						bProbeWritten = true;
-						break;
+	// Writer rank writes each gathered probe to the slot of its global probe 
+	// index. Probes sitting exactly on a rank boundary may be reported twice 
+	// in which case only the first is kept.
+	int numProbes = cNumProbes[0] * cNumProbes[1] * (L_DIMS == 3 ? cNumProbes[2] : 1);
+	probeNumWritten = numProbes;
+	probeSlots.resize(gatheredIdx.size());
+	std::vector<bool> bTaken(numProbes, false);
+	int numLocated = 0;
+	for (size_t n = 0; n < gatheredIdx.size(); n++) {
+		int slot = gatheredIdx[n];
+		probeSlots[n] = bTaken[slot] ? -1 : slot;
+		if (!bTaken[slot]) numLocated++;
+		bTaken[slot] = true;
+	}
 
-					}
+	if (numLocated < numProbes)
+		L_WARN(std::to_string(numProbes - numLocated) + " of " + std::to_string(numProbes) + 
+		" probes could not be located on the grid and will be written as NaN.", GridUtils::logfile);
 
-					if (bProbeWritten) break;
-				}
+	if (!bWriteHeader) return;
 
+	// Write the header (number of probes, components per probe and probe positions)
+	std::ofstream probefile(GridUtils::path_str + "/probe.bin", std::ios::out | std::ios::binary);
+	int numComps = 4;
+	probefile.write(reinterpret_cast<const char*>(&probeNumWritten), sizeof(int));
+	probefile.write(reinterpret_cast<const char*>(&numComps), sizeof(int));
+	for (i = 0; i < cNumProbes[0]; i++) {
+		for (j = 0; j < cNumProbes[1]; j++) {
+			for (int k = 0; k < (L_DIMS == 3 ? cNumProbes[2] : 1); k++) {
+				double pos[3] = {
+					probeLimsX[0] + i*pspace[0],
+					probeLimsY[0] + j*pspace[1],
+#if (L_DIMS == 3)
+					probeLimsZ[0] + k*pspace[2]
+#else
+					0.0
+#endif
+				};
+				probefile.write(reinterpret_cast<const char*>(pos), 3 * sizeof(double));
 			}
 		}
 	}
-
 	probefile.close();
+	probeFileStarted = true;
 
+}
+
+// *****************************************************************************
+/// \brief	Probe writer.
+///
+///			This routine copies the quantities at the probe locations owned by 
+///			this rank into a buffer. No communication takes place until the 
+///			buffer holds L_PROBE_BUFFER_STEPS records at which point it is 
+///			flushed to file. Must be called by all ranks.
+void GridObj::io_probeOutput() {
+
+	// Store time step and values (ux, uy, uz, rho) for each owned probe
+	probeBufferTimes.push_back(t);
+	for (size_t n = 0; n < probeIdx.size(); n++) {
+		GridObj *g = probeGrid[n];
+		int id = probeSiteID[n];
+		for (int d = 0; d < L_DIMS; d++)
+			probeBuffer.push_back(g->u[d + id * L_DIMS]);
+#if (L_DIMS != 3)
+		probeBuffer.push_back(0.0);
+#endif
+		probeBuffer.push_back(g->rho[id]);
+	}
+
+	// Flush if buffer full
+	if (probeBufferTimes.size() >= L_PROBE_BUFFER_STEPS) io_probeFlush();
 
 }
 
 // *****************************************************************************
-/// \brief	ASCII dump of grid data.
+/// \brief	Flushes the buffered probe data to file.
 ///
-///			Generic ASCII writer for each rank to write out all grid data in rows 
-///			into a single, unsorted file.
+///			Buffered probe values from all ranks are gathered to the writer rank 
+///			in a single collective and appended to the binary probe file. Each 
+///			record is an integer time step followed by 4 doubles per probe 
+///			(ux, uy, uz, rho) in the order of the positions given in the header.
+///			Probes which could not be located are written as NaN. Must be 
+///			called by all ranks.
+void GridObj::io_probeFlush() {
+
+	int numSteps = static_cast<int>(probeBufferTimes.size());
+	if (numSteps == 0) return;
+
+	// Gather buffers to the writer rank
+	const int numComps = 4;
+	std::vector<double> recvBuffer;
+#ifdef L_BUILD_FOR_MPI
+	MpiManager *mpim = MpiManager::getInstance();
+	std::vector<int> recvSizes, recvDisps;
+	if (mpim->my_rank == 0) {
+		recvSizes.resize(mpim->num_ranks, 0);
+		recvDisps.resize(mpim->num_ranks, 0);
+		for (int r = 0; r < mpim->num_ranks; r++) {
+			recvSizes[r] = probeCounts[r] * numComps * numSteps;
+			if (r > 0) recvDisps[r] = recvDisps[r - 1] + recvSizes[r - 1];
+		}
+		recvBuffer.resize(std::accumulate(recvSizes.begin(), recvSizes.end(), 0));
+	}
+	MPI_Gatherv(probeBuffer.data(), static_cast<int>(probeBuffer.size()), MPI_DOUBLE, 
+		recvBuffer.data(), recvSizes.data(), recvDisps.data(), MPI_DOUBLE, 0, mpim->world_comm);
+#else
+	recvBuffer.swap(probeBuffer);
+#endif
+
+	std::vector<int> times;
+	times.swap(probeBufferTimes);
+	probeBuffer.clear();
+	if (!probeFileStarted) return;
+
+	// Reorder into file order and append (each rank block is [step][probe][comp])
+	std::ofstream probefile(GridUtils::path_str + "/probe.bin", 
+		std::ios::out | std::ios::binary | std::ios::app);
+	std::vector<double> record(probeNumWritten * numComps);
+	for (int s = 0; s < numSteps; s++) {
+		std::fill(record.begin(), record.end(), std::nan(""));
+		size_t offset = 0;
+		int n = 0;
+		for (size_t r = 0; r < probeCounts.size(); r++) {
+			for (int q = 0; q < probeCounts[r]; q++, n++) {
+				int slot = probeSlots[n];
+				if (slot >= 0) {
+					const double *src = &recvBuffer[offset + (s * probeCounts[r] + q) * numComps];
+					std::copy(src, src + numComps, &record[slot * numComps]);
+				}
+			}
+			offset += static_cast<size_t>(probeCounts[r]) * numComps * numSteps;
+		}
+		probefile.write(reinterpret_cast<const char*>(&times[s]), sizeof(int));
+		probefile.write(reinterpret_cast<const char*>(record.data()), record.size() * sizeof(double));
+	}
+	probefile.close();
+
+}
+
+// *****************************************************************************
+/// \brief	ASCII or binary dump of grid data.
+///
+///			Generic writer for each rank to write out all grid data in rows 
+///			into a single, unsorted file. Each row holds the rank, type, 
+///			position, rho, u (3 components), f, fNew and, if computed, the time 
+///			averaged quantities (10 values). The file is written through a large
+///			buffer.
+///
+///			If L_IO_LITE_BINARY is defined a .bin file is written instead with 
+///			the header
+///				char[8] "LUMALITE", int32 version, int32 dims, int32 velocities,
+///				int32 doubles per record, int32 level, int32 region, int32 rank,
+///				double time, int64 number of records
+///			followed by fixed-width records of int32 rank, int32 type and the 
+///			remaining values of a row as doubles. tools/post_processors/litetool
+///			merges and compares either format.
 ///
 /// \param tval	time value being written out.
 /// \param TAG	text identifier for the data.
@@ -708,17 +926,42 @@ void GridObj::io_lite(double tval, std::string TAG) {
 	int rank = GridUtils::safeGetRank();
 	std::ofstream litefile;
 
+	// Large write buffer (must be set before the file is opened)
+	const size_t bufferSize = 4 * 1024 * 1024;
+	std::vector<char> buffer(bufferSize);
+	litefile.rdbuf()->pubsetbuf(buffer.data(), bufferSize);
+
 	// Filename
 	std::string filename ("./" + GridUtils::path_str + "/io_lite.Lev" + std::to_string(level) + ".Reg" + std::to_string(region_number)
-			+ ".Rnk" + std::to_string(rank) + "." + std::to_string((int)tval) + ".dat");
+			+ ".Rnk" + std::to_string(rank) + "." + std::to_string((int)tval));
 
+	// Values per row after rank and type
+#ifdef L_COMPUTE_TIME_AVERAGED_QUANTITIES
+	const int nValues = 7 + 2 * L_NUM_VELS + 10;
+#else
+	const int nValues = 7 + 2 * L_NUM_VELS;
+#endif
+	std::vector<double> row(nValues);
+
+#ifdef L_IO_LITE_BINARY
+	// Create file and write header (record count filled in at the end)
+	litefile.open(filename + ".bin", std::ios::out | std::ios::binary);
+	const int32_t header[7] = { 1, L_DIMS, L_NUM_VELS, nValues, level, region_number, rank };
+	int64_t nRecords = 0;
+	litefile.write("LUMALITE", 8);
+	litefile.write(reinterpret_cast<const char*>(header), sizeof(header));
+	litefile.write(reinterpret_cast<const char*>(&tval), sizeof(double));
+	std::streampos countPos = litefile.tellp();
+	litefile.write(reinterpret_cast<const char*>(&nRecords), sizeof(int64_t));
+#else
 	// Create file
-	litefile.open(filename, std::ios::out);
+	litefile.open(filename + ".dat", std::ios::out);
 
 	// Set precision and force fixed formatting
 	litefile.precision(L_OUTPUT_PRECISION);
 	litefile.setf(std::ios::fixed);
 	litefile.setf(std::ios::showpoint);
+#endif
 	
 	// Indices
 	size_t i,j,k,v;
@@ -734,65 +977,74 @@ void GridObj::io_lite(double tval, std::string TAG) {
 				if (!GridUtils::isOnRecvLayer(XPos[i],YPos[j],ZPos[k]))
 #endif				
 				{
+					int n = 0;
 
-					// Write out rank
-					litefile << rank << "\t";
-				
-					// Write out type
-					litefile << LatTyp(i,j,k,M_lim,K_lim) << "\t";
-
-					// Write out X, Y, Z
-					litefile << XPos[i] << "\t" << YPos[j] << "\t" << ZPos[k] << "\t";
+					// X, Y, Z
+					row[n++] = XPos[i];
+					row[n++] = YPos[j];
+					row[n++] = ZPos[k];
 
-					// Write out rho and u
-					litefile << rho(i,j,k,M_lim,K_lim) << "\t";
+					// rho and u
+					row[n++] = rho(i,j,k,M_lim,K_lim);
 					for (v = 0; v < L_DIMS; v++) {
-						litefile << u(i,j,k,v,M_lim,K_lim,L_DIMS) << "\t";
+						row[n++] = u(i,j,k,v,M_lim,K_lim,L_DIMS);
 					}
 #if (L_DIMS != 3)
-					litefile << std::to_string(0.0) << "\t";
+					row[n++] = 0.0;
 #endif
 
-					// Write out F and Feq
+					// F and Feq
 					for (v = 0; v < L_NUM_VELS; v++) {
-						litefile << f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) << "\t";
+						row[n++] = L_POP_GET(f[popIdx(i, j, k, v)], v);
 					}
 					for (v = 0; v < L_NUM_VELS; v++) {
-						litefile << fNew(i,j,k,v,M_lim,K_lim,L_NUM_VELS) << "\t";
+						row[n++] = L_POP_GET(fNew[popIdx(i, j, k, v)], v);
 					}
 				
 #ifdef L_COMPUTE_TIME_AVERAGED_QUANTITIES
-					// Write out time averaged rho and u
-					litefile << rho_timeav(i,j,k,M_lim,K_lim) << "\t";
+					// Time averaged rho and u
+					row[n++] = rho_timeav(i,j,k,M_lim,K_lim);
 					for (v = 0; v < L_DIMS; v++) {
-						litefile << ui_timeav(i,j,k,v,M_lim,K_lim,L_DIMS) << "\t";
+						row[n++] = ui_timeav(i,j,k,v,M_lim,K_lim,L_DIMS);
 					}
 #if (L_DIMS != 3)
-					litefile << std::to_string(0.0) << "\t";
+					row[n++] = 0.0;
 #endif
 
-					// Write out time averaged u products
-					litefile << uiuj_timeav(i,j,k,0,M_lim,K_lim,(3*L_DIMS-3)) << "\t";
-					litefile << uiuj_timeav(i,j,k,1,M_lim,K_lim,(3*L_DIMS-3)) << "\t";
+					// Time averaged u products
+					row[n++] = uiuj_timeav(i,j,k,0,M_lim,K_lim,(3*L_DIMS-3));
+					row[n++] = uiuj_timeav(i,j,k,1,M_lim,K_lim,(3*L_DIMS-3));
 #if (L_DIMS == 3)
-					litefile << uiuj_timeav(i,j,k,2,M_lim,K_lim,(3*L_DIMS-3)) << "\t";
+					row[n++] = uiuj_timeav(i,j,k,2,M_lim,K_lim,(3*L_DIMS-3));
+					row[n++] = uiuj_timeav(i,j,k,3,M_lim,K_lim,(3*L_DIMS-3));
+					row[n++] = uiuj_timeav(i,j,k,4,M_lim,K_lim,(3*L_DIMS-3));
+					row[n++] = uiuj_timeav(i,j,k,5,M_lim,K_lim,(3*L_DIMS-3));
 #else
-					litefile << std::to_string(0.0) << "\t";
-#endif
-#if (L_DIMS == 3)
-					litefile << uiuj_timeav(i,j,k,3,M_lim,K_lim,(3*L_DIMS-3)) << "\t";
-					litefile << uiuj_timeav(i,j,k,4,M_lim,K_lim,(3*L_DIMS-3)) << "\t";
-					litefile << uiuj_timeav(i,j,k,5,M_lim,K_lim,(3*L_DIMS-3)) << "\t";
-#else
-					litefile << uiuj_timeav(i,j,k,2,M_lim,K_lim,(3*L_DIMS-3)) << "\t";
-					litefile << std::to_string(0.0) << "\t" << std::to_string(0.0) << "\t";
+					row[n++] = 0.0;
+					row[n++] = uiuj_timeav(i,j,k,2,M_lim,K_lim,(3*L_DIMS-3));
+					row[n++] = 0.0;
+					row[n++] = 0.0;
 #endif
 
 #endif // L_COMPUTE_TIME_AVERAGED_QUANTITIES
 
-					// New line
-					litefile << std::endl;
+					int32_t type = static_cast<int32_t>(LatTyp(i,j,k,M_lim,K_lim));
 
+#ifdef L_IO_LITE_BINARY
+					// Fixed-width record
+					int32_t rnk = rank;
+					litefile.write(reinterpret_cast<const char*>(&rnk), sizeof(int32_t));
+					litefile.write(reinterpret_cast<const char*>(&type), sizeof(int32_t));
+					litefile.write(reinterpret_cast<const char*>(row.data()), nValues * sizeof(double));
+					nRecords++;
+#else
+					// Tab separated row (no flush)
+					litefile << rank << "\t" << type << "\t";
+					for (n = 0; n < nValues; n++) {
+						litefile << row[n] << "\t";
+					}
+					litefile << '\n';
+#endif
 
 				}
 
@@ -800,6 +1052,13 @@ void GridObj::io_lite(double tval, std::string TAG) {
 		}
 	}
 
+#ifdef L_IO_LITE_BINARY
+	// Fill in the number of records
+	litefile.seekp(countPos);
+	litefile.write(reinterpret_cast<const char*>(&nRecords), sizeof(int64_t));
+#endif
+	litefile.close();
+
 	// Now do any sub-grids
 	if (L_NUM_LEVELS > level) {
 		for (size_t reg = 0; reg < subGrid.size(); reg++) {
@@ -941,8 +1200,27 @@ int GridObj::io_hdf5(double tval)
 
 #endif // L_BUILD_FOR_MPI
 
+		// A block created by a regrid has no file yet
+		bool bCreate = (t == 0);
+#ifdef L_BLOCK_AMR
+		if (!bCreate)
+		{
+			int bExists = 0;
+#ifdef L_BUILD_FOR_MPI
+			MPI_Comm comm = (level == 0) ? mpim->world_comm : mpim->subGrid_comm[(level - 1) + region_number * L_NUM_LEVELS];
+			int commRank;
+			MPI_Comm_rank(comm, &commRank);
+			if (commRank == 0) bExists = std::ifstream(FILE_NAME.c_str()).good();
+			MPI_Bcast(&bExists, 1, MPI_INT, 0, comm);
+#else
+			bExists = std::ifstream(FILE_NAME.c_str()).good();
+#endif
+			bCreate = !bExists;
+		}
+#endif
+
 		// Create/open file using the property list defined above
-		if (t == 0) file_id = H5Fcreate(FILE_NAME.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, plist_id);
+		if (bCreate) file_id = H5Fcreate(FILE_NAME.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, plist_id);
 		else file_id = H5Fopen(FILE_NAME.c_str(), H5F_ACC_RDWR, plist_id);
 		if (file_id == static_cast<hid_t>(NULL)) *GridUtils::logfile << "HDF5 ERROR: Open file failed!" << std::endl;
 		status = H5Pclose(plist_id);	 // Close access to property list now we have finished with it
@@ -1031,7 +1309,7 @@ int GridObj::io_hdf5(double tval)
 		/***** ATTRIBUTES ******/
 		/***********************/
 
-		if (t == 0)
+		if (bCreate)
 		{
 
 			// Create 1D attribute buffers
@@ -1081,6 +1359,14 @@ int GridObj::io_hdf5(double tval)
 			status = H5Aclose(attrib_id);
 			if (status != 0) *GridUtils::logfile << "HDF5 ERROR: Attribute close failed: " << status << std::endl;
 
+			// Write dt
+			buffer_double = dt;
+			attrib_id = H5Acreate(file_id, "Dt", H5T_NATIVE_DOUBLE, attspace, H5P_DEFAULT, H5P_DEFAULT);
+			status = H5Awrite(attrib_id, H5T_NATIVE_DOUBLE, &buffer_double);
+			if (status != 0) *GridUtils::logfile << "HDF5 ERROR: Attribute write failed: " << status << std::endl;
+			status = H5Aclose(attrib_id);
+			if (status != 0) *GridUtils::logfile << "HDF5 ERROR: Attribute close failed: " << status << std::endl;
+
 			// Write Levels
 			buffer_int = L_NUM_LEVELS + 1;
 			attrib_id = H5Acreate(file_id, "NumberOfGrids", H5T_NATIVE_INT, attspace, H5P_DEFAULT, H5P_DEFAULT);
@@ -1120,6 +1406,25 @@ int GridObj::io_hdf5(double tval)
 			if (status != 0) *GridUtils::logfile << "HDF5 ERROR: Attribute space close failed: " << status << std::endl;
 
 		}
+		else if (bMeshChanged)
+		{
+			// Grid has been regridded so record its new size on this time step
+			int buffer_int_array[L_DIMS];
+			buffer_int_array[0] = static_cast<int>(dimsf[0]);
+			buffer_int_array[1] = static_cast<int>(dimsf[1]);
+#if (L_DIMS == 3)
+			buffer_int_array[2] = static_cast<int>(dimsf[2]);
+#endif
+			dimsa[0] = L_DIMS;
+			attspace = H5Screate_simple(1, dimsa, NULL);
+			attrib_id = H5Acreate(group_id, "GridSize", H5T_NATIVE_INT, attspace, H5P_DEFAULT, H5P_DEFAULT);
+			status = H5Awrite(attrib_id, H5T_NATIVE_INT, &buffer_int_array[0]);
+			if (status != 0) *GridUtils::logfile << "HDF5 ERROR: Attribute write failed: " << status << std::endl;
+			status = H5Aclose(attrib_id);
+			if (status != 0) *GridUtils::logfile << "HDF5 ERROR: Attribute close failed: " << status << std::endl;
+			status = H5Sclose(attspace);
+			if (status != 0) *GridUtils::logfile << "HDF5 ERROR: Attribute space close failed: " << status << std::endl;
+		}
 
 
 
@@ -1130,7 +1435,7 @@ int GridObj::io_hdf5(double tval)
 		// WRITE LATTYP
 		variable_name = time_string + "/LatTyp";
 		dataset_id = H5Dcreate(file_id, variable_name.c_str(), H5T_NATIVE_INT, filespace, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-		hdf5_writeDataSet(memspace, filespace, dataset_id, eScalar, this, &LatTyp[0], H5T_NATIVE_INT, TL_present, TL_thickness, &minEdges[0], p_data);
+		hdf5_writeDataSet(memspace, filespace, dataset_id, eScalar, this, &LatTyp[0], H5T_NATIVE_UCHAR, TL_present, TL_thickness, &minEdges[0], p_data);
 		status = H5Dclose(dataset_id); // Close dataset
 		if (status != 0) *GridUtils::logfile << "HDF5 ERROR: Close dataset failed: " << status << std::endl;
 
@@ -1158,6 +1463,8 @@ int GridObj::io_hdf5(double tval)
 		/******* VECTORS *******/
 		/***********************/
 
+#ifndef L_HDF5_NO_VELOCITY
+
 		// WRITE UX
 		variable_name = time_string + "/Ux";
 		dataset_id = H5Dcreate(file_id, variable_name.c_str(), H5T_NATIVE_DOUBLE, filespace, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
@@ -1181,6 +1488,32 @@ int GridObj::io_hdf5(double tval)
 		if (status != 0) *GridUtils::logfile << "HDF5 ERROR: Close dataset failed: " << status << std::endl;
 #endif
 
+#endif // L_HDF5_NO_VELOCITY
+
+#ifdef L_HDF5_DERIVED
+
+		/***********************/
+		/******* DERIVED *******/
+		/***********************/
+
+		// Computed from the current fields on output steps only
+		{
+			std::vector<double> derived[eDerivedFields];
+			_io_computeDerived(derived);
+			const char *derivedNames[eDerivedFields] = { "/VortX", "/VortY", "/VortZ", "/QCriterion", "/StrainRate", "/WallShearStress" };
+			for (int df = 0; df < eDerivedFields; df++)
+			{
+				if (derived[df].empty()) continue;	// In-plane vorticity in 2D
+				variable_name = time_string + derivedNames[df];
+				dataset_id = H5Dcreate(file_id, variable_name.c_str(), H5T_NATIVE_DOUBLE, filespace, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+				hdf5_writeDataSet(memspace, filespace, dataset_id, eScalar, this, &derived[df][0], H5T_NATIVE_DOUBLE, TL_present, TL_thickness, &minEdges[0], p_data);
+				status = H5Dclose(dataset_id); // Close dataset
+				if (status != 0) *GridUtils::logfile << "HDF5 ERROR: Close dataset failed: " << status << std::endl;
+			}
+		}
+
+#endif // L_HDF5_DERIVED
+
 #ifdef L_COMPUTE_TIME_AVERAGED_QUANTITIES
 
 		// WRITE UX_TIMEAV
@@ -1261,8 +1594,8 @@ int GridObj::io_hdf5(double tval)
 
 #endif // L_COMPUTE_TIME_AVERAGED_QUANTITIES
 
-		// Only write positions and block labels on first time step as these don't change
-		if (t == 0)
+		// Only write positions and block labels on first time step or when the grid has changed
+		if (bCreate || bMeshChanged)
 		{
 
 			/***********************/
@@ -1308,6 +1641,7 @@ int GridObj::io_hdf5(double tval)
 			if (status != 0) *GridUtils::logfile << "HDF5 ERROR: Close dataset failed: " << status << std::endl;
 #endif
 
+			bMeshChanged = false;
 		}
 
 #ifdef L_BUILD_FOR_MPI
@@ -1371,5 +1705,359 @@ int GridObj::io_hdf5(double tval)
 	return 0;
 
 }
+
+// ***************************************************************************//
+/// \brief	Computes the derived fields written by io_hdf5.
+///
+///			Vorticity and the Q-criterion come from central differences of the
+///			velocity (one-sided next to solid sites and at the grid edges). The
+///			strain rate comes from the non-equilibrium moments of the populations
+///			on fluid sites when LBGK collision is used and from the velocity
+///			gradient otherwise, as the Smagorinsky and KBC operators relax with
+///			a local rate which is not stored. The wall shear stress is the
+///			tangential part of the viscous traction on fluid sites next to solid
+///			sites, with the wall normal taken from the lattice directions which
+///			point into the solid, and is zero elsewhere. All fields are in
+///			dimensionless units. In MPI builds the velocity on the receiver
+///			layer is recomputed from the received populations since only the
+///			populations are exchanged.
+///
+///	\param	fields	array of eDerivedFields vectors which are sized and filled
+///					here (in-plane vorticity is left empty in 2D).
+void GridObj::_io_computeDerived(std::vector<double> *fields)
+{
+	const int numSites = N_lim * M_lim * K_lim;
+	for (int df = 0; df < eDerivedFields; df++)
+	{
+		if (L_DIMS == 2 && (df == eDerivedVortX || df == eDerivedVortY)) continue;
+		fields[df].assign(numSites, 0.0);
+	}
+
+	// Velocity used for the gradients
+	std::vector<double> vel(u.begin(), u.end());
+#ifdef L_BUILD_FOR_MPI
+	for (int i = 0; i < N_lim; i++)
+	{
+		for (int j = 0; j < M_lim; j++)
+		{
+			for (int k = 0; k < K_lim; k++)
+			{
+				int id = k + j * K_lim + i * K_lim * M_lim;
+				if (LatTyp[id] == eSolid || !GridUtils::isOnRecvLayer(XPos[i], YPos[j], ZPos[k])) continue;
+
+				double rhoSite = 0.0;
+				double mom[3] = { 0.0, 0.0, 0.0 };
+				for (int v = 0; v < L_NUM_VELS; v++)
+				{
+					double fv = L_POP_GET(f[popIdx(id, v)], v);
+					rhoSite += fv;
+					for (int d = 0; d < L_DIMS; d++) mom[d] += c_opt[v][d] * fv;
+				}
+				for (int d = 0; d < L_DIMS; d++) vel[d + id * L_DIMS] = mom[d] / rhoSite;
+			}
+		}
+	}
+#endif
+
+	// Constants
+	const int lims[3] = { N_lim, M_lim, K_lim };
+	const int strides[3] = { M_lim * K_lim, K_lim, 1 };
+	const bool bNonEq = (RuntimeParams::collisionModel == eBGK && std::fabs(1.0 - omega) > 1e-3);
+	const double nuDimless = SQ(cs) * (1.0 / omega - 0.5) * SQ(dh) / dt;
+
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
+#endif
+	for (int i = 0; i < N_lim; i++)
+	{
+		for (int j = 0; j < M_lim; j++)
+		{
+			for (int k = 0; k < K_lim; k++)
+			{
+				int id = k + j * K_lim + i * K_lim * M_lim;
+				if (LatTyp[id] == eSolid) continue;
+				const int ijk[3] = { i, j, k };
+
+				// Velocity gradient G[a][b] = du_a / dx_b in lattice units
+				double G[3][3] = { { 0.0 } };
+				for (int b = 0; b < L_DIMS; b++)
+				{
+					int idM = (ijk[b] > 0 && LatTyp[id - strides[b]] != eSolid) ? id - strides[b] : -1;
+					int idP = (ijk[b] < lims[b] - 1 && LatTyp[id + strides[b]] != eSolid) ? id + strides[b] : -1;
+					if (idM < 0 && idP < 0) continue;
+					double h = (idM >= 0 && idP >= 0) ? 2.0 : 1.0;
+					if (idM < 0) idM = id;
+					if (idP < 0) idP = id;
+					for (int a = 0; a < L_DIMS; a++)
+						G[a][b] = (vel[a + idP * L_DIMS] - vel[a + idM * L_DIMS]) / h;
+				}
+
+				// Strain and rotation rates
+				double S[3][3] = { { 0.0 } };
+				double SS = 0.0;
+				double OO = 0.0;
+				for (int a = 0; a < L_DIMS; a++)
+				{
+					for (int b = 0; b < L_DIMS; b++)
+					{
+						S[a][b] = 0.5 * (G[a][b] + G[b][a]);
+						SS += SQ(S[a][b]);
+						OO += SQ(0.5 * (G[a][b] - G[b][a]));
+					}
+				}
+
+				// Vorticity and Q-criterion
+#if (L_DIMS == 3)
+				fields[eDerivedVortX][id] = (G[2][1] - G[1][2]) / dt;
+				fields[eDerivedVortY][id] = (G[0][2] - G[2][0]) / dt;
+#endif
+				fields[eDerivedVortZ][id] = (G[1][0] - G[0][1]) / dt;
+				fields[eDerivedQ][id] = 0.5 * (OO - SS) / SQ(dt);
+
+				// Strain rate from the non-equilibrium moments (the non-equilibrium
+				// part of the post-collision populations is (1 - omega) times that
+				// of the pre-collision populations the velocity was computed from)
+				if (bNonEq && LatTyp[id] == eFluid)
+				{
+					double Pi[3][3] = { { 0.0 } };
+					for (int v = 0; v < L_NUM_VELS; v++)
+					{
+						double fneq = L_POP_GET(f[popIdx(id, v)], v) - _LBM_equilibrium_opt(id, v);
+						for (int a = 0; a < L_DIMS; a++)
+							for (int b = 0; b < L_DIMS; b++)
+								Pi[a][b] += c_opt[v][a] * c_opt[v][b] * fneq;
+					}
+					double coeff = -omega / (2.0 * rho[id] * SQ(cs) * (1.0 - omega));
+					SS = 0.0;
+					for (int a = 0; a < L_DIMS; a++)
+					{
+						for (int b = 0; b < L_DIMS; b++)
+						{
+							S[a][b] = coeff * Pi[a][b];
+							SS += SQ(S[a][b]);
+						}
+					}
+				}
+				fields[eDerivedStrainRate][id] = sqrt(2.0 * SS) / dt;
+
+				// Wall normal pointing into the fluid from any solid neighbours
+				double n[3] = { 0.0, 0.0, 0.0 };
+				bool bWall = false;
+				for (int v = 0; v < L_NUM_VELS; v++)
+				{
+					int ni = i + c_opt[v][0];
+					int nj = j + c_opt[v][1];
+					int nk = k + c_opt[v][2];
+					if (ni < 0 || ni >= N_lim || nj < 0 || nj >= M_lim || nk < 0 || nk >= K_lim) continue;
+					if (LatTyp(ni, nj, nk, M_lim, K_lim) != eSolid) continue;
+					for (int d = 0; d < L_DIMS; d++) n[d] -= c_opt[v][d];
+					bWall = true;
+				}
+				double nNorm = sqrt(SQ(n[0]) + SQ(n[1]) + SQ(n[2]));
+				if (!bWall || nNorm == 0.0) continue;
+				for (int d = 0; d < L_DIMS; d++) n[d] /= nNorm;
+
+				// Tangential part of the viscous traction
+				double traction[3] = { 0.0, 0.0, 0.0 };
+				double tn = 0.0;
+				for (int a = 0; a < L_DIMS; a++)
+				{
+					for (int b = 0; b < L_DIMS; b++)
+						traction[a] += 2.0 * rho[id] * nuDimless * S[a][b] / dt * n[b];
+					tn += traction[a] * n[a];
+				}
+				double wss = 0.0;
+				for (int a = 0; a < L_DIMS; a++) wss += SQ(traction[a] - tn * n[a]);
+				fields[eDerivedWallShear][id] = sqrt(wss);
+			}
+		}
+	}
+}
+
+// ***************************************************************************//
+/// \brief	Initialises the velocity on this grid from an HDF5 file.
+///
+///			Reads L_INIT_VELOCITY_HDF5_FILE, a file in the layout written by
+///			io_hdf5() such as hdf_R0N0.h5 of a coarser precursor run, at time
+///			L_INIT_VELOCITY_HDF5_TIME (the last time in the file if negative).
+///			Each rank opens the file for reading independently and reads only
+///			the block of the file bracketing its own sites on this grid. The
+///			block is interpolated trilinearly onto the sites so the file may
+///			have any resolution and this grid may be any level or region.
+///			Sites beyond the extent of the file take the value at the nearest
+///			file site. Solid sites start at rest and velocity boundary sites
+///			take the inlet profile as they would without the file.
+void GridObj::io_hdf5InitVelocity()
+{
+	const std::string fileName(L_INIT_VELOCITY_HDF5_FILE);
+	L_INFO("Loading initial velocity on L" + std::to_string(level) + " R" + std::to_string(region_number) +
+		" from " + fileName + "...", GridUtils::logfile);
+
+	// Turn auto error printing off
+	H5Eset_auto(H5E_DEFAULT, NULL, NULL);
+
+	// Open read only on this rank alone
+	hid_t file_id = H5Fopen(fileName.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+	if (file_id < 0) L_ERROR("Cannot open initial velocity file " + fileName + ". Exiting.", GridUtils::logfile);
+
+	// Size and spacing of the grid in the file
+	int fileDims = 0;
+	int fileSize[L_DIMS];
+	double fileDx = 0.0;
+	double fileDt = 0.0;
+	hid_t attrib_id = H5Aopen(file_id, "Dimensions", H5P_DEFAULT);
+	if (attrib_id >= 0) { H5Aread(attrib_id, H5T_NATIVE_INT, &fileDims); H5Aclose(attrib_id); }
+	if (fileDims != L_DIMS)
+		L_ERROR("Initial velocity file " + fileName + " has " + std::to_string(fileDims) + " dimensions but the simulation has " +
+			std::to_string(L_DIMS) + ". Exiting.", GridUtils::logfile);
+	attrib_id = H5Aopen(file_id, "GridSize", H5P_DEFAULT);
+	H5Aread(attrib_id, H5T_NATIVE_INT, &fileSize[0]);
+	H5Aclose(attrib_id);
+	attrib_id = H5Aopen(file_id, "Dx", H5P_DEFAULT);
+	H5Aread(attrib_id, H5T_NATIVE_DOUBLE, &fileDx);
+	H5Aclose(attrib_id);
+	if (H5Aexists(file_id, "Dt") > 0)
+	{
+		attrib_id = H5Aopen(file_id, "Dt", H5P_DEFAULT);
+		H5Aread(attrib_id, H5T_NATIVE_DOUBLE, &fileDt);
+		H5Aclose(attrib_id);
+	}
+	else
+	{
+		// Older files: assume the same ratio of time step to spacing as this run
+		fileDt = fileDx * L_TIMESTEP / L_COARSE_SITE_WIDTH;
+		L_WARN("Initial velocity file has no Dt attribute. Assuming its time step scales with Dx as in this simulation.", GridUtils::logfile);
+	}
+
+	// Time to read
+	int fileTime = L_INIT_VELOCITY_HDF5_TIME;
+	if (fileTime < 0) H5Literate(file_id, H5_INDEX_NAME, H5_ITER_NATIVE, NULL, hdf5_findLastTime, &fileTime);
+	const std::string time_string("/Time_" + std::to_string(fileTime));
+	if (fileTime < 0 || H5Lexists(file_id, time_string.c_str(), H5P_DEFAULT) <= 0)
+		L_ERROR("Initial velocity file " + fileName + " has no data for the requested time. Exiting.", GridUtils::logfile);
+
+	// Position of the first site in the file (positions are only written at t = 0)
+	hsize_t offset[L_DIMS];
+	hsize_t count[L_DIMS];
+	double fileOrigin[L_DIMS];
+	const char *posNames[3] = { "/Time_0/XPos", "/Time_0/YPos", "/Time_0/ZPos" };
+	for (int d = 0; d < L_DIMS; d++)
+	{
+		offset[d] = 0;
+		count[d] = 1;
+	}
+	for (int d = 0; d < L_DIMS; d++)
+	{
+		if (H5Lexists(file_id, "/Time_0", H5P_DEFAULT) <= 0 || H5Lexists(file_id, posNames[d], H5P_DEFAULT) <= 0 ||
+			!hdf5_readBlock(file_id, posNames[d], offset, count, &fileOrigin[d]))
+		{
+			// Coarsest grid starting at the domain origin
+			fileOrigin[d] = fileDx / 2.0;
+		}
+	}
+
+	// Bracketing file sites and weights for each site on this grid
+	const std::vector<double> *pos[3] = { &XPos, &YPos, &ZPos };
+	const int lims[3] = { N_lim, M_lim, K_lim };
+	std::vector<int> lo[L_DIMS], hi[L_DIMS];
+	std::vector<double> w[L_DIMS];
+	for (int d = 0; d < L_DIMS; d++)
+	{
+		int last = fileSize[d] - 1;
+		int minIdx = last, maxIdx = 0;
+		lo[d].resize(lims[d]);
+		hi[d].resize(lims[d]);
+		w[d].resize(lims[d]);
+		for (int n = 0; n < lims[d]; n++)
+		{
+			double s = ((*pos[d])[n] - fileOrigin[d]) / fileDx;
+			s = std::min(std::max(s, 0.0), static_cast<double>(last));
+			lo[d][n] = std::min(static_cast<int>(s), std::max(last - 1, 0));
+			hi[d][n] = std::min(lo[d][n] + 1, last);
+			w[d][n] = s - lo[d][n];
+			minIdx = std::min(minIdx, lo[d][n]);
+			maxIdx = std::max(maxIdx, hi[d][n]);
+		}
+
+		// Only the block covering this rank is read
+		offset[d] = minIdx;
+		count[d] = maxIdx - minIdx + 1;
+		for (int n = 0; n < lims[d]; n++)
+		{
+			lo[d][n] -= minIdx;
+			hi[d][n] -= minIdx;
+		}
+	}
+	const size_t blockSize = std::accumulate(count, count + L_DIMS, static_cast<size_t>(1), std::multiplies<size_t>());
+
+	// Read the velocity components and convert from the lattice units of the file to those of this grid
+	const char *velNames[3] = { "/Ux", "/Uy", "/Uz" };
+	std::vector<double> block[L_DIMS];
+	for (int d = 0; d < L_DIMS; d++)
+	{
+		block[d].resize(blockSize);
+		if (!hdf5_readBlock(file_id, time_string + velNames[d], offset, count, block[d].data()))
+			L_ERROR("Cannot read " + time_string + velNames[d] + " from initial velocity file " + fileName + ". Exiting.", GridUtils::logfile);
+	}
+	H5Fclose(file_id);
+	const double scale = (fileDx / fileDt) * (dt / dh);
+	const size_t strideY = (L_DIMS == 3) ? count[L_DIMS - 1] : 1;
+	const size_t strideX = strideY * count[1];
+
+	// If doing a ramp velocity then boundary velocity should be set to ramp at t = 0
+	double rampCoefficient = GridUtils::getVelocityRampCoefficient(0.0);
+
+	// Interpolate onto the grid
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
+#endif
+	for (int i = 0; i < N_lim; i++)
+	{
+		for (int j = 0; j < M_lim; j++)
+		{
+			for (int k = 0; k < K_lim; k++)
+			{
+				if (LatTyp(i, j, k, M_lim, K_lim) == eSolid)
+				{
+					for (int d = 0; d < L_DIMS; d++) u(i, j, k, d, M_lim, K_lim, L_DIMS) = 0.0;
+					continue;
+				}
+
+				if (LatTyp(i, j, k, M_lim, K_lim) == eVelocity)
+				{
+					u(i, j, k, eXDirection, M_lim, K_lim, L_DIMS) = ux_in[j] * rampCoefficient;
+					u(i, j, k, eYDirection, M_lim, K_lim, L_DIMS) = uy_in[j] * rampCoefficient;
+#if (L_DIMS == 3)
+					u(i, j, k, eZDirection, M_lim, K_lim, L_DIMS) = uz_in[j] * rampCoefficient;
+#endif
+					continue;
+				}
+
+				// Corners of the enclosing file cell and their weights
+				size_t x[2] = { lo[0][i] * strideX, hi[0][i] * strideX };
+				size_t y[2] = { lo[1][j] * strideY, hi[1][j] * strideY };
+				double wx[2] = { 1.0 - w[0][i], w[0][i] };
+				double wy[2] = { 1.0 - w[1][j], w[1][j] };
+#if (L_DIMS == 3)
+				size_t z[2] = { static_cast<size_t>(lo[2][k]), static_cast<size_t>(hi[2][k]) };
+				double wz[2] = { 1.0 - w[2][k], w[2][k] };
+#else
+				size_t z[2] = { 0, 0 };
+				double wz[2] = { 1.0, 0.0 };
+#endif
+
+				for (int d = 0; d < L_DIMS; d++)
+				{
+					double val = 0.0;
+					for (int a = 0; a < 2; a++)
+						for (int b = 0; b < 2; b++)
+							for (int c = 0; c < 2; c++)
+								val += wx[a] * wy[b] * wz[c] * block[d][x[a] + y[b] + z[c]];
+					u(i, j, k, d, M_lim, K_lim, L_DIMS) = val * scale;
+				}
+			}
+		}
+	}
+}
 // ***************************************************************************//
 
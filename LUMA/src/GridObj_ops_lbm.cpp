@@ -41,10 +41,10 @@ using namespace std;
 /// \param j		j-index of lattice site.
 /// \param k		k-index of lattice site.
 /// \param f_new	reference to the temporary, post-collision grid.
-void GridObj::LBM_kbcCollide( int i, int j, int k, IVector<double>& f_new ) {
+void GridObj::LBM_kbcCollide( int i, int j, int k, IVector<popType>& f_new ) {
 	
 	// Declarations
-	double ds[L_NUM_VELS], dh[L_NUM_VELS], gamma;
+	double ds[L_NUM_VELS], dh[L_NUM_VELS], feq[L_NUM_VELS], gamma;
 
 	// Compute required moments and equilibrium moments
 #if (L_DIMS == 3)
@@ -71,36 +71,36 @@ void GridObj::LBM_kbcCollide( int i, int j, int k, IVector<double>& f_new ) {
 	for (int v = 0; v < L_NUM_VELS; v++) {
 		
 		// Update feq
-		feq(i,j,k,v,M_lim,K_lim,L_NUM_VELS) = _LBM_equilibrium_opt(k + j * K_lim + i * K_lim * M_lim, v);
+		feq[v] = _LBM_equilibrium_opt(k + j * K_lim + i * K_lim * M_lim, v);
 
 		// These are actually rho * MXXX but no point in dividing to multiply later
-		M200 += f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[0][v] * c[0][v]);
-		M020 += f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[1][v] * c[1][v]);
-		M002 += f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[2][v] * c[2][v]);
-		M110 += f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[0][v] * c[1][v]);
-		M101 += f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[0][v] * c[2][v]);
-		M011 += f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[1][v] * c[2][v]);
-		M111 += f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[0][v] * c[1][v] * c[2][v]);
-		M102 += f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[0][v] * c[2][v] * c[2][v]);
-		M210 += f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[0][v] * c[0][v] * c[1][v]);
-		M021 += f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[1][v] * c[1][v] * c[2][v]);
-		M201 += f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[0][v] * c[0][v] * c[2][v]);
-		M120 += f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[0][v] * c[1][v] * c[1][v]);
-		M012 += f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[1][v] * c[2][v] * c[2][v]);
-
-		M200eq += feq(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[0][v] * c[0][v]);
-		M020eq += feq(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[1][v] * c[1][v]);
-		M002eq += feq(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[2][v] * c[2][v]);
-		M110eq += feq(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[0][v] * c[1][v]);
-		M101eq += feq(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[0][v] * c[2][v]);
-		M011eq += feq(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[1][v] * c[2][v]);
-		M111eq += feq(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[0][v] * c[1][v] * c[2][v]);
-		M102eq += feq(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[0][v] * c[2][v] * c[2][v]);
-		M210eq += feq(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[0][v] * c[0][v] * c[1][v]);
-		M021eq += feq(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[1][v] * c[1][v] * c[2][v]);
-		M201eq += feq(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[0][v] * c[0][v] * c[2][v]);
-		M120eq += feq(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[0][v] * c[1][v] * c[1][v]);
-		M012eq += feq(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[1][v] * c[2][v] * c[2][v]);
+		M200 += L_POP_GET(f[popIdx(i, j, k, v)], v) * (c[0][v] * c[0][v]);
+		M020 += L_POP_GET(f[popIdx(i, j, k, v)], v) * (c[1][v] * c[1][v]);
+		M002 += L_POP_GET(f[popIdx(i, j, k, v)], v) * (c[2][v] * c[2][v]);
+		M110 += L_POP_GET(f[popIdx(i, j, k, v)], v) * (c[0][v] * c[1][v]);
+		M101 += L_POP_GET(f[popIdx(i, j, k, v)], v) * (c[0][v] * c[2][v]);
+		M011 += L_POP_GET(f[popIdx(i, j, k, v)], v) * (c[1][v] * c[2][v]);
+		M111 += L_POP_GET(f[popIdx(i, j, k, v)], v) * (c[0][v] * c[1][v] * c[2][v]);
+		M102 += L_POP_GET(f[popIdx(i, j, k, v)], v) * (c[0][v] * c[2][v] * c[2][v]);
+		M210 += L_POP_GET(f[popIdx(i, j, k, v)], v) * (c[0][v] * c[0][v] * c[1][v]);
+		M021 += L_POP_GET(f[popIdx(i, j, k, v)], v) * (c[1][v] * c[1][v] * c[2][v]);
+		M201 += L_POP_GET(f[popIdx(i, j, k, v)], v) * (c[0][v] * c[0][v] * c[2][v]);
+		M120 += L_POP_GET(f[popIdx(i, j, k, v)], v) * (c[0][v] * c[1][v] * c[1][v]);
+		M012 += L_POP_GET(f[popIdx(i, j, k, v)], v) * (c[1][v] * c[2][v] * c[2][v]);
+
+		M200eq += feq[v] * (c[0][v] * c[0][v]);
+		M020eq += feq[v] * (c[1][v] * c[1][v]);
+		M002eq += feq[v] * (c[2][v] * c[2][v]);
+		M110eq += feq[v] * (c[0][v] * c[1][v]);
+		M101eq += feq[v] * (c[0][v] * c[2][v]);
+		M011eq += feq[v] * (c[1][v] * c[2][v]);
+		M111eq += feq[v] * (c[0][v] * c[1][v] * c[2][v]);
+		M102eq += feq[v] * (c[0][v] * c[2][v] * c[2][v]);
+		M210eq += feq[v] * (c[0][v] * c[0][v] * c[1][v]);
+		M021eq += feq[v] * (c[1][v] * c[1][v] * c[2][v]);
+		M201eq += feq[v] * (c[0][v] * c[0][v] * c[2][v]);
+		M120eq += feq[v] * (c[0][v] * c[1][v] * c[1][v]);
+		M012eq += feq[v] * (c[1][v] * c[2][v] * c[2][v]);
 	}
 
 	// Compute ds
@@ -159,7 +159,7 @@ void GridObj::LBM_kbcCollide( int i, int j, int k, IVector<double>& f_new ) {
 
 
 		// Compute dh
-		dh[v] = f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) - feq(i,j,k,v,M_lim,K_lim,L_NUM_VELS) - ds[v];
+		dh[v] = L_POP_GET(f[popIdx(i, j, k, v)], v) - feq[v] - ds[v];
 
 	}
 
@@ -175,16 +175,16 @@ void GridObj::LBM_kbcCollide( int i, int j, int k, IVector<double>& f_new ) {
 	for (int v = 0; v < L_NUM_VELS; v++) {
 		
 		// Update feq
-		feq(i, j, k, v, M_lim, K_lim, L_NUM_VELS) = _LBM_equilibrium_opt(k + j * K_lim + i * M_lim * K_lim, v);
+		feq[v] = _LBM_equilibrium_opt(k + j * K_lim + i * M_lim * K_lim, v);
 		
 		// These are actually rho * MXX but no point in dividing to multiply later
-		M20 += f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[0][v] * c[0][v]);
-		M02 += f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[1][v] * c[1][v]);
-		M11 += f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[0][v] * c[1][v]);
+		M20 += L_POP_GET(f[popIdx(i, j, k, v)], v) * (c[0][v] * c[0][v]);
+		M02 += L_POP_GET(f[popIdx(i, j, k, v)], v) * (c[1][v] * c[1][v]);
+		M11 += L_POP_GET(f[popIdx(i, j, k, v)], v) * (c[0][v] * c[1][v]);
 
-		M20eq += feq(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[0][v] * c[0][v]);
-		M02eq += feq(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[1][v] * c[1][v]);
-		M11eq += feq(i,j,k,v,M_lim,K_lim,L_NUM_VELS) * (c[0][v] * c[1][v]);
+		M20eq += feq[v] * (c[0][v] * c[0][v]);
+		M02eq += feq[v] * (c[1][v] * c[1][v]);
+		M11eq += feq[v] * (c[0][v] * c[1][v]);
 	}
 
 	// Compute ds
@@ -218,7 +218,7 @@ void GridObj::LBM_kbcCollide( int i, int j, int k, IVector<double>& f_new ) {
 
 
 		// Compute dh
-		dh[v] = f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) - feq(i,j,k,v,M_lim,K_lim,L_NUM_VELS) - ds[v];
+		dh[v] = L_POP_GET(f[popIdx(i, j, k, v)], v) - feq[v] - ds[v];
 
 	}
 
@@ -229,8 +229,8 @@ void GridObj::LBM_kbcCollide( int i, int j, int k, IVector<double>& f_new ) {
 	for (int v = 0; v < L_NUM_VELS; v++) {
 
 		// Compute scalar products
-		top_prod += ds[v] * dh[v] / feq(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
-		bot_prod += dh[v] * dh[v] / feq(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+		top_prod += ds[v] * dh[v] / feq[v];
+		bot_prod += dh[v] * dh[v] / feq[v];
 
 	}
 	
@@ -238,16 +238,21 @@ void GridObj::LBM_kbcCollide( int i, int j, int k, IVector<double>& f_new ) {
 	if (bot_prod == 0.0) gamma = (2/omega);
 	else gamma = (2/omega) - ( 2 - (2/omega) ) * (top_prod / bot_prod);
 
+#if (defined L_GRAVITY_ON || defined L_IBM_ON)
+	// Do not force solid sites
+	bool bForced = (LatTyp(i, j, k, M_lim, K_lim) != eSolid);
+#endif
+
 	// Finally perform collision
 	for (int v = 0; v < L_NUM_VELS; v++) {
 
 		// Perform collision
-		f_new(i, j, k, v, M_lim, K_lim, L_NUM_VELS) =
-			f(i, j, k, v, M_lim, K_lim, L_NUM_VELS) -
+		f_new[popIdx(i, j, k, v)] =
+			f[popIdx(i, j, k, v)] -
 			(omega / 2) * (2 * ds[v] + gamma * dh[v])
 
 #if (defined L_GRAVITY_ON || defined L_IBM_ON)
-			+ force_i(i,j,k,v,M_lim,K_lim,L_NUM_VELS)
+			+ (bForced ? _LBM_forceGrid_opt(k + j * K_lim + i * K_lim * M_lim, v) : 0.0)
 #endif
 			;
 	}
@@ -308,12 +313,12 @@ void GridObj::LBM_macro( int i, int j, int k ) {
 		for (int v = 0; v < L_NUM_VELS; v++) {
 
 			// Sum up to find mass flux
-			fux_temp += (double)c[0][v] * f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
-			fuy_temp += (double)c[1][v] * f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
-			fuz_temp += (double)c[2][v] * f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+			fux_temp += (double)c[0][v] * L_POP_GET(f[popIdx(i, j, k, v)], v);
+			fuy_temp += (double)c[1][v] * L_POP_GET(f[popIdx(i, j, k, v)], v);
+			fuz_temp += (double)c[2][v] * L_POP_GET(f[popIdx(i, j, k, v)], v);
 
 			// Sum up to find density
-			rho_temp += f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+			rho_temp += L_POP_GET(f[popIdx(i, j, k, v)], v);
 
 		}
 
@@ -41,11 +41,12 @@ void GridObj::LBM_multi_opt(int subcycle)
 	_LBM_updateReynolds(static_cast<double>(L_RE) * GridUtils::getReynoldsRampCoefficient((t + 1) * dt));
 #endif
 
-	// Two iterations on sub-grids
+	// Two iterations on sub-grids then coalesce their values onto this grid
 	for (GridObj * sg : subGrid)
 	{
 		for (int i = 0; i < 2; ++i)
 			sg->LBM_multi_opt(i);
+		sg->_LBM_coalesce_opt();
 	}
 
 	// Get object manager instance
@@ -58,13 +59,117 @@ void GridObj::LBM_multi_opt(int subcycle)
 #endif
 
 	// Start the clock to time this kernel
-	clock_t secs, t_start = clock();
+	double t_start = Profiler::now();
 
 #ifdef L_LD_OUT
 	// Reset object forces for momentum exchange force calculation
 	objman->resetMomexBodyForces(this);
 #endif
 
+	// Run the kernel selected for the collision model
+	(this->*_LBM_kernel)(subcycle);
+
+	// Swap distributions
+	f.swap(fNew);
+
+#ifdef L_MOMEX_DEBUG
+	if (level == objman->bbbOnGridLevel && region_number == objman->bbbOnGridReg)
+	{
+		// Close file for momentum exchange information (call before t increments)
+		objman->toggleDebugStream(this);
+	}
+#endif
+
+	// Increment internal loop counter
+	++t;
+
+	// Get time of loop
+	double secs = Profiler::now() - t_start;
+#ifdef L_LOG_TIMINGS
+	Profiler::add(eProfStep, level, region_number, secs);
+#endif
+
+	// Update average timestep time on this grid
+	timeav_timestep *= (t - 1);
+	timeav_timestep += secs;
+	timeav_timestep /= t;
+
+	if (t % L_GRID_OUT_FREQ == 0) {
+		// Performance data to logfile
+		*GridUtils::logfile << "Grid " << level << ": Time stepping taking an average of " << timeav_timestep * 1000 << "ms" << std::endl;
+	}
+
+	// MPI COMMUNICATION //
+#ifdef L_BUILD_FOR_MPI
+
+	// Launch communication on this grid by passing its level and region number
+	MpiManager::getInstance()->mpi_communicate(level, region_number);
+
+#endif
+
+}
+
+
+
+// *****************************************************************************
+/// \brief	Selects the optimised kernel for the collision model.
+///
+///			The kernel is instantiated for each collision model so that the 
+///			choice made at run time does not cost a branch per site.
+void GridObj::_LBM_initKernel_opt()
+{
+	switch (RuntimeParams::collisionModel)
+	{
+	case eBGKSmag:
+		_LBM_kernel = &GridObj::_LBM_kernel_opt<eBGKSmag>;
+		break;
+
+	case eKBC:
+		_LBM_kernel = &GridObj::_LBM_kernel_opt<eKBC>;
+		break;
+
+	default:
+		_LBM_kernel = &GridObj::_LBM_kernel_opt<eBGK>;
+		break;
+	}
+
+#ifdef L_SPARSE_LATTICE
+	// Loop over the stored sites instead
+	switch (RuntimeParams::collisionModel)
+	{
+	case eBGKSmag:
+		_LBM_kernel = &GridObj::_LBM_sparseKernel_opt<eBGKSmag>;
+		break;
+
+	case eKBC:
+		_LBM_kernel = &GridObj::_LBM_sparseKernel_opt<eKBC>;
+		break;
+
+	default:
+		_LBM_kernel = &GridObj::_LBM_sparseKernel_opt<eBGK>;
+		break;
+	}
+#endif
+}
+
+// *****************************************************************************
+/// \brief	Optimised LBM kernel.
+///
+///			Performs stream, macroscopic and collide operations on this grid 
+///			in a single loop.
+///
+///	\tparam	C			collision model.
+///	\param	subcycle	sub-cycle to be performed if called from a subgrid.
+template <eCollisionModel C>
+void GridObj::_LBM_kernel_opt(int subcycle)
+{
+
+	// Get object manager instance
+	ObjectManager *objman = ObjectManager::getInstance();
+
+	// Start timing the loop
+	L_PROF_START(t_lbm);
+
 	// Loop over grid
 #ifdef L_ENABLE_OPENMP
 #pragma omp parallel for
@@ -112,14 +217,14 @@ void GridObj::LBM_multi_opt(int subcycle)
 		}
 	}
 
-	// Set post-LBM macros
-	if (objman->hasFlexibleBodies[level])
-		u_n = u;
+	L_PROF_STOP(t_lbm, eProfStreamMacro, level, region_number);
 
 	// Perform IBM steps (interpolate, force calc, spread and update macro)
 	if (objman->hasIBMBodies[level])
 		objman->ibm_apply(this, true);
 
+	L_PROF_START(t_collide);
+
 
 	// Loop over grid
 	for (int i = 0; i < N_lim; ++i)
@@ -134,65 +239,138 @@ void GridObj::LBM_multi_opt(int subcycle)
 
 #endif
 
-				// FORCING //
-#if (defined L_IBM_ON || defined L_GRAVITY_ON)
-				// Do not force solid sites
-				if (type_local != eSolid)
-					_LBM_forceGrid_opt(id);
-#endif
-				// COLLIDE //
+				// COLLIDE (with fused forcing) //
 				if (type_local != eTransitionToCoarser) // Do not collide on UpperTL
 				{ 
 
-#ifdef L_USE_KBC_COLLISION
-					_LBM_kbcCollide_opt(id);
-#else
-					_LBM_collide_opt(id);
-#endif
+					if (C == eKBC)
+						_LBM_kbcCollide_opt(id);
+					else
+						_LBM_collide_opt<C>(id);
 				}
 
 			}
 		}
 	}
 
-	// Swap distributions
-	f.swap(fNew);
+#ifdef L_IBM_ON
+	L_PROF_STOP(t_collide, eProfCollide, level, region_number);
+#else
+	L_PROF_STOP(t_lbm, eProfLBM, level, region_number);
+#endif
+}
 
-#ifdef L_MOMEX_DEBUG
-	if (level == objman->bbbOnGridLevel && region_number == objman->bbbOnGridReg)
+#ifdef L_SPARSE_LATTICE
+// *****************************************************************************
+/// \brief	Optimised LBM kernel for the sparse lattice.
+///
+///			Performs the same operations as _LBM_kernel_opt() but loops over 
+///			the sites whose populations are stored, which are in the order of 
+///			the dense loop, rather than the whole grid.
+///
+///	\tparam	C			collision model.
+///	\param	subcycle	sub-cycle to be performed if called from a subgrid.
+template <eCollisionModel C>
+void GridObj::_LBM_sparseKernel_opt(int subcycle)
+{
+
+	// Get object manager instance
+	ObjectManager *objman = ObjectManager::getInstance();
+
+	// Start timing the loop
+	L_PROF_START(t_lbm);
+
+	// MOMENTUM EXCHANGE //
+#ifdef L_LD_OUT
+	// Solid sites are not in the loop below
+	for (int i = 0; i < N_lim; ++i)
 	{
-		// Close file for momentum exchange information (call before t increments)
-		objman->toggleDebugStream(this);
+		for (int j = 0; j < M_lim; ++j)
+		{
+			for (int k = 0; k < K_lim; ++k)
+			{
+				if (LatTyp(i, j, k, M_lim, K_lim) == eSolid)
+					objman->computeLiftDrag(i, j, k, this);
+			}
+		}
 	}
 #endif
 
-	// Increment internal loop counter
-	++t;
+	// Loop over stored sites
+	const int nStored = static_cast<int>(sparseSites.size());
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
+#endif
+	for (int s = 0; s < nStored; ++s)
+	{
+		// Local index and type
+		int id = sparseSites[s];
+		eType type_local = LatTyp[id];
 
-	// Get time of loop
-	secs = clock() - t_start;
+		// IGNORE THESE SITES //
+		if (type_local == eRefined
+#ifndef L_REGULARISED_BOUNDARIES
+			|| type_local == eVelocity
+#endif
+			) continue;
 
-	// Update average timestep time on this grid
-	timeav_timestep *= (t - 1);
-	timeav_timestep += ((double)secs) / CLOCKS_PER_SEC;
-	timeav_timestep /= t;
+		// Position of the site
+		int i = id / (K_lim * M_lim);
+		int j = (id / K_lim) % M_lim;
+		int k = id % K_lim;
 
-	if (t % L_GRID_OUT_FREQ == 0) {
-		// Performance data to logfile
-		*GridUtils::logfile << "Grid " << level << ": Time stepping taking an average of " << timeav_timestep * 1000 << "ms" << std::endl;
+		// STREAM //
+		_LBM_stream_opt(i, j, k, id, type_local, subcycle);
+
+		// REGULARISED BCs //
+#ifdef L_REGULARISED_BOUNDARIES
+		if (type_local == eVelocity || type_local == ePressure)
+			_LBM_regularised_opt(i, j, k, id, type_local, subcycle);
+#endif
+
+		// MACROSCOPIC //
+		_LBM_macro_opt(i, j, k, id, type_local);
+
+		// If IBM is on then split loop and perform IBM step
+#ifdef L_IBM_ON
 	}
 
-	// MPI COMMUNICATION //
-#ifdef L_BUILD_FOR_MPI
+	L_PROF_STOP(t_lbm, eProfStreamMacro, level, region_number);
 
-	// Launch communication on this grid by passing its level and region number
-	MpiManager::getInstance()->mpi_communicate(level, region_number);
+	// Perform IBM steps (interpolate, force calc, spread and update macro)
+	if (objman->hasIBMBodies[level])
+		objman->ibm_apply(this, true);
+
+	L_PROF_START(t_collide);
+
+	// Loop over stored sites
+	for (int s = 0; s < nStored; ++s)
+	{
+		// Local index and type
+		int id = sparseSites[s];
+		eType type_local = LatTyp[id];
 
 #endif
 
-}
+		// COLLIDE (with fused forcing) //
+		if (type_local != eTransitionToCoarser) // Do not collide on UpperTL
+		{
 
+			if (C == eKBC)
+				_LBM_kbcCollide_opt(id);
+			else
+				_LBM_collide_opt<C>(id);
+		}
 
+	}
+
+#ifdef L_IBM_ON
+	L_PROF_STOP(t_collide, eProfCollide, level, region_number);
+#else
+	L_PROF_STOP(t_lbm, eProfLBM, level, region_number);
+#endif
+}
+#endif
 
 // *****************************************************************************
 /// \brief	Optimised stream operation.
@@ -209,16 +387,46 @@ void GridObj::_LBM_stream_opt(int i, int j, int k, int id, eType type_local, int
 	// Local value to save multiple loads
 	eType src_type_local;
 
+#ifdef L_STREAM_MASK
+	// Directions which need the source label (all of them on BFL and slip sites)
+	unsigned int mask = (type_local == eBFL || type_local == eSlip) ? ~0u : streamMask[id];
+#endif
+
+#ifdef L_SPARSE_LATTICE
+	// Neighbour table entries of this site
+	const int *src_f = &sparseSrc[popIdx(id)];
+#endif
+
 	// Loop over velocities
 	for (int v = 0; v < L_NUM_VELS; ++v)
 	{
+#ifdef L_SPARSE_LATTICE
+		// Plain link so pull through the neighbour table
+		if (src_f[v] >= 0)
+		{
+			fNew[popIdx(id, v)] = f[src_f[v]];
+			continue;
+		}
+#endif
+
 		// Get indicies for source site (periodic by default)
 		int src_x = (i - c_opt[v][0] + N_lim) % N_lim;
 		int src_y = (j - c_opt[v][1] + M_lim) % M_lim;
 		int src_z = (k - c_opt[v][2] + K_lim) % K_lim;
 
-		// Source id and type
+		// Source id
 		int src_id = src_z + src_y * K_lim + src_x * K_lim * M_lim;
+
+#ifdef L_STREAM_MASK
+		// Plain source so pull without reading its label
+		if (!(mask & (1u << v)))
+		{
+			fNew[popIdx(id, v)] = f[popIdx(src_id, v)];
+			continue;
+		}
+#endif
+
+		// Source type
 		src_type_local = LatTyp[src_id];
 
 		// BFL BOUNCEBACK
@@ -238,16 +446,16 @@ void GridObj::_LBM_stream_opt(int i, int j, int k, int id, eType type_local, int
 		if (src_type_local == eSolid)
 		{
 			// F value is its opposite (HWBB)
-			fNew[v + id * L_NUM_VELS] =
-				f[GridUtils::getOpposite(v) + id * L_NUM_VELS];
+			fNew[popIdx(id, v)] =
+				f[popIdx(id, GridUtils::getOpposite(v))];
 		}
 
 		// EXTRAPOLATERIGHT
 		else if (src_type_local == eExtrapolateRight)
 		{
 			// F value is 2 to the left of the src site
-			fNew[v + id * L_NUM_VELS] =
-				f[v + (src_id - 2 * (K_lim * M_lim)) * L_NUM_VELS];
+			fNew[popIdx(id, v)] =
+				f[popIdx(src_id - 2 * (K_lim * M_lim), v)];
 		}
 
 		// VELOCITY BC (forced equilbirium)
@@ -265,7 +473,7 @@ void GridObj::_LBM_stream_opt(int i, int j, int k, int id, eType type_local, int
 
 #endif
 			// Set f to equilibrium (forced equilibrium BC)
-			fNew[v + id * L_NUM_VELS] = _LBM_equilibrium_opt(src_id, v);
+			fNew[popIdx(id, v)] = L_POP_SET(_LBM_equilibrium_opt(src_id, v), v);
 		}
 #endif
 
@@ -274,14 +482,14 @@ void GridObj::_LBM_stream_opt(int i, int j, int k, int id, eType type_local, int
 		else if (src_type_local == eTransitionToCoarser && subcycle == 0)
 		{
 			// Pull value from parent TL site
-			_LBM_explode_opt(id, v, src_x, src_y, src_z);
+			_LBM_explode_opt(id, v, src_id);
 		}
 
 		// COALESCE
 		else if (src_type_local == eRefined && type_local == eTransitionToFiner)
 		{
-			// Pull average value from child TL cluster to get value leaving fine grid
-			_LBM_coalesce_opt(i, j, k, id, v);
+			// Already written by the child after its sub-cycles
+			continue;
 		}
 #endif
 
@@ -289,7 +497,7 @@ void GridObj::_LBM_stream_opt(int i, int j, int k, int id, eType type_local, int
 		else
 		{
 			// Pull population from source site
-			fNew[v + id * L_NUM_VELS] = f[v + src_id * L_NUM_VELS];
+			fNew[popIdx(id, v)] = f[popIdx(src_id, v)];
 		}
 
 	}
@@ -379,13 +587,13 @@ void GridObj::_LBM_regularised_opt(int i, int j, int k, int id, eType type, int
 			if (c_opt[v][normalDirection] == -normalVector[normalDirection])
 			{
 				// Add to known momentum leaving the domain
-				f_plus += fNew[v + id * L_NUM_VELS];
+				f_plus += L_POP_GET(fNew[popIdx(id, v)], v);
 
 			}
 			// If it is perpendicular to wall part of f_zero
 			else if (c_opt[v][normalDirection] == 0)
 			{
-				f_zero += fNew[v + id * L_NUM_VELS];
+				f_zero += L_POP_GET(fNew[popIdx(id, v)], v);
 			}
 		}
 
@@ -440,8 +648,8 @@ void GridObj::_LBM_regularised_opt(int i, int j, int k, int id, eType type, int
 		// Unknowns for a normal case share the normal vector components
 		if (edgeCount == 1 && c_opt[v][normalDirection] == normalVector[normalDirection])
 		{
-			fNew[v + id * L_NUM_VELS] = _LBM_equilibrium_opt(id, v) +
-				(fNew[GridUtils::getOpposite(v) + id * L_NUM_VELS] - _LBM_equilibrium_opt(id, GridUtils::getOpposite(v)));
+			fNew[popIdx(id, v)] = L_POP_SET(_LBM_equilibrium_opt(id, v) +
+				(L_POP_GET(fNew[popIdx(id, GridUtils::getOpposite(v))], GridUtils::getOpposite(v)) - _LBM_equilibrium_opt(id, GridUtils::getOpposite(v))), v);
 		}
 
 		// Unknown in edge cases are ones who share at least one of the normal components
@@ -467,18 +675,18 @@ void GridObj::_LBM_regularised_opt(int i, int j, int k, int id, eType type, int
 			// If a buried link then set to feq (plane with normal parallel to normal of boundary)
 			if (dp == 0 && mag > 1.0)
 			{
-				fNew[v + id * L_NUM_VELS] = _LBM_equilibrium_opt(id, v);
+				fNew[popIdx(id, v)] = L_POP_SET(_LBM_equilibrium_opt(id, v), v);
 			}
 			// Else apply non-equilbrium bounceback
 			else
 			{
-				fNew[v + id * L_NUM_VELS] = _LBM_equilibrium_opt(id, v) +
-					(fNew[GridUtils::getOpposite(v) + id * L_NUM_VELS] - _LBM_equilibrium_opt(id, GridUtils::getOpposite(v)));
+				fNew[popIdx(id, v)] = L_POP_SET(_LBM_equilibrium_opt(id, v) +
+					(L_POP_GET(fNew[popIdx(id, GridUtils::getOpposite(v))], GridUtils::getOpposite(v)) - _LBM_equilibrium_opt(id, GridUtils::getOpposite(v))), v);
 			}
 		}
 
 		// Store off-equilibrium and update stress components
-		fneq = fNew[v + id * L_NUM_VELS] - _LBM_equilibrium_opt(id, v);
+		fneq = L_POP_GET(fNew[popIdx(id, v)], v) - _LBM_equilibrium_opt(id, v);
 
 		// Compute off-equilibrium stress components
 		Sxx += c_opt[v][eXDirection] * c_opt[v][eXDirection] * fneq;
@@ -495,7 +703,7 @@ void GridObj::_LBM_regularised_opt(int i, int j, int k, int id, eType type, int
 	// Compute regularised non-equilibrium components and add to feq to get new populations
 	for (int v = 0; v < L_NUM_VELS; v++)
 	{
-		fNew[v + id * L_NUM_VELS] = _LBM_equilibrium_opt(id, v) +
+		fNew[popIdx(id, v)] = L_POP_SET(_LBM_equilibrium_opt(id, v), v) +
 			(w[v] / (2.0 * SQ(cs) * SQ(cs))) *
 			(
 			((c_opt[v][eXDirection] * c_opt[v][eXDirection] - SQ(cs)) * Sxx) +
@@ -534,42 +742,42 @@ bool GridObj::_LBM_applySpecReflect_opt(int i, int j, int k, int id, int v)
 		// Left slip
 		if (normVec[eXDirection] == 1 && c_opt[v][eXDirection] == 1)
 		{
-			fNew[v + id * L_NUM_VELS] = f[GridUtils::getReflect(v, eXDirection) + id * L_NUM_VELS];
+			fNew[popIdx(id, v)] = f[popIdx(id, GridUtils::getReflect(v, eXDirection))];
 			return true;
 		}
 
 		// Right slip
 		if (normVec[eXDirection] == -1 && c_opt[v][eXDirection] == -1)
 		{
-			fNew[v + id * L_NUM_VELS] = f[GridUtils::getReflect(v, eXDirection) + id * L_NUM_VELS];
+			fNew[popIdx(id, v)] = f[popIdx(id, GridUtils::getReflect(v, eXDirection))];
 			return true;
 		}
 
 		// Bottom slip
 		if (normVec[eYDirection] == 1 && c_opt[v][eYDirection] == 1)
 		{
-			fNew[v + id * L_NUM_VELS] = f[GridUtils::getReflect(v, eYDirection) + id * L_NUM_VELS];
+			fNew[popIdx(id, v)] = f[popIdx(id, GridUtils::getReflect(v, eYDirection))];
 			return true;
 		}
 
 		// Top slip
 		if (normVec[eYDirection] == -1 && c_opt[v][eYDirection] == -1)
 		{
-			fNew[v + id * L_NUM_VELS] = f[GridUtils::getReflect(v, eYDirection) + id * L_NUM_VELS];
+			fNew[popIdx(id, v)] = f[popIdx(id, GridUtils::getReflect(v, eYDirection))];
 			return true;
 		}
 
 		// Front slip
 		if (normVec[eZDirection] == 1 && c_opt[v][eZDirection] == 1)
 		{
-			fNew[v + id * L_NUM_VELS] = f[GridUtils::getReflect(v, eZDirection) + id * L_NUM_VELS];
+			fNew[popIdx(id, v)] = f[popIdx(id, GridUtils::getReflect(v, eZDirection))];
 			return true;
 		}
 
 		// Back slip
 		if (normVec[eZDirection] == -1 && c_opt[v][eZDirection] == -1)
 		{
-			fNew[v + id * L_NUM_VELS] = f[GridUtils::getReflect(v, eZDirection) + id * L_NUM_VELS];
+			fNew[popIdx(id, v)] = f[popIdx(id, GridUtils::getReflect(v, eZDirection))];
 			return true;
 		}
 
@@ -583,83 +791,83 @@ bool GridObj::_LBM_applySpecReflect_opt(int i, int j, int k, int id, int v)
 // *****************************************************************************
 /// \brief	Optimised coalesce operation.
 ///
-/// \param	i	x-index of current site.
-/// \param	j	y-index of current site.
-/// \param	k	z-index of current site.
-///	\param	id	flattened ijk index.
-/// \param	v	lattice direction.
-void GridObj::_LBM_coalesce_opt(int i, int j, int k, int id, int v) {
-
-	// Get pointer to appropriate child grid
-	GridObj *childGrid = GridUtils::getSubGrid(i, j, k, this);
-	if (!childGrid) L_ERROR("Could not get correct grid for coalesce operation.", GridUtils::logfile);
-
-	// Get sizes
-	int cM_lim = childGrid->M_lim;
-	int cK_lim = childGrid->K_lim;
-
-	// Get indices of child site
-	std::vector<int> cInd =
-		GridUtils::getFineIndices(
-		i, childGrid->CoarseLimsX[eMinimum],
-		j, childGrid->CoarseLimsY[eMinimum],
-		k, childGrid->CoarseLimsZ[eMinimum]);
-
-	// Pull average value of f from child cluster
-	double fNew_local = 0.0;
-	for (int ii = 0; ii < 2; ++ii) {
-		for (int jj = 0; jj < 2; ++jj) {
-#if (L_DIMS == 3)
-			for (int kk = 0; kk < 2; ++kk)
+///			Called on a sub-grid once it has completed both sub-cycles. Writes 
+///			the average of each child cluster into the parent populations which 
+///			the parent stream would otherwise pull from its refined sites. The 
+///			populations are taken from the list built by LBM_initRefinedMaps() 
+///			so the whole interface is handled in one pass while the child data 
+///			is still in cache.
+void GridObj::_LBM_coalesce_opt() {
+
+#ifdef L_SPARSE_LATTICE
+	// Sites of a cluster are not a fixed distance apart in f so all are listed
+	const int nCluster = (L_DIMS == 3) ? 8 : 4;
+
+	int nCoalesce = static_cast<int>(coalesceDst.size());
+	for (int n = 0; n < nCoalesce; ++n)
+	{
+		const int *s = &coalesceSrc[n * nCluster];
+
+		// Pull average value of f from child cluster (same order as below)
+		double fNew_local = 0.0;
+		for (int c = 0; c < nCluster; ++c)
+			fNew_local += f[s[c]];
+		fNew_local /= static_cast<double>(nCluster);
+
+		// Store in parent
+		parentGrid->fNew[coalesceDst[n]] = fNew_local;
+	}
+
 #else
-			int kk = 0;
+	// Offsets of the other sites of a cluster from its first site
+	const int di = L_NUM_VELS * K_lim * M_lim;
+	const int dj = L_NUM_VELS * K_lim;
+#if (L_DIMS == 3)
+	const int dk = L_NUM_VELS;
 #endif
-			{
-				fNew_local +=
-					childGrid->f[v +
-					(cInd[2] + kk) * L_NUM_VELS +
-					(cInd[1] + jj) * L_NUM_VELS * cK_lim +
-					(cInd[0] + ii) * L_NUM_VELS * cK_lim * cM_lim];
-			}
-		}
-	}
 
+	int nCoalesce = static_cast<int>(coalesceDst.size());
+	for (int n = 0; n < nCoalesce; ++n)
+	{
+		int s = coalesceSrc[n];
+
+		// Pull average value of f from child cluster
+		double fNew_local = 0.0;
 #if (L_DIMS == 3)
-	fNew_local /= 8.0;
+		fNew_local += f[s];
+		fNew_local += f[s + dk];
+		fNew_local += f[s + dj];
+		fNew_local += f[s + dj + dk];
+		fNew_local += f[s + di];
+		fNew_local += f[s + di + dk];
+		fNew_local += f[s + di + dj];
+		fNew_local += f[s + di + dj + dk];
+		fNew_local /= 8.0;
 #else
-	fNew_local /= 4.0;
+		fNew_local += f[s];
+		fNew_local += f[s + dj];
+		fNew_local += f[s + di];
+		fNew_local += f[s + di + dj];
+		fNew_local /= 4.0;
 #endif
 
-	// Store back in memory
-	fNew[v + id * L_NUM_VELS] = fNew_local;
+		// Store in parent
+		parentGrid->fNew[coalesceDst[n]] = fNew_local;
+	}
+#endif
 
 }
 
 // *****************************************************************************
 /// \brief	Optimised explode operation.
 ///
-/// \param	id	flattened ijk index.
-///	\param	v	lattice direction.
-///	\param	src_x	x-index of site where value is pulled from.
-///	\param	src_y	y-index of site where value is pulled from.
-///	\param	src_z	z-index of site where value is pulled from.
-void GridObj::_LBM_explode_opt(int id, int v, int src_x, int src_y, int src_z) {
-
-	// Get parent indices
-	std::vector<int> pInd =
-		GridUtils::getCoarseIndices(
-		src_x, CoarseLimsX[eMinimum],
-		src_y, CoarseLimsY[eMinimum],
-		src_z, CoarseLimsZ[eMinimum]);
-
-	// Pull value from parent
-	fNew[v + id * L_NUM_VELS] =
-		parentGrid->f[
-			v +
-				pInd[2] * L_NUM_VELS +
-				pInd[1] * L_NUM_VELS * parentGrid->K_lim +
-				pInd[0] * L_NUM_VELS * parentGrid->K_lim * parentGrid->M_lim
-		];
+/// \param	id		flattened ijk index.
+///	\param	v		lattice direction.
+///	\param	src_id	flattened index of site where value is pulled from.
+void GridObj::_LBM_explode_opt(int id, int v, int src_id) {
+
+	// Pull value from parent site above the source
+	fNew[popIdx(id, v)] = parentGrid->f[parentGrid->popIdx(refineParent[src_id], v)];
 }
 
 // *****************************************************************************
@@ -722,7 +930,7 @@ double GridObj::_LBM_smag(int id, double omega)
  
 	// Compute non-equilibrium values
 	for (int v = 0; v < L_NUM_VELS; ++v)
-		fneq[v] = fNew[v + id*L_NUM_VELS] - _LBM_equilibrium_opt(id, v);
+		fneq[v] = L_POP_GET(fNew[popIdx(id, v)], v) - _LBM_equilibrium_opt(id, v);
 
 	// Calculate diagonal and upper diagonal of the non equilibrium stress tensor
 	for (int i = 0; i < L_DIMS; ++i)
@@ -761,28 +969,31 @@ double GridObj::_LBM_smag(int id, double omega)
 ///			BGK collision operator. If Smagnorinksy turned on, will modify the 
 ///			value of omega locally.
 ///
+///	\tparam	C	collision model (eBGK or eBGKSmag).
 /// \param	id	flattened ijk index.
+template <eCollisionModel C>
 void GridObj::_LBM_collide_opt(int id)
 {
 
-#ifdef L_USE_BGKSMAG
-	// Compute Smagorinksy-modified relaxation
-	double omega_s = _LBM_smag(id, omega);
-#else
-	double omega_s = omega;
+	// Compute Smagorinksy-modified relaxation if required
+	double omega_s = (C == eBGKSmag) ? _LBM_smag(id, omega) : omega;
+
+#if (defined L_GRAVITY_ON || defined L_IBM_ON)
+	// Do not force solid sites
+	bool bForced = (LatTyp[id] != eSolid);
 #endif
 
 	// Perform collision operation (using omega_s -- modified if using Smagorinksy)
 	for (int v = 0; v < L_NUM_VELS; ++v)
 	{
-		fNew[v + id * L_NUM_VELS] +=
+		fNew[popIdx(id, v)] +=
 			omega_s *	(
-			_LBM_equilibrium_opt(id, v) -
-			fNew[v + id * L_NUM_VELS]
+			L_POP_SET(_LBM_equilibrium_opt(id, v), v) -
+			fNew[popIdx(id, v)]
 			)
 
 #if (defined L_GRAVITY_ON || defined L_IBM_ON)
-			+ force_i[v + id * L_NUM_VELS]
+			+ (bForced ? _LBM_forceGrid_opt(id, v) : 0.0)
 #endif
 			;
 	}
@@ -817,14 +1028,19 @@ void GridObj::_LBM_macro_opt(int i, int j, int k, int id, eType type_local) {
 		// Sum to find rho and momentum
 		for (int v = 0; v < L_NUM_VELS; ++v)
 		{
-			rho_temp += fNew[v + id * L_NUM_VELS];
-			rhouX_temp += c_opt[v][0] * fNew[v + id * L_NUM_VELS];
-			rhouY_temp += c_opt[v][1] * fNew[v + id * L_NUM_VELS];
+			rho_temp += fNew[popIdx(id, v)];
+			rhouX_temp += c_opt[v][0] * fNew[popIdx(id, v)];
+			rhouY_temp += c_opt[v][1] * fNew[popIdx(id, v)];
 #if (L_DIMS == 3)
-			rhouZ_temp += c_opt[v][2] * fNew[v + id * L_NUM_VELS];
+			rhouZ_temp += c_opt[v][2] * fNew[popIdx(id, v)];
 #endif
 		}
 
+#ifdef L_SHIFTED_POPULATIONS
+		// Shifts sum to one (and carry no momentum) so add back once
+		rho_temp += 1.0;
+#endif
+
 		// Add forces to momentum
 #if (defined L_IBM_ON || defined L_GRAVITY_ON)
 		rhouX_temp += 0.5 * force_xyz[0 + id * L_DIMS];
@@ -847,17 +1063,12 @@ void GridObj::_LBM_macro_opt(int i, int j, int k, int id, eType type_local) {
 	}
 
 	// Update child TL sites for aethetic reasons only -- can be removed for performance
+#if (L_NUM_LEVELS > 0)
 	if (type_local == eTransitionToFiner) {
 
-		// Get child grid
-		GridObj *childGrid = GridUtils::getSubGrid(i, j, k, this);
-
-		// Get indices
-		std::vector<int> cInd =
-			GridUtils::getFineIndices(
-			i, childGrid->CoarseLimsX[eMinimum],
-			j, childGrid->CoarseLimsY[eMinimum],
-			k, childGrid->CoarseLimsZ[eMinimum]);
+		// Get child grid and first site of the cluster
+		GridObj *childGrid = subGrid[refineChild[id]];
+		int cBase = refineChildBase[id];
 
 		// Get sizes
 		int cM_lim = childGrid->M_lim;
@@ -871,24 +1082,15 @@ void GridObj::_LBM_macro_opt(int i, int j, int k, int id, eType type_local) {
 				int kk = 0;
 #endif
 				{
-					for (int d = 0; d < L_DIMS; ++d) {
-						childGrid->u[
-							d +
-								(cInd[2] + kk) * L_DIMS +
-								(cInd[1] + jj) * L_DIMS * cK_lim +
-								(cInd[0] + ii) * L_DIMS * cK_lim * cM_lim
-						] = u[d + id * L_DIMS];
-					}
-
-					childGrid->rho[
-						(cInd[2] + kk) +
-							(cInd[1] + jj) * cK_lim +
-							(cInd[0] + ii) * cK_lim * cM_lim
-					] = rho[id];
+					int cid = cBase + kk + jj * cK_lim + ii * cK_lim * cM_lim;
+					for (int d = 0; d < L_DIMS; ++d)
+						childGrid->u[d + cid * L_DIMS] = u[d + id * L_DIMS];
+					childGrid->rho[cid] = rho[id];
 				}
 			}
 		}
 	}
+#endif
 
 	// TIME-AVERAGED QUANTITIES //
 
@@ -921,11 +1123,14 @@ void GridObj::_LBM_macro_opt(int i, int j, int k, int id, eType type_local) {
 // *****************************************************************************
 /// \brief	Optimised body force calculator.
 ///
-///			Takes Cartesian force vector and populates forces for each lattice 
-///			direction. If reset_flag is true, then resets the force vectors to zero.
+///			Takes Cartesian force vector and returns the lattice force in the 
+///			given direction. Called from within the collision so the lattice 
+///			forces are never stored.
 ///
 ///	\param	id	flattened ijk index.
-void GridObj::_LBM_forceGrid_opt(int id) {
+///	\param	v	lattice direction.
+///	\return	lattice force in direction v.
+double GridObj::_LBM_forceGrid_opt(int id, int v) {
 
 	/* This routine computes the forces applied along each direction on the lattice
 	from Guo's 2002 scheme. The basic LBM must be modified in two ways: 1) the forces
@@ -957,36 +1162,25 @@ void GridObj::_LBM_forceGrid_opt(int id) {
 	*/
 
 	// Declarations
-	double lambda_v, beta_v;
+	double lambda_v, beta_v = 0.0, force_v = 0.0;
 
-	// Reset the lattice forces
-	memset(&force_i[id * L_NUM_VELS], 0, sizeof(double) * L_NUM_VELS);
-	
-	// Now compute force_i components from Cartesian force vector
-	for (size_t v = 0; v < L_NUM_VELS; v++)
-	{
+	// Compute the lattice forces based on Guo's forcing scheme
+	lambda_v = (1 - 0.5 * omega) * (w[v] / (cs*cs));
 
-		// Reset beta_v
-		beta_v = 0.0;
-
-		// Compute the lattice forces based on Guo's forcing scheme
-		lambda_v = (1 - 0.5 * omega) * (w[v] / (cs*cs));
-
-		// Dot product (sum over d dimensions)
-		for (int d = 0; d < L_DIMS; d++) {
-			beta_v += (c_opt[v][d] * u[d + id * L_DIMS]);
-		}
-		beta_v = beta_v * (1 / (cs*cs));
-
-		// Compute force using shorthand sum described above
-		for (int d = 0; d < L_DIMS; d++) {
-			force_i[v + id * L_NUM_VELS] += force_xyz[d + id * L_DIMS] * 
-				(c_opt[v][d] * (1 + beta_v) - u[d + id * L_DIMS]);
-		}
+	// Dot product (sum over d dimensions)
+	for (int d = 0; d < L_DIMS; d++) {
+		beta_v += (c_opt[v][d] * u[d + id * L_DIMS]);
+	}
+	beta_v = beta_v * (1 / (cs*cs));
 
-		// Multiply by lambda_v
-		force_i[v + id * L_NUM_VELS] *= lambda_v;
+	// Compute force using shorthand sum described above
+	for (int d = 0; d < L_DIMS; d++) {
+		force_v += force_xyz[d + id * L_DIMS] * 
+			(c_opt[v][d] * (1 + beta_v) - u[d + id * L_DIMS]);
 	}
+
+	// Multiply by lambda_v
+	return force_v * lambda_v;
 }
 
 // *****************************************************************************
@@ -1077,10 +1271,10 @@ bool GridObj::_LBM_applyBFL_opt(int id, int src_id, int v, int i, int j, int k,
 			stencil_k >= 0 && stencil_k < K_lim)
 		{
 			// Interpolate pre-stream value then perform bounceback stream
-			fNew[v + id * L_NUM_VELS] =
+			fNew[popIdx(id, v)] =
 				(1 - 2 * q_link) *
-				(f[GridUtils::getOpposite(v) + stencil_id * L_NUM_VELS] - f[GridUtils::getOpposite(v) + id * L_NUM_VELS])
-				+ f[GridUtils::getOpposite(v) + id * L_NUM_VELS];
+				(f[popIdx(stencil_id, GridUtils::getOpposite(v))] - f[popIdx(id, GridUtils::getOpposite(v))])
+				+ f[popIdx(id, GridUtils::getOpposite(v))];
 
 			// Momentum exchange -- don't include forces computed on halo sites to avoid duplicates
 #ifdef L_LD_OUT
@@ -1096,10 +1290,10 @@ bool GridObj::_LBM_applyBFL_opt(int id, int src_id, int v, int i, int j, int k,
 		/* Wall must be nearer the source site than the current site. We can 
 		 * compute bounced value at current site from post-stream interpolated
 		 * values pointing away from the wall. */
-		fNew[v + id * L_NUM_VELS] =
+		fNew[popIdx(id, v)] =
 			(1 - 2 * q_link) *
-			((f[v + id * L_NUM_VELS] - f[GridUtils::getOpposite(v) + id * L_NUM_VELS]) / (2 - 2 * q_link))
-			+ f[GridUtils::getOpposite(v) + id * L_NUM_VELS];
+			((f[popIdx(id, v)] - f[popIdx(id, GridUtils::getOpposite(v))]) / (2 - 2 * q_link))
+			+ f[popIdx(id, GridUtils::getOpposite(v))];
 
 		// Momentum exchange -- don't include forces computed on halo sites to avoid duplicates
 #ifdef L_LD_OUT
@@ -1125,6 +1319,7 @@ void GridObj::_LBM_kbcCollide_opt(int id)
 	// Declarations
 	double ds[L_NUM_VELS];
 	double dh[L_NUM_VELS];
+	double feq[L_NUM_VELS];
 	double fneq[L_NUM_VELS];
 	double gamma;
 	std::vector<double> Mneq;
@@ -1143,8 +1338,8 @@ void GridObj::_LBM_kbcCollide_opt(int id)
 	{
 
 		// Update feq and store fneq
-		feq[v + id * L_NUM_VELS] = _LBM_equilibrium_opt(id, v);
-		fneq[v] = f[v + id * L_NUM_VELS] - feq[v + id * L_NUM_VELS];
+		feq[v] = _LBM_equilibrium_opt(id, v);
+		fneq[v] = L_POP_GET(f[popIdx(id, v)], v) - feq[v];
 
 		// 2-index and 3-index non-equilibrium moments
 		int idx = 0;
@@ -1277,8 +1472,8 @@ void GridObj::_LBM_kbcCollide_opt(int id)
 	for (int v = 0; v < L_NUM_VELS; v++)
 	{
 		// Compute scalar products
-		top_prod += ds[v] * dh[v] / feq[v + id * L_NUM_VELS];
-		bot_prod += dh[v] * dh[v] / feq[v + id * L_NUM_VELS];
+		top_prod += ds[v] * dh[v] / feq[v];
+		bot_prod += dh[v] * dh[v] / feq[v];
 	}
 
 	// Compute 1/beta
@@ -1288,16 +1483,21 @@ void GridObj::_LBM_kbcCollide_opt(int id)
 	if (bot_prod == 0.0) gamma = 2.0;	// Regularised?
 	else gamma = beta_m1 - (2.0 - beta_m1) * (top_prod / bot_prod);
 
+#if (defined L_GRAVITY_ON || defined L_IBM_ON)
+	// Do not force solid sites
+	bool bForced = (LatTyp[id] != eSolid);
+#endif
+
 	// Finally perform collision
 	for (int v = 0; v < L_NUM_VELS; v++)
 	{
 		// Perform collision
-		fNew[v + id * L_NUM_VELS] =
-			f[v + id * L_NUM_VELS] -
+		fNew[popIdx(id, v)] =
+			f[popIdx(id, v)] -
 			(1.0 / beta_m1) * (2.0 * ds[v] + gamma * dh[v])
 
 #if (defined L_GRAVITY_ON || defined L_IBM_ON)
-			+ force_i[v + id * L_NUM_VELS]
+			+ (bForced ? _LBM_forceGrid_opt(id, v) : 0.0)
 #endif
 			;
 	}
@@ -1426,6 +1626,11 @@ void GridObj::_LBM_updateInteriorLatticeSite(int i, int j, int k, int subcycle)
 	int id = k + j * K_lim + i * K_lim * M_lim;
 	eType type_local = LatTyp[id];
 
+#ifdef L_SPARSE_LATTICE
+	// Solid sites have no populations of their own
+	if (type_local == eSolid) return;
+#endif
+
 	// STREAM //
 	_LBM_stream_opt(i, j, k, id, type_local, subcycle);
 
@@ -0,0 +1,940 @@
+/*
+* --------------------------------------------------------------
+*
+* ------ Lattice Boltzmann @ The University of Manchester ------
+*
+* -------------------------- L-U-M-A ---------------------------
+*
+* Copyright 2019 The University of Manchester
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.*
+*/
+
+/* This file contains the methods for block-structured adaptive refinement 
+ * (L_BLOCK_AMR) and for migrating site data between grids which have been 
+ * rebuilt. Each level holds up to L_NUM_REGIONS independent blocks. A block 
+ * is a sub-grid with its own region number and its parent may be any block
+ * of the level above. The regrid tags tiles of each level, clusters them into
+ * blocks, refines new blocks from their parent, coarsens removed blocks onto
+ * their parent and then redistributes the blocks across the ranks. */
+
+#include "../inc/stdafx.h"
+#include "../inc/ObjectManager.h"
+
+
+// *****************************************************************************
+///	\brief	Number of values in the record of a migrated site.
+///
+///			Record layout is (lev, reg, x, y, z, LatTyp, rho, u, f, fNew)
+///			followed by (rho_timeav, ui_timeav, uiuj_timeav) if time averages
+///			are computed.
+///
+///	\returns	number of doubles in a site record.
+int GridObj::LBM_siteRecordSize()
+{
+#ifdef L_COMPUTE_TIME_AVERAGED_QUANTITIES
+	return 5 + 5 * L_DIMS + 2 * L_NUM_VELS;
+#else
+	return 7 + L_DIMS + 2 * L_NUM_VELS;
+#endif
+}
+
+// *****************************************************************************
+///	\brief	Pack the core sites of all grids on this rank into records.
+///
+///			Called on L0. Sites on the receiver layers are not packed as they
+///			are sent by the rank on whose core they lie.
+///
+///	\param	records	vector to which the site records are appended.
+void GridObj::LBM_packSites(std::vector<double>& records)
+{
+	for (int lev = 0; lev < L_NUM_LEVELS + 1; ++lev)
+	{
+		for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+		{
+			GridObj *g = nullptr;
+			GridUtils::getGrid(this, lev, reg, g);
+			if (!g) continue;
+
+			for (int i = 0; i < g->N_lim; ++i)
+			{
+				for (int j = 0; j < g->M_lim; ++j)
+				{
+					for (int k = 0; k < g->K_lim; ++k)
+					{
+						if (GridUtils::isOnRecvLayer(g->XPos[i], g->YPos[j], g->ZPos[k])) continue;
+
+						int id = k + j * g->K_lim + i * g->K_lim * g->M_lim;
+						records.push_back(lev);
+						records.push_back(reg);
+						records.push_back(g->XPos[i]);
+						records.push_back(g->YPos[j]);
+						records.push_back(g->ZPos[k]);
+						records.push_back(static_cast<double>(g->LatTyp[id]));
+						records.push_back(g->rho[id]);
+						for (int d = 0; d < L_DIMS; d++) records.push_back(g->u[d + id * L_DIMS]);
+						for (int v = 0; v < L_NUM_VELS; v++) records.push_back(g->f[g->popIdx(id, v)]);
+						for (int v = 0; v < L_NUM_VELS; v++) records.push_back(g->fNew[g->popIdx(id, v)]);
+#ifdef L_COMPUTE_TIME_AVERAGED_QUANTITIES
+						records.push_back(g->rho_timeav[id]);
+						for (int d = 0; d < L_DIMS; d++) records.push_back(g->ui_timeav[d + id * L_DIMS]);
+						for (int d = 0; d < 3 * L_DIMS - 3; d++) records.push_back(g->uiuj_timeav[d + id * (3 * L_DIMS - 3)]);
+#endif
+					}
+				}
+			}
+		}
+	}
+}
+
+// *****************************************************************************
+///	\brief	Unpack site records into the grids on this rank.
+///
+///			Called on L0 after the hierarchy has been rebuilt. Records of sites
+///			which do not exist on this rank are ignored. When regridding, each
+///			record goes to the block of its level which now contains it and the
+///			labels of the rebuilt grids are kept as refined sites have moved
+///			but solid labels from bodies are carried over. Sub-grid sites which
+///			were not on the old blocks then take the data of their parent.
+///
+///	\param	records		pointer to the first record.
+///	\param	numRecords	number of records.
+///	\param	bRegrid		true if the refined blocks have changed.
+void GridObj::LBM_unpackSites(const double *records, int numRecords, bool bRegrid)
+{
+	GridManager *gm = GridManager::getInstance();
+	const int recSize = LBM_siteRecordSize();
+	std::vector<int> ijk;
+
+#if (L_NUM_LEVELS > 0)
+	// Sites of each sub-grid which have been set from a record
+	std::vector<std::vector<char>> bSet(L_NUM_LEVELS * L_NUM_REGIONS + 1);
+	for (int lev = 1; lev < L_NUM_LEVELS + 1 && bRegrid; ++lev)
+	{
+		for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+		{
+			GridObj *g = nullptr;
+			GridUtils::getGrid(this, lev, reg, g);
+			if (g) bSet[lev + reg * L_NUM_LEVELS].assign(g->N_lim * g->M_lim * g->K_lim, 0);
+		}
+	}
+#endif
+
+	for (int rec = 0; rec < numRecords; ++rec)
+	{
+		const double *data = records + rec * recSize;
+
+		// After a regrid the site goes to the block of its level which now holds it
+		int reg = bRegrid ? gm->getRegion(static_cast<int>(data[0]), data + 2) : static_cast<int>(data[1]);
+		if (reg < 0) continue;
+		GridObj *g = nullptr;
+		GridUtils::getGrid(this, static_cast<int>(data[0]), reg, g);
+		if (!g) continue;
+
+		eLocationOnRank loc = eNone;
+		if (!GridUtils::isOnThisRank(data[2], data[3], data[4], &loc, g, &ijk)) continue;
+
+		int id = ijk[eZDirection] + ijk[eYDirection] * g->K_lim + ijk[eXDirection] * g->K_lim * g->M_lim;
+		data += 5;
+		eType type = static_cast<eType>(static_cast<int>(*data++));
+		if (!bRegrid) g->LatTyp[id] = type;
+		else if (type == eSolid && g->LatTyp[id] != eVelocity) g->LatTyp[id] = eSolid;
+		g->rho[id] = *data++;
+		for (int d = 0; d < L_DIMS; d++) g->u[d + id * L_DIMS] = *data++;
+		for (int v = 0; v < L_NUM_VELS; v++) g->f[g->popIdx(id, v)] = static_cast<popType>(*data++);
+		for (int v = 0; v < L_NUM_VELS; v++) g->fNew[g->popIdx(id, v)] = static_cast<popType>(*data++);
+#ifdef L_COMPUTE_TIME_AVERAGED_QUANTITIES
+		g->rho_timeav[id] = *data++;
+		for (int d = 0; d < L_DIMS; d++) g->ui_timeav[d + id * L_DIMS] = *data++;
+		for (int d = 0; d < 3 * L_DIMS - 3; d++) g->uiuj_timeav[d + id * (3 * L_DIMS - 3)] = *data++;
+#endif
+#if (L_NUM_LEVELS > 0)
+		if (bRegrid && g->level > 0) bSet[g->level + g->region_number * L_NUM_LEVELS][id] = 1;
+#endif
+	}
+
+#if (L_NUM_LEVELS > 0)
+	// Fill the rest of the changed blocks from the top down
+	for (int lev = 1; lev < L_NUM_LEVELS + 1 && bRegrid; ++lev)
+	{
+		for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+		{
+			GridObj *g = nullptr;
+			GridUtils::getGrid(this, lev, reg, g);
+			if (g) g->_LBM_regridFill(bSet[lev + reg * L_NUM_LEVELS]);
+		}
+	}
+#endif
+}
+
+// The rest is only needed when there are refined blocks to change
+#if (L_NUM_LEVELS > 0)
+
+// *****************************************************************************
+///	\brief	Fill the sites of a block which were not on the old blocks.
+///
+///			Each site takes the density, velocity and populations of the parent
+///			site above it as is done for the populations in the explode step.
+///			The site is labelled solid if the parent site is solid since bodies
+///			are labelled on every grid behind the finest grid.
+///
+///	\param	bSet	flag for each site which is set if it already holds data.
+void GridObj::_LBM_regridFill(const std::vector<char>& bSet)
+{
+	GridObj *p = parentGrid;
+
+	for (int i = 0; i < N_lim; ++i)
+	{
+		int pi = CoarseLimsX[eMinimum] + i / 2;
+		for (int j = 0; j < M_lim; ++j)
+		{
+			int pj = CoarseLimsY[eMinimum] + j / 2;
+			for (int k = 0; k < K_lim; ++k)
+			{
+				int id = k + j * K_lim + i * K_lim * M_lim;
+				if (bSet[id]) continue;
+
+#if (L_DIMS == 3)
+				int pk = CoarseLimsZ[eMinimum] + k / 2;
+#else
+				int pk = 0;
+#endif
+				if (pi >= p->N_lim || pj >= p->M_lim || pk >= p->K_lim) continue;
+				int pid = pk + pj * p->K_lim + pi * p->K_lim * p->M_lim;
+
+				if (p->LatTyp[pid] == eSolid && LatTyp[id] != eVelocity) LatTyp[id] = eSolid;
+				rho[id] = p->rho[pid];
+				for (int d = 0; d < L_DIMS; d++) u[d + id * L_DIMS] = p->u[d + pid * L_DIMS];
+				for (int v = 0; v < L_NUM_VELS; v++)
+				{
+					f[popIdx(id, v)] = p->f[p->popIdx(pid, v)];
+					fNew[popIdx(id, v)] = p->f[p->popIdx(pid, v)];
+				}
+#ifdef L_COMPUTE_TIME_AVERAGED_QUANTITIES
+				rho_timeav[id] = p->rho_timeav[pid];
+				for (int d = 0; d < L_DIMS; d++) ui_timeav[d + id * L_DIMS] = p->ui_timeav[d + pid * L_DIMS];
+				for (int d = 0; d < 3 * L_DIMS - 3; d++) uiuj_timeav[d + id * (3 * L_DIMS - 3)] = p->uiuj_timeav[d + pid * (3 * L_DIMS - 3)];
+#endif
+			}
+		}
+	}
+}
+
+// *****************************************************************************
+///	\brief	Average the sub-grid data onto all refined sites of this grid.
+///
+///			The coalesce step only updates the sites of the parent which are
+///			needed by the transition layers so the rest of the refined sites
+///			hold stale data. Before the regions are moved, the populations,
+///			density and velocity of every cluster of child sites are averaged
+///			onto the refined site above it, from the finest grid up.
+void GridObj::_LBM_regridCoalesce()
+{
+	for (GridObj *c : subGrid)
+	{
+		c->_LBM_regridCoalesce();
+
+#if (L_DIMS == 3)
+		const int nChild = 8;
+		const int kStep = 2;
+#else
+		const int nChild = 4;
+		const int kStep = 1;
+#endif
+		for (int i = 0; i + 1 < c->N_lim; i += 2)
+		{
+			for (int j = 0; j + 1 < c->M_lim; j += 2)
+			{
+				for (int k = 0; k + kStep - 1 < c->K_lim; k += kStep)
+				{
+					int pi = c->CoarseLimsX[eMinimum] + i / 2;
+					int pj = c->CoarseLimsY[eMinimum] + j / 2;
+					int pk = (L_DIMS == 3) ? c->CoarseLimsZ[eMinimum] + k / 2 : 0;
+					if (pi >= N_lim || pj >= M_lim || pk >= K_lim) continue;
+					int pid = pk + pj * K_lim + pi * K_lim * M_lim;
+					if (LatTyp[pid] != eRefined) continue;
+
+					// Indices of the children
+					int cid[8];
+					int n = 0;
+					for (int a = 0; a < 2; a++)
+						for (int b = 0; b < 2; b++)
+							for (int e = 0; e < kStep; e++)
+								cid[n++] = (k + e) + (j + b) * c->K_lim + (i + a) * c->K_lim * c->M_lim;
+
+					double rhoAv = 0.0;
+					for (n = 0; n < nChild; n++) rhoAv += c->rho[cid[n]];
+					rho[pid] = rhoAv / nChild;
+
+					for (int d = 0; d < L_DIMS; d++)
+					{
+						double uAv = 0.0;
+						for (n = 0; n < nChild; n++) uAv += c->u[d + cid[n] * L_DIMS];
+						u[d + pid * L_DIMS] = uAv / nChild;
+					}
+
+					for (int v = 0; v < L_NUM_VELS; v++)
+					{
+						double fAv = 0.0;
+						for (n = 0; n < nChild; n++) fAv += c->f[c->popIdx(cid[n], v)];
+						f[popIdx(pid, v)] = static_cast<popType>(fAv / nChild);
+					}
+				}
+			}
+		}
+	}
+}
+
+// *****************************************************************************
+///	\brief	Tag the tiles of the child level which require refinement.
+///
+///			Sites where the regridding criterion (vorticity or strain rate
+///			scaled by the site width) exceeds L_REGRID_THRESHOLD are tagged. Sites
+///			already covered by a child block only need to exceed the threshold
+///			scaled by L_REGRID_COARSEN_FRACTION to stay refined. Solid sites next
+///			to fluid stay refined if they are already covered so walls and
+///			bodies placed inside a block remain inside one. The tile of the 
+///			child level holding each tagged site is added to the tags.
+///
+///	\param	tags	keys of the tagged tiles of the child level.
+void GridObj::_LBM_regridFlag(std::vector<long long>& tags)
+{
+	GridManager *gm = GridManager::getInstance();
+	const int childLev = level + 1;
+
+	std::vector<double> fields[eDerivedFields];
+	_io_computeDerived(fields);
+
+	for (int i = 0; i < N_lim; ++i)
+	{
+		for (int j = 0; j < M_lim; ++j)
+		{
+			for (int k = 0; k < K_lim; ++k)
+			{
+				if (GridUtils::isOnRecvLayer(XPos[i], YPos[j], ZPos[k])) continue;
+				int id = k + j * K_lim + i * K_lim * M_lim;
+				double pos[3] = { XPos[i], YPos[j], ZPos[k] };
+
+				// Site is already covered by a child block
+				bool bInside = (gm->getRegion(childLev, pos) >= 0);
+
+				bool bFlag = false;
+				if (LatTyp[id] == eSolid)
+				{
+					// Solid site on the surface of a wall or body already refined
+					for (int v = 0; v < L_NUM_VELS && bInside && !bFlag; v++)
+					{
+						int ni = i + c_opt[v][eXDirection];
+						int nj = j + c_opt[v][eYDirection];
+						int nk = k + ((L_DIMS == 3) ? c_opt[v][eZDirection] : 0);
+						if (ni < 0 || ni >= N_lim || nj < 0 || nj >= M_lim || nk < 0 || nk >= K_lim) continue;
+						if (LatTyp[nk + nj * K_lim + ni * K_lim * M_lim] != eSolid) bFlag = true;
+					}
+				}
+				else
+				{
+					double crit = 0.0;
+					if (L_REGRID_CRITERION == eRegridStrainRate)
+					{
+						crit = fields[eDerivedStrainRate][id];
+					}
+					else
+					{
+						crit = SQ(fields[eDerivedVortZ][id]);
+#if (L_DIMS == 3)
+						crit += SQ(fields[eDerivedVortX][id]) + SQ(fields[eDerivedVortY][id]);
+#endif
+						crit = sqrt(crit);
+					}
+					bFlag = (crit * dh > L_REGRID_THRESHOLD * (bInside ? L_REGRID_COARSEN_FRACTION : 1.0));
+				}
+				if (!bFlag) continue;
+
+				// Tag the enclosing tile
+				int tile[3];
+				_LBM_regridTileOf(childLev, pos, tile);
+				int box[6] = { tile[0], tile[0], tile[1], tile[1], tile[2], tile[2] };
+				_LBM_regridTagBox(childLev, box, tags);
+			}
+		}
+	}
+}
+
+// *****************************************************************************
+///	\brief	Number of regrid tiles of a level in each direction.
+///
+///			Tiles are cubes of L_REGRID_BLOCK_SIZE sites of the parent level
+///			laid out from the origin. The blocks of a level are made of whole
+///			tiles except where they are clipped near the domain edges.
+///
+///	\param	lev				level of the tiles.
+///	\param[out]	numTiles	number of tiles in each direction.
+void GridObj::_LBM_regridTileCount(int lev, int *numTiles)
+{
+	GridManager *gm = GridManager::getInstance();
+	for (int d = 0; d < 3; d++)
+	{
+		int sites = gm->global_size[d][0] << (lev - 1);
+		numTiles[d] = (d < L_DIMS) ? (sites + L_REGRID_BLOCK_SIZE - 1) / L_REGRID_BLOCK_SIZE : 1;
+	}
+}
+
+// *****************************************************************************
+///	\brief	Tile of a level which holds a position.
+///
+///	\param	lev			level of the tiles.
+///	\param	pos			position (x, y, z).
+///	\param[out]	tile	tile indices in each direction.
+void GridObj::_LBM_regridTileOf(int lev, const double *pos, int *tile)
+{
+	int numTiles[3];
+	_LBM_regridTileCount(lev, numTiles);
+	const double width = L_REGRID_BLOCK_SIZE * L_COARSE_SITE_WIDTH / pow(2.0, lev - 1);
+	for (int d = 0; d < 3; d++)
+	{
+		tile[d] = (d < L_DIMS) ? static_cast<int>(std::floor(pos[d] / width)) : 0;
+		tile[d] = std::min(std::max(tile[d], 0), numTiles[d] - 1);
+	}
+}
+
+// *****************************************************************************
+///	\brief	Tile of a level with a given key.
+///
+///	\param	lev			level of the tiles.
+///	\param	key			key of the tile.
+///	\param[out]	tile	tile indices in each direction.
+void GridObj::_LBM_regridTileIndices(int lev, long long key, int *tile)
+{
+	int numTiles[3];
+	_LBM_regridTileCount(lev, numTiles);
+	tile[eXDirection] = static_cast<int>(key % numTiles[eXDirection]);
+	tile[eYDirection] = static_cast<int>((key / numTiles[eXDirection]) % numTiles[eYDirection]);
+	tile[eZDirection] = static_cast<int>(key / (static_cast<long long>(numTiles[eXDirection]) * numTiles[eYDirection]));
+}
+
+// *****************************************************************************
+///	\brief	Tag every tile of a level in a box of tiles.
+///
+///	\param	lev		level of the tiles.
+///	\param	box		first and last tile in each direction accessed using the
+///					eCartMinMax enumeration. Clipped to the tiles of the level.
+///	\param	tags	keys of the tagged tiles to which the tiles are added.
+void GridObj::_LBM_regridTagBox(int lev, const int *box, std::vector<long long>& tags)
+{
+	int numTiles[3], lo[3], hi[3];
+	_LBM_regridTileCount(lev, numTiles);
+	for (int d = 0; d < 3; d++)
+	{
+		lo[d] = std::max(box[2 * d], 0);
+		hi[d] = std::min(box[2 * d + 1], numTiles[d] - 1);
+	}
+
+	for (int i = lo[eXDirection]; i <= hi[eXDirection]; i++)
+	{
+		for (int j = lo[eYDirection]; j <= hi[eYDirection]; j++)
+		{
+			for (int k = lo[eZDirection]; k <= hi[eZDirection]; k++)
+			{
+				long long key = i + static_cast<long long>(numTiles[eXDirection]) * (j + static_cast<long long>(numTiles[eYDirection]) * k);
+				if (tags.empty() || tags.back() != key) tags.push_back(key);
+			}
+		}
+	}
+}
+
+// *****************************************************************************
+///	\brief	Cluster the tagged tiles of a level into blocks.
+///
+///			Each group of touching tiles gives a block covering its extent.
+///			Blocks are clipped so they keep two sites of every coarser level
+///			from the domain edges and are at least four parent sites wide.
+///			Blocks which overlap or are less than a tile apart are merged so
+///			the transition layers of different blocks never meet. While there
+///			are more blocks than L_NUM_REGIONS, the pair which adds the least
+///			volume when merged is merged.
+///
+///	\param	lev			level of the blocks.
+///	\param	tags		sorted keys of the tagged tiles.
+///	\param[out]	blocks	edges of each block in sites of the parent level from 
+///						the origin as six values accessed using the 
+///						eCartMinMax enumeration.
+void GridObj::_LBM_regridCluster(int lev, const std::vector<long long>& tags, std::vector<int>& blocks)
+{
+	GridManager *gm = GridManager::getInstance();
+	const int bs = L_REGRID_BLOCK_SIZE;
+	const int margin = (2 << lev) - 2;	// Two sites of each coarser level
+	int numTiles[3], sites[3];
+	_LBM_regridTileCount(lev, numTiles);
+	for (int d = 0; d < 3; d++) sites[d] = gm->global_size[d][0] << (lev - 1);
+
+	// Groups of touching tiles
+	blocks.clear();
+	std::vector<char> bVisited(tags.size(), 0);
+	std::vector<size_t> stack;
+	for (size_t t = 0; t < tags.size(); t++)
+	{
+		if (bVisited[t]) continue;
+		bVisited[t] = 1;
+		stack.push_back(t);
+
+		int box[6] = { numTiles[0], -1, numTiles[1], -1, numTiles[2], -1 };
+		while (!stack.empty())
+		{
+			int tile[3];
+			_LBM_regridTileIndices(lev, tags[stack.back()], tile);
+			stack.pop_back();
+			for (int d = 0; d < 3; d++)
+			{
+				box[2 * d] = std::min(box[2 * d], tile[d]);
+				box[2 * d + 1] = std::max(box[2 * d + 1], tile[d]);
+			}
+
+			for (int a = -1; a <= 1; a++)
+			{
+				for (int b = -1; b <= 1; b++)
+				{
+					for (int c = (L_DIMS == 3) ? -1 : 0; c <= ((L_DIMS == 3) ? 1 : 0); c++)
+					{
+						int n[3] = { tile[0] + a, tile[1] + b, tile[2] + c };
+						if (n[0] < 0 || n[0] >= numTiles[0] || n[1] < 0 || n[1] >= numTiles[1] || n[2] < 0 || n[2] >= numTiles[2]) continue;
+						long long key = n[0] + static_cast<long long>(numTiles[0]) * (n[1] + static_cast<long long>(numTiles[1]) * n[2]);
+						std::vector<long long>::const_iterator it = std::lower_bound(tags.begin(), tags.end(), key);
+						if (it == tags.end() || *it != key || bVisited[it - tags.begin()]) continue;
+						bVisited[it - tags.begin()] = 1;
+						stack.push_back(it - tags.begin());
+					}
+				}
+			}
+		}
+
+		// Block covering the group clipped near the domain edges
+		for (int d = 0; d < 3; d++)
+		{
+			int lo = 0, hi = 0;
+			if (d < L_DIMS)
+			{
+				lo = std::max(box[2 * d] * bs, margin);
+				hi = std::min((box[2 * d + 1] + 1) * bs, sites[d] - margin);
+				if (hi - lo < 4)
+				{
+					hi = std::min(lo + 4, sites[d] - margin);
+					lo = hi - 4;
+				}
+			}
+			blocks.push_back(lo);
+			blocks.push_back(hi);
+		}
+	}
+
+	// Merge blocks which are too close then the closest while there are too many
+	while (true)
+	{
+		int numBlocks = static_cast<int>(blocks.size()) / 6;
+		int mergeA = -1, mergeB = -1;
+		bool bClose = false;
+		double minAdded = std::numeric_limits<double>::max();
+		for (int a = 0; a < numBlocks && !bClose; a++)
+		{
+			for (int b = a + 1; b < numBlocks && !bClose; b++)
+			{
+				bool bNear = true;
+				double volA = 1.0, volB = 1.0, volAB = 1.0;
+				for (int d = 0; d < L_DIMS; d++)
+				{
+					const int *eA = &blocks[6 * a + 2 * d], *eB = &blocks[6 * b + 2 * d];
+					if (eA[0] >= eB[1] + bs || eB[0] >= eA[1] + bs) bNear = false;
+					volA *= eA[1] - eA[0];
+					volB *= eB[1] - eB[0];
+					volAB *= std::max(eA[1], eB[1]) - std::min(eA[0], eB[0]);
+				}
+
+				if (bNear || volAB - volA - volB < minAdded)
+				{
+					bClose = bNear;
+					minAdded = volAB - volA - volB;
+					mergeA = a;
+					mergeB = b;
+				}
+			}
+		}
+		if (mergeA < 0 || (!bClose && numBlocks <= L_NUM_REGIONS)) break;
+
+		for (int d = 0; d < L_DIMS; d++)
+		{
+			blocks[6 * mergeA + 2 * d] = std::min(blocks[6 * mergeA + 2 * d], blocks[6 * mergeB + 2 * d]);
+			blocks[6 * mergeA + 2 * d + 1] = std::max(blocks[6 * mergeA + 2 * d + 1], blocks[6 * mergeB + 2 * d + 1]);
+		}
+		blocks.erase(blocks.begin() + 6 * mergeB, blocks.begin() + 6 * mergeB + 6);
+	}
+}
+
+// *****************************************************************************
+///	\brief	Refine and coarsen the blocks of each level to follow the flow.
+///
+///			Called on L0 by all ranks. The data on refined sites is brought up
+///			to date and every grid with a child tags the tiles of the child 
+///			level which require refinement. Tiles covering the IB bodies and 
+///			the markers of the BFL bodies on refined levels are tagged so the
+///			bodies stay on their level and each IB body stays in one block. The
+///			tags of all ranks are combined and each level, from the finest up,
+///			is padded with L_REGRID_BUFFER tiles, joined by the tiles needed to
+///			contain its child blocks and clustered into at most L_NUM_REGIONS 
+///			blocks. Blocks are matched to the block slots they overlap most so
+///			unchanged blocks keep their region number and the parent of each 
+///			block is the block of the level above which contains it. If the 
+///			blocks change, the grid manager is updated, the hierarchy is rebuilt 
+///			and the site data of all grids is carried over. Sites of created or
+///			grown blocks take the data of their parent and sites of removed or 
+///			shrunk blocks leave the average of their children on the parent. 
+///			With MPI the new blocks are also redistributed across the ranks.
+///
+///	\returns	true if the blocks changed.
+bool GridObj::LBM_regrid()
+{
+	GridManager *gm = GridManager::getInstance();
+	ObjectManager *objman = ObjectManager::getInstance();
+	const int numGrids = L_NUM_LEVELS * L_NUM_REGIONS + 1;
+	const int rank = GridUtils::safeGetRank();
+#ifdef L_BUILD_FOR_MPI
+	MpiManager *mpim = MpiManager::getInstance();
+#endif
+
+	// Bring refined sites up to date and tag the tiles of each refined level
+	_LBM_regridCoalesce();
+	std::vector< std::vector<long long> > tags(L_NUM_LEVELS + 1);
+	this->_LBM_regridFlag(tags[1]);
+	for (int lev = 1; lev < L_NUM_LEVELS; ++lev)
+	{
+		for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+		{
+			GridObj *g = nullptr;
+			GridUtils::getGrid(this, lev, reg, g);
+			if (g) g->_LBM_regridFlag(tags[lev + 1]);
+		}
+	}
+
+	// Tiles covering each IB body stored by ID as (-min, max) and its level
+	int numBodies = 0;
+	for (size_t ib = 0; ib < objman->iBody.size(); ib++)
+		numBodies = std::max(numBodies, objman->iBody[ib].id + 1);
+#ifdef L_BUILD_FOR_MPI
+	MPI_Allreduce(MPI_IN_PLACE, &numBodies, 1, MPI_INT, MPI_MAX, mpim->world_comm);
+#endif
+	std::vector<int> bodyTiles(7 * numBodies, -std::numeric_limits<int>::max());
+	for (size_t ib = 0; ib < objman->iBody.size(); ib++)
+	{
+		IBBody &body = objman->iBody[ib];
+		if (body.owningRank != rank || body.markers.empty()) continue;
+		int *bt = &bodyTiles[body.id * 7];
+		bt[6] = body.level;
+		for (size_t m = 0; m < body.markers.size(); m++)
+		{
+			int tile[3];
+			_LBM_regridTileOf(body.level, &body.markers[m].position[0], tile);
+			for (int d = 0; d < 3; d++)
+			{
+				bt[2 * d] = std::max(bt[2 * d], -tile[d]);
+				bt[2 * d + 1] = std::max(bt[2 * d + 1], tile[d]);
+			}
+		}
+	}
+#ifdef L_BUILD_FOR_MPI
+	if (numBodies > 0)
+		MPI_Allreduce(MPI_IN_PLACE, &bodyTiles[0], static_cast<int>(bodyTiles.size()), MPI_INT, MPI_MAX, mpim->world_comm);
+#endif
+	for (int ib = 0; ib < numBodies; ib++)
+	{
+		int *bt = &bodyTiles[ib * 7];
+		if (bt[6] <= 0 || bt[1] < 0) continue;
+		int box[6] = { -bt[0], bt[1], -bt[2], bt[3], -bt[4], bt[5] };
+		_LBM_regridTagBox(bt[6], box, tags[bt[6]]);
+	}
+
+	// Tiles holding the markers of each BFL body
+	for (size_t ib = 0; ib < objman->pBody.size(); ib++)
+	{
+		int lev = objman->pBody[ib]._Owner->level;
+		if (lev == 0) continue;
+		for (size_t m = 0; m < objman->pBody[ib].markers.size(); m++)
+		{
+			int tile[3];
+			_LBM_regridTileOf(lev, &objman->pBody[ib].markers[m].position[0], tile);
+			int box[6] = { tile[0], tile[0], tile[1], tile[1], tile[2], tile[2] };
+			_LBM_regridTagBox(lev, box, tags[lev]);
+		}
+	}
+
+	// Combine the tags of all ranks
+	for (int lev = 1; lev <= L_NUM_LEVELS; ++lev)
+	{
+		std::sort(tags[lev].begin(), tags[lev].end());
+		tags[lev].erase(std::unique(tags[lev].begin(), tags[lev].end()), tags[lev].end());
+
+#ifdef L_BUILD_FOR_MPI
+		int numTags = static_cast<int>(tags[lev].size());
+		std::vector<int> counts(mpim->num_ranks), offsets(mpim->num_ranks, 0);
+		MPI_Allgather(&numTags, 1, MPI_INT, &counts[0], 1, MPI_INT, mpim->world_comm);
+		for (int r = 1; r < mpim->num_ranks; r++) offsets[r] = offsets[r - 1] + counts[r - 1];
+		std::vector<long long> allTags(offsets.back() + counts.back());
+		MPI_Allgatherv(tags[lev].data(), numTags, MPI_LONG_LONG, allTags.data(), &counts[0], &offsets[0], 
+			MPI_LONG_LONG, mpim->world_comm);
+		std::sort(allTags.begin(), allTags.end());
+		allTags.erase(std::unique(allTags.begin(), allTags.end()), allTags.end());
+		tags[lev].swap(allTags);
+#endif
+	}
+
+	// Cluster the tags of each level into blocks (bottom up)
+	const int bs = L_REGRID_BLOCK_SIZE;
+	std::vector< std::vector<int> > blocks(L_NUM_LEVELS + 2);
+	for (int lev = L_NUM_LEVELS; lev > 0; --lev)
+	{
+		// Tagged tiles padded with the buffer
+		std::vector<long long> padded;
+		for (size_t t = 0; t < tags[lev].size(); t++)
+		{
+			int tile[3];
+			_LBM_regridTileIndices(lev, tags[lev][t], tile);
+			int box[6];
+			for (int d = 0; d < 3; d++)
+			{
+				int pad = (d < L_DIMS) ? L_REGRID_BUFFER : 0;
+				box[2 * d] = tile[d] - pad;
+				box[2 * d + 1] = tile[d] + pad;
+			}
+			_LBM_regridTagBox(lev, box, padded);
+		}
+
+		// Tiles which contain the child blocks with two sites of this level around them
+		for (size_t c = 0; c < blocks[lev + 1].size() / 6; c++)
+		{
+			const int *e = &blocks[lev + 1][6 * c];
+			int box[6] = { 0, 0, 0, 0, 0, 0 };
+			for (int d = 0; d < L_DIMS; d++)
+			{
+				box[2 * d] = (e[2 * d] - 2) / (2 * bs);
+				box[2 * d + 1] = (e[2 * d + 1] + 1) / (2 * bs);
+			}
+			_LBM_regridTagBox(lev, box, padded);
+		}
+
+		std::sort(padded.begin(), padded.end());
+		padded.erase(std::unique(padded.begin(), padded.end()), padded.end());
+		_LBM_regridCluster(lev, padded, blocks[lev]);
+	}
+
+	// Assign the blocks to slots and find their parents (top down)
+	std::vector<double> newEdges(6 * numGrids, 0.0);
+	std::vector<int> newParent(gm->parent_region, gm->parent_region + numGrids);
+	std::vector<char> bNewActive(numGrids, 0);
+	std::vector<int> parentSlot(1, 0);
+	for (int lev = 1; lev <= L_NUM_LEVELS; ++lev)
+	{
+		const double dhp = L_COARSE_SITE_WIDTH / pow(2.0, lev - 1);
+		const std::vector<int> &blk = blocks[lev];
+		int numBlocks = static_cast<int>(blk.size()) / 6;
+		std::vector<int> slot(numBlocks, -1);
+		std::vector<char> bTaken(L_NUM_REGIONS, 0);
+
+		// Keep the slot of the old block each new block overlaps most
+		while (true)
+		{
+			double maxOverlap = 0.0;
+			int bestBlock = -1, bestSlot = -1;
+			for (int b = 0; b < numBlocks; b++)
+			{
+				if (slot[b] >= 0) continue;
+				for (int reg = 0; reg < L_NUM_REGIONS; reg++)
+				{
+					if (bTaken[reg] || !gm->isActive(lev, reg)) continue;
+					int idx = lev + reg * L_NUM_LEVELS;
+					double overlap = 1.0;
+					for (int d = 0; d < L_DIMS; d++)
+					{
+						overlap *= std::max(0.0, std::min(blk[6 * b + 2 * d + 1] * dhp, gm->global_edges[2 * d + 1][idx]) -
+							std::max(blk[6 * b + 2 * d] * dhp, gm->global_edges[2 * d][idx]));
+					}
+					if (overlap > maxOverlap)
+					{
+						maxOverlap = overlap;
+						bestBlock = b;
+						bestSlot = reg;
+					}
+				}
+			}
+			if (bestBlock < 0) break;
+			slot[bestBlock] = bestSlot;
+			bTaken[bestSlot] = 1;
+		}
+
+		// Remaining blocks take free slots
+		for (int b = 0, reg = 0; b < numBlocks; b++)
+		{
+			if (slot[b] >= 0) continue;
+			while (bTaken[reg]) reg++;
+			slot[b] = reg;
+			bTaken[reg] = 1;
+		}
+
+		for (int b = 0; b < numBlocks; b++)
+		{
+			int idx = lev + slot[b] * L_NUM_LEVELS;
+			bNewActive[idx] = 1;
+			for (int d = 0; d < 3; d++)
+			{
+				newEdges[2 * d + idx * 6] = (d < L_DIMS) ? blk[6 * b + 2 * d] * dhp : gm->global_edges[2 * d][0];
+				newEdges[2 * d + 1 + idx * 6] = (d < L_DIMS) ? blk[6 * b + 2 * d + 1] * dhp : gm->global_edges[2 * d + 1][0];
+			}
+
+			// Parent is the block of the level above which contains it
+			newParent[idx] = (lev == 1) ? 0 : -1;
+			for (size_t p = 0; p < blocks[lev - 1].size() / 6 && newParent[idx] < 0; p++)
+			{
+				bool bContains = true;
+				for (int d = 0; d < L_DIMS; d++)
+				{
+					if (2 * blocks[lev - 1][6 * p + 2 * d] > blk[6 * b + 2 * d] - 2 || 
+						blk[6 * b + 2 * d + 1] + 2 > 2 * blocks[lev - 1][6 * p + 2 * d + 1])
+						bContains = false;
+				}
+				if (bContains) newParent[idx] = parentSlot[p];
+			}
+			if (newParent[idx] < 0)
+				L_ERROR("Level " + std::to_string(lev) + " Block " + std::to_string(slot[b]) +
+					" has no parent block after regridding. Exiting.", GridUtils::logfile);
+		}
+		parentSlot.swap(slot);
+	}
+
+	// Check which blocks have changed
+	bool bChanged = false;
+	std::vector<char> bBlockChanged(numGrids, 0);
+	for (int idx = 1; idx < numGrids; idx++)
+	{
+		int lev = (idx - 1) % L_NUM_LEVELS + 1, reg = (idx - 1) / L_NUM_LEVELS;
+		if (gm->isActive(lev, reg) != (bNewActive[idx] != 0)) bBlockChanged[idx] = 1;
+		if (bNewActive[idx] && newParent[idx] != gm->parent_region[idx]) bBlockChanged[idx] = 1;
+		for (int d = 0; d < L_DIMS && bNewActive[idx]; d++)
+		{
+			if (std::fabs(newEdges[2 * d + idx * 6] - gm->global_edges[2 * d][idx]) > L_SMALL_NUMBER ||
+				std::fabs(newEdges[2 * d + 1 + idx * 6] - gm->global_edges[2 * d + 1][idx]) > L_SMALL_NUMBER)
+				bBlockChanged[idx] = 1;
+		}
+		if (bBlockChanged[idx]) bChanged = true;
+	}
+	if (!bChanged)
+	{
+		L_INFO("Refined blocks unchanged.", GridUtils::logfile);
+		return false;
+	}
+
+	// Set every block and report those which have changed
+	long oldCells = gm->activeCellCount;
+	for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+	{
+		for (int lev = 1; lev <= L_NUM_LEVELS; ++lev)
+		{
+			int idx = lev + reg * L_NUM_LEVELS;
+			bool bWasActive = gm->isActive(lev, reg);
+			gm->moveSubGrid(lev, reg, newParent[idx], &newEdges[idx * 6]);
+			if (!bBlockChanged[idx]) continue;
+
+			std::string msg = "Level " + std::to_string(lev) + " Block " + std::to_string(reg);
+			if (!bNewActive[idx])
+			{
+				if (bWasActive) L_INFO(msg + " removed.", GridUtils::logfile);
+				continue;
+			}
+			msg += (bWasActive ? " moved to X = [" : " created at X = [") +
+				std::to_string(newEdges[eXMin + idx * 6]) + ", " + std::to_string(newEdges[eXMax + idx * 6]) + "], Y = [" +
+				std::to_string(newEdges[eYMin + idx * 6]) + ", " + std::to_string(newEdges[eYMax + idx * 6]) + "]";
+#if (L_DIMS == 3)
+			msg += ", Z = [" + std::to_string(newEdges[eZMin + idx * 6]) + ", " + std::to_string(newEdges[eZMax + idx * 6]) + "]";
+#endif
+			if (lev > 1) msg += " with parent Block " + std::to_string(newParent[idx]);
+			L_INFO(msg, GridUtils::logfile);
+		}
+	}
+	gm->updateGlobalCellCount();
+
+#ifdef L_BUILD_FOR_MPI
+	// Decompose for the new blocks and send the sites and bodies to their new grids
+#ifdef L_MPI_SMART_DECOMPOSE
+	mpim->mpi_SDGatherIBMSites();
+	mpim->mpi_smartDecompose(L_COARSE_SITE_WIDTH);
+#endif
+	mpim->mpi_redistribute(this, true);
+
+	// Timings before the regrid no longer reflect the load
+	double lbmTime, mpiTime;
+	mpim->mpi_getStepTimes(lbmTime, mpiTime, true);
+#else
+	// Pack the sites of the current grids
+	std::vector<double> records;
+	LBM_packSites(records);
+
+	// Store the grid on which each IB body lives
+	std::vector<int> bodyLev(objman->iBody.size()), bodyReg(objman->iBody.size());
+	for (size_t ib = 0; ib < objman->iBody.size(); ib++)
+	{
+		bodyLev[ib] = objman->iBody[ib]._Owner->level;
+		bodyReg[ib] = objman->iBody[ib]._Owner->region_number;
+	}
+
+	// Store the markers of the BFL bodies which are rebuilt on the new grids
+	std::vector<double> bflMarkers;
+	objman->bfl_packMarkers(bflMarkers);
+
+#ifdef L_PROBE_OUTPUT
+	// Probe mapping points at the current grids so write out what is buffered
+	io_probeFlush();
+#endif
+
+	// Rebuild the hierarchy and carry the data over
+	gm->p_data.clear();
+	LBM_rebuildHierarchy();
+	LBM_unpackSites(records.data(), static_cast<int>(records.size()) / LBM_siteRecordSize(), true);
+	std::vector<double>().swap(records);
+	objman->bfl_buildFromMarkers(bflMarkers);
+
+	// Labels have changed so rebuild the streaming masks and refinement maps
+	LBM_initStreamMask();
+	LBM_initRefinedMaps();
+
+	// Point the bodies at the blocks which now hold them
+	for (size_t ib = 0; ib < objman->iBody.size(); ib++)
+	{
+		int reg = objman->iBody[ib].markers.empty() ? -1 : 
+			gm->getRegion(bodyLev[ib], &objman->iBody[ib].markers[0].position[0]);
+		GridObj *g = nullptr;
+		GridUtils::getGrid(this, bodyLev[ib], (reg >= 0) ? reg : bodyReg[ib], g);
+		objman->iBody[ib]._Owner = g;
+	}
+
+#ifdef L_IBM_ON
+	// Rebuild supports for the new grids
+	if (objman->iBody.size() > 0) objman->ibm_initialise();
+#endif
+
+#ifdef L_PROBE_OUTPUT
+	// Re-map probes without rewriting the file header
+	io_initProbes(false);
+#endif
+#endif
+
+	L_INFO("Regridded. Approximate number of active cells changed from " + std::to_string(oldCells) +
+		" to " + std::to_string(gm->activeCellCount) + ".", GridUtils::logfile);
+	return true;
+}
+
+#endif
@@ -942,8 +942,13 @@ void GridUtils::getGrid(GridObj* const Grids, int level, int region, GridObj*& p
 		// Loop through array of subgrids on this grid getting each one by reference
 		for (GridObj * const G : Grids->subGrid)
 		{
+			// Region of the desired grid or of its ancestor on this level
+			int ancestor = region;
+			for (int lev = level; lev > G->level; lev--)
+				ancestor = GridManager::getInstance()->parent_region[lev + ancestor * L_NUM_LEVELS];
+
 			// Region must match
-			if (G->region_number == region)
+			if (G->region_number == ancestor)
 			{
 				// Look for match on this subgrid
 				GridUtils::getGrid(G, level, region, ptr);
@@ -1749,9 +1754,10 @@ int GridUtils::safeGetRank()
 /// \brief	Method to retireve the sub-grid corresponding to the supplied coarse 
 ///			indices.
 ///
-///			For level 0 grids it is possible to have multiple sub-grids -- one 
-///			for each refinement region. The coalesce operation must get the correct
-///			sub-grid to function properly. For other levels, there is no ambiguity.
+///			A grid may have several sub-grids -- one for each refinement region 
+///			or block it holds. The coalesce operation must get the correct
+///			sub-grid to function properly so the sub-grid whose edges enclose the
+///			coarse site is returned.
 ///			
 /// \param	i		i-index of the coarse site.
 /// \param	j		j-index of the coarse site.
@@ -1766,32 +1772,29 @@ GridObj* GridUtils::getSubGrid(int i, int j, int k, GridObj * parent)
 
 #if (L_NUM_LEVELS > 0)
 
-	if (parent->level == 0)
-	{
-		// Get grid manager
-		GridManager * gm = GridManager::getInstance();
+	// Only one sub-grid so no ambiguity
+	if (parent->subGrid.size() == 1) return parent->subGrid[0];
 
-		// Get grid from region based on edges
-		for (int idx = 1; idx < L_NUM_REGIONS * (L_NUM_LEVELS + 1); idx += L_NUM_LEVELS)
-		{
-			if (
-				gm->global_edges[eXMin][idx] <= gm->Grids->XPos[i] && gm->global_edges[eXMax][idx] >= gm->Grids->XPos[i] &&
-				gm->global_edges[eYMin][idx] <= gm->Grids->YPos[j] && gm->global_edges[eYMax][idx] >= gm->Grids->YPos[j]
+	// Get grid manager
+	GridManager * gm = GridManager::getInstance();
+
+	// Get grid from region based on edges
+	for (GridObj * const c : parent->subGrid)
+	{
+		int idx = c->level + c->region_number * L_NUM_LEVELS;
+		if (
+			gm->global_edges[eXMin][idx] <= parent->XPos[i] && gm->global_edges[eXMax][idx] >= parent->XPos[i] &&
+			gm->global_edges[eYMin][idx] <= parent->YPos[j] && gm->global_edges[eYMax][idx] >= parent->YPos[j]
 #if (L_DIMS == 3)
-				&&
-				gm->global_edges[eZMin][idx] <= gm->Grids->ZPos[k] && gm->global_edges[eZMax][idx] >= gm->Grids->ZPos[k]
+			&&
+			gm->global_edges[eZMin][idx] <= parent->ZPos[k] && gm->global_edges[eZMax][idx] >= parent->ZPos[k]
 #endif
-				)
-			{
-				getGrid(1, (idx - 1) / L_NUM_LEVELS, g);
-				break;
-			}
+			)
+		{
+			g = c;
+			break;
 		}
 	}
-	else
-	{
-		g = parent->subGrid[0];
-	}
 
 #endif
 
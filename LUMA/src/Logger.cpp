@@ -0,0 +1,307 @@
+/*
+* --------------------------------------------------------------
+*
+* ------ Lattice Boltzmann @ The University of Manchester ------
+*
+* -------------------------- L-U-M-A ---------------------------
+*
+* Copyright 2019 The University of Manchester
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.*
+*/
+
+#include "../inc/stdafx.h"
+
+// Static variable declarations
+std::vector<LogBuffer*> Logger::buffers;
+double Logger::lastHandOff = 0.0;
+bool Logger::bAggregate = false;
+std::thread Logger::writer;
+std::mutex Logger::queueMutex;
+std::condition_variable Logger::queueCond;
+std::deque<std::pair<std::streambuf*, std::string>> Logger::queue;
+bool Logger::bWriting = false;
+bool Logger::bStop = false;
+MPI_File Logger::file = MPI_FILE_NULL;
+MPI_Request Logger::request = MPI_REQUEST_NULL;
+std::string Logger::inFlight;
+
+// ************************************************************************** //
+/// \brief	Installs the buffer in a log stream.
+///
+///	\param	stream	stream whose output is buffered.
+///	\param	sink	file buffer the text is written to (nullptr when aggregated).
+///	\param	prefix	text added to the start of each line.
+LogBuffer::LogBuffer(std::ostream &stream, std::streambuf *sink, const std::string &prefix)
+	: stream(stream), sink(sink), prefix(prefix), bLineStart(true)
+{
+	original = stream.rdbuf(this);
+}
+
+// ************************************************************************** //
+/// \brief	Appends a single character.
+///	\param	ch	character to append.
+///	\return	the character or EOF.
+int LogBuffer::overflow(int ch)
+{
+	if (ch == traits_type::eof()) return traits_type::not_eof(ch);
+
+	if (bLineStart) pending += prefix;
+	pending += static_cast<char>(ch);
+	bLineStart = (ch == '\n');
+	return ch;
+}
+
+// ************************************************************************** //
+/// \brief	Appends a sequence of characters adding the prefix to each line.
+///	\param	s	characters to append.
+///	\param	n	number of characters.
+///	\return	number of characters appended.
+std::streamsize LogBuffer::xsputn(const char *s, std::streamsize n)
+{
+	std::streamsize i = 0;
+	while (i < n)
+	{
+		if (bLineStart) pending += prefix;
+		const char *nl = static_cast<const char*>(memchr(s + i, '\n', static_cast<size_t>(n - i)));
+		std::streamsize end = (nl != nullptr) ? (nl - s) + 1 : n;
+		pending.append(s + i, static_cast<size_t>(end - i));
+		bLineStart = (nl != nullptr);
+		i = end;
+	}
+	return n;
+}
+
+// ************************************************************************** //
+/// \brief	Called on std::endl and std::flush. Lets the Logger decide whether
+///			to hand the text off rather than writing it every line.
+///	\return	0 (success).
+int LogBuffer::sync()
+{
+	Logger::lineEnded(*this);
+	return 0;
+}
+
+// ************************************************************************** //
+/// \brief	Opens a log and buffers the stream writing to it.
+///
+///			The stream is opened as <name>_rank<N>.log in the output directory
+///			unless the logs are aggregated, in which case the first call opens
+///			log_all.log on all ranks and the stream itself is never opened.
+///			With MPI this must be called by all ranks in the same order.
+///
+///	\param	stream	log stream to open.
+///	\param	name	name of the log.
+///	\return	true if the log was opened.
+bool Logger::attach(std::ofstream &stream, const std::string &name)
+{
+	static bool bRegistered = false;
+	int rank = 0;
+#ifdef L_BUILD_FOR_MPI
+	// Not safeGetRank() since this may be called while the MpiManager is constructed
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+	// Set up on first use
+	if (buffers.empty())
+	{
+		if (!bRegistered)
+		{
+			std::atexit(_closeAtExit);
+			bRegistered = true;
+		}
+		lastHandOff = Profiler::now();
+
+#ifdef L_BUILD_FOR_MPI
+		// Collective open of the aggregated log
+		bAggregate = false;
+		if (L_LOG_AGGREGATE)
+		{
+			std::string path = GridUtils::path_str + "/log_all.log";
+			bAggregate = (MPI_File_open(MPI_COMM_WORLD, &path[0],
+				MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &file) == MPI_SUCCESS);
+		}
+#endif
+
+		// Per-rank logs are written by the writer thread
+		if (!bAggregate) writer = std::thread(_write);
+	}
+
+	// Buffer the stream
+	std::string log = name + "_rank" + std::to_string(rank);
+	if (bAggregate)
+	{
+		buffers.push_back(new LogBuffer(stream, nullptr, log + ": "));
+	}
+	else
+	{
+		stream.open(GridUtils::path_str + "/" + log + ".log", std::ios::out);
+		if (!stream.is_open()) return false;
+		buffers.push_back(new LogBuffer(stream, stream.rdbuf(), ""));
+	}
+	return true;
+}
+
+// ************************************************************************** //
+/// \brief	Hands off the buffered text if the flush interval has passed or
+///			the buffer is full.
+///	\param	buffer	buffer of the stream which ended a line.
+void Logger::lineEnded(LogBuffer &buffer)
+{
+	if (buffer.pending.size() >= L_LOG_BUFFER_BYTES ||
+		Profiler::now() - lastHandOff >= L_LOG_FLUSH_INTERVAL)
+		_handOff();
+}
+
+// ************************************************************************** //
+/// \brief	Writes all buffered text and waits for it to reach the file.
+///
+///			Called on errors so nothing is lost when the application exits.
+void Logger::flush()
+{
+	if (buffers.empty()) return;
+	_handOff();
+
+#ifdef L_BUILD_FOR_MPI
+	if (bAggregate)
+	{
+		MPI_Wait(&request, MPI_STATUS_IGNORE);
+		return;
+	}
+#endif
+
+	std::unique_lock<std::mutex> lock(queueMutex);
+	queueCond.wait(lock, [] { return queue.empty() && !bWriting; });
+}
+
+// ************************************************************************** //
+/// \brief	Flushes and detaches all logs.
+///
+///			The streams get their own file buffers back so anything written
+///			after this goes straight to the per-rank files as before.
+///
+///	\param	bCollective	all ranks are closing together so the aggregated
+///						log can be closed (false on an error on one rank).
+void Logger::close(bool bCollective)
+{
+	if (buffers.empty()) return;
+
+	// Nothing more can be written to the aggregated log once MPI has finalised
+	bool bCanWrite = true;
+#ifdef L_BUILD_FOR_MPI
+	int bFinalized;
+	MPI_Finalized(&bFinalized);
+	bCanWrite = !(bAggregate && bFinalized);
+#endif
+	if (bCanWrite) flush();
+
+	// Stop the writer
+	if (!bAggregate)
+	{
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			bStop = true;
+		}
+		queueCond.notify_all();
+		writer.join();
+		bStop = false;
+	}
+
+	// Restore the streams
+	for (LogBuffer *b : buffers)
+	{
+		b->stream.rdbuf(b->original);
+		delete b;
+	}
+	buffers.clear();
+
+#ifdef L_BUILD_FOR_MPI
+	if (bAggregate && bCollective && bCanWrite) MPI_File_close(&file);
+#endif
+	bAggregate = false;
+}
+
+// ************************************************************************** //
+/// \brief	Moves the buffered text of all logs to the writer.
+///
+///			For per-rank logs the text is queued for the writer thread. For
+///			the aggregated log the text of all streams is written with a
+///			single non-blocking write on the shared file pointer after the
+///			previous write has completed.
+void Logger::_handOff()
+{
+	lastHandOff = Profiler::now();
+
+#ifdef L_BUILD_FOR_MPI
+	if (bAggregate)
+	{
+		std::string text;
+		for (LogBuffer *b : buffers)
+		{
+			text += b->pending;
+			b->pending.clear();
+		}
+		if (text.empty()) return;
+
+		MPI_Wait(&request, MPI_STATUS_IGNORE);
+		inFlight.swap(text);
+		MPI_File_iwrite_shared(file, &inFlight[0], static_cast<int>(inFlight.size()), MPI_CHAR, &request);
+		return;
+	}
+#endif
+
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		for (LogBuffer *b : buffers)
+		{
+			if (b->pending.empty()) continue;
+			queue.emplace_back(b->sink, std::string());
+			queue.back().second.swap(b->pending);
+		}
+	}
+	queueCond.notify_all();
+}
+
+// ************************************************************************** //
+/// \brief	Writer thread for the per-rank logs.
+///
+///			Writes queued text to the file buffers until told to stop and the
+///			queue is empty.
+void Logger::_write()
+{
+	std::unique_lock<std::mutex> lock(queueMutex);
+	while (true)
+	{
+		queueCond.wait(lock, [] { return bStop || !queue.empty(); });
+		if (queue.empty()) break;
+
+		std::pair<std::streambuf*, std::string> item = std::move(queue.front());
+		queue.pop_front();
+		bWriting = true;
+		lock.unlock();
+
+		item.first->sputn(item.second.data(), static_cast<std::streamsize>(item.second.size()));
+		item.first->pubsync();
+
+		lock.lock();
+		bWriting = false;
+		queueCond.notify_all();
+	}
+}
+
+// ************************************************************************** //
+/// \brief	Flushes the logs if the application exits without closing them.
+void Logger::_closeAtExit()
+{
+	close(false);
+}
@@ -22,6 +22,7 @@
 
 #include "../inc/stdafx.h"
 #include "../inc/GridObj.h"
+#include "../inc/ObjectManager.h"
 
 // Static declarations
 MpiManager* MpiManager::me;
@@ -51,8 +52,8 @@ MpiManager::MpiManager()
 #endif
 
 	// Resize buffer arrays based on number of MPI directions
-	f_buffer_send.resize(L_MPI_DIRS, std::vector<double>(0));
-	f_buffer_recv.resize(L_MPI_DIRS, std::vector<double>(0));	
+	f_buffer_send.resize(L_MPI_DIRS, std::vector<popType>(0));
+	f_buffer_recv.resize(L_MPI_DIRS, std::vector<popType>(0));	
 
 	// Initialise the manager, grid information and topology
 	mpi_init();
@@ -62,6 +63,8 @@ MpiManager::MpiManager()
 	markerCommMarkerSide.resize(L_NUM_LEVELS+1);
 	supportCommMarkerSide.resize(L_NUM_LEVELS+1);
 	supportCommSupportSide.resize(L_NUM_LEVELS+1);
+	forceNeighbours.resize(L_NUM_LEVELS+1);
+	markerNeighbours.resize(L_NUM_LEVELS+1);
 }
 
 /// \brief	Default destructor.
@@ -159,8 +162,8 @@ void MpiManager::mpi_init()
 
 #ifdef L_MPI_VERBOSE
 	
-	// Open logfile now my_rank has been assigned
-	logout->open( GridUtils::path_str + "/mpi_log_rank" + std::to_string(my_rank) + ".log", std::ios::out );
+	// Open logfile now the output directory is known
+	Logger::attach(*logout, "mpi_log");
 
 #endif	
 
@@ -260,6 +263,23 @@ void MpiManager::mpi_gridbuild(GridManager* const grid_man)
 	L_INFO(msg, logout); msg.clear();
 #endif
 
+	// Set local sizes, core edges and layer positions from the block sizes
+	mpi_setBlockLayout(grid_man);
+}
+
+// ************************************************************************* //
+/// \brief	Set the layout of the blocks from the block sizes.
+///
+///			Uses the block sizes in cRankSizeX/Y/Z to set the local grid size 
+///			in the grid manager, the positions of the core edges of every rank 
+///			and the sender and receiver layer positions on this rank. Called by 
+///			all ranks.
+///
+///	\param	grid_man	Pointer to an initialised grid manager.
+void MpiManager::mpi_setBlockLayout(GridManager* const grid_man)
+{
+	double dh = L_COARSE_SITE_WIDTH;
+
 	// Compute required local grid size to pass to grid manager //
 	std::vector<int> local_size;
 
@@ -631,7 +651,7 @@ void MpiManager::mpi_writeout_buf( std::string filename, int dir ) {
 void MpiManager::mpi_communicate(int lev, int reg) {
 
 	// Wall clock variables
-	clock_t t_start, t_end, secs;
+	double t_start, secs;
 
 	// Tag
 	int TAG;
@@ -671,7 +691,7 @@ void MpiManager::mpi_communicate(int lev, int reg) {
 	* we use the MPI Manager class to hold the buffer in house. */
 
 	// Start the clock
-	t_start = clock();
+	t_start = Profiler::now();
 
 	// Loop over directions in Cartesian topology
 	for (int dir = 0; dir < L_MPI_DIRS; dir++)
@@ -700,7 +720,9 @@ void MpiManager::mpi_communicate(int lev, int reg) {
 		if (f_buffer_send[dir].size()) {
 
 			// Pass direction and Grid by reference and pack if required
+			L_PROF_START(t_pack);
 			mpi_buffer_pack( dir, Grid );
+			L_PROF_STOP(t_pack, eProfMPIPack, Grid->level, Grid->region_number);
 		
 
 			///////////////
@@ -715,7 +737,7 @@ void MpiManager::mpi_communicate(int lev, int reg) {
 								<< " sites to Rank " << neighbour_rank[dir] << " with tag " << TAG << "." << std::endl;
 #endif
 			// Post send message to message queue and log request handle in array
-			MPI_Isend( &f_buffer_send[dir].front(), static_cast<int>(f_buffer_send[dir].size()), MPI_DOUBLE, neighbour_rank[dir], 
+			MPI_Isend( &f_buffer_send[dir].front(), static_cast<int>(f_buffer_send[dir].size()), L_MPI_POP_TYPE, neighbour_rank[dir], 
 				TAG, world_comm, &send_requests[send_count-1] );
 
 #ifdef L_MPI_VERBOSE
@@ -748,8 +770,10 @@ void MpiManager::mpi_communicate(int lev, int reg) {
 #endif
 
 			// Use a blocking receive call if required
-			MPI_Recv( &f_buffer_recv[dir].front(), static_cast<int>(f_buffer_recv[dir].size()), MPI_DOUBLE, neighbour_rank[opp_dir], 
+			L_PROF_START(t_recv);
+			MPI_Recv( &f_buffer_recv[dir].front(), static_cast<int>(f_buffer_recv[dir].size()), L_MPI_POP_TYPE, neighbour_rank[opp_dir], 
 				TAG, world_comm, &recv_stat );
+			L_PROF_STOP(t_recv, eProfMPIWait, Grid->level, Grid->region_number);
 
 #ifdef L_MPI_VERBOSE
 			*logout << "Direction " << dir << " --> Received." << std::endl;
@@ -760,7 +784,9 @@ void MpiManager::mpi_communicate(int lev, int reg) {
 			///////////////////////////
 
 			// Pass direction and Grid by reference
+			L_PROF_START(t_unpack);
 			mpi_buffer_unpack( dir, Grid );
+			L_PROF_STOP(t_unpack, eProfMPIUnpack, Grid->level, Grid->region_number);
 
 		}
 
@@ -786,16 +812,17 @@ void MpiManager::mpi_communicate(int lev, int reg) {
 	/* Wait until other processes have handled all the sends from this rank
 	 * Note that calls to this command destroy the handles once complete so
 	 * do not need to clear the array afterward. */
+	L_PROF_START(t_wait);
 	MPI_Waitall(send_count,send_requests,send_stat);
+	L_PROF_STOP(t_wait, eProfMPIWait, Grid->level, Grid->region_number);
 
 
 	// Print Time of MPI comms
-	t_end = clock();
-	secs = t_end - t_start;
+	secs = Profiler::now() - t_start;
 
 	// Update average MPI overhead time for this particular grid
 	Grid->timeav_mpi_overhead *= (Grid->t-1);
-	Grid->timeav_mpi_overhead += ((double)secs)/CLOCKS_PER_SEC;
+	Grid->timeav_mpi_overhead += secs;
 	Grid->timeav_mpi_overhead /= Grid->t;
 
 #ifdef L_TEXTOUT
@@ -1360,7 +1387,8 @@ bool MpiManager::mpi_SDCheckDelta(SDData& solutionData, double dh, std::vector<i
 }
 
 // ************************************************************************* //
-/// \brief	Reassembles the solutions vectors given the vector of variable block edges.
+/// \brief	Reassembles the solutions vectors given the vector of perturbed
+///			variable block edges.
 ///
 ///	\param	solutionData	structure to hold SD information.
 ///	\param	numCores		reference to vector holding core topology.
@@ -1371,17 +1399,17 @@ void MpiManager::mpi_SDReconstructSolution(SDData& solutionData, std::vector<int
 	int i = 0;
 	for (i = 1; i < numCores[eXDirection]; ++i)
 	{
-		solutionData.XSol[i] = solutionData.theta[c];
+		solutionData.XSol[i] = solutionData.thetaNew[c];
 		c++;
 	}
 	for (i = 1; i < numCores[eYDirection]; ++i)
 	{
-		solutionData.YSol[i] = solutionData.theta[c];
+		solutionData.YSol[i] = solutionData.thetaNew[c];
 		c++;
 	}
 	for (i = 1; i < numCores[eZDirection]; ++i)
 	{
-		solutionData.ZSol[i] = solutionData.theta[c];
+		solutionData.ZSol[i] = solutionData.thetaNew[c];
 		c++;
 	}
 
@@ -1400,11 +1428,11 @@ void MpiManager::mpi_SDReconstructSolution(SDData& solutionData, std::vector<int
 void MpiManager::mpi_SDComputeImbalance(LoadImbalanceData& load,
 	SDData& solutionData, std::vector<int>& numCores)
 {
-	size_t count = 0;
-	size_t countMax = 0;
-	size_t countMin = std::numeric_limits<size_t>::max();
+	double count = 0.0;
+	double countMax = 0.0;
+	double countMin = std::numeric_limits<double>::max();
 
-	// Construct bounds for each block and then find active cell count from grid manager
+	// Construct bounds for each block and then find block cost from grid manager
 	double bounds[6];
 	for (int i = 0; i < numCores[eXDirection]; ++i)
 	{
@@ -1420,8 +1448,8 @@ void MpiManager::mpi_SDComputeImbalance(LoadImbalanceData& load,
 				bounds[eZMin] = solutionData.ZSol[k];
 				bounds[eZMax] = solutionData.ZSol[k + 1];
 
-				// Get active operation count
-				count = GridManager::getInstance()->getActiveCellCount(&bounds[0], true);
+				// Get weighted operation count
+				count = GridManager::getInstance()->getBlockCost(&bounds[0]);
 
 				// Update the extremes
 				if (count > countMax)
@@ -1438,9 +1466,8 @@ void MpiManager::mpi_SDComputeImbalance(LoadImbalanceData& load,
 	}
 
 	// Update load imbalance
-	load.loadImbalance = 
-		std::abs(static_cast<double>(countMax) - static_cast<double>(countMin)) * 100.0 / static_cast<double>(countMax);
-	load.heaviestOps = countMax;
+	load.loadImbalance = std::abs(countMax - countMin) * 100.0 / countMax;
+	load.heaviestOps = static_cast<size_t>(std::round(countMax));
 
 }
 
@@ -1449,7 +1476,12 @@ void MpiManager::mpi_SDComputeImbalance(LoadImbalanceData& load,
 ///			load balance.
 ///
 ///			This method is independent of the topology in use. Topologies of custom
-///			dimensions can be passed through the optional argument.
+///			dimensions can be passed through the optional argument. Block costs 
+///			are looked up from the cost table of the grid manager so each costs 
+///			O(1). Called by all ranks. For the decomposition of this run the 
+///			step lengths tried at each iteration are shared between the ranks 
+///			and the best step is found with a reduction. For a topology report 
+///			each rank computes the cases it was given on its own.
 ///
 ///	\param	reqDims		pointer to a vector containing the desired MPI dimensions.
 ///	\param	dh			size of a voxel on the coarsest grid.
@@ -1477,151 +1509,204 @@ MpiManager::LoadImbalanceData MpiManager::mpi_smartDecompose(double dh, std::vec
 
 	// Create imbalance structure
 	LoadImbalanceData load;
+	bool bDistributed = (reqDims.size() == 0);
 
-	// Only rank 0 does the calculation and result is pushed to other ranks
-	if (my_rank == 0)
+	// Read cost model inputs if present and tabulate the cost (once for a report)
+	GridManager *gm = GridManager::getInstance();
+	gm->loadCostModel();
+	if (bDistributed || gm->costTable.empty()) gm->buildCostTable();
+
+	// Data
+	int p = (numCores[eXDirection] + numCores[eYDirection] + numCores[eZDirection]) - 3;	// Number of unknowns
+	int i = 0;
+	int c = 0;
+	std::vector<int> domainSize(3);
+	domainSize[eXDirection] = L_N;
+	domainSize[eYDirection] = L_M;
+	domainSize[eZDirection] = L_K;
+
+	// Fix the edges as we know where they are
+	solutionData.XSol[0] = 0.0;
+	solutionData.YSol[0] = 0.0;
+	solutionData.ZSol[0] = 0.0;
+	solutionData.XSol.back() = GridManager::getInstance()->global_edges[eXMax][0];
+	solutionData.YSol.back() = GridManager::getInstance()->global_edges[eYMax][0];
+	solutionData.ZSol.back() = GridManager::getInstance()->global_edges[eZMax][0];
+
+	// Handle the 1, 1, 1 case
+	if (p == 0)
 	{
-		// Data
-		int p = (numCores[eXDirection] + numCores[eYDirection] + numCores[eZDirection]) - 3;	// Number of unknowns
-		int i = 0;
-		int c = 0;
-		std::vector<int> domainSize(3);
-		domainSize[eXDirection] = L_N;
-		domainSize[eYDirection] = L_M;
-		domainSize[eZDirection] = L_K;
-
-		// Fix the edges as we know where they are
-		solutionData.XSol[0] = 0.0;
-		solutionData.YSol[0] = 0.0;
-		solutionData.ZSol[0] = 0.0;
-		solutionData.XSol.back() = GridManager::getInstance()->global_edges[eXMax][0];
-		solutionData.YSol.back() = GridManager::getInstance()->global_edges[eYMax][0];
-		solutionData.ZSol.back() = GridManager::getInstance()->global_edges[eZMax][0];
-
-		// Handle the 1, 1, 1 case
-		if (p == 0)
-		{
-			// Communicate information around topology if not performing a report
-			if (!reqDims.size()) mpi_SDCommunicateSolution(solutionData, load.loadImbalance, dh);
+		// Communicate information around topology if not performing a report
+		if (!reqDims.size()) mpi_SDCommunicateSolution(solutionData, load.loadImbalance, dh);
 
-			// Return as no need to perform the iteration
-			return load;
-		}
+		// Return as no need to perform the iteration
+		return load;
+	}
 
-		// Create theta vector with initial guesses (uniform decomposition)
-		solutionData.theta.resize(p, 0.0);
-		solutionData.thetaNew = solutionData.theta;
-		for (int d = 0; d < 3; ++d)
-		{
-			// Coarse sites in a block if decomposed uniformly
-			int uniSpace = static_cast<int>(std::round(domainSize[d] / numCores[d]));
+	// Create theta vector with initial guesses (uniform decomposition)
+	solutionData.theta.resize(p, 0.0);
+	solutionData.thetaNew = solutionData.theta;
+	for (int d = 0; d < 3; ++d)
+	{
+		// Coarse sites in a block if decomposed uniformly
+		int uniSpace = static_cast<int>(std::round(domainSize[d] / numCores[d]));
 
-			// Upper edge of block is a variable
-			for (i = 0; i < numCores[d] - 1; ++i)
-			{
-				solutionData.theta[c] = (i + 1) * uniSpace * dh;
-				c++;
-			}
+		// Upper edge of block is a variable
+		for (i = 0; i < numCores[d] - 1; ++i)
+		{
+			solutionData.theta[c] = (i + 1) * uniSpace * dh;
+			c++;
 		}
+	}
 
-		// Perturbation vector
-		solutionData.delta.resize(p, 0);
+	// Perturbation vector
+	solutionData.delta.resize(p, 0);
 
-		// Populate initial solution vectors and imbalance from uniform decomposition
-		mpi_SDCheckDelta(solutionData, dh, numCores);
-		mpi_SDComputeImbalance(load, solutionData, numCores);
+	// Populate initial solution vectors and imbalance from uniform decomposition
+	mpi_SDCheckDelta(solutionData, dh, numCores);
+	mpi_SDComputeImbalance(load, solutionData, numCores);
 
-		// Update uniform decomposition quantity
-		load.uniImbalance = load.loadImbalance;
+	// Update uniform decomposition quantity
+	load.uniImbalance = load.loadImbalance;
 #ifndef L_MPI_TOPOLOGY_REPORT
-		L_INFO("Uniform decomposition produces an imbalance of " + std::to_string(load.uniImbalance) + "%.", GridUtils::logfile);
+	L_INFO("Uniform decomposition produces an imbalance of " + std::to_string(load.uniImbalance) + "%.", GridUtils::logfile);
 #endif
 
-		// Temporaries
-		SDData tempData(solutionData);		// Make a copy
-		LoadImbalanceData tmpLoad(load);	// Make a copy
+	// Temporaries
+	SDData tempData(solutionData);		// Make a copy
+	LoadImbalanceData tmpLoad(load);	// Make a copy
 
-		// Start iteration
-		int k = 0;
-		double midHeavyBlockX, midHeavyBlockY, midHeavyBlockZ;
-		double midCurrentBlockX, midCurrentBlockY, midCurrentBlockZ;
-		double dirX, dirY, dirZ;
-		while (k < L_MPI_SD_MAX_ITER)
+	/* Steps of 1, 2, ... coarse sites along the perturbation are tried at 
+	 * each iteration, shared round robin between the ranks. Steps wider 
+	 * than a uniform block are not tried. */
+	int numSteps = 1, stepRank = 0, stepStride = 1;
+	if (bDistributed)
+	{
+		int maxStep = 1;
+		for (int d = 0; d < L_DIMS; ++d)
 		{
+			if (numCores[d] > 1) maxStep = std::max(maxStep, domainSize[d] / numCores[d]);
+		}
+		numSteps = std::min(num_ranks, maxStep);
+		stepRank = my_rank;
+		stepStride = num_ranks;
+	}
+	struct { double imbalance; int step; } localBest, best;
+	LoadImbalanceData stepLoad;
+
+	// Start iteration
+	int k = 0;
+	double midHeavyBlockX, midHeavyBlockY, midHeavyBlockZ;
+	double midCurrentBlockX, midCurrentBlockY, midCurrentBlockZ;
+	double dirX, dirY, dirZ;
+	while (k < L_MPI_SD_MAX_ITER)
+	{
 
-			// Set perturbation directions by driving towards heaviest block
-			midHeavyBlockX =
-				(tempData.XSol[tmpLoad.heaviestBlock[eXDirection] + 1] + tempData.XSol[tmpLoad.heaviestBlock[eXDirection]]) / 2.0;
-			midHeavyBlockY =
-				(tempData.YSol[tmpLoad.heaviestBlock[eYDirection] + 1] + tempData.YSol[tmpLoad.heaviestBlock[eYDirection]]) / 2.0;
-			midHeavyBlockZ =
-				(tempData.ZSol[tmpLoad.heaviestBlock[eZDirection] + 1] + tempData.ZSol[tmpLoad.heaviestBlock[eZDirection]]) / 2.0;
+		// Set perturbation directions by driving towards heaviest block
+		midHeavyBlockX =
+			(tempData.XSol[tmpLoad.heaviestBlock[eXDirection] + 1] + tempData.XSol[tmpLoad.heaviestBlock[eXDirection]]) / 2.0;
+		midHeavyBlockY =
+			(tempData.YSol[tmpLoad.heaviestBlock[eYDirection] + 1] + tempData.YSol[tmpLoad.heaviestBlock[eYDirection]]) / 2.0;
+		midHeavyBlockZ =
+			(tempData.ZSol[tmpLoad.heaviestBlock[eZDirection] + 1] + tempData.ZSol[tmpLoad.heaviestBlock[eZDirection]]) / 2.0;
 
-			for (int i = 0; i < numCores[eXDirection]; i++)
+		for (int i = 0; i < numCores[eXDirection]; i++)
+		{
+			for (int j = 0; j < numCores[eYDirection]; j++)
 			{
-				for (int j = 0; j < numCores[eYDirection]; j++)
+				for (int k = 0; k < numCores[eZDirection]; k++)
 				{
-					for (int k = 0; k < numCores[eZDirection]; k++)
-					{
-						if (
-							i == numCores[eXDirection] - 1 || j == numCores[eYDirection] - 1
+					if (
+						i == numCores[eXDirection] - 1 || j == numCores[eYDirection] - 1
 #if (L_DIMS == 3)
-							|| k == numCores[eZDirection] - 1
+						|| k == numCores[eZDirection] - 1
 #endif
-							) continue;
+						) continue;
 
-						// Compute middle of current block
-						midCurrentBlockX = (tempData.XSol[i + 1] + tempData.XSol[i]) / 2.0;
-						midCurrentBlockY = (tempData.YSol[j + 1] + tempData.YSol[j]) / 2.0;
-						midCurrentBlockZ = (tempData.ZSol[k + 1] + tempData.ZSol[k]) / 2.0;
+					// Compute middle of current block
+					midCurrentBlockX = (tempData.XSol[i + 1] + tempData.XSol[i]) / 2.0;
+					midCurrentBlockY = (tempData.YSol[j + 1] + tempData.YSol[j]) / 2.0;
+					midCurrentBlockZ = (tempData.ZSol[k + 1] + tempData.ZSol[k]) / 2.0;
 
-						// Compute direction to heaviest block
-						dirX = midHeavyBlockX - midCurrentBlockX;
-						dirY = midHeavyBlockY - midCurrentBlockY;
-						dirZ = midHeavyBlockZ - midCurrentBlockZ;
+					// Compute direction to heaviest block
+					dirX = midHeavyBlockX - midCurrentBlockX;
+					dirY = midHeavyBlockY - midCurrentBlockY;
+					dirZ = midHeavyBlockZ - midCurrentBlockZ;
 
-						// Set deltas					
-						if (dirX == 0)
-							tempData.delta[i] = -dh;
-						else
-							tempData.delta[i] = (dirX / std::fabs(dirX)) * dh;
+					// Set deltas					
+					if (dirX == 0)
+						tempData.delta[i] = -dh;
+					else
+						tempData.delta[i] = (dirX / std::fabs(dirX)) * dh;
 
-						if (dirY == 0)
-							tempData.delta[numCores[eXDirection] - 1 + j] = -dh;
-						else
-							tempData.delta[numCores[eXDirection] - 1 + j] = (dirY / std::fabs(dirY)) * dh;
+					if (dirY == 0)
+						tempData.delta[numCores[eXDirection] - 1 + j] = -dh;
+					else
+						tempData.delta[numCores[eXDirection] - 1 + j] = (dirY / std::fabs(dirY)) * dh;
 
 #if (L_DIMS == 3)
-						if (dirZ == 0)
-							tempData.delta[numCores[eXDirection] + numCores[eYDirection] - 2 + k] = -dh;
-						else
-							tempData.delta[numCores[eXDirection] + numCores[eYDirection] - 2 + k] = (dirZ / std::fabs(dirZ)) * dh;
+					if (dirZ == 0)
+						tempData.delta[numCores[eXDirection] + numCores[eYDirection] - 2 + k] = -dh;
+					else
+						tempData.delta[numCores[eXDirection] + numCores[eYDirection] - 2 + k] = (dirZ / std::fabs(dirZ)) * dh;
 #endif
-					}
 				}
 			}
+		}
 
-			// Check and adjust delta if necessary
-			mpi_SDCheckDelta(tempData, dh, numCores);
-
-			// Obtain new imbalance under the adjusted delta
-			mpi_SDComputeImbalance(tmpLoad, tempData, numCores);
+		// Try the steps assigned to this rank along the unit perturbation
+		std::vector<double> unitDelta(tempData.delta);
+		localBest.imbalance = std::numeric_limits<double>::max();
+		localBest.step = 0;
+		for (int n = stepRank; n < numSteps; n += stepStride)
+		{
+			SDData stepData(tempData);
+			for (size_t v = 0; v < unitDelta.size(); ++v) stepData.delta[v] = (n + 1) * unitDelta[v];
+			mpi_SDCheckDelta(stepData, dh, numCores);
+
+			// Longer steps must leave every block at least a site wide
+			bool bValid = true;
+			for (int i = 0; i < numCores[eXDirection]; ++i)
+				if (stepData.XSol[i + 1] - stepData.XSol[i] < dh) bValid = false;
+			for (int j = 0; j < numCores[eYDirection]; ++j)
+				if (stepData.YSol[j + 1] - stepData.YSol[j] < dh) bValid = false;
+#if (L_DIMS == 3)
+			for (int k = 0; k < numCores[eZDirection]; ++k)
+				if (stepData.ZSol[k + 1] - stepData.ZSol[k] < dh) bValid = false;
+#endif
+			if (n > 0 && !bValid) continue;
 
-			// If better than current solution, update
-			if (tmpLoad.loadImbalance <= load.loadImbalance)
+			mpi_SDComputeImbalance(stepLoad, stepData, numCores);
+			if (stepLoad.loadImbalance < localBest.imbalance)
 			{
-				load.loadImbalance = tmpLoad.loadImbalance;
-				solutionData.XSol = tempData.XSol;
-				solutionData.YSol = tempData.YSol;
-				solutionData.ZSol = tempData.ZSol;
+				localBest.imbalance = stepLoad.loadImbalance;
+				localBest.step = n;
 			}
+		}
 
-			// Update theta
-			tempData.theta = tempData.thetaNew;
+		// Find the best step over all ranks (shortest step on a tie)
+		best = localBest;
+		if (bDistributed) MPI_Allreduce(&localBest, &best, 1, MPI_DOUBLE_INT, MPI_MINLOC, world_comm);
 
-			// Increment k
-			k++;
+		// Take the best step on every rank
+		for (size_t v = 0; v < unitDelta.size(); ++v) tempData.delta[v] = (best.step + 1) * unitDelta[v];
+		mpi_SDCheckDelta(tempData, dh, numCores);
+		mpi_SDComputeImbalance(tmpLoad, tempData, numCores);
+
+		// If better than current solution, update
+		if (tmpLoad.loadImbalance <= load.loadImbalance)
+		{
+			load.loadImbalance = tmpLoad.loadImbalance;
+			solutionData.XSol = tempData.XSol;
+			solutionData.YSol = tempData.YSol;
+			solutionData.ZSol = tempData.ZSol;
 		}
+
+		// Update theta
+		tempData.theta = tempData.thetaNew;
+
+		// Increment k
+		k++;
 	}
 
 	// Communicate information around topology if not performing a report
@@ -1698,8 +1783,9 @@ void MpiManager::mpi_SDCommunicateSolution(SDData& solutionData, double imbalanc
 /// \brief	Writes a report on imbalances from different decomposition topologies.
 ///
 ///			This method terminates the application on completion. Only compatible
-///			with smart decomposition at present. Uses the values of L_MPI_?CORES
-///			as the upper threshold for options.
+///			with smart decomposition at present. Uses the values of L_MPI_TOP_?CORES
+///			as the upper threshold for options. Called by all ranks which share
+///			the cases between them. The report is written by rank 0.
 ///
 ///	\param	dh			coarse cell spacing.
 void MpiManager::mpi_reportOnDecomposition(double dh)
@@ -1712,11 +1798,29 @@ void MpiManager::mpi_reportOnDecomposition(double dh)
 
 	L_WARN("Topology report mode enabled. No simulation will take place.", GridUtils::logfile);
 
+	/* Cases are independent so are shared round robin between the ranks.
+	 * Each rank stores imbalance, uniform imbalance and heaviest block 
+	 * operations for its cases which are summed on rank 0. */
+	int numCases = L_MPI_TOP_XCORES * L_MPI_TOP_YCORES * L_MPI_TOP_ZCORES;
+	std::vector<double> results(3 * numCases, 0.0);
+	std::vector<double> allResults(3 * numCases, 0.0);
+	std::vector<int> coreCombo(3);
+	for (int n = my_rank; n < numCases; n += num_ranks)
+	{
+		coreCombo[eXDirection] = n / (L_MPI_TOP_ZCORES * L_MPI_TOP_YCORES) + 1;
+		coreCombo[eYDirection] = (n / L_MPI_TOP_ZCORES) % L_MPI_TOP_YCORES + 1;
+		coreCombo[eZDirection] = n % L_MPI_TOP_ZCORES + 1;
+		LoadImbalanceData load;
+		load = mpi_smartDecompose(dh, coreCombo);
+		results[3 * n] = load.loadImbalance;
+		results[3 * n + 1] = load.uniImbalance;
+		results[3 * n + 2] = static_cast<double>(load.heaviestOps);
+	}
+	MPI_Reduce(&results[0], &allResults[0], 3 * numCases, MPI_DOUBLE, MPI_SUM, 0, world_comm);
+
 	if (my_rank == 0)
 	{
 		// Declarations
-		std::vector<int> coreCombo(3);
-		std::string logInfo;
 		std::ofstream reportFile;
 		reportFile.open(GridUtils::path_str + "/topologyreport.out", std::ios::out);
 		if (!reportFile.is_open()) L_ERROR("Could not open topology report file. Exiting.", GridUtils::logfile);
@@ -1732,23 +1836,17 @@ void MpiManager::mpi_reportOnDecomposition(double dh)
 			{
 				for (int k = 1; k < L_MPI_TOP_ZCORES + 1; ++k)
 				{
-					coreCombo[eXDirection] = i;
-					coreCombo[eYDirection] = j;
-					coreCombo[eZDirection] = k;
-					LoadImbalanceData load;
-					load = mpi_smartDecompose(dh, coreCombo);
+					int n = (k - 1) + (j - 1) * L_MPI_TOP_ZCORES + (i - 1) * L_MPI_TOP_ZCORES * L_MPI_TOP_YCORES;
 
 					// Log information
-					reportFile << std::to_string(
-						(k - 1) + (j - 1) * L_MPI_TOP_ZCORES + (i - 1) * L_MPI_TOP_ZCORES * L_MPI_TOP_YCORES
-						) + "\t";
+					reportFile << std::to_string(n) + "\t";
 					reportFile << std::to_string(i) + "\t";
 					reportFile << std::to_string(j) + "\t";
 					reportFile << std::to_string(k) + "\t";
 					reportFile << std::to_string(i * j * k) + "\t";
-					reportFile << std::to_string(load.loadImbalance) + "\t";
-					reportFile << std::to_string(load.uniImbalance) + "\t";
-					reportFile << std::to_string(load.heaviestOps);
+					reportFile << std::to_string(allResults[3 * n]) + "\t";
+					reportFile << std::to_string(allResults[3 * n + 1]) + "\t";
+					reportFile << std::to_string(static_cast<size_t>(allResults[3 * n + 2]));
 					reportFile << std::endl;
 				}
 			}
@@ -1761,10 +1859,352 @@ void MpiManager::mpi_reportOnDecomposition(double dh)
 	MPI_Barrier(world_comm);
 
 	// Exit
+	Logger::close();
 	MPI_Finalize();
 	exit(EXIT_SUCCESS);
 }
 
+// ************************************************************************** //
+/// \brief	Get the measured time per coarse time step on this rank.
+///
+///			Time spent in the LBM kernel and in MPI communication by each grid 
+///			is recovered from the running averages and scaled by the number of 
+///			sub-cycles per coarse time step. Times are averaged over the window 
+///			since the marks were last reset (or the start of the simulation).
+///
+///	\param	lbmTime	time per coarse step spent in the LBM kernel.
+///	\param	mpiTime	time per coarse step spent in MPI communication.
+///	\param	bReset	flag to reset the marks so the next window starts now.
+void MpiManager::mpi_getStepTimes(double& lbmTime, double& mpiTime, bool bReset)
+{
+	lbmTime = 0.0;
+	mpiTime = 0.0;
+	loadTimeMarks.resize(3 * (L_NUM_LEVELS + 1) * L_NUM_REGIONS, 0.0);
+
+	for (int lev = 0; lev < L_NUM_LEVELS + 1; ++lev)
+	{
+		for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+		{
+			GridObj *g = nullptr;
+			GridUtils::getGrid(lev, reg, g);
+			if (!g) continue;
+
+			// Totals since the start and since the marks
+			double *mark = &loadTimeMarks[3 * (lev + reg * (L_NUM_LEVELS + 1))];
+			double lbmTotal = g->timeav_timestep * g->t;
+			double mpiTotal = g->timeav_mpi_overhead * g->t;
+			double steps = g->t - mark[2];
+
+			if (steps > 0)
+			{
+				double subcycles = pow(2, lev);
+				lbmTime += (lbmTotal - mark[0]) / steps * subcycles;
+				mpiTime += (mpiTotal - mark[1]) / steps * subcycles;
+			}
+
+			if (bReset)
+			{
+				mark[0] = lbmTotal;
+				mark[1] = mpiTotal;
+				mark[2] = g->t;
+			}
+		}
+	}
+}
+
+// ************************************************************************** //
+/// \brief	Calibrate the decomposition cost model from measured timings.
+///
+///			Each rank counts its core sites of each cost class (weighted by the 
+///			number of sub-cycles per coarse time step) and maps them to the L0 
+///			sites they cover. The measured time per coarse time step on each 
+///			rank is then used to fit the weights by least squares (regularised 
+///			towards the defaults). The result is stored in the grid manager for 
+///			use by any subsequent decomposition and, if requested, weights are 
+///			written to sdweights.out and the cost map to sdcostmap.out in the 
+///			output directory. Copying these to ./input/sdweights.in and 
+///			./input/sdcostmap.in enables them for the smart decomposition of 
+///			subsequent runs. Called by all ranks.
+///
+///	\param	bWriteFiles	flag to write the calibrated model to file.
+void MpiManager::mpi_SDCalibrate(bool bWriteFiles)
+{
+	GridManager *gm = GridManager::getInstance();
+	double dh = L_COARSE_SITE_WIDTH;
+
+	// L0 global sites covered by the core of this rank
+	int lims[3][2] = { { 0, 1 }, { 0, 1 }, { 0, 1 } };
+	for (int d = 0; d < L_DIMS; d++)
+	{
+		lims[d][0] = static_cast<int>(std::round(rank_core_edge[2 * d][my_rank] / dh));
+		lims[d][1] = static_cast<int>(std::round(rank_core_edge[2 * d + 1][my_rank] / dh));
+	}
+	int size[3] = { lims[0][1] - lims[0][0], lims[1][1] - lims[1][0], lims[2][1] - lims[2][0] };
+	std::vector<double> localMap(static_cast<size_t>(size[0]) * size[1] * size[2] * eCostTypes, 0.0);
+
+	// Measured time per coarse time step and site counts for this rank
+	double rankTime, rankMpiTime;
+	mpi_getStepTimes(rankTime, rankMpiTime, false);
+	double rankCounts[eCostTypes] = { 0.0 };
+
+	for (int lev = 0; lev < L_NUM_LEVELS + 1; ++lev)
+	{
+		for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+		{
+			GridObj *g = nullptr;
+			GridUtils::getGrid(lev, reg, g);
+			if (!g) continue;
+
+			double subcycles = pow(2, lev);
+
+			for (int i = 0; i < g->N_lim; ++i)
+			{
+				for (int j = 0; j < g->M_lim; ++j)
+				{
+					for (int k = 0; k < g->K_lim; ++k)
+					{
+						// Only count core sites
+						if (GridUtils::isOnRecvLayer(g->XPos[i], g->YPos[j], g->ZPos[k])) continue;
+
+						// Map to L0 site in local map
+						int idx[3] = { static_cast<int>(g->XPos[i] / dh), static_cast<int>(g->YPos[j] / dh), 0 };
+#if (L_DIMS == 3)
+						idx[eZDirection] = static_cast<int>(g->ZPos[k] / dh);
+#endif
+						for (int d = 0; d < 3; d++)
+							idx[d] = std::min(std::max(idx[d] - lims[d][0], 0), size[d] - 1);
+
+						int c = GridManager::getCostClass(g->LatTyp(i, j, k, g->M_lim, g->K_lim));
+						localMap[c + (idx[2] + idx[1] * size[2] + static_cast<size_t>(idx[0]) * size[2] * size[1]) * eCostTypes] += subcycles;
+						rankCounts[c] += subcycles;
+					}
+				}
+			}
+		}
+	}
+
+#ifdef L_IBM_ON
+	// IBM support sites owned by this rank
+	for (IBBody& body : ObjectManager::getInstance()->iBody)
+	{
+		double subcycles = pow(2, body.level);
+		for (int m : body.validMarkers)
+		{
+			IBMarker& marker = body.markers[m];
+			for (size_t s = 0; s < marker.supp_x.size(); ++s)
+			{
+				if (marker.support_rank[s] != my_rank) continue;
+
+				int idx[3] = { static_cast<int>(marker.supp_x[s] / dh), static_cast<int>(marker.supp_y[s] / dh), 0 };
+#if (L_DIMS == 3)
+				idx[eZDirection] = static_cast<int>(marker.supp_z[s] / dh);
+#endif
+				for (int d = 0; d < 3; d++)
+					idx[d] = std::min(std::max(idx[d] - lims[d][0], 0), size[d] - 1);
+
+				localMap[eCostIBM + (idx[2] + idx[1] * size[2] + static_cast<size_t>(idx[0]) * size[2] * size[1]) * eCostTypes] += subcycles;
+				rankCounts[eCostIBM] += subcycles;
+			}
+		}
+	}
+#endif
+
+	// Pack non-empty sites as records of global ID followed by class counts
+	std::vector<double> records;
+	for (int i = 0; i < size[0]; ++i)
+	{
+		for (int j = 0; j < size[1]; ++j)
+		{
+			for (int k = 0; k < size[2]; ++k)
+			{
+				size_t id = k + j * size[2] + static_cast<size_t>(i) * size[2] * size[1];
+				bool bEmpty = true;
+				for (int c = 0; c < eCostTypes; ++c)
+					if (localMap[c + id * eCostTypes] != 0.0) bEmpty = false;
+				if (bEmpty) continue;
+
+				records.push_back(static_cast<double>((k + lims[2][0]) + (j + lims[1][0]) * gm->global_size[eZDirection][0] +
+					static_cast<size_t>(i + lims[0][0]) * gm->global_size[eZDirection][0] * gm->global_size[eYDirection][0]));
+				for (int c = 0; c < eCostTypes; ++c)
+					records.push_back(localMap[c + id * eCostTypes]);
+			}
+		}
+	}
+
+	// Gather timings and counts
+	std::vector<double> rankData(eCostTypes + 1);
+	rankData[0] = rankTime;
+	for (int c = 0; c < eCostTypes; ++c) rankData[c + 1] = rankCounts[c];
+	std::vector<double> allData;
+	if (my_rank == 0) allData.resize(num_ranks * (eCostTypes + 1));
+	MPI_Gather(&rankData[0], eCostTypes + 1, MPI_DOUBLE, allData.data(), eCostTypes + 1, MPI_DOUBLE, 0, world_comm);
+
+	// Gather cost map records
+	int recordSize = static_cast<int>(records.size());
+	std::vector<int> recordSizes, displs;
+	if (my_rank == 0) recordSizes.resize(num_ranks);
+	MPI_Gather(&recordSize, 1, MPI_INT, recordSizes.data(), 1, MPI_INT, 0, world_comm);
+
+	std::vector<double> allRecords;
+	if (my_rank == 0)
+	{
+		displs.resize(num_ranks, 0);
+		for (int r = 1; r < num_ranks; ++r) displs[r] = displs[r - 1] + recordSizes[r - 1];
+		allRecords.resize(displs.back() + recordSizes.back());
+	}
+	MPI_Gatherv(records.data(), recordSize, MPI_DOUBLE, allRecords.data(), recordSizes.data(), displs.data(), MPI_DOUBLE, 0, world_comm);
+
+	if (my_rank != 0) return;
+
+	// Build normal equations (A^T A + lambda I) w = A^T T + lambda w0 with the 
+	// defaults scaled to the measured time so the fit only deviates where the 
+	// timings carry information.
+	double w0[eCostTypes] = { L_SD_WEIGHT_FLUID, L_SD_WEIGHT_SOLID, L_SD_WEIGHT_BOUNDARY, L_SD_WEIGHT_IBM };
+	double ATA[eCostTypes][eCostTypes] = { { 0.0 } };
+	double ATT[eCostTypes] = { 0.0 };
+	double timeSum = 0.0, costSum = 0.0;
+	for (int r = 0; r < num_ranks; ++r)
+	{
+		double *row = &allData[r * (eCostTypes + 1)];
+		timeSum += row[0];
+		for (int c = 0; c < eCostTypes; ++c)
+		{
+			costSum += w0[c] * row[c + 1];
+			ATT[c] += row[c + 1] * row[0];
+			for (int c2 = 0; c2 < eCostTypes; ++c2)
+				ATA[c][c2] += row[c + 1] * row[c2 + 1];
+		}
+	}
+
+	double scale = (costSum > 0.0) ? timeSum / costSum : 1.0;
+	double lambda = 0.0;
+	for (int c = 0; c < eCostTypes; ++c) lambda += ATA[c][c];
+	lambda = std::max(lambda * 1.0e-3 / eCostTypes, 1.0e-30);
+	for (int c = 0; c < eCostTypes; ++c)
+	{
+		ATA[c][c] += lambda;
+		ATT[c] += lambda * scale * w0[c];
+	}
+
+	// Solve by Gaussian elimination with partial pivoting
+	double w[eCostTypes];
+	for (int c = 0; c < eCostTypes; ++c)
+	{
+		int pivot = c;
+		for (int r = c + 1; r < eCostTypes; ++r)
+			if (std::abs(ATA[r][c]) > std::abs(ATA[pivot][c])) pivot = r;
+		for (int c2 = 0; c2 < eCostTypes; ++c2) std::swap(ATA[c][c2], ATA[pivot][c2]);
+		std::swap(ATT[c], ATT[pivot]);
+
+		for (int r = c + 1; r < eCostTypes; ++r)
+		{
+			double factor = ATA[r][c] / ATA[c][c];
+			for (int c2 = c; c2 < eCostTypes; ++c2) ATA[r][c2] -= factor * ATA[c][c2];
+			ATT[r] -= factor * ATT[c];
+		}
+	}
+	for (int c = eCostTypes - 1; c >= 0; --c)
+	{
+		w[c] = ATT[c];
+		for (int c2 = c + 1; c2 < eCostTypes; ++c2) w[c] -= ATA[c][c2] * w[c2];
+		w[c] /= ATA[c][c];
+	}
+
+	// Normalise relative to fluid and keep positive
+	if (w[eCostFluid] <= 0.0)
+	{
+		L_WARN("Calibration produced a non-positive fluid cost. Default weights will be written.", GridUtils::logfile);
+		for (int c = 0; c < eCostTypes; ++c) w[c] = w0[c];
+	}
+	double fluidCost = w[eCostFluid];
+	for (int c = 0; c < eCostTypes; ++c) w[c] = std::max(w[c] / fluidCost, 1.0e-3);
+
+	// Assemble cost map
+	std::vector<float> costMap(static_cast<size_t>(gm->global_size[eXDirection][0]) * 
+		gm->global_size[eYDirection][0] * gm->global_size[eZDirection][0] * eCostTypes, 0.0f);
+	for (size_t r = 0; r < allRecords.size(); r += eCostTypes + 1)
+	{
+		size_t id = static_cast<size_t>(allRecords[r]);
+		for (int c = 0; c < eCostTypes; ++c)
+			costMap[c + id * eCostTypes] += static_cast<float>(allRecords[r + c + 1]);
+	}
+
+	L_INFO("Decomposition cost model calibrated: fluid = " + std::to_string(w[eCostFluid]) + 
+		", solid = " + std::to_string(w[eCostSolid]) + 
+		", boundary = " + std::to_string(w[eCostBoundary]) + 
+		", IBM = " + std::to_string(w[eCostIBM]) + ".", GridUtils::logfile);
+
+	if (bWriteFiles)
+	{
+		// Write weights
+		std::ofstream weightfile(GridUtils::path_str + "/sdweights.out", std::ios::out);
+		weightfile << "FLUID " << w[eCostFluid] << std::endl;
+		weightfile << "SOLID " << w[eCostSolid] << std::endl;
+		weightfile << "BOUNDARY " << w[eCostBoundary] << std::endl;
+		weightfile << "IBM " << w[eCostIBM] << std::endl;
+		weightfile.close();
+
+		// Write cost map
+		std::ofstream mapfile(GridUtils::path_str + "/sdcostmap.out", std::ios::out | std::ios::binary);
+		int sizes[3] = { gm->global_size[eXDirection][0], gm->global_size[eYDirection][0], gm->global_size[eZDirection][0] };
+		mapfile.write(reinterpret_cast<char*>(sizes), 3 * sizeof(int));
+		mapfile.write(reinterpret_cast<char*>(costMap.data()), costMap.size() * sizeof(float));
+		mapfile.close();
+
+		L_INFO("Copy sdweights.out and sdcostmap.out to ./input/sdweights.in and ./input/sdcostmap.in to use them.", GridUtils::logfile);
+	}
+
+	// Store model for subsequent decompositions
+	for (int c = 0; c < eCostTypes; ++c) gm->costWeights[c] = w[c];
+	gm->costMap.swap(costMap);
+	gm->buildCostTable();
+	gm->bCostModelLoaded = true;
+}
+
+// ************************************************************************** //
+/// \brief	Gather the IB support sites of all ranks for the cost model.
+///
+///			Bodies only exist on the ranks holding their grid so the support 
+///			sites owned by each rank are shared with all ranks. Each is 
+///			weighted by its sub-cycles as in mpi_SDCalibrate() and stored in 
+///			the grid manager for the analytical cost estimate. Called by all 
+///			ranks before a decomposition when no cost map is available.
+void MpiManager::mpi_SDGatherIBMSites()
+{
+	GridManager *gm = GridManager::getInstance();
+	gm->ibmCostSites.clear();
+
+#ifdef L_IBM_ON
+	// Support sites owned by this rank
+	std::vector<double> sites;
+	for (IBBody& body : ObjectManager::getInstance()->iBody)
+	{
+		double subcycles = pow(2, body.level);
+		for (int m : body.validMarkers)
+		{
+			IBMarker& marker = body.markers[m];
+			for (size_t s = 0; s < marker.supp_x.size(); ++s)
+			{
+				if (marker.support_rank[s] != my_rank) continue;
+				sites.push_back(marker.supp_x[s]);
+				sites.push_back(marker.supp_y[s]);
+				sites.push_back(marker.supp_z[s]);
+				sites.push_back(subcycles);
+			}
+		}
+	}
+
+	// Share with all ranks
+	int numSites = static_cast<int>(sites.size());
+	std::vector<int> rankSizes(num_ranks), displs(num_ranks, 0);
+	MPI_Allgather(&numSites, 1, MPI_INT, &rankSizes.front(), 1, MPI_INT, world_comm);
+	for (int r = 1; r < num_ranks; ++r) displs[r] = displs[r - 1] + rankSizes[r - 1];
+	gm->ibmCostSites.resize(displs[num_ranks - 1] + rankSizes[num_ranks - 1]);
+	MPI_Allgatherv(sites.data(), numSites, MPI_DOUBLE, gm->ibmCostSites.data(), 
+		&rankSizes.front(), &displs.front(), MPI_DOUBLE, world_comm);
+#endif
+}
+
 // ************************************************************************** //
 /// \brief Sets the number of accessible sub-grids on this rank.
 ///
@@ -1781,15 +2221,15 @@ void MpiManager::mpi_setSubGridDepth()
 	// Loop through all subgrids on this rank
 	for (int lev = 1; lev < (L_NUM_LEVELS + 1); lev++)
 	{
-		// Check if this rank has this level
-		g = NULL;
-		GridUtils::getGrid(GridManager::getInstance()->Grids, lev, 0, g);
-
-		// Check if g is NULL
-		if (g == NULL) break;
+		// Check if this rank has this level in any region
+		for (int reg = 0; reg < L_NUM_REGIONS; reg++)
+		{
+			g = NULL;
+			GridUtils::getGrid(GridManager::getInstance()->Grids, lev, reg, g);
 
-		// If it makes it here then it has this level
-		highestLevel = lev;
+			// If it finds one then it has this level
+			if (g != NULL) highestLevel = lev;
+		}
 	}
 
 	// Resize vector
@@ -0,0 +1,521 @@
+/*
+* --------------------------------------------------------------
+*
+* ------ Lattice Boltzmann @ The University of Manchester ------
+*
+* -------------------------- L-U-M-A ---------------------------
+*
+* Copyright 2019 The University of Manchester
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.*
+*/
+
+/* This file contains the methods for dynamic load balancing of the grid. */
+
+#include "../inc/stdafx.h"
+#include "../inc/ObjectManager.h"
+
+
+// *****************************************************************************
+///	\brief	Redistribute the grid if the measured load is imbalanced.
+///
+///			The time spent in the LBM kernel per coarse time step since the
+///			last check is gathered from all ranks. If the spread exceeds
+///			L_MPI_REBALANCE_THRESHOLD percent of the slowest rank, the cost
+///			model is recalibrated from the measured timings and the smart
+///			decomposition is recomputed. If the blocks change, the grid is
+///			redistributed for the new layout. Called by all ranks.
+///
+///	\param	Grids	pointer to L0 grid.
+///	\returns		true if the grid was redistributed.
+bool MpiManager::mpi_rebalance(GridObj* const Grids)
+{
+	// Get instances
+	double dh = L_COARSE_SITE_WIDTH;
+	double lbmTime, mpiTime;
+
+	// Gather the measured times per coarse time step
+	double rankTimes[2];
+	mpi_getStepTimes(rankTimes[0], rankTimes[1], false);
+	std::vector<double> allTimes(2 * num_ranks, 0.0);
+	MPI_Allgather(rankTimes, 2, MPI_DOUBLE, &allTimes.front(), 2, MPI_DOUBLE, world_comm);
+
+	// Compute imbalance of kernel time
+	double maxTime = 0.0, minTime = std::numeric_limits<double>::max(), maxMpiTime = 0.0;
+	for (int r = 0; r < num_ranks; r++)
+	{
+		maxTime = std::max(maxTime, allTimes[2 * r]);
+		minTime = std::min(minTime, allTimes[2 * r]);
+		maxMpiTime = std::max(maxMpiTime, allTimes[2 * r + 1]);
+	}
+	double imbalance = (maxTime > 0.0) ? (maxTime - minTime) / maxTime * 100.0 : 0.0;
+
+	L_INFO("Measured load imbalance = " + std::to_string(imbalance) +
+		"% (slowest rank " + std::to_string(maxTime * 1000) + "ms, fastest rank " +
+		std::to_string(minTime * 1000) + "ms, largest MPI overhead " +
+		std::to_string(maxMpiTime * 1000) + "ms per step).", GridUtils::logfile);
+
+	if (imbalance < L_MPI_REBALANCE_THRESHOLD)
+	{
+		mpi_getStepTimes(lbmTime, mpiTime, true);
+		return false;
+	}
+
+	// Recalibrate cost model and recompute decomposition
+	L_INFO("Load imbalance above threshold. Recomputing decomposition...", GridUtils::logfile);
+	mpi_SDCalibrate(false);
+	std::vector<int> oldSizeX(cRankSizeX), oldSizeY(cRankSizeY), oldSizeZ(cRankSizeZ);
+	mpi_smartDecompose(dh);
+
+	if (cRankSizeX == oldSizeX && cRankSizeY == oldSizeY && cRankSizeZ == oldSizeZ)
+	{
+		L_INFO("Decomposition unchanged. Grid will not be redistributed.", GridUtils::logfile);
+		mpi_getStepTimes(lbmTime, mpiTime, true);
+		return false;
+	}
+
+	mpi_redistribute(Grids);
+	L_INFO("Grid redistributed.", GridUtils::logfile);
+	mpi_getStepTimes(lbmTime, mpiTime, true);
+	return true;
+}
+
+
+// *****************************************************************************
+///	\brief	Send the sites of every grid to the ranks holding them in a new layout.
+///
+///			Called by all ranks once the block sizes (and, when regridding, the
+///			refined regions) have been changed. The core sites of every grid
+///			are sent to the ranks whose new block (including halo) covers them,
+///			the grid hierarchy is rebuilt in place and the MPI buffers, writable
+///			data, bodies and probe mappings are updated for the new layout.
+///
+///	\param	Grids	pointer to L0 grid.
+///	\param	bRegrid	true if the refined regions have moved.
+void MpiManager::mpi_redistribute(GridObj* const Grids, bool bRegrid)
+{
+	// Get instances
+	GridManager *gm = GridManager::getInstance();
+	ObjectManager *objman = ObjectManager::getInstance();
+	double dh = L_COARSE_SITE_WIDTH;
+	bool bHasIBBodies = !objman->bodyIDToIdx.empty();
+
+	// Pack the core sites of all grids on this rank
+	const int recSize = GridObj::LBM_siteRecordSize();
+	std::vector<double> records;
+	Grids->LBM_packSites(records);
+
+	// Note which grids are on this rank
+	std::vector<int> presence((L_NUM_LEVELS + 1) * L_NUM_REGIONS, 0);
+	for (int lev = 0; lev < L_NUM_LEVELS + 1; ++lev)
+	{
+		for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+		{
+			GridObj *g = nullptr;
+			GridUtils::getGrid(Grids, lev, reg, g);
+			if (g) presence[lev + reg * (L_NUM_LEVELS + 1)] = 1;
+		}
+	}
+
+	// Store the grid on which each IB body lives
+	std::vector<int> bodyLev(objman->iBody.size()), bodyReg(objman->iBody.size());
+	for (size_t ib = 0; ib < objman->iBody.size(); ib++)
+	{
+		bodyLev[ib] = objman->iBody[ib]._Owner->level;
+		bodyReg[ib] = objman->iBody[ib]._Owner->region_number;
+
+		// Regridding may have put the body on another block of its level
+		if (bRegrid && !objman->iBody[ib].markers.empty())
+		{
+			int reg = gm->getRegion(bodyLev[ib], &objman->iBody[ib].markers[0].position[0]);
+			if (reg >= 0) bodyReg[ib] = reg;
+		}
+	}
+
+	// Store the markers of the BFL bodies which are rebuilt on the new grids
+	std::vector<double> bflMarkers;
+	objman->bfl_packMarkers(bflMarkers);
+
+#ifdef L_PROBE_OUTPUT
+	// Probe mapping points at the current grids so write out what is buffered
+	Grids->io_probeFlush();
+#endif
+
+	// Apply new layout and rebuild the hierarchy
+	mpi_setBlockLayout(gm);
+	Grids->LBM_rebuildHierarchy();
+
+	// Check whether sub-grids have moved between ranks
+	int bPresenceChanged = 0, bAnyPresenceChanged = 0;
+	for (int lev = 0; lev < L_NUM_LEVELS + 1; ++lev)
+	{
+		for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+		{
+			GridObj *g = nullptr;
+			GridUtils::getGrid(Grids, lev, reg, g);
+			if ((g != nullptr) != (presence[lev + reg * (L_NUM_LEVELS + 1)] == 1)) bPresenceChanged = 1;
+		}
+	}
+	MPI_Allreduce(&bPresenceChanged, &bAnyPresenceChanged, 1, MPI_INT, MPI_MAX, world_comm);
+
+	if (bAnyPresenceChanged)
+	{
+		// Rebuild the level communicators (and the neighbourhoods built on them)
+		mpi_freeNeighbourComms();
+		for (size_t lev = 0; lev < lev_comm.size(); lev++)
+			if (lev_comm[lev] != MPI_COMM_NULL) MPI_Comm_free(&lev_comm[lev]);
+		mpi_setSubGridDepth();
+	}
+
+
+	/* Site destinations. The edges of the new blocks are indexed by the block
+	 * coordinate in each direction. A site goes to every block whose core
+	 * extended by one coarse site (the halo) contains it allowing for the
+	 * periodic wrapping of the halo. */
+	std::vector<std::vector<double>> blockEdges(L_DIMS);
+	std::vector<int> coords(L_DIMS);
+	for (int d = 0; d < L_DIMS; d++) blockEdges[d].resize(dimensions[d] + 1, 0.0);
+	for (int r = 0; r < num_ranks; r++)
+	{
+		MPI_Cart_coords(world_comm, r, L_DIMS, &coords[0]);
+		for (int d = 0; d < L_DIMS; d++)
+		{
+			blockEdges[d][coords[d]] = rank_core_edge[2 * d][r];
+			blockEdges[d][coords[d] + 1] = rank_core_edge[2 * d + 1][r];
+		}
+	}
+
+	std::vector<std::vector<double>> sendBuffer(num_ranks, std::vector<double>(0));
+	std::vector<std::vector<int>> blockCoords(L_DIMS, std::vector<int>(0));
+	for (size_t rec = 0; rec < records.size(); rec += recSize)
+	{
+		// Find blocks in each direction which hold this position
+		for (int d = 0; d < L_DIMS; d++)
+		{
+			blockCoords[d].clear();
+			double pos = records[rec + 2 + d];
+			double length = gm->global_edges[2 * d + 1][0];
+			// No halo if only one block in this direction
+			if (dimensions[d] == 1)
+			{
+				blockCoords[d].push_back(0);
+				continue;
+			}
+
+			for (int c = 0; c < dimensions[d]; c++)
+			{
+				double lo = blockEdges[d][c] - dh;
+				double hi = blockEdges[d][c + 1] + dh;
+				if ((pos >= lo && pos < hi) || (pos + length >= lo && pos + length < hi) ||
+					(pos - length >= lo && pos - length < hi))
+					blockCoords[d].push_back(c);
+			}
+		}
+
+		// Copy record to each of these blocks
+		for (size_t a = 0; a < blockCoords[eXDirection].size(); a++)
+		{
+			coords[eXDirection] = blockCoords[eXDirection][a];
+			for (size_t b = 0; b < blockCoords[eYDirection].size(); b++)
+			{
+				coords[eYDirection] = blockCoords[eYDirection][b];
+#if (L_DIMS == 3)
+				for (size_t c = 0; c < blockCoords[eZDirection].size(); c++)
+				{
+					coords[eZDirection] = blockCoords[eZDirection][c];
+#else
+				{
+#endif
+					int toRank;
+					MPI_Cart_rank(world_comm, &coords[0], &toRank);
+					sendBuffer[toRank].insert(sendBuffer[toRank].end(), records.begin() + rec, records.begin() + rec + recSize);
+				}
+			}
+		}
+	}
+	records.clear();
+	records.shrink_to_fit();
+
+	// Exchange and unpack into the new grids
+	std::vector<double> recvData;
+	mpi_exchangeRecords(sendBuffer, recvData);
+	Grids->LBM_unpackSites(recvData.data(), static_cast<int>(recvData.size()) / recSize, bRegrid);
+	std::vector<double>().swap(recvData);
+
+	// Rebuild the BFL bodies on the new grids
+	mpi_redistributeBFLBodies(bflMarkers);
+
+	// Labels have changed so rebuild the streaming masks and refinement maps
+	Grids->LBM_initStreamMask();
+	Grids->LBM_initRefinedMaps();
+
+
+	// Rebuild buffer information
+	buffer_send_info.clear();
+	buffer_recv_info.clear();
+	mpi_buffer_size();
+
+	// Rebuild writable data and sub-grid communicators
+	for (int n = 0; n < L_NUM_LEVELS * L_NUM_REGIONS; n++)
+		if (subGrid_comm[n] != MPI_COMM_NULL) MPI_Comm_free(&subGrid_comm[n]);
+	gm->p_data.clear();
+	mpi_buildCommunicators(gm);
+
+	// Move the IB bodies onto the ranks holding their grids
+	if (bHasIBBodies) mpi_redistributeIBBodies(Grids, bodyLev, bodyReg);
+
+#ifdef L_IBM_ON
+	// Redistribute the markers of all bodies and rebuild supports and comms
+	for (int lev = 0; lev < L_NUM_LEVELS + 1 && bHasIBBodies; lev++)
+	{
+		if (lev <= rankGrids[my_rank])
+			objman->ibm_updateMarkers(lev, true);
+	}
+	if (bHasIBBodies) objman->ibm_initialise();
+#endif
+
+#ifdef L_PROBE_OUTPUT
+	// Re-map probes without rewriting the file header
+	Grids->io_initProbes(false);
+#endif
+
+	// Update load information
+	mpi_updateLoadInfo(gm);
+}
+
+
+// *****************************************************************************
+///	\brief	Send a buffer of records to each rank.
+///
+///			Called by all ranks. The sizes are exchanged first then the data.
+///			The send buffers are released once they have been copied.
+///
+///	\param	sendBuffer	records to send to each rank.
+///	\param	recvData	records received from all ranks in rank order.
+void MpiManager::mpi_exchangeRecords(std::vector<std::vector<double>>& sendBuffer, std::vector<double>& recvData)
+{
+	// Exchange sizes then data
+	std::vector<int> sendCounts(num_ranks, 0), recvCounts(num_ranks, 0);
+	std::vector<int> sendDisps(num_ranks, 0), recvDisps(num_ranks, 0);
+	std::vector<double> sendData;
+	for (int r = 0; r < num_ranks; r++)
+	{
+		sendCounts[r] = static_cast<int>(sendBuffer[r].size());
+		sendDisps[r] = static_cast<int>(sendData.size());
+		sendData.insert(sendData.end(), sendBuffer[r].begin(), sendBuffer[r].end());
+		std::vector<double>().swap(sendBuffer[r]);
+	}
+	MPI_Alltoall(&sendCounts.front(), 1, MPI_INT, &recvCounts.front(), 1, MPI_INT, world_comm);
+	for (int r = 1; r < num_ranks; r++) recvDisps[r] = recvDisps[r - 1] + recvCounts[r - 1];
+	int recvSize = recvDisps.back() + recvCounts.back();
+	sendData.resize(std::max(sendData.size(), static_cast<size_t>(1)));
+	recvData.resize(std::max(recvSize, 1));
+	MPI_Alltoallv(&sendData.front(), &sendCounts.front(), &sendDisps.front(), MPI_DOUBLE,
+		&recvData.front(), &recvCounts.front(), &recvDisps.front(), MPI_DOUBLE, world_comm);
+	recvData.resize(recvSize);
+}
+
+
+// *****************************************************************************
+///	\brief	Rebuild the BFL bodies on the grids of a new layout.
+///
+///			Called by all ranks once the sites have been unpacked. BFL bodies
+///			do not move so the markers of every body are shared with all ranks
+///			and each rank builds the bodies from the markers on its new grids 
+///			(ObjectManager::bfl_buildFromMarkers).
+///
+///	\param	markers		records of (body ID, level, marker ID, x, y, z) for 
+///						the markers on this rank before the change.
+void MpiManager::mpi_redistributeBFLBodies(std::vector<double>& markers)
+{
+	// Share the markers with all ranks
+	int sendCount = static_cast<int>(markers.size());
+	std::vector<int> recvCounts(num_ranks, 0), recvDisps(num_ranks, 0);
+	MPI_Allgather(&sendCount, 1, MPI_INT, &recvCounts.front(), 1, MPI_INT, world_comm);
+	for (int r = 1; r < num_ranks; r++) recvDisps[r] = recvDisps[r - 1] + recvCounts[r - 1];
+	int recvCount = recvDisps.back() + recvCounts.back();
+	if (recvCount == 0) return;
+
+	std::vector<double> allMarkers(recvCount);
+	markers.resize(std::max(markers.size(), static_cast<size_t>(1)));
+	MPI_Allgatherv(&markers.front(), sendCount, MPI_DOUBLE, &allMarkers.front(),
+		&recvCounts.front(), &recvDisps.front(), MPI_DOUBLE, world_comm);
+	std::vector<double>().swap(markers);
+
+	// Build each body from the markers on the new grids on this rank
+	ObjectManager::getInstance()->bfl_buildFromMarkers(allMarkers);
+}
+
+
+// *****************************************************************************
+///	\brief	Move the IB bodies onto the ranks holding their grids in a new layout.
+///
+///			Called by all ranks once the grids have been redistributed. Ranks
+///			which now hold the grid of a body get an empty copy of it and ranks
+///			which no longer hold it drop it. A body keeps its owner if the 
+///			owner still holds its grid. Otherwise ownership passes to one of
+///			the new holders and the old owner sends it all the markers and the
+///			structural state. The markers are then spread from the owners by
+///			ObjectManager::ibm_updateMarkers.
+///
+///	\param	Grids	pointer to L0 grid.
+///	\param	bodyLev	level of the grid of each body on this rank before the change.
+///	\param	bodyReg	region of the grid of each body on this rank before the change.
+void MpiManager::mpi_redistributeIBBodies(GridObj* const Grids,
+	const std::vector<int>& bodyLev, const std::vector<int>& bodyReg)
+{
+	ObjectManager *objman = ObjectManager::getInstance();
+	const int numGrids = (L_NUM_LEVELS + 1) * L_NUM_REGIONS;
+	const int numBodies = static_cast<int>(objman->bodyIDToIdx.size());
+	const int infoSize = 4;
+	const int markerSize = 13 + L_DIMS;
+
+	// Share which grids are now on each rank
+	std::vector<int> presence(numGrids, 0), allPresence(numGrids * num_ranks, 0);
+	for (int lev = 0; lev < L_NUM_LEVELS + 1; ++lev)
+	{
+		for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+		{
+			GridObj *g = nullptr;
+			GridUtils::getGrid(Grids, lev, reg, g);
+			if (g) presence[lev + reg * (L_NUM_LEVELS + 1)] = 1;
+		}
+	}
+	MPI_Allgather(&presence.front(), numGrids, MPI_INT, &allPresence.front(), numGrids, MPI_INT, world_comm);
+
+	// Share the level, region, owner and flags of every body from its owner
+	std::vector<int> info(infoSize * numBodies, -1), bodyInfo(infoSize * numBodies, -1);
+	for (size_t ib = 0; ib < objman->iBody.size(); ib++)
+	{
+		IBBody &body = objman->iBody[ib];
+		if (body.owningRank != my_rank) continue;
+		info[infoSize * body.id] = bodyLev[ib];
+		info[infoSize * body.id + 1] = bodyReg[ib];
+		info[infoSize * body.id + 2] = my_rank;
+		info[infoSize * body.id + 3] = body.isFlexible + 2 * body.isMovable + 4 * body.closed_surface;
+	}
+	MPI_Allreduce(&info.front(), &bodyInfo.front(), infoSize * numBodies, MPI_INT, MPI_MAX, world_comm);
+
+	// Keep the owner if it still holds the grid otherwise pick one of the new holders
+	std::vector<int> newOwner(numBodies);
+	for (int id = 0; id < numBodies; id++)
+	{
+		int gridIdx = bodyInfo[infoSize * id] + bodyInfo[infoSize * id + 1] * (L_NUM_LEVELS + 1);
+		int oldOwner = bodyInfo[infoSize * id + 2];
+		if (allPresence[gridIdx + oldOwner * numGrids])
+		{
+			newOwner[id] = oldOwner;
+			continue;
+		}
+
+		std::vector<int> holders;
+		for (int r = 0; r < num_ranks; r++)
+			if (allPresence[gridIdx + r * numGrids]) holders.push_back(r);
+		newOwner[id] = holders[id % holders.size()];
+	}
+
+	// Pack all the markers and the structural state of bodies changing owner
+	std::vector<std::vector<double>> sendBuffer(num_ranks, std::vector<double>(0));
+	for (size_t ib = 0; ib < objman->iBody.size(); ib++)
+	{
+		IBBody &body = objman->iBody[ib];
+		if (body.owningRank != my_rank || newOwner[body.id] == my_rank) continue;
+
+		std::vector<double> &buffer = sendBuffer[newOwner[body.id]];
+		buffer.push_back(body.id);
+		buffer.push_back(static_cast<double>(body.markers.size()));
+		for (size_t m = 0; m < body.markers.size(); m++)
+		{
+			IBMarker &marker = body.markers[m];
+			buffer.push_back(marker.id);
+			buffer.insert(buffer.end(), marker.position.begin(), marker.position.begin() + 3);
+			buffer.insert(buffer.end(), marker.position0.begin(), marker.position0.begin() + 3);
+			buffer.insert(buffer.end(), marker.markerVel.begin(), marker.markerVel.begin() + 3);
+			buffer.insert(buffer.end(), marker.markerVel_km1.begin(), marker.markerVel_km1.begin() + 3);
+			buffer.insert(buffer.end(), marker.force_xyz.begin(), marker.force_xyz.begin() + L_DIMS);
+		}
+
+		// Structural state only lives on the owner
+		if (body.fBody)
+		{
+			body.fBody->packState(buffer);
+			delete body.fBody;
+			body.fBody = NULL;
+		}
+	}
+	std::vector<double> recvData;
+	mpi_exchangeRecords(sendBuffer, recvData);
+
+	// Keep the bodies on grids this rank holds and add the ones it does not have yet
+	std::vector<IBBody> bodies;
+	std::vector<int> idx(numBodies, -1);
+	for (int id = 0; id < numBodies; id++)
+	{
+		GridObj *g = nullptr;
+		GridUtils::getGrid(Grids, bodyInfo[infoSize * id], bodyInfo[infoSize * id + 1], g);
+		if (!g) continue;
+
+		idx[id] = static_cast<int>(bodies.size());
+		if (objman->bodyIDToIdx[id] >= 0)
+			bodies.push_back(objman->iBody[objman->bodyIDToIdx[id]]);
+		else
+		{
+			bodies.emplace_back();
+			bodies.back().id = id;
+			bodies.back().isFlexible = (bodyInfo[infoSize * id + 3] & 1) != 0;
+			bodies.back().isMovable = (bodyInfo[infoSize * id + 3] & 2) != 0;
+			bodies.back().closed_surface = (bodyInfo[infoSize * id + 3] & 4) != 0;
+		}
+
+		IBBody &body = bodies.back();
+		body._Owner = g;
+		body.level = g->level;
+		body.dh = g->dh;
+		body.owningRank = newOwner[id];
+	}
+
+	// Unpack the bodies this rank now owns
+	const double *rec = recvData.data(), *recEnd = rec + recvData.size();
+	while (rec < recEnd)
+	{
+		IBBody &body = bodies[idx[static_cast<int>(rec[0])]];
+		int numMarkers = static_cast<int>(rec[1]);
+		rec += 2;
+
+		body.markers.clear();
+		for (int m = 0; m < numMarkers; m++, rec += markerSize)
+		{
+			body.markers.emplace_back(rec[1], rec[2], rec[3], static_cast<int>(rec[0]), body._Owner);
+			IBMarker &marker = body.markers.back();
+			std::copy(rec + 4, rec + 7, marker.position0.begin());
+			std::copy(rec + 7, rec + 10, marker.markerVel.begin());
+			std::copy(rec + 10, rec + 13, marker.markerVel_km1.begin());
+			std::copy(rec + 13, rec + 13 + L_DIMS, marker.force_xyz.begin());
+		}
+
+		if (body.isFlexible)
+		{
+			body.fBody = new FEMBody();
+			rec = body.fBody->unpackState(rec);
+		}
+	}
+
+	// Swap in the new bodies and rebuild the index mappings
+	objman->iBody.swap(bodies);
+	objman->ibm_finaliseReadIn(numBodies);
+
+	// IBM is only applied on levels where this rank now holds bodies
+	std::fill(objman->hasIBMBodies.begin(), objman->hasIBMBodies.end(), false);
+	for (size_t ib = 0; ib < objman->iBody.size(); ib++)
+		objman->hasIBMBodies[objman->iBody[ib].level] = true;
+}
@@ -24,20 +24,165 @@
 #include "../inc/ObjectManager.h"
 
 
+// *****************************************************************************
+///	\brief	Update a persistent neighbourhood used by the FEM exchanges
+///
+///			Collective over the level communicator. The distributed graph 
+///			communicator is only rebuilt if any rank on the level needs to send
+///			to a rank outside its neighbourhood, or if most of its neighbours 
+///			are no longer used, so the usual cost is a single reduction. Unused
+///			neighbours are simply sent nothing so markers oscillating across a 
+///			rank boundary do not cause repeated rebuilds. In-neighbours are 
+///			found by MPI when the graph is built so ranks only need to know who
+///			they send to.
+///
+///	\param	level			current grid level
+///	\param	nc				neighbourhood to update
+///	\param	destinations	sorted world ranks this rank will send to
+void MpiManager::mpi_updateNeighbourComm(int level, NeighbourCommStruct& nc, std::vector<int>& destinations) {
+
+	// Decide collectively whether the graph needs rebuilding
+	int changed = (nc.comm == MPI_COMM_NULL ||
+		!std::includes(nc.destSet.begin(), nc.destSet.end(), destinations.begin(), destinations.end()) ||
+		nc.destSet.size() > 2 * destinations.size() + 2) ? 1 : 0;
+	int anyChanged = 0;
+	MPI_Allreduce(&changed, &anyChanged, 1, MPI_INT, MPI_LOR, lev_comm[level]);
+	if (!anyChanged) return;
+
+	// Release old graph
+	if (nc.comm != MPI_COMM_NULL) MPI_Comm_free(&nc.comm);
+	nc.destSet = destinations;
+
+	// Map destinations to level ranks (buffers are never empty so data pointers are valid)
+	std::vector<int> lev2glob = mpi_mapRankLevelToWorld(level);
+	std::vector<int> glob2lev = mpi_mapRankWorldToLevel(level);
+	int levRank, degree = static_cast<int>(destinations.size());
+	MPI_Comm_rank(lev_comm[level], &levRank);
+	std::vector<int> levDestinations(degree + 1);
+	for (int i = 0; i < degree; i++) levDestinations[i] = glob2lev[destinations[i]];
+
+	// Build graph from the outgoing edges of each rank
+	MPI_Dist_graph_create(lev_comm[level], 1, &levRank, &degree, &levDestinations.front(),
+		MPI_UNWEIGHTED, MPI_INFO_NULL, 0, &nc.comm);
+
+	// Get the neighbours in the order used by the neighbourhood collectives
+	int inDegree, outDegree, weighted;
+	MPI_Dist_graph_neighbors_count(nc.comm, &inDegree, &outDegree, &weighted);
+	std::vector<int> levSources(inDegree + 1), levDests(outDegree + 1);
+	MPI_Dist_graph_neighbors(nc.comm, inDegree, &levSources.front(), MPI_UNWEIGHTED, outDegree, &levDests.front(), MPI_UNWEIGHTED);
+
+	nc.sources.resize(inDegree);
+	nc.destinations.resize(outDegree);
+	nc.srcIdx.clear();
+	nc.destIdx.clear();
+	for (int i = 0; i < inDegree; i++) {
+		nc.sources[i] = lev2glob[levSources[i]];
+		nc.srcIdx[nc.sources[i]] = i;
+	}
+	for (int i = 0; i < outDegree; i++) {
+		nc.destinations[i] = lev2glob[levDests[i]];
+		nc.destIdx[nc.destinations[i]] = i;
+	}
+
+	// Size count arrays (one extra entry so they are never empty)
+	nc.sendCounts.assign(outDegree + 1, 0);
+	nc.sendDisps.assign(outDegree + 1, 0);
+	nc.recvCounts.assign(inDegree + 1, 0);
+	nc.recvDisps.assign(inDegree + 1, 0);
+	nc.cursor.assign(std::max(inDegree, outDegree) + 1, 0);
+
+#ifdef L_MPI_VERBOSE
+	L_INFO("Level " + std::to_string(level) + " FEM neighbourhood rebuilt with " + std::to_string(outDegree) + 
+		" destinations and " + std::to_string(inDegree) + " sources.", logout);
+#endif
+}
+
+// *****************************************************************************
+///	\brief	Update the neighbourhood used to gather forces from off-rank markers
+///
+///			Marker ranks send forces to the owners of the flexible bodies whose
+///			markers they hold. Only depends on the marker-side comms so is 
+///			called when they are rebuilt rather than every step.
+///
+///	\param	level			current grid level
+void MpiManager::mpi_updateForceNeighbours(int level) {
+
+	// Get object manager instance
+	ObjectManager *objman = ObjectManager::getInstance();
+
+	// Find the owners this rank sends forces to
+	std::vector<int> destinations;
+	for (size_t i = 0; i < markerCommMarkerSide[level].size(); i++) {
+		if (objman->iBody[objman->bodyIDToIdx[markerCommMarkerSide[level][i].bodyID]].isFlexible)
+			destinations.push_back(markerCommMarkerSide[level][i].rankComm);
+	}
+	std::sort(destinations.begin(), destinations.end());
+	destinations.erase(std::unique(destinations.begin(), destinations.end()), destinations.end());
+
+	// Rebuild the neighbourhood if the owners have changed
+	mpi_updateNeighbourComm(level, forceNeighbours[level], destinations);
+}
+
+// *****************************************************************************
+///	\brief	Get the neighbour index of a world rank in a neighbourhood
+///
+///			Exits if the rank is not a neighbour since the neighbourhood then
+///			no longer matches the comms being exchanged.
+///
+///	\param	idxMap			destination or source index map of the neighbourhood
+///	\param	rank			world rank
+///	\param	level			current grid level
+///	\return	index of the rank in the neighbourhood
+int MpiManager::mpi_getNeighbourIdx(const std::unordered_map<int, int>& idxMap, int rank, int level) {
+
+	auto it = idxMap.find(rank);
+	if (it == idxMap.end())
+		L_ERROR("Rank " + std::to_string(rank) + " is not in the level " + std::to_string(level) + 
+			" FEM neighbourhood of rank " + std::to_string(my_rank) + ". Exiting.", GridUtils::logfile);
+	return it->second;
+}
+
+// *****************************************************************************
+///	\brief	Release the neighbourhoods of all levels
+///
+///			Must be called before the level communicators are freed. The 
+///			neighbourhoods are rebuilt the next time the comms are updated.
+void MpiManager::mpi_freeNeighbourComms() {
+
+	for (size_t lev = 0; lev < forceNeighbours.size(); lev++) {
+		if (forceNeighbours[lev].comm != MPI_COMM_NULL) MPI_Comm_free(&forceNeighbours[lev].comm);
+		if (markerNeighbours[lev].comm != MPI_COMM_NULL) MPI_Comm_free(&markerNeighbours[lev].comm);
+	}
+}
+
 // *****************************************************************************
 ///	\brief	Do communication required for gathering forces from off-rank markers
 ///
+///			Forces are sent from the ranks holding the markers to the rank 
+///			owning the body over the neighbourhood built with the marker comms.
+///
 ///	\param	level		current grid level
 void MpiManager::mpi_forceCommGather(int level) {
 
 	// Get object manager instance
 	ObjectManager *objman = ObjectManager::getInstance();
+	NeighbourCommStruct& nc = forceNeighbours[level];
+	int nDests = static_cast<int>(nc.destinations.size());
+	int nSources = static_cast<int>(nc.sources.size());
 
-	// Declare send buffer
-	std::vector<std::vector<double>> sendBuffer(num_ranks, std::vector<double>(0));
+	// Work out how much to send to each neighbour
+	int toRank, fromRank, ib, m;
+	std::fill(nc.sendCounts.begin(), nc.sendCounts.end(), 0);
+	for (size_t i = 0; i < markerCommMarkerSide[level].size(); i++) {
+		ib = objman->bodyIDToIdx[markerCommMarkerSide[level][i].bodyID];
+		if (objman->iBody[ib]._Owner->level == level && objman->iBody[ib].isFlexible)
+			nc.sendCounts[mpi_getNeighbourIdx(nc.destIdx, markerCommMarkerSide[level][i].rankComm, level)] += L_DIMS;
+	}
+	for (int n = 1; n <= nDests; n++) nc.sendDisps[n] = nc.sendDisps[n - 1] + nc.sendCounts[n - 1];
+	nc.sendBuffer.resize(nc.sendDisps[nDests] + 1);
 
 	// Pack the data to send
-	int toRank, ib, m;
+	std::copy(nc.sendDisps.begin(), nc.sendDisps.begin() + nDests, nc.cursor.begin());
 	for (size_t i = 0; i < markerCommMarkerSide[level].size(); i++) {
 
 		// Get body ID
@@ -47,52 +192,30 @@ void MpiManager::mpi_forceCommGather(int level) {
 		if (objman->iBody[ib]._Owner->level == level && objman->iBody[ib].isFlexible) {
 
 			// Get ID info
-			toRank = markerCommMarkerSide[level][i].rankComm;
+			toRank = mpi_getNeighbourIdx(nc.destIdx, markerCommMarkerSide[level][i].rankComm, level);
 			m = markerCommMarkerSide[level][i].markerIdx;
 
 			// Pack marker data
-			sendBuffer[toRank].push_back(objman->iBody[ib].markers[m].force_xyz[eXDirection]);
-			sendBuffer[toRank].push_back(objman->iBody[ib].markers[m].force_xyz[eYDirection]);
-#if (L_DIMS == 3)
-			sendBuffer[toRank].push_back(objman->iBody[ib].markers[m].force_xyz[eZDirection]);
-#endif
-		}
-	}
-
-	// Now loop through send buffer and send to appropriate ranks
-	std::vector<MPI_Request> sendRequests;
-	for (int toRank = 0; toRank < num_ranks; toRank++) {
-		if (sendBuffer[toRank].size() > 0) {
-			sendRequests.push_back(MPI_REQUEST_NULL);
-			MPI_Isend(&sendBuffer[toRank].front(), static_cast<int>(sendBuffer[toRank].size()), MPI_DOUBLE, toRank, my_rank, world_comm, &sendRequests.back());
+			for (int d = 0; d < L_DIMS; d++)
+				nc.sendBuffer[nc.cursor[toRank]++] = objman->iBody[ib].markers[m].force_xyz[d];
 		}
 	}
 
 	// Get buffer sizes
-	std::vector<int> bufferSize(num_ranks, 0);
+	std::fill(nc.recvCounts.begin(), nc.recvCounts.end(), 0);
 	for (size_t i = 0; i < markerCommOwnerSide[level].size(); i++) {
 		if (objman->iBody[objman->bodyIDToIdx[markerCommOwnerSide[level][i].bodyID]].isFlexible)
-			bufferSize[markerCommOwnerSide[level][i].rankComm] += L_DIMS;
-	}
-
-	// Now create receive buffer
-	std::vector<std::vector<double>> recvBuffer(num_ranks, std::vector<double>(0));
-
-	// Now loop through and receive the buffer
-	for (int fromRank = 0; fromRank < num_ranks; fromRank++) {
-
-		// Only do if there is information to receive
-		if (bufferSize[fromRank] > 0) {
-			recvBuffer[fromRank].resize(bufferSize[fromRank]);
-			MPI_Recv(&recvBuffer[fromRank].front(), static_cast<int>(recvBuffer[fromRank].size()), MPI_DOUBLE, fromRank, fromRank, world_comm, MPI_STATUS_IGNORE);
-		}
+			nc.recvCounts[mpi_getNeighbourIdx(nc.srcIdx, markerCommOwnerSide[level][i].rankComm, level)] += L_DIMS;
 	}
+	for (int n = 1; n <= nSources; n++) nc.recvDisps[n] = nc.recvDisps[n - 1] + nc.recvCounts[n - 1];
+	nc.recvBuffer.resize(nc.recvDisps[nSources] + 1);
 
-	// Index vector for looping through recvBuffer
-	std::vector<int> idx(num_ranks, 0);
+	// Exchange with neighbours only
+	MPI_Neighbor_alltoallv(&nc.sendBuffer.front(), &nc.sendCounts.front(), &nc.sendDisps.front(), MPI_DOUBLE,
+		&nc.recvBuffer.front(), &nc.recvCounts.front(), &nc.recvDisps.front(), MPI_DOUBLE, nc.comm);
 
 	// Now unpack
-	int fromRank;
+	std::copy(nc.recvDisps.begin(), nc.recvDisps.begin() + nSources, nc.cursor.begin());
 	for (size_t i = 0; i < markerCommOwnerSide[level].size(); i++) {
 
 		// Get body idx
@@ -102,49 +225,85 @@ void MpiManager::mpi_forceCommGather(int level) {
 		if (objman->iBody[ib].isFlexible) {
 
 			// Get ID info
-			fromRank = markerCommOwnerSide[level][i].rankComm;
+			fromRank = mpi_getNeighbourIdx(nc.srcIdx, markerCommOwnerSide[level][i].rankComm, level);
 			m = markerCommOwnerSide[level][i].markerID;
 
 			// Loop through and set force
 			for (int d = 0; d < L_DIMS; d++)
-				objman->iBody[ib].markers[m].force_xyz[d] = recvBuffer[fromRank][idx[fromRank]+d];
-
-			// Increment
-			idx[fromRank] += L_DIMS;
+				objman->iBody[ib].markers[m].force_xyz[d] = nc.recvBuffer[nc.cursor[fromRank]++];
 		}
 	}
-
-	// If sending any messages then wait for request status
-	MPI_Waitall(static_cast<int>(sendRequests.size()), &sendRequests.front(), MPI_STATUS_IGNORE);
 }
 
 // *****************************************************************************
 ///	\brief	Do communication required for sending new marker positions after FEM
 ///
+///			Owners send each off-rank marker as a record of body ID, marker ID,
+///			position and velocity to the rank the marker now lies on. The
+///			neighbourhood only changes when markers move onto a rank the body
+///			did not previously send to.
+///
 ///	\param	level			current grid level
 ///	\param	markerIDs		IDs of markers that have been sent
 ///	\param	positions		positions of markers that have been sent
 ///	\param	vels			velocities of markers that have been sent
-void MpiManager::mpi_spreadNewMarkers(int level, std::vector<std::vector<int>> &markerIDs, std::vector<std::vector<std::vector<double>>> &positions, std::vector<std::vector<std::vector<double>>> &vels) {
+///	\param	bAllBodies		flag to send markers of all owned bodies rather than just flexible ones
+void MpiManager::mpi_spreadNewMarkers(int level, std::vector<std::vector<int>> &markerIDs, std::vector<std::vector<std::vector<double>>> &positions, std::vector<std::vector<std::vector<double>>> &vels, bool bAllBodies) {
 
 	// Get object manager instance
 	ObjectManager *objman = ObjectManager::getInstance();
+	NeighbourCommStruct& nc = markerNeighbours[level];
+	const int recordSize = 2 + 2 * L_DIMS;
+
+	// Find the ranks markers of bodies owned by this rank are on
+	std::vector<int> destinations;
+	for (size_t ib = 0; ib < objman->iBody.size(); ib++) {
+		if (objman->iBody[ib].owningRank == my_rank && objman->iBody[ib]._Owner->level == level &&
+			(objman->iBody[ib].isFlexible || bAllBodies)) {
+			for (size_t m = 0; m < objman->iBody[ib].markers.size(); m++) {
+				if (objman->iBody[ib].markers[m].owningRank != my_rank)
+					destinations.push_back(objman->iBody[ib].markers[m].owningRank);
+			}
+		}
+	}
+	std::sort(destinations.begin(), destinations.end());
+	destinations.erase(std::unique(destinations.begin(), destinations.end()), destinations.end());
+
+	// Rebuild the neighbourhood if markers have moved onto new ranks
+	mpi_updateNeighbourComm(level, nc, destinations);
+	int nDests = static_cast<int>(nc.destinations.size());
+	int nSources = static_cast<int>(nc.sources.size());
+
+	// Count markers to send to each neighbour
+	std::fill(nc.sendCounts.begin(), nc.sendCounts.end(), 0);
+	for (size_t ib = 0; ib < objman->iBody.size(); ib++) {
+		if (objman->iBody[ib].owningRank == my_rank && objman->iBody[ib]._Owner->level == level &&
+			(objman->iBody[ib].isFlexible || bAllBodies)) {
+			for (size_t m = 0; m < objman->iBody[ib].markers.size(); m++) {
+				if (objman->iBody[ib].markers[m].owningRank != my_rank)
+					nc.sendCounts[mpi_getNeighbourIdx(nc.destIdx, objman->iBody[ib].markers[m].owningRank, level)]++;
+			}
+		}
+	}
 
-	// Get ranks which exist on this level
-	std::vector<int> lev2glob = mpi_mapRankLevelToWorld(level);
-	std::vector<int> glob2lev = mpi_mapRankWorldToLevel(level);
+	// Tell each neighbour how many markers it is receiving
+	MPI_Neighbor_alltoall(&nc.sendCounts.front(), 1, MPI_INT, &nc.recvCounts.front(), 1, MPI_INT, nc.comm);
 
-	// Declare send buffers
-	std::vector<int> nMarkersToSend(num_ranks, 0);
-	std::vector<int> nMarkersToSendLev(lev2glob.size(), 0);
-	std::vector<std::vector<int>> sendIDs(num_ranks, std::vector<int>(0));
-	std::vector<std::vector<double>> sendPosAndVel(num_ranks, std::vector<double>());
+	// Convert to buffer sizes
+	for (int n = 0; n < nDests; n++) nc.sendCounts[n] *= recordSize;
+	for (int n = 0; n < nSources; n++) nc.recvCounts[n] *= recordSize;
+	for (int n = 1; n <= nDests; n++) nc.sendDisps[n] = nc.sendDisps[n - 1] + nc.sendCounts[n - 1];
+	for (int n = 1; n <= nSources; n++) nc.recvDisps[n] = nc.recvDisps[n - 1] + nc.recvCounts[n - 1];
+	nc.sendBuffer.resize(nc.sendDisps[nDests] + 1);
+	nc.recvBuffer.resize(nc.recvDisps[nSources] + 1);
 
-	// Loop through and pack data
-	for (auto ib : objman->idxFEM) {
+	// Loop through and pack data for bodies owned by this rank
+	std::copy(nc.sendDisps.begin(), nc.sendDisps.begin() + nDests, nc.cursor.begin());
+	for (size_t ib = 0; ib < objman->iBody.size(); ib++) {
 
-		// Only do if on this grid level
-		if (objman->iBody[ib]._Owner->level == level) {
+		// Only do if on this grid level and flexible (unless doing all)
+		if (objman->iBody[ib].owningRank == my_rank && objman->iBody[ib]._Owner->level == level &&
+			(objman->iBody[ib].isFlexible || bAllBodies)) {
 
 			// Loop through all markers (valid and invalid) on this rank
 			for (size_t m = 0; m < objman->iBody[ib].markers.size(); m++) {
@@ -152,91 +311,47 @@ void MpiManager::mpi_spreadNewMarkers(int level, std::vector<std::vector<int>> &
 				// If it is not on this rank then pack into buffer
 				if (objman->iBody[ib].markers[m].owningRank != my_rank) {
 
-					// Increment the number of markers to send to this rank
-					nMarkersToSend[objman->iBody[ib].markers[m].owningRank]++;
-					nMarkersToSendLev[glob2lev[objman->iBody[ib].markers[m].owningRank]]++;
+					int &pos = nc.cursor[mpi_getNeighbourIdx(nc.destIdx, objman->iBody[ib].markers[m].owningRank, level)];
 
 					// Pack body and marker IDs
-					sendIDs[objman->iBody[ib].markers[m].owningRank].push_back(objman->iBody[ib].id);
-					sendIDs[objman->iBody[ib].markers[m].owningRank].push_back(objman->iBody[ib].markers[m].id);
+					nc.sendBuffer[pos++] = static_cast<double>(objman->iBody[ib].id);
+					nc.sendBuffer[pos++] = static_cast<double>(objman->iBody[ib].markers[m].id);
 
-					// Pack position
+					// Pack position and velocity
 					for (int d = 0; d < L_DIMS; d++)
-						sendPosAndVel[objman->iBody[ib].markers[m].owningRank].push_back(objman->iBody[ib].markers[m].position[d]);
-
-					// Pack position
+						nc.sendBuffer[pos++] = objman->iBody[ib].markers[m].position[d];
 					for (int d = 0; d < L_DIMS; d++)
-						sendPosAndVel[objman->iBody[ib].markers[m].owningRank].push_back(objman->iBody[ib].markers[m].markerVel[d]);
+						nc.sendBuffer[pos++] = objman->iBody[ib].markers[m].markerVel[d];
 				}
 			}
 		}
 	}
 
-	// To an all gather so each rank knows how many markers it is receiving from each of the other ranks
-	std::vector<int> nMarkersToRecv(num_ranks, 0);
-	std::vector<int> nMarkersToRecvLev(lev2glob.size(), 0);
-	MPI_Alltoall(&nMarkersToSendLev.front(), 1, MPI_INT, &nMarkersToRecvLev.front(), 1, MPI_INT, lev_comm[level]);
-
-	// Insert into full vector
-	for (int levRank = 0; levRank < lev2glob.size(); levRank++)
-		nMarkersToRecv[lev2glob[levRank]] = nMarkersToRecvLev[levRank];
-
-	// Loop through all sends that are required
-	std::vector<MPI_Request> sendRequests;
-	for (int toRank = 0; toRank < num_ranks; toRank++) {
-
-		// Check if it has stuff to send to rank toRank
-		if (nMarkersToSend[toRank] > 0) {
-			sendRequests.push_back(MPI_REQUEST_NULL);
-			MPI_Isend(&sendIDs[toRank].front(), static_cast<int>(sendIDs[toRank].size()), MPI_INT, toRank, my_rank, world_comm, &sendRequests.back());
-			sendRequests.push_back(MPI_REQUEST_NULL);
-			MPI_Isend(&sendPosAndVel[toRank].front(), static_cast<int>(sendPosAndVel[toRank].size()), MPI_DOUBLE, toRank, my_rank, world_comm, &sendRequests.back());
-		}
-	}
-
-	// Declare receive buffers
-	std::vector<std::vector<int>> recvIDs(num_ranks, std::vector<int>(0));
-	std::vector<std::vector<double>> recvPositions(num_ranks, std::vector<double>());
-
-	// Loop through all receives that are required
-	for (int fromRank = 0; fromRank < num_ranks; fromRank++) {
+	// Exchange with neighbours only
+	MPI_Neighbor_alltoallv(&nc.sendBuffer.front(), &nc.sendCounts.front(), &nc.sendDisps.front(), MPI_DOUBLE,
+		&nc.recvBuffer.front(), &nc.recvCounts.front(), &nc.recvDisps.front(), MPI_DOUBLE, nc.comm);
 
-		// Resize the buffer
-		recvIDs[fromRank].resize(nMarkersToRecv[fromRank] * 2);
-		recvPositions[fromRank].resize(nMarkersToRecv[fromRank] * 2 * L_DIMS);
-
-		// Check if it has stuff to receive from rank i
-		if (nMarkersToRecv[fromRank] > 0) {
-			MPI_Recv(&recvIDs[fromRank].front(), static_cast<int>(recvIDs[fromRank].size()), MPI_INT, fromRank, fromRank, world_comm, MPI_STATUS_IGNORE);
-			MPI_Recv(&recvPositions[fromRank].front(), static_cast<int>(recvPositions[fromRank].size()), MPI_DOUBLE, fromRank, fromRank, world_comm, MPI_STATUS_IGNORE);
-		}
-	}
-
-	// Unpack data
+	// Unpack data (all markers of a body come from its owner so stay in ID order)
 	int ib;
 	std::vector<double> positionVec(L_DIMS, 0.0);
 	std::vector<double> velVec(L_DIMS, 0.0);
-	for (int fromRank = 0; fromRank < num_ranks; fromRank++) {
+	int nRecords = nc.recvDisps[nSources] / recordSize;
+	for (int r = 0; r < nRecords; r++) {
 
-		// Loop through markers which have been received from this rank
-		for (int marker = 0; marker < nMarkersToRecv[fromRank]; marker++) {
+		const double *record = &nc.recvBuffer[r * recordSize];
 
-			// Unpack IDs
-			ib = objman->bodyIDToIdx[recvIDs[fromRank][marker*2]];
-			markerIDs[ib].push_back(recvIDs[fromRank][marker*2+1]);
+		// Unpack IDs
+		ib = objman->bodyIDToIdx[static_cast<int>(record[0])];
+		markerIDs[ib].push_back(static_cast<int>(record[1]));
 
-			// Unpack positions
-			for (int d = 0; d < L_DIMS; d++) {
-				positionVec[d] = recvPositions[fromRank][marker*(L_DIMS*2)+d];
-				velVec[d] = recvPositions[fromRank][marker*(L_DIMS*2)+d+2];
-			}
-
-			// Push back
-			positions[ib].push_back(positionVec);
-			vels[ib].push_back(velVec);
+		// Unpack positions
+		for (int d = 0; d < L_DIMS; d++) {
+			positionVec[d] = record[2 + d];
+			velVec[d] = record[2 + L_DIMS + d];
 		}
-	}
 
-	// If sending any messages then wait for request status
-	MPI_Waitall(static_cast<int>(sendRequests.size()), &sendRequests.front(), MPI_STATUS_IGNORE);
-}
\ No newline at end of file
+		// Push back
+		positions[ib].push_back(positionVec);
+		vels[ib].push_back(velVec);
+	}
+}
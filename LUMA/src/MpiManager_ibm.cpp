@@ -102,7 +102,7 @@ void MpiManager::mpi_spreadComm(int level, std::vector<std::vector<double>> &spr
 
 	// If sending any messages then wait for request status
 	//MPI_Waitall(static_cast<int>(sendRequests.size()), &sendRequests.front(), MPI_STATUS_IGNORE);
-	MPI_Barrier(MpiManager::getInstance()->world_comm);
+	MPI_Barrier(MpiManager::getInstance()->lev_comm[level]);
 }
 
 
@@ -199,7 +199,7 @@ void MpiManager::mpi_interpolateComm(int level, std::vector<std::vector<double>>
 
 	// If sending any messages then wait for request status
 	//MPI_Waitall(static_cast<int>(sendRequests.size()), &sendRequests.front(), MPI_STATUS_IGNORE);
-	MPI_Barrier(MpiManager::getInstance()->world_comm);
+	MPI_Barrier(MpiManager::getInstance()->lev_comm[level]);
 }
 
 
@@ -288,7 +288,7 @@ void MpiManager::mpi_epsilonCommScatter(int level) {
 
 	// If sending any messages then wait for request status
 	//MPI_Waitall(static_cast<int>(sendRequests.size()), &sendRequests.front(), MPI_STATUS_IGNORE);
-	MPI_Barrier(MpiManager::getInstance()->world_comm);
+	MPI_Barrier(MpiManager::getInstance()->lev_comm[level]);
 }
 
 
@@ -388,7 +388,7 @@ void MpiManager::mpi_epsilonCommGather(int level) {
 
 	// If sending any messages then wait for request status
 	//MPI_Waitall(static_cast<int>(sendRequests.size()), &sendRequests.front(), MPI_STATUS_IGNORE);
-	MPI_Barrier(MpiManager::getInstance()->world_comm);
+	MPI_Barrier(MpiManager::getInstance()->lev_comm[level]);
 }
 
 
@@ -732,7 +732,7 @@ void MpiManager::mpi_uniEpsilonCommScatter(int level, int rootRank, IBBody &iBod
 
 	// If sending any messages then wait for request status
 	//MPI_Waitall(static_cast<int>(sendRequests.size()), &sendRequests.front(), MPI_STATUS_IGNORE);
-	MPI_Barrier(MpiManager::getInstance()->world_comm);
+	MPI_Barrier(MpiManager::getInstance()->lev_comm[level]);
 }
 
 
@@ -750,9 +750,9 @@ void MpiManager::mpi_buildMarkerComms(int level) {
 	ObjectManager *objman = ObjectManager::getInstance();
 
 	// Build owner side for marker comms
-	for (int ib = 0; ib < objman->iBody.size(); ib++) {
+	for (size_t ib = 0; ib < objman->iBody.size(); ib++) {
 		if (my_rank == objman->iBody[ib].owningRank && level == objman->iBody[ib]._Owner->level) {
-			for (int m = 0; m < objman->iBody[ib].markers.size(); m++) {
+			for (size_t m = 0; m < objman->iBody[ib].markers.size(); m++) {
 				if (my_rank != objman->iBody[ib].markers[m].owningRank)
 					markerCommOwnerSide[level].emplace_back(objman->iBody[ib].markers[m].owningRank, objman->iBody[ib].id, objman->iBody[ib].markers[m].id);
 			}
@@ -760,7 +760,7 @@ void MpiManager::mpi_buildMarkerComms(int level) {
 	}
 
 	// Build marker side for marker comms
-	for (int ib = 0; ib < objman->iBody.size(); ib++) {
+	for (size_t ib = 0; ib < objman->iBody.size(); ib++) {
 		if (my_rank != objman->iBody[ib].owningRank && level == objman->iBody[ib]._Owner->level) {
 			for (auto m : objman->iBody[ib].validMarkers)
 				markerCommMarkerSide[level].emplace_back(objman->iBody[ib].owningRank, objman->iBody[ib].id, m);
@@ -772,7 +772,7 @@ void MpiManager::mpi_buildMarkerComms(int level) {
 
 	// Pack data
 	int toRank, ib, m;
-	for (int i = 0; i < markerCommMarkerSide[level].size(); i++) {
+	for (size_t i = 0; i < markerCommMarkerSide[level].size(); i++) {
 
 		// Get marker info
 		toRank = markerCommMarkerSide[level][i].rankComm;
@@ -797,7 +797,7 @@ void MpiManager::mpi_buildMarkerComms(int level) {
 
 	// Now create and size the receive buffer
 	std::vector<std::vector<int>> recvBuffer(num_ranks, std::vector<int>(0));
-	for (int i = 0; i < markerCommOwnerSide[level].size(); i++)
+	for (size_t i = 0; i < markerCommOwnerSide[level].size(); i++)
 		recvBuffer[markerCommOwnerSide[level][i].rankComm].push_back(0);
 
 	// Now loop through and receive
@@ -810,14 +810,17 @@ void MpiManager::mpi_buildMarkerComms(int level) {
 
 	// Now unpack
 	std::vector<int> idx(num_ranks, 0);
-	for (int i = 0; i < markerCommOwnerSide[level].size(); i++) {
+	for (size_t i = 0; i < markerCommOwnerSide[level].size(); i++) {
 		markerCommOwnerSide[level][i].nSupportSites = recvBuffer[markerCommOwnerSide[level][i].rankComm][idx[markerCommOwnerSide[level][i].rankComm]];
 		idx[markerCommOwnerSide[level][i].rankComm]++;
 	}
 
+	// Marker ranks send forces to the owners of flexible bodies after each FEM step
+	mpi_updateForceNeighbours(level);
+
 	// If sending any messages then wait for request status
 	//MPI_Waitall(static_cast<int>(sendRequests.size()), &sendRequests.front(), MPI_STATUS_IGNORE);
-	MPI_Barrier(MpiManager::getInstance()->world_comm);
+	MPI_Barrier(MpiManager::getInstance()->lev_comm[level]);
 }
 
 // *****************************************************************************
@@ -838,10 +841,10 @@ void MpiManager::mpi_buildSupportComms(int level) {
 	ObjectManager *objman = ObjectManager::getInstance();
 
 	// Loop through all bodies, markers and support sites and get places where communication is necessary
-	for (int ib = 0; ib < objman->iBody.size(); ib++) {
+	for (size_t ib = 0; ib < objman->iBody.size(); ib++) {
 		if (objman->iBody[ib]._Owner->level == level) {
 			for (auto m : objman->iBody[ib].validMarkers) {
-				for (int s = 0; s < objman->iBody[ib].markers[m].deltaval.size(); s++) {
+				for (size_t s = 0; s < objman->iBody[ib].markers[m].deltaval.size(); s++) {
 
 					// If this rank does not own support site then add new element in comm vector
 					if (my_rank != objman->iBody[ib].markers[m].support_rank[s])
@@ -854,7 +857,7 @@ void MpiManager::mpi_buildSupportComms(int level) {
 	// Get how many supports site that need to be received from each rank
 	std::vector<int> nSupportToRecv(num_ranks, 0);
 	std::vector<int> nSupportToRecvLev(lev2glob.size(), 0);
-	for (int i = 0; i < supportCommMarkerSide[level].size(); i++) {
+	for (size_t i = 0; i < supportCommMarkerSide[level].size(); i++) {
 		nSupportToRecv[supportCommMarkerSide[level][i].rankComm]++;
 		nSupportToRecvLev[glob2lev[supportCommMarkerSide[level][i].rankComm]]++;
 	}
@@ -865,7 +868,7 @@ void MpiManager::mpi_buildSupportComms(int level) {
 	MPI_Alltoall(&nSupportToRecvLev.front(), 1, MPI_INT, &nSupportToSendLev.front(), 1, MPI_INT, lev_comm[level]);
 
 	// Insert into full vector
-	for (int levRank = 0; levRank < lev2glob.size(); levRank++)
+	for (size_t levRank = 0; levRank < lev2glob.size(); levRank++)
 		nSupportToSend[lev2glob[levRank]] = nSupportToSendLev[levRank];
 
 	// Declare variables for packing positions and body IDs
@@ -874,7 +877,7 @@ void MpiManager::mpi_buildSupportComms(int level) {
 	std::vector<std::vector<int>> bodyIDs(num_ranks, std::vector<int>(0));
 
 	// Pack the positions of the support sites that need to be received into buffer
-	for (int i = 0; i < supportCommMarkerSide[level].size(); i++) {
+	for (size_t i = 0; i < supportCommMarkerSide[level].size(); i++) {
 
 		// Get IDs of support site
 		ib = objman->bodyIDToIdx[supportCommMarkerSide[level][i].bodyID];
@@ -954,7 +957,7 @@ void MpiManager::mpi_buildSupportComms(int level) {
 
 	// If sending any messages then wait for request status
 	//MPI_Waitall(static_cast<int>(sendRequests.size()), &sendRequests.front(), MPI_STATUS_IGNORE);
-	MPI_Barrier(MpiManager::getInstance()->world_comm);
+	MPI_Barrier(MpiManager::getInstance()->lev_comm[level]);
 }
 
 
@@ -1033,7 +1036,7 @@ void MpiManager::mpi_dsCommScatter(int level) {
 
 	// If sending any messages then wait for request status
 	//MPI_Waitall(static_cast<int>(sendRequests.size()), &sendRequests.front(), MPI_STATUS_IGNORE);
-	MPI_Barrier(MpiManager::getInstance()->world_comm);
+	MPI_Barrier(MpiManager::getInstance()->lev_comm[level]);
 }
 
 
@@ -85,7 +85,7 @@ void MpiManager::mpi_buffer_pack(int dir, GridObj* const g) {
 						) {
 							// Must be a site to send
 							for (v = 0; v < L_NUM_VELS; v++) {
-								f_buffer_send[dir][idx] = g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+								f_buffer_send[dir][idx] = g->f[g->popIdx(i, j, k, v)];
 								idx++;
 							}
 						}
@@ -115,7 +115,7 @@ void MpiManager::mpi_buffer_pack(int dir, GridObj* const g) {
 						) {
 							// Must be a site to send
 							for (v = 0; v < L_NUM_VELS; v++) {
-								f_buffer_send[dir][idx] = g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+								f_buffer_send[dir][idx] = g->f[g->popIdx(i, j, k, v)];
 								idx++;
 							}
 						}
@@ -145,7 +145,7 @@ void MpiManager::mpi_buffer_pack(int dir, GridObj* const g) {
 						) {
 							// Must be a site to send
 							for (v = 0; v < L_NUM_VELS; v++) {
-								f_buffer_send[dir][idx] = g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+								f_buffer_send[dir][idx] = g->f[g->popIdx(i, j, k, v)];
 								idx++;
 							}
 						}
@@ -175,7 +175,7 @@ void MpiManager::mpi_buffer_pack(int dir, GridObj* const g) {
 						) {
 							// Must be a site to send
 							for (v = 0; v < L_NUM_VELS; v++) {
-								f_buffer_send[dir][idx] = g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+								f_buffer_send[dir][idx] = g->f[g->popIdx(i, j, k, v)];
 								idx++;
 							}
 						}
@@ -205,7 +205,7 @@ void MpiManager::mpi_buffer_pack(int dir, GridObj* const g) {
 						) {
 							// Must be a site to send
 							for (v = 0; v < L_NUM_VELS; v++) {
-								f_buffer_send[dir][idx] = g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+								f_buffer_send[dir][idx] = g->f[g->popIdx(i, j, k, v)];
 								idx++;
 							}
 						}
@@ -236,7 +236,7 @@ void MpiManager::mpi_buffer_pack(int dir, GridObj* const g) {
 						) {
 							// Must be a site to send
 							for (v = 0; v < L_NUM_VELS; v++) {
-								f_buffer_send[dir][idx] = g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+								f_buffer_send[dir][idx] = g->f[g->popIdx(i, j, k, v)];
 								idx++;
 							}
 						}
@@ -266,7 +266,7 @@ void MpiManager::mpi_buffer_pack(int dir, GridObj* const g) {
 						) {
 							// Must be a site to send
 							for (v = 0; v < L_NUM_VELS; v++) {
-								f_buffer_send[dir][idx] = g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+								f_buffer_send[dir][idx] = g->f[g->popIdx(i, j, k, v)];
 								idx++;
 							}
 						}
@@ -296,7 +296,7 @@ void MpiManager::mpi_buffer_pack(int dir, GridObj* const g) {
 						) {
 							// Must be a site to send
 							for (v = 0; v < L_NUM_VELS; v++) {
-								f_buffer_send[dir][idx] = g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+								f_buffer_send[dir][idx] = g->f[g->popIdx(i, j, k, v)];
 								idx++;
 							}
 						}
@@ -328,7 +328,7 @@ void MpiManager::mpi_buffer_pack(int dir, GridObj* const g) {
 						) {
 							// Must be a site to send
 							for (v = 0; v < L_NUM_VELS; v++) {
-								f_buffer_send[dir][idx] = g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+								f_buffer_send[dir][idx] = g->f[g->popIdx(i, j, k, v)];
 								idx++;
 							}
 						}
@@ -355,7 +355,7 @@ void MpiManager::mpi_buffer_pack(int dir, GridObj* const g) {
 						) {
 							// Must be a site to send
 							for (v = 0; v < L_NUM_VELS; v++) {
-								f_buffer_send[dir][idx] = g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+								f_buffer_send[dir][idx] = g->f[g->popIdx(i, j, k, v)];
 								idx++;
 							}
 						}
@@ -382,7 +382,7 @@ void MpiManager::mpi_buffer_pack(int dir, GridObj* const g) {
 						) {
 							// Must be a site to send
 							for (v = 0; v < L_NUM_VELS; v++) {
-								f_buffer_send[dir][idx] = g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+								f_buffer_send[dir][idx] = g->f[g->popIdx(i, j, k, v)];
 								idx++;
 							}
 						}
@@ -409,7 +409,7 @@ void MpiManager::mpi_buffer_pack(int dir, GridObj* const g) {
 						) {
 							// Must be a site to send
 							for (v = 0; v < L_NUM_VELS; v++) {
-								f_buffer_send[dir][idx] = g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+								f_buffer_send[dir][idx] = g->f[g->popIdx(i, j, k, v)];
 								idx++;
 							}
 						}
@@ -436,7 +436,7 @@ void MpiManager::mpi_buffer_pack(int dir, GridObj* const g) {
 						) {
 							// Must be a site to send
 							for (v = 0; v < L_NUM_VELS; v++) {
-								f_buffer_send[dir][idx] = g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+								f_buffer_send[dir][idx] = g->f[g->popIdx(i, j, k, v)];
 								idx++;
 							}
 						}
@@ -463,7 +463,7 @@ void MpiManager::mpi_buffer_pack(int dir, GridObj* const g) {
 						) {
 							// Must be a site to send
 							for (v = 0; v < L_NUM_VELS; v++) {
-								f_buffer_send[dir][idx] = g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+								f_buffer_send[dir][idx] = g->f[g->popIdx(i, j, k, v)];
 								idx++;
 							}
 						}
@@ -490,7 +490,7 @@ void MpiManager::mpi_buffer_pack(int dir, GridObj* const g) {
 						) {
 							// Must be a site to send
 							for (v = 0; v < L_NUM_VELS; v++) {
-								f_buffer_send[dir][idx] = g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+								f_buffer_send[dir][idx] = g->f[g->popIdx(i, j, k, v)];
 								idx++;
 							}
 						}
@@ -517,7 +517,7 @@ void MpiManager::mpi_buffer_pack(int dir, GridObj* const g) {
 						) {
 							// Must be a site to send
 							for (v = 0; v < L_NUM_VELS; v++) {
-								f_buffer_send[dir][idx] = g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+								f_buffer_send[dir][idx] = g->f[g->popIdx(i, j, k, v)];
 								idx++;
 							}
 						}
@@ -544,7 +544,7 @@ void MpiManager::mpi_buffer_pack(int dir, GridObj* const g) {
 						) {
 							// Must be a site to send
 							for (v = 0; v < L_NUM_VELS; v++) {
-								f_buffer_send[dir][idx] = g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+								f_buffer_send[dir][idx] = g->f[g->popIdx(i, j, k, v)];
 								idx++;
 							}
 						}
@@ -571,7 +571,7 @@ void MpiManager::mpi_buffer_pack(int dir, GridObj* const g) {
 						) {
 							// Must be a site to send
 							for (v = 0; v < L_NUM_VELS; v++) {
-								f_buffer_send[dir][idx] = g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+								f_buffer_send[dir][idx] = g->f[g->popIdx(i, j, k, v)];
 								idx++;
 							}
 						}
@@ -598,7 +598,7 @@ void MpiManager::mpi_buffer_pack(int dir, GridObj* const g) {
 						) {
 							// Must be a site to send
 							for (v = 0; v < L_NUM_VELS; v++) {
-								f_buffer_send[dir][idx] = g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+								f_buffer_send[dir][idx] = g->f[g->popIdx(i, j, k, v)];
 								idx++;
 							}
 						}
@@ -625,7 +625,7 @@ void MpiManager::mpi_buffer_pack(int dir, GridObj* const g) {
 						) {
 							// Must be a site to send
 							for (v = 0; v < L_NUM_VELS; v++) {
-								f_buffer_send[dir][idx] = g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+								f_buffer_send[dir][idx] = g->f[g->popIdx(i, j, k, v)];
 								idx++;
 							}
 						}
@@ -652,7 +652,7 @@ void MpiManager::mpi_buffer_pack(int dir, GridObj* const g) {
 						) {
 							// Must be a site to send
 							for (v = 0; v < L_NUM_VELS; v++) {
-								f_buffer_send[dir][idx] = g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+								f_buffer_send[dir][idx] = g->f[g->popIdx(i, j, k, v)];
 								idx++;
 							}
 						}
@@ -679,7 +679,7 @@ void MpiManager::mpi_buffer_pack(int dir, GridObj* const g) {
 						) {
 							// Must be a site to send
 							for (v = 0; v < L_NUM_VELS; v++) {
-								f_buffer_send[dir][idx] = g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+								f_buffer_send[dir][idx] = g->f[g->popIdx(i, j, k, v)];
 								idx++;
 							}
 						}
@@ -706,7 +706,7 @@ void MpiManager::mpi_buffer_pack(int dir, GridObj* const g) {
 						) {
 							// Must be a site to send
 							for (v = 0; v < L_NUM_VELS; v++) {
-								f_buffer_send[dir][idx] = g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+								f_buffer_send[dir][idx] = g->f[g->popIdx(i, j, k, v)];
 								idx++;
 							}
 						}
@@ -733,7 +733,7 @@ void MpiManager::mpi_buffer_pack(int dir, GridObj* const g) {
 						) {
 							// Must be a site to send
 							for (v = 0; v < L_NUM_VELS; v++) {
-								f_buffer_send[dir][idx] = g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+								f_buffer_send[dir][idx] = g->f[g->popIdx(i, j, k, v)];
 								idx++;
 							}
 						}
@@ -760,7 +760,7 @@ void MpiManager::mpi_buffer_pack(int dir, GridObj* const g) {
 						) {
 							// Must be a site to send
 							for (v = 0; v < L_NUM_VELS; v++) {
-								f_buffer_send[dir][idx] = g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+								f_buffer_send[dir][idx] = g->f[g->popIdx(i, j, k, v)];
 								idx++;
 							}
 						}
@@ -787,7 +787,7 @@ void MpiManager::mpi_buffer_pack(int dir, GridObj* const g) {
 						) {
 							// Must be a site to send
 							for (v = 0; v < L_NUM_VELS; v++) {
-								f_buffer_send[dir][idx] = g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS);
+								f_buffer_send[dir][idx] = g->f[g->popIdx(i, j, k, v)];
 								idx++;
 							}
 						}
@@ -76,7 +76,7 @@ void MpiManager::mpi_buffer_unpack( int dir, GridObj* const g ) {
 						) {
 							// Must be suitable receiver site
 							for (v = 0; v < L_NUM_VELS; v++) {
-								g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) = f_buffer_recv[dir][idx];
+								g->f[g->popIdx(i, j, k, v)] = f_buffer_recv[dir][idx];
 								idx++;
 							}
 							// Update macroscopic (but not time-averaged quantities)
@@ -109,7 +109,7 @@ void MpiManager::mpi_buffer_unpack( int dir, GridObj* const g ) {
 						) {
 							// Must be suitable receiver site
 							for (v = 0; v < L_NUM_VELS; v++) {
-								g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) = f_buffer_recv[dir][idx];
+								g->f[g->popIdx(i, j, k, v)] = f_buffer_recv[dir][idx];
 								idx++;
 							}
 							// Update macroscopic (but not time-averaged quantities)
@@ -142,7 +142,7 @@ void MpiManager::mpi_buffer_unpack( int dir, GridObj* const g ) {
 						) {
 							// Must be suitable receiver site
 							for (v = 0; v < L_NUM_VELS; v++) {
-								g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) = f_buffer_recv[dir][idx];
+								g->f[g->popIdx(i, j, k, v)] = f_buffer_recv[dir][idx];
 								idx++;
 							}
 							// Update macroscopic (but not time-averaged quantities)
@@ -175,7 +175,7 @@ void MpiManager::mpi_buffer_unpack( int dir, GridObj* const g ) {
 						) {
 							// Must be suitable receiver site
 							for (v = 0; v < L_NUM_VELS; v++) {
-								g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) = f_buffer_recv[dir][idx];
+								g->f[g->popIdx(i, j, k, v)] = f_buffer_recv[dir][idx];
 								idx++;
 							}
 							// Update macroscopic (but not time-averaged quantities)
@@ -208,7 +208,7 @@ void MpiManager::mpi_buffer_unpack( int dir, GridObj* const g ) {
 						) {
 							// Must be suitable receiver site
 							for (v = 0; v < L_NUM_VELS; v++) {
-								g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) = f_buffer_recv[dir][idx];
+								g->f[g->popIdx(i, j, k, v)] = f_buffer_recv[dir][idx];
 								idx++;
 							}
 							// Update macroscopic (but not time-averaged quantities)
@@ -242,7 +242,7 @@ void MpiManager::mpi_buffer_unpack( int dir, GridObj* const g ) {
 						) {
 							// Must be suitable receiver site
 							for (v = 0; v < L_NUM_VELS; v++) {
-								g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) = f_buffer_recv[dir][idx];
+								g->f[g->popIdx(i, j, k, v)] = f_buffer_recv[dir][idx];
 								idx++;
 							}
 							// Update macroscopic (but not time-averaged quantities)
@@ -275,7 +275,7 @@ void MpiManager::mpi_buffer_unpack( int dir, GridObj* const g ) {
 						) {
 							// Must be suitable receiver site
 							for (v = 0; v < L_NUM_VELS; v++) {
-								g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) = f_buffer_recv[dir][idx];
+								g->f[g->popIdx(i, j, k, v)] = f_buffer_recv[dir][idx];
 								idx++;
 							}
 							// Update macroscopic (but not time-averaged quantities)
@@ -308,7 +308,7 @@ void MpiManager::mpi_buffer_unpack( int dir, GridObj* const g ) {
 						) {
 							// Must be suitable receiver site
 							for (v = 0; v < L_NUM_VELS; v++) {
-								g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) = f_buffer_recv[dir][idx];
+								g->f[g->popIdx(i, j, k, v)] = f_buffer_recv[dir][idx];
 								idx++;
 							}
 							// Update macroscopic (but not time-averaged quantities)
@@ -343,7 +343,7 @@ void MpiManager::mpi_buffer_unpack( int dir, GridObj* const g ) {
 						) {
 							// Must be suitable receiver site
 							for (v = 0; v < L_NUM_VELS; v++) {
-								g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) = f_buffer_recv[dir][idx];
+								g->f[g->popIdx(i, j, k, v)] = f_buffer_recv[dir][idx];
 								idx++;
 							}
 							// Update macroscopic (but not time-averaged quantities)
@@ -373,7 +373,7 @@ void MpiManager::mpi_buffer_unpack( int dir, GridObj* const g ) {
 						) {
 							// Must be suitable receiver site
 							for (v = 0; v < L_NUM_VELS; v++) {
-								g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) = f_buffer_recv[dir][idx];
+								g->f[g->popIdx(i, j, k, v)] = f_buffer_recv[dir][idx];
 								idx++;
 							}
 							// Update macroscopic (but not time-averaged quantities)
@@ -403,7 +403,7 @@ void MpiManager::mpi_buffer_unpack( int dir, GridObj* const g ) {
 						) {
 							// Must be suitable receiver site
 							for (v = 0; v < L_NUM_VELS; v++) {
-								g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) = f_buffer_recv[dir][idx];
+								g->f[g->popIdx(i, j, k, v)] = f_buffer_recv[dir][idx];
 								idx++;
 							}
 							// Update macroscopic (but not time-averaged quantities)
@@ -433,7 +433,7 @@ void MpiManager::mpi_buffer_unpack( int dir, GridObj* const g ) {
 						) {
 							// Must be suitable receiver site
 							for (v = 0; v < L_NUM_VELS; v++) {
-								g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) = f_buffer_recv[dir][idx];
+								g->f[g->popIdx(i, j, k, v)] = f_buffer_recv[dir][idx];
 								idx++;
 							}
 							// Update macroscopic (but not time-averaged quantities)
@@ -463,7 +463,7 @@ void MpiManager::mpi_buffer_unpack( int dir, GridObj* const g ) {
 						) {
 							// Must be suitable receiver site
 							for (v = 0; v < L_NUM_VELS; v++) {
-								g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) = f_buffer_recv[dir][idx];
+								g->f[g->popIdx(i, j, k, v)] = f_buffer_recv[dir][idx];
 								idx++;
 							}
 							// Update macroscopic (but not time-averaged quantities)
@@ -493,7 +493,7 @@ void MpiManager::mpi_buffer_unpack( int dir, GridObj* const g ) {
 						) {
 							// Must be suitable receiver site
 							for (v = 0; v < L_NUM_VELS; v++) {
-								g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) = f_buffer_recv[dir][idx];
+								g->f[g->popIdx(i, j, k, v)] = f_buffer_recv[dir][idx];
 								idx++;
 							}
 							// Update macroscopic (but not time-averaged quantities)
@@ -523,7 +523,7 @@ void MpiManager::mpi_buffer_unpack( int dir, GridObj* const g ) {
 						) {
 							// Must be suitable receiver site
 							for (v = 0; v < L_NUM_VELS; v++) {
-								g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) = f_buffer_recv[dir][idx];
+								g->f[g->popIdx(i, j, k, v)] = f_buffer_recv[dir][idx];
 								idx++;
 							}
 							// Update macroscopic (but not time-averaged quantities)
@@ -553,7 +553,7 @@ void MpiManager::mpi_buffer_unpack( int dir, GridObj* const g ) {
 						) {
 							// Must be suitable receiver site
 							for (v = 0; v < L_NUM_VELS; v++) {
-								g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) = f_buffer_recv[dir][idx];
+								g->f[g->popIdx(i, j, k, v)] = f_buffer_recv[dir][idx];
 								idx++;
 							}
 							// Update macroscopic (but not time-averaged quantities)
@@ -583,7 +583,7 @@ void MpiManager::mpi_buffer_unpack( int dir, GridObj* const g ) {
 						) {
 							// Must be suitable receiver site
 							for (v = 0; v < L_NUM_VELS; v++) {
-								g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) = f_buffer_recv[dir][idx];
+								g->f[g->popIdx(i, j, k, v)] = f_buffer_recv[dir][idx];
 								idx++;
 							}
 							// Update macroscopic (but not time-averaged quantities)
@@ -613,7 +613,7 @@ void MpiManager::mpi_buffer_unpack( int dir, GridObj* const g ) {
 						) {
 							// Must be suitable receiver site
 							for (v = 0; v < L_NUM_VELS; v++) {
-								g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) = f_buffer_recv[dir][idx];
+								g->f[g->popIdx(i, j, k, v)] = f_buffer_recv[dir][idx];
 								idx++;
 							}
 							// Update macroscopic (but not time-averaged quantities)
@@ -643,7 +643,7 @@ void MpiManager::mpi_buffer_unpack( int dir, GridObj* const g ) {
 						) {
 							// Must be suitable receiver site
 							for (v = 0; v < L_NUM_VELS; v++) {
-								g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) = f_buffer_recv[dir][idx];
+								g->f[g->popIdx(i, j, k, v)] = f_buffer_recv[dir][idx];
 								idx++;
 							}
 							// Update macroscopic (but not time-averaged quantities)
@@ -673,7 +673,7 @@ void MpiManager::mpi_buffer_unpack( int dir, GridObj* const g ) {
 						) {
 							// Must be suitable receiver site
 							for (v = 0; v < L_NUM_VELS; v++) {
-								g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) = f_buffer_recv[dir][idx];
+								g->f[g->popIdx(i, j, k, v)] = f_buffer_recv[dir][idx];
 								idx++;
 							}
 							// Update macroscopic (but not time-averaged quantities)
@@ -703,7 +703,7 @@ void MpiManager::mpi_buffer_unpack( int dir, GridObj* const g ) {
 						) {
 							// Must be suitable receiver site
 							for (v = 0; v < L_NUM_VELS; v++) {
-								g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) = f_buffer_recv[dir][idx];
+								g->f[g->popIdx(i, j, k, v)] = f_buffer_recv[dir][idx];
 								idx++;
 							}
 							// Update macroscopic (but not time-averaged quantities)
@@ -733,7 +733,7 @@ void MpiManager::mpi_buffer_unpack( int dir, GridObj* const g ) {
 						) {
 							// Must be suitable receiver site
 							for (v = 0; v < L_NUM_VELS; v++) {
-								g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) = f_buffer_recv[dir][idx];
+								g->f[g->popIdx(i, j, k, v)] = f_buffer_recv[dir][idx];
 								idx++;
 							}
 							// Update macroscopic (but not time-averaged quantities)
@@ -763,7 +763,7 @@ void MpiManager::mpi_buffer_unpack( int dir, GridObj* const g ) {
 						) {
 							// Must be suitable receiver site
 							for (v = 0; v < L_NUM_VELS; v++) {
-								g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) = f_buffer_recv[dir][idx];
+								g->f[g->popIdx(i, j, k, v)] = f_buffer_recv[dir][idx];
 								idx++;
 							}
 							// Update macroscopic (but not time-averaged quantities)
@@ -793,7 +793,7 @@ void MpiManager::mpi_buffer_unpack( int dir, GridObj* const g ) {
 						) {
 							// Must be suitable receiver site
 							for (v = 0; v < L_NUM_VELS; v++) {
-								g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) = f_buffer_recv[dir][idx];
+								g->f[g->popIdx(i, j, k, v)] = f_buffer_recv[dir][idx];
 								idx++;
 							}
 							// Update macroscopic (but not time-averaged quantities)
@@ -823,7 +823,7 @@ void MpiManager::mpi_buffer_unpack( int dir, GridObj* const g ) {
 						) {
 							// Must be suitable receiver site
 							for (v = 0; v < L_NUM_VELS; v++) {
-								g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) = f_buffer_recv[dir][idx];
+								g->f[g->popIdx(i, j, k, v)] = f_buffer_recv[dir][idx];
 								idx++;
 							}
 							// Update macroscopic (but not time-averaged quantities)
@@ -853,7 +853,7 @@ void MpiManager::mpi_buffer_unpack( int dir, GridObj* const g ) {
 						) {
 							// Must be suitable receiver site
 							for (v = 0; v < L_NUM_VELS; v++) {
-								g->f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) = f_buffer_recv[dir][idx];
+								g->f[g->popIdx(i, j, k, v)] = f_buffer_recv[dir][idx];
 								idx++;
 							}
 							// Update macroscopic (but not time-averaged quantities)
@@ -73,9 +73,25 @@ ObjectManager::ObjectManager(GridObj* g) : _Grids(g)
 	hasIBMBodies.resize(L_NUM_LEVELS+1 ,false);
 	hasFlexibleBodies.resize(L_NUM_LEVELS+1 ,false);
 
+	// Resize support-local sub-iteration stores (one per grid)
+	subSupportSites.resize(L_NUM_LEVELS * L_NUM_REGIONS + 1);
+	subSupportVel.resize(L_NUM_LEVELS * L_NUM_REGIONS + 1);
+	subSupportSlot.resize(L_NUM_LEVELS * L_NUM_REGIONS + 1);
+
 	// Set sub-iteration loop values
 	timeav_subResidual = 0.0;
 	timeav_subIterations = 0.0;
+
+	// Body output series (items are marker index, x, y, z or forces)
+	bodySeries[eSeriesPosition].fileName = "Body_Positions.bin";
+	bodySeries[eSeriesPosition].stride = 4;
+	bodySeries[eSeriesTips].fileName = "Body_TipPositions.bin";
+	bodySeries[eSeriesTips].stride = 3;
+	bodySeries[eSeriesLiftDrag].fileName = "Body_LiftDrag.bin";
+	bodySeries[eSeriesLiftDrag].stride = 4;
+	bodySeries[eSeriesForces].fileName = "Object_Forces.bin";
+	bodySeries[eSeriesForces].stride = 3;
+	bodySeries[eSeriesForces].bSum = true;
 };
 
 // ************************************************************************* //
@@ -144,9 +160,9 @@ void ObjectManager::computeLiftDrag(int i, int j, int k, GridObj *g) {
 				 */
 
 				 // Store contribution in this direction
-				contrib_x = 2.0 * c[eXDirection][n_opp] * g->f(xdest, ydest, zdest, n_opp, M_lim, K_lim, L_NUM_VELS);
-				contrib_y = 2.0 * c[eYDirection][n_opp] * g->f(xdest, ydest, zdest, n_opp, M_lim, K_lim, L_NUM_VELS);
-				contrib_z = 2.0 * c[eZDirection][n_opp] * g->f(xdest, ydest, zdest, n_opp, M_lim, K_lim, L_NUM_VELS);
+				contrib_x = 2.0 * c[eXDirection][n_opp] * L_POP_GET(g->f[g->popIdx(xdest, ydest, zdest, n_opp)], n_opp);
+				contrib_y = 2.0 * c[eYDirection][n_opp] * L_POP_GET(g->f[g->popIdx(xdest, ydest, zdest, n_opp)], n_opp);
+				contrib_z = 2.0 * c[eZDirection][n_opp] * L_POP_GET(g->f[g->popIdx(xdest, ydest, zdest, n_opp)], n_opp);
 			}
 
 #ifdef L_MOMEX_DEBUG
@@ -181,11 +197,11 @@ void ObjectManager::computeLiftDrag(int v, int id, GridObj *g, int markerID)
 
 	// Similar to BBB but we cannot assume that bounced-back population is the same anymore
 	pBody[0].markers[markerID].forceX +=
-		c[eXDirection][v_opp] * (g->f[v_opp + id * L_NUM_VELS] + g->fNew[v + id * L_NUM_VELS]);
+		c[eXDirection][v_opp] * (L_POP_GET(g->f[g->popIdx(id, v_opp)], v_opp) + L_POP_GET(g->fNew[g->popIdx(id, v)], v));
 	pBody[0].markers[markerID].forceY +=
-		c[eYDirection][v_opp] * (g->f[v_opp + id * L_NUM_VELS] + g->fNew[v + id * L_NUM_VELS]);
+		c[eYDirection][v_opp] * (L_POP_GET(g->f[g->popIdx(id, v_opp)], v_opp) + L_POP_GET(g->fNew[g->popIdx(id, v)], v));
 	pBody[0].markers[markerID].forceZ +=
-		c[eZDirection][v_opp] * (g->f[v_opp + id * L_NUM_VELS] + g->fNew[v + id * L_NUM_VELS]);
+		c[eZDirection][v_opp] * (L_POP_GET(g->f[g->popIdx(id, v_opp)], v_opp) + L_POP_GET(g->fNew[g->popIdx(id, v)], v));
 }
 
 // ************************************************************************* //
@@ -342,6 +358,85 @@ void ObjectManager::addBouncebackObject(GridObj *g, GeomPacked *geom, PCpts *_PC
 	}
 }
 
+// ************************************************************************* //
+/// \brief	Stores the markers of the BFL bodies on this rank.
+///
+///			Called before the grids are rebuilt so the bodies can be built 
+///			again on the new grids by bfl_buildFromMarkers().
+///
+/// \param	markers	vector to which records of (body ID, level, marker ID, x, y, z) are appended.
+void ObjectManager::bfl_packMarkers(std::vector<double>& markers)
+{
+	for (BFLBody& body : pBody)
+	{
+		for (BFLMarker& marker : body.markers)
+		{
+			markers.push_back(body.id);
+			markers.push_back(body._Owner->level);
+			markers.push_back(marker.id);
+			markers.insert(markers.end(), marker.position.begin(), marker.position.end());
+		}
+	}
+}
+
+// ************************************************************************* //
+/// \brief	Rebuilds the BFL bodies on the grids of a new layout.
+///
+///			BFL bodies do not move so each body is built from its markers on 
+///			the new grids in the same way as when the geometry is read in. This 
+///			labels the BFL sites and computes Q for the new grids. The markers 
+///			are matched to the grids of the level of the body by position so a 
+///			body which now spans several refined blocks is built on each.
+///
+/// \param	markers	records of (body ID, level, marker ID, x, y, z) for every 
+///					marker of every body. Released on return.
+void ObjectManager::bfl_buildFromMarkers(std::vector<double>& markers)
+{
+	const int recSize = 6;
+	int numMarkers = static_cast<int>(markers.size()) / recSize;
+	if (numMarkers == 0) return;
+
+	// Order by body then marker
+	std::vector<int> order = GridUtils::onespace(0, numMarkers - 1);
+	std::stable_sort(order.begin(), order.end(), [&markers](int a, int b) {
+		if (markers[a * recSize] != markers[b * recSize]) return markers[a * recSize] < markers[b * recSize];
+		return markers[a * recSize + 2] < markers[b * recSize + 2];
+	});
+
+	// Build each body from its markers on each grid of its level on this rank
+	pBody.clear();
+	eLocationOnRank loc = eNone;
+	for (int first = 0, last = 0; first < numMarkers; first = last)
+	{
+		int id = static_cast<int>(markers[order[first] * recSize]);
+		int lev = static_cast<int>(markers[order[first] * recSize + 1]);
+		for (last = first; last < numMarkers && markers[order[last] * recSize] == id; last++);
+
+		for (int reg = 0; reg < L_NUM_REGIONS; reg++)
+		{
+			GridObj *g = nullptr;
+			GridUtils::getGrid(_Grids, lev, reg, g);
+			if (!g) continue;
+
+			PCpts cloud;
+			for (int n = first; n < last; n++)
+			{
+				const double *rec = &markers[order[n] * recSize];
+				if (GridUtils::isOnThisRank(rec[3], rec[4], rec[5], &loc, g))
+				{
+					cloud.x.push_back(rec[3]);
+					cloud.y.push_back(rec[4]);
+					cloud.z.push_back(rec[5]);
+					cloud.id.push_back(static_cast<int>(rec[2]));
+				}
+			}
+
+			if (!cloud.x.empty()) pBody.emplace_back(g, id, &cloud);
+		}
+	}
+	std::vector<double>().swap(markers);
+}
+
 // ************************************************************************* //
 /// Private method for opening/closing a debugging file
 ///	\param	g	pointer to grid toggling the stream
@@ -32,21 +32,39 @@
 ///	\param	doSubIterate		flag to switch sub-iterations on
 void ObjectManager::ibm_apply(GridObj *g, bool doSubIterate) {
 
+	// Start a new record of modified support sites for this time step on every grid of the level
+	if (doSubIterate == true && hasFlexibleBodies[g->level]) {
+		for (int reg = 0; reg < (g->level == 0 ? 1 : L_NUM_REGIONS); reg++) {
+			int gm_idx = g->level + reg * L_NUM_LEVELS;
+			subSupportSites[gm_idx].clear();
+			subSupportVel[gm_idx].clear();
+			subSupportSlot[gm_idx].clear();
+		}
+	}
+
 	// Interpolate the velocity onto the markers
+	L_PROF_START(t_interp);
 	ibm_interpolate(g->level);
+	L_PROF_STOP(t_interp, eProfIBMInterpolate, g->level, g->region_number);
 	
 	// Compute force
+	L_PROF_START(t_force);
 	ibm_computeForce(g->level);
+	L_PROF_STOP(t_force, eProfIBMForce, g->level, g->region_number);
 
 	// Spread force
+	L_PROF_START(t_spread);
 	ibm_spread(g->level);
+	L_PROF_STOP(t_spread, eProfIBMSpread, g->level, g->region_number);
 
 	// Update the macroscopic values
+	L_PROF_START(t_macro);
 	ibm_updateMacroscopic(g->level);
+	L_PROF_STOP(t_macro, eProfIBMMacro, g->level, g->region_number);
 
 	// Perform FEM
 	if (hasFlexibleBodies[g->level])
-		ibm_moveBodies(g->level);
+		ibm_moveBodies(g);
 
 	// Do subiteration step to enforce kinematic condition at interface
 	if (doSubIterate == true && hasFlexibleBodies[g->level])
@@ -57,9 +75,13 @@ void ObjectManager::ibm_apply(GridObj *g, bool doSubIterate) {
 // *****************************************************************************
 ///	\brief	Moves iBodies after applying IBM
 ///
-///	\param	level		current grid level
-void ObjectManager::ibm_moveBodies(int level) {
+///	\param	g		pointer to current grid
+void ObjectManager::ibm_moveBodies(GridObj *g) {
 
+	// Current grid level
+	int level = g->level;
+
+	L_PROF_START(t_fem);
 
 #ifdef L_BUILD_FOR_MPI
 
@@ -77,8 +99,10 @@ void ObjectManager::ibm_moveBodies(int level) {
 		if (iBody[ib]._Owner->level == level)
 			iBody[ib].fBody->dynamicFEM();
 	}
+	L_PROF_STOP(t_fem, eProfFEM, level, g->region_number);
 
 	// Update IBM markers
+	L_PROF_START(t_support);
 #ifdef L_BUILD_FOR_MPI
 	ibm_updateMarkers(level);
 #endif
@@ -98,9 +122,12 @@ void ObjectManager::ibm_moveBodies(int level) {
 
 	// Compute ds
 	ibm_computeDs(level);
+	L_PROF_STOP(t_support, eProfIBMSupport, level, g->region_number);
 
 	// Find epsilon for the body
+	L_PROF_START(t_epsilon);
 	ibm_findEpsilon(level);
+	L_PROF_STOP(t_epsilon, eProfIBMEpsilon, level, g->region_number);
 }
 
 
@@ -119,11 +146,8 @@ void ObjectManager::ibm_subIterate(GridObj *g) {
 	// Do the while loop for sub iteration
 	do {
 
-		// Reset velocities to start of time step
-		g->u = g->u_n;
-
-		// Reset forces
-		g->_LBM_resetForces();
+		// Reset velocities and forces to start of time step at the support sites
+		ibm_resetSupportSites(g);
 
 		// Apply IBM again
 		ibm_apply(g, false);
@@ -155,6 +179,7 @@ void ObjectManager::ibm_subIterate(GridObj *g) {
 			iBody[ib].fBody->U_n = iBody[ib].fBody->U;
 			iBody[ib].fBody->Udot_n = iBody[ib].fBody->Udot;
 			iBody[ib].fBody->Udotdot_n = iBody[ib].fBody->Udotdot;
+			iBody[ib].fBody->subIt = 0;
 
 			// Get time averaged FEM values
 			iBody[ib].fBody->timeav_FEMIterations *= (g->t % L_GRID_OUT_FREQ);
@@ -185,6 +210,69 @@ void ObjectManager::ibm_subIterate(GridObj *g) {
 }
 
 
+// *****************************************************************************
+///	\brief	Record a support site the first time IBM modifies it this time step
+///
+///			The velocity at the site is stored before the first macroscopic 
+///			update so that sub-iterations can restore the start-of-step state 
+///			at the support sites only rather than copying the whole grid.
+///
+///	\param	g		pointer to grid owning the site
+///	\param	id		flattened grid site index
+void ObjectManager::ibm_recordSupportSite(GridObj *g, int id) {
+
+	// Records of this grid (site indices are local to the grid)
+	int gm_idx = g->level + g->region_number * L_NUM_LEVELS;
+
+	// Already recorded during this time step
+	if (subSupportSlot[gm_idx].find(id) != subSupportSlot[gm_idx].end()) return;
+
+	// Add site and its current velocity
+	subSupportSlot[gm_idx][id] = subSupportSites[gm_idx].size();
+	subSupportSites[gm_idx].push_back(id);
+	for (int d = 0; d < L_DIMS; d++)
+		subSupportVel[gm_idx].push_back(g->u[d + id * L_DIMS]);
+}
+
+
+// *****************************************************************************
+///	\brief	Reset velocity and force at the recorded support sites
+///
+///			Only support sites can have been modified by IBM since the LBM 
+///			kernel ran so this is equivalent to a whole-grid reset. The IBM 
+///			step covers the bodies of every region on the level so the sites 
+///			recorded on each grid of the level are reset.
+///
+///	\param	g		pointer to current grid
+void ObjectManager::ibm_resetSupportSites(GridObj *g) {
+
+	for (int reg = 0; reg < (g->level == 0 ? 1 : L_NUM_REGIONS); reg++) {
+
+		// Grid holding the records
+		GridObj *gr = nullptr;
+		GridUtils::getGrid(_Grids, g->level, reg, gr);
+		if (!gr) continue;
+		int gm_idx = g->level + reg * L_NUM_LEVELS;
+
+		// Loop over sites of this grid touched so far this time step
+		for (size_t s = 0; s < subSupportSites[gm_idx].size(); s++) {
+			int id = subSupportSites[gm_idx][s];
+
+			// Restore start-of-step velocity
+			for (int d = 0; d < L_DIMS; d++)
+				gr->u[d + id * L_DIMS] = subSupportVel[gm_idx][d + s * L_DIMS];
+
+			// Reset force (same as GridObj::_LBM_resetForces)
+#ifdef L_GRAVITY_ON
+			gr->force_xyz[L_GRAVITY_DIRECTION + id * L_DIMS] = gr->rho[id] * gr->gravity * gr->refinement_ratio;
+#else
+			for (int d = 0; d < L_DIMS; d++)
+				gr->force_xyz[d + id * L_DIMS] = 0.0;
+#endif
+		}
+	}
+}
+
 // *****************************************************************************
 ///	\brief	Initialise the array of iBodies
 void ObjectManager::ibm_initialise() {
@@ -725,6 +813,10 @@ void ObjectManager::ibm_updateMacroscopic(int level) {
 						id = kdx + jdx * iBody[ib]._Owner->K_lim + idx * iBody[ib]._Owner->K_lim * iBody[ib]._Owner->M_lim;
 						type_local = iBody[ib]._Owner->LatTyp[id];
 
+						// Store start-of-step velocity before modifying it
+						if (hasFlexibleBodies[level])
+							ibm_recordSupportSite(iBody[ib]._Owner, id);
+
 						// Update macroscopic value at this site
 						iBody[ib]._Owner->_LBM_macro_opt(idx, jdx, kdx, id, type_local);
 					}
@@ -758,6 +850,10 @@ void ObjectManager::ibm_updateMacroscopic(int level) {
 			id = kdx + jdx * iBody[ib]._Owner->K_lim + idx * iBody[ib]._Owner->K_lim * iBody[ib]._Owner->M_lim;
 			type_local = iBody[ib]._Owner->LatTyp[id];
 
+			// Store start-of-step velocity before modifying it
+			if (hasFlexibleBodies[level])
+				ibm_recordSupportSite(iBody[ib]._Owner, id);
+
 			// Update macroscopic value at this site
 			iBody[ib]._Owner->_LBM_macro_opt(idx, jdx, kdx, id, type_local);
 		}
@@ -802,7 +898,7 @@ void ObjectManager::ibm_findEpsilon(int level) {
 	int rank = GridUtils::safeGetRank();
 
 #ifdef L_BUILD_FOR_MPI
-	MPI_Barrier(MpiManager::getInstance()->world_comm);
+	MPI_Barrier(MpiManager::getInstance()->lev_comm[level]);
 #endif
 
 	// Loop through all iBodys this rank owns
@@ -899,7 +995,7 @@ void ObjectManager::ibm_findEpsilon(int level) {
 	}
 
 #ifdef L_BUILD_FOR_MPI
-	MPI_Barrier(MpiManager::getInstance()->world_comm);
+	MPI_Barrier(MpiManager::getInstance()->lev_comm[level]);
 #endif
 
 #ifdef L_UNIVERSAL_EPSILON_CALC
@@ -1035,14 +1131,18 @@ double ObjectManager::ibm_checkVelDiff(int level) {
 // *****************************************************************************
 ///	\brief	Some final setup required for IBM after geometry read-in
 ///
+///			Also called when the bodies have moved between ranks to rebuild
+///			the index mappings.
+///
 ///	\param	iBodyID		global body ID
 void ObjectManager::ibm_finaliseReadIn(int iBodyID) {
 
 	// Get rank
 	int rank = GridUtils::safeGetRank();
 
-	// Resize mapping vector
-	bodyIDToIdx.resize(iBodyID, -1);
+	// Reset mapping vectors
+	bodyIDToIdx.assign(iBodyID, -1);
+	idxFEM.clear();
 
 	// Set index mapping and reset FEM to IBM pointers
 	for (size_t ib = 0; ib < iBody.size(); ib++) {
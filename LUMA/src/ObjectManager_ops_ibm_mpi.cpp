@@ -140,22 +140,32 @@ void ObjectManager::ibm_spreadOffRankForces(int level) {
 // *****************************************************************************
 ///	\brief	Update new markers across all ranks
 ///
+///			By default only flexible bodies are updated as these are the only 
+///			ones whose markers move between ranks. After a change in the 
+///			decomposition all bodies must be redistributed in which case the 
+///			bAllBodies flag should be set.
+///
 ///	\param	level		current grid level
-void ObjectManager::ibm_updateMarkers(int level) {
+///	\param	bAllBodies	flag to update all bodies rather than just flexible ones
+void ObjectManager::ibm_updateMarkers(int level, bool bAllBodies) {
 
 	// Get the mpi manager instance
 	MpiManager *mpim = MpiManager::getInstance();
 
-	// Loop through all flexible bodies that this rank owns
-	for (auto ib : idxFEM) {
+	// Loop through all bodies that this rank owns
+	for (size_t ib = 0; ib < iBody.size(); ib++) {
 
-		// Only do if on this grid level
-		if (iBody[ib]._Owner->level == level) {
+		// Only do if owned, on this grid level and flexible (unless doing all)
+		if (iBody[ib].owningRank == mpim->my_rank && iBody[ib]._Owner->level == level &&
+			(iBody[ib].isFlexible || bAllBodies)) {
 
 			// Loop through all markers and assign rank
 			for (size_t m = 0; m < iBody[ib].markers.size(); m++) {
 				iBody[ib].markers[m].owningRank = GridUtils::getRankfromPosition(iBody[ib].markers[m].position);
 			}
+
+			// Owner keeps all markers but which are valid may have changed
+			if (bAllBodies) iBody[ib].getValidMarkers();
 		}
 	}
 
@@ -165,13 +175,13 @@ void ObjectManager::ibm_updateMarkers(int level) {
 	std::vector<std::vector<std::vector<double>>> vels(iBody.size(), std::vector<std::vector<double>>(0, std::vector<double>(0)));
 
 	// Do MPI comm for spreading markers
-	mpim->mpi_spreadNewMarkers(level, markerIDs, positions, vels);
+	mpim->mpi_spreadNewMarkers(level, markerIDs, positions, vels, bAllBodies);
 
 	// Loop through all iBodies
 	for (size_t ib = 0; ib < iBody.size(); ib++) {
 
-		// If body is on this level and flexible
-		if (iBody[ib]._Owner->level == level && iBody[ib].isFlexible) {
+		// If body is on this level and flexible (unless doing all)
+		if (iBody[ib]._Owner->level == level && (iBody[ib].isFlexible || bAllBodies)) {
 
 			// Also if not owned by this rank
 			if (iBody[ib].owningRank != mpim->my_rank) {
@@ -27,104 +27,90 @@
 
 
 // *****************************************************************************
-///	\brief	Write out position of immersed boundary bodies
+///	\brief	Buffer the marker positions of immersed boundary bodies
+///
+///			Each body is recorded by its owning rank. Records are written to
+///			Body_Positions.bin once L_BODY_BUFFER_STEPS write outs are held.
+///			Must be called by all ranks.
 ///
 ///	\param	timestep		current time step
 void ObjectManager::io_writeBodyPosition(int timestep) {
 
 	int rank = GridUtils::safeGetRank();
+	std::vector<double> &buf = bodySeries[eSeriesPosition].buffer;
 
 	for (size_t ib = 0; ib < iBody.size(); ib++) {
 
+		if (iBody[ib].owningRank != rank) continue;
 
-			// Open file for given time step
-			std::ofstream jout;
-			jout.open(GridUtils::path_str + "/Body_" + std::to_string(ib) + "_position_" + std::to_string(timestep) + 
-				"_rank" + std::to_string(rank) + ".out", std::ios::out);
-			jout << "x" + std::to_string(timestep) + ", y" + std::to_string(timestep) + ", z" << std::endl;
-
-			// Write out position
-			for (size_t i = 0; i < iBody[ib].markers.size(); i++) {
-#if (L_DIMS == 3)
-				jout	<< iBody[ib].markers[i].position[0] << ", " 
-						<< iBody[ib].markers[i].position[1] << ", " 
-						<< iBody[ib].markers[i].position[2] << std::endl;
-#else
-				jout	<< iBody[ib].markers[i].position[0] << ", " 
-						<< iBody[ib].markers[i].position[1] << ", " 
-						<< 0.0 << std::endl;
-#endif
-			}
-			jout.close();
+		// Marker index and position
+		_io_bodySeriesRecord(eSeriesPosition, timestep, iBody[ib].id, iBody[ib].markers.size());
+		for (size_t i = 0; i < iBody[ib].markers.size(); i++) {
+			buf.push_back(static_cast<double>(i));
+			for (int d = 0; d < 3; d++)
+				buf.push_back(d < L_DIMS ? iBody[ib].markers[i].position[d] : 0.0);
+		}
 	}
+
+	_io_bodySeriesEndStep(eSeriesPosition);
 }
 
 
 // *****************************************************************************
-///	\brief	Write out forces on the markers of immersed boundary bodies
+///	\brief	Buffer the forces on the markers of immersed boundary bodies
+///
+///			Flexible bodies are recorded by the owning rank and rigid bodies by
+///			each rank holding valid markers. Records are written to
+///			Body_LiftDrag.bin once L_BODY_BUFFER_STEPS write outs are held.
+///			Must be called by all ranks.
 void ObjectManager::io_writeLiftDrag() {
 
 	// Force conversion
 	double forceScaling, volWidth, volDepth;
 
-	// Write out lift and drag
 	int rank = GridUtils::safeGetRank();
+	std::vector<double> &buf = bodySeries[eSeriesLiftDrag].buffer;
 
 	// Loop through all bodies
 	for (size_t ib = 0; ib < iBody.size(); ib++) {
 
-		// If owning and flexible then write or if body is rigid and this rank has some markers
-		if ((iBody[ib].isFlexible && iBody[ib].owningRank == rank) || (!iBody[ib].isFlexible && iBody[ib].validMarkers.size() > 0)) {
+		// Sort out which markers to write out
+		std::vector<int> validMarkers;
 
-			// Sort out which markers to write out
-			std::vector<int> validMarkers;
+		// If flexible then write out all markers, if rigid only markers on this rank
+		if (iBody[ib].isFlexible && iBody[ib].owningRank == rank)
+			validMarkers = GridUtils::onespace(0, static_cast<int>(iBody[ib].markers.size())-1);
+		else if (!iBody[ib].isFlexible && iBody[ib].validMarkers.size() > 0)
+			validMarkers = iBody[ib].validMarkers;
+		else
+			continue;
 
-			// If flexible then write out all markers, if rigid only markers on this rank
-			if (iBody[ib].isFlexible && iBody[ib].owningRank == rank)
-				validMarkers = GridUtils::onespace(0, static_cast<int>(iBody[ib].markers.size())-1);
-			else if (!iBody[ib].isFlexible && iBody[ib].validMarkers.size() > 0)
-				validMarkers = iBody[ib].validMarkers;
-
-			// Open file for given time step
-			std::ofstream jout;
-			jout.open(GridUtils::path_str + "/Body_" + std::to_string(iBody[ib].id) + "_LD_rank" + std::to_string(rank) + ".out", std::ios::app);
-			jout.precision(L_OUTPUT_PRECISION);
-
-			// If first time then write out header
-			if (_Grids->t == 0)
-				jout << "Timestep\tTime (s)\tDrag (N)\tLift (N)" << std::endl;
-
-			// Convert force per volume to force
+		// Convert force per volume to force
 #if (L_DIMS == 2)
-			forceScaling = iBody[ib]._Owner->dm * iBody[ib]._Owner->dh / SQ(iBody[ib]._Owner->dt) * 1.0 / iBody[ib]._Owner->dh;
+		forceScaling = iBody[ib]._Owner->dm * iBody[ib]._Owner->dh / SQ(iBody[ib]._Owner->dt) * 1.0 / iBody[ib]._Owner->dh;
 #elif (L_DIMS == 3)
-			forceScaling = iBody[ib]._Owner->dm * iBody[ib]._Owner->dh / SQ(iBody[ib]._Owner->dt);
+		forceScaling = iBody[ib]._Owner->dm * iBody[ib]._Owner->dh / SQ(iBody[ib]._Owner->dt);
 #endif
 
-			// Write out timestep data
-			jout << _Grids->t << "\t" << _Grids->t * _Grids->dt;
-
-			// Compute lift and drag
-			for (auto m : validMarkers) {
+		// Marker index and force on marker
+		_io_bodySeriesRecord(eSeriesLiftDrag, _Grids->t, iBody[ib].id, validMarkers.size());
+		for (auto m : validMarkers) {
 
-				// Get volume scaling
-				volWidth = iBody[ib].markers[m].epsilon;
+			// Get volume scaling
+			volWidth = iBody[ib].markers[m].epsilon;
 #if (L_DIMS == 2)
-				volDepth = 1.0;
+			volDepth = 1.0;
 #elif (L_DIMS == 3)
-				volDepth = iBody[ib].markers[m].ds;
+			volDepth = iBody[ib].markers[m].ds;
 #endif
 
-				// Write out force on markers
-				for (int dir = 0; dir < L_DIMS; dir++)
-					jout << "\t" << iBody[ib].markers[m].force_xyz[dir] * volWidth * volDepth * iBody[ib].markers[m].ds * forceScaling;
-			}
-
-			// Next line and close file
-			jout << std::endl;
-			jout.close();
+			buf.push_back(static_cast<double>(m));
+			for (int dir = 0; dir < 3; dir++)
+				buf.push_back(dir < L_DIMS ? iBody[ib].markers[m].force_xyz[dir] * volWidth * volDepth * iBody[ib].markers[m].ds * forceScaling : 0.0);
 		}
 	}
+
+	_io_bodySeriesEndStep(eSeriesLiftDrag);
 }
 
 
@@ -314,6 +300,223 @@ void ObjectManager::io_vtkBodyWriter(int tval)
 }
 
 
+// *****************************************************************************
+///	\brief	Aggregated binary body writer
+///
+///			Gathers the markers of all bodies (IB and BFL) from their owning 
+///			ranks to rank 0 and writes a single binary VTK XML unstructured grid 
+///			file per time step. Markers are written as points joined by lines 
+///			with body ID, marker velocity and marker force as point data (BFL 
+///			markers carry zero velocity and force). Bodies without markers are 
+///			left out. No file is written when there are no body markers on any 
+///			rank. Must be called by all ranks.
+///
+///	\param	tval		time value at which the write out is being performed
+void ObjectManager::io_vtuBodyWriter(int tval)
+{
+
+	// Get the rank
+	int rank = GridUtils::safeGetRank();
+
+	// Pack geometry records for owned bodies (tag 0 for IB or 2 for BFL, id, 
+	// nMarkers, closed flag, positions) and IB marker data records (tag 1, id, 
+	// marker index, velocity, force). Marker data is only looked up among IB 
+	// bodies so a BFL body sharing an id cannot take it. As for lift and drag, 
+	// marker data for flexible bodies comes from the owning rank and for rigid 
+	// bodies from the ranks holding valid markers.
+	std::vector<double> sendBuffer;
+	for (IBBody& body : iBody) {
+		if (body.owningRank == rank) {
+			sendBuffer.push_back(0.0);
+			sendBuffer.push_back(body.id);
+			sendBuffer.push_back(static_cast<double>(body.markers.size()));
+			sendBuffer.push_back(body.closed_surface ? 1.0 : 0.0);
+			for (auto& m : body.markers) {
+				for (int d = 0; d < 3; d++) sendBuffer.push_back(m.position[d]);
+			}
+		}
+
+		std::vector<int> dataMarkers;
+		if (body.isFlexible && body.owningRank == rank)
+			dataMarkers = GridUtils::onespace(0, static_cast<int>(body.markers.size()) - 1);
+		else if (!body.isFlexible)
+			dataMarkers = body.validMarkers;
+
+		for (auto m : dataMarkers) {
+			sendBuffer.push_back(1.0);
+			sendBuffer.push_back(body.id);
+			sendBuffer.push_back(m);
+			for (int d = 0; d < 3; d++) sendBuffer.push_back(body.markers[m].markerVel[d]);
+			for (int d = 0; d < 3; d++) sendBuffer.push_back(d < L_DIMS ? body.markers[m].force_xyz[d] : 0.0);
+		}
+	}
+	for (BFLBody& body : pBody) {
+		if (body.owningRank != rank) continue;
+		sendBuffer.push_back(2.0);
+		sendBuffer.push_back(body.id);
+		sendBuffer.push_back(static_cast<double>(body.markers.size()));
+		sendBuffer.push_back(body.closed_surface ? 1.0 : 0.0);
+		for (auto& m : body.markers) {
+			for (int d = 0; d < 3; d++) sendBuffer.push_back(m.position[d]);
+		}
+	}
+
+	// Count the owned markers and skip the file if no rank owns any
+	int numPoints = 0;
+	for (IBBody& body : iBody) {
+		if (body.owningRank == rank) numPoints += static_cast<int>(body.markers.size());
+	}
+	for (BFLBody& body : pBody) {
+		if (body.owningRank == rank) numPoints += static_cast<int>(body.markers.size());
+	}
+#ifdef L_BUILD_FOR_MPI
+	MpiManager *mpim = MpiManager::getInstance();
+	MPI_Allreduce(MPI_IN_PLACE, &numPoints, 1, MPI_INT, MPI_SUM, mpim->world_comm);
+#endif
+	if (numPoints == 0) return;
+
+	// Gather to rank 0
+	std::vector<double> recvBuffer;
+#ifdef L_BUILD_FOR_MPI
+	int sendSize = static_cast<int>(sendBuffer.size());
+	std::vector<int> recvSizes, recvDisps;
+	if (rank == 0) {
+		recvSizes.resize(mpim->num_ranks, 0);
+		recvDisps.resize(mpim->num_ranks, 0);
+	}
+	MPI_Gather(&sendSize, 1, MPI_INT, recvSizes.data(), 1, MPI_INT, 0, mpim->world_comm);
+	if (rank == 0) {
+		for (int r = 1; r < mpim->num_ranks; r++)
+			recvDisps[r] = recvDisps[r - 1] + recvSizes[r - 1];
+		recvBuffer.resize(std::accumulate(recvSizes.begin(), recvSizes.end(), 0));
+	}
+	MPI_Gatherv(sendBuffer.data(), sendSize, MPI_DOUBLE, recvBuffer.data(), 
+		recvSizes.data(), recvDisps.data(), MPI_DOUBLE, 0, mpim->world_comm);
+	if (rank != 0) return;
+#else
+	recvBuffer.swap(sendBuffer);
+#endif
+
+	// Unpack geometry records into point and cell arrays
+	std::vector<float> points, velocity, force;
+	std::vector<int> bodyID, connectivity, offsets;
+	std::vector<unsigned char> cellTypes;
+	std::vector<int> ibBodyStart, ibBodyPoints;
+	size_t pos = 0;
+	while (pos < recvBuffer.size()) {
+		if (recvBuffer[pos] == 1.0) {
+			pos += 9;
+			continue;
+		}
+		bool bIB = (recvBuffer[pos] == 0.0);
+		int id = static_cast<int>(recvBuffer[pos + 1]);
+		int nMarkers = static_cast<int>(recvBuffer[pos + 2]);
+		bool closed = (recvBuffer[pos + 3] != 0.0);
+		pos += 4;
+		if (nMarkers == 0) continue;
+		int start = static_cast<int>(bodyID.size());
+		if (bIB) {
+			if (id >= static_cast<int>(ibBodyStart.size())) {
+				ibBodyStart.resize(id + 1, -1);
+				ibBodyPoints.resize(id + 1, 0);
+			}
+			ibBodyStart[id] = start;
+			ibBodyPoints[id] = nMarkers;
+		}
+		for (int m = 0; m < nMarkers; m++) {
+			for (int d = 0; d < 3; d++) points.push_back(static_cast<float>(recvBuffer[pos++]));
+			bodyID.push_back(id);
+		}
+		int nLines = (closed ? nMarkers : nMarkers - 1);
+		for (int i = 0; i < nLines; i++) {
+			connectivity.push_back(start + i);
+			connectivity.push_back(start + (i + 1) % nMarkers);
+			offsets.push_back(static_cast<int>(connectivity.size()));
+			cellTypes.push_back(3);		// VTK_LINE
+		}
+	}
+
+	// Unpack marker data records into point data arrays
+	velocity.resize(points.size(), 0.0f);
+	force.resize(points.size(), 0.0f);
+	pos = 0;
+	while (pos < recvBuffer.size()) {
+		if (recvBuffer[pos] != 1.0) {
+			pos += 4 + 3 * static_cast<size_t>(recvBuffer[pos + 2]);
+			continue;
+		}
+		// Skip data for bodies without points in the file
+		int id = static_cast<int>(recvBuffer[pos + 1]);
+		int m = static_cast<int>(recvBuffer[pos + 2]);
+		if (id >= static_cast<int>(ibBodyStart.size()) || ibBodyStart[id] < 0 || m >= ibBodyPoints[id]) {
+			pos += 9;
+			continue;
+		}
+		int idx = 3 * (ibBodyStart[id] + m);
+		for (int d = 0; d < 3; d++) {
+			velocity[idx + d] = static_cast<float>(recvBuffer[pos + 3 + d]);
+			force[idx + d] = static_cast<float>(recvBuffer[pos + 6 + d]);
+		}
+		pos += 9;
+	}
+
+	// Appended data blocks (each preceded by a 64-bit byte count)
+	struct Block { const char *data; uint64_t bytes; };
+	std::vector<Block> blocks = {
+		{ reinterpret_cast<const char*>(points.data()), points.size() * sizeof(float) },
+		{ reinterpret_cast<const char*>(bodyID.data()), bodyID.size() * sizeof(int) },
+		{ reinterpret_cast<const char*>(velocity.data()), velocity.size() * sizeof(float) },
+		{ reinterpret_cast<const char*>(force.data()), force.size() * sizeof(float) },
+		{ reinterpret_cast<const char*>(connectivity.data()), connectivity.size() * sizeof(int) },
+		{ reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(int) },
+		{ reinterpret_cast<const char*>(cellTypes.data()), cellTypes.size() * sizeof(unsigned char) }
+	};
+	std::vector<uint64_t> blockOffsets(blocks.size(), 0);
+	for (size_t b = 1; b < blocks.size(); b++)
+		blockOffsets[b] = blockOffsets[b - 1] + sizeof(uint64_t) + blocks[b - 1].bytes;
+
+	// Open file
+	std::ofstream fout(GridUtils::path_str + "/Bodies." + std::to_string(tval) + ".vtu", 
+		std::ios::out | std::ios::binary);
+	if (!fout.is_open()) {
+		L_WARN("Could not open body VTU file for writing.", GridUtils::logfile);
+		return;
+	}
+
+	// XML header
+	fout << "<?xml version=\"1.0\"?>\n"
+		<< "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\">\n"
+		<< "<UnstructuredGrid>\n"
+		<< "<Piece NumberOfPoints=\"" << bodyID.size() << "\" NumberOfCells=\"" << cellTypes.size() << "\">\n"
+		<< "<Points>\n"
+		<< "<DataArray type=\"Float32\" NumberOfComponents=\"3\" format=\"appended\" offset=\"" << blockOffsets[0] << "\"/>\n"
+		<< "</Points>\n"
+		<< "<PointData Scalars=\"BodyID\" Vectors=\"Velocity\">\n"
+		<< "<DataArray type=\"Int32\" Name=\"BodyID\" format=\"appended\" offset=\"" << blockOffsets[1] << "\"/>\n"
+		<< "<DataArray type=\"Float32\" Name=\"Velocity\" NumberOfComponents=\"3\" format=\"appended\" offset=\"" << blockOffsets[2] << "\"/>\n"
+		<< "<DataArray type=\"Float32\" Name=\"Force\" NumberOfComponents=\"3\" format=\"appended\" offset=\"" << blockOffsets[3] << "\"/>\n"
+		<< "</PointData>\n"
+		<< "<Cells>\n"
+		<< "<DataArray type=\"Int32\" Name=\"connectivity\" format=\"appended\" offset=\"" << blockOffsets[4] << "\"/>\n"
+		<< "<DataArray type=\"Int32\" Name=\"offsets\" format=\"appended\" offset=\"" << blockOffsets[5] << "\"/>\n"
+		<< "<DataArray type=\"UInt8\" Name=\"types\" format=\"appended\" offset=\"" << blockOffsets[6] << "\"/>\n"
+		<< "</Cells>\n"
+		<< "</Piece>\n"
+		<< "</UnstructuredGrid>\n"
+		<< "<AppendedData encoding=\"raw\">\n_";
+
+	// Raw binary data
+	for (auto& b : blocks) {
+		fout.write(reinterpret_cast<const char*>(&b.bytes), sizeof(uint64_t));
+		if (b.bytes > 0) fout.write(b.data, b.bytes);
+	}
+	fout << "\n</AppendedData>\n</VTKFile>\n";
+
+	// Close file
+	fout.close();
+}
+
+
 // *****************************************************************************
 ///	\brief	Read in geometry config file
 ///
@@ -1052,19 +1255,19 @@ void ObjectManager::io_readInCloud(PCpts*& _PCpts, GeomPacked *geom)
 
 
 // *****************************************************************************
-/// \brief	Write out the forces on a solid object
+/// \brief	Buffer the forces on solid objects
 ///
-///			Writes out the forces on solid objects in the domain computed using
-///			momentum exchange. Each rank writes its own file. Output is a CSV file.
+///			Buffers the forces on solid objects in the domain computed using
+///			momentum exchange. The bounce-back objects are recorded with ID -1
+///			and BFL bodies with their own ID. Contributions from all ranks are
+///			summed when written to Object_Forces.bin. Must be called by all ranks.
 ///
 ///	\param	tval		time value at which write out is taking place
 void ObjectManager::io_writeForcesOnObjects(double tval) {
 	
 	// Declarations
-	int rank = GridUtils::safeGetRank();
-	std::ofstream fout;
-	fout.precision(L_OUTPUT_PRECISION);
-	std::stringstream fileName;
+	int t = static_cast<int>(tval);
+	std::vector<double> &buf = bodySeries[eSeriesForces].buffer;
 
 	// BB OBJECTS //
 
@@ -1074,44 +1277,20 @@ void ObjectManager::io_writeForcesOnObjects(double tval) {
 	// If this grid exists on this process
 	if (g != NULL)
 	{
-		// Filename
-		fileName << GridUtils::path_str + "/LiftDragBBB_Rnk" << rank << ".csv";
-
-		// Open file
-		fout.open(fileName.str().c_str(), std::ios::out | std::ios::app);
-
-		// Write out the header (first time step only)
-		if (static_cast<int>(tval) == L_EXTRA_OUT_FREQ) fout << "Time,Fx,Fy,Fz" << std::endl;
-
 		// Scaled with respect to refinement ratio
-		fout << std::to_string(tval) << ","
-			<< std::to_string(bbbForceOnObjectX * g->refinement_ratio) << ","
-			<< std::to_string(bbbForceOnObjectY * g->refinement_ratio) << ","
-#if (dims == 3)
-			<< std::to_string(bbbForceOnObjectZ * g->refinement_ratio)
+		_io_bodySeriesRecord(eSeriesForces, t, -1, 1);
+		buf.push_back(bbbForceOnObjectX * g->refinement_ratio);
+		buf.push_back(bbbForceOnObjectY * g->refinement_ratio);
+#if (L_DIMS == 3)
+		buf.push_back(bbbForceOnObjectZ * g->refinement_ratio);
 #else
-			<< std::to_string(0.0)
+		buf.push_back(0.0);
 #endif
-			<< std::endl;
-
-		fout.close();
 	}
 
 	// BFL OBJECTS //
-	ObjectManager *objman = ObjectManager::getInstance();
-	
-	// Search for bodies on this rank
-	for (BFLBody& body : objman->pBody)
+	for (BFLBody& body : pBody)
 	{
-		// Filename
-		fileName << GridUtils::path_str + "/LiftDragBFL_Rnk" << rank << ".csv";
-
-		// Open file
-		fout.open(fileName.str().c_str(), std::ios::out | std::ios::app);
-
-		// Write out the header (first time step only)
-		if (static_cast<int>(tval) == L_EXTRA_OUT_FREQ) fout << "Time,Fx,Fy,Fz" << std::endl;
-
 		// Summation required
 		double bodyForceX = 0.0;
 		double bodyForceY = 0.0;
@@ -1127,19 +1306,17 @@ void ObjectManager::io_writeForcesOnObjects(double tval) {
 		}
 
 		// Scaled with respect to refinement ratio
-		fout << std::to_string(tval) << ","
-			<< std::to_string(bodyForceX * body._Owner->refinement_ratio) << ","
-			<< std::to_string(bodyForceY * body._Owner->refinement_ratio) << ","
-#if (dims == 3)
-			<< std::to_string(bodyForceZ * body._Owner->refinement_ratio)
+		_io_bodySeriesRecord(eSeriesForces, t, body.id, 1);
+		buf.push_back(bodyForceX * body._Owner->refinement_ratio);
+		buf.push_back(bodyForceY * body._Owner->refinement_ratio);
+#if (L_DIMS == 3)
+		buf.push_back(bodyForceZ * body._Owner->refinement_ratio);
 #else
-			<< std::to_string(0.0)
+		buf.push_back(0.0);
 #endif
-			<< std::endl;
-
-		fout.close();
 	}
 
+	_io_bodySeriesEndStep(eSeriesForces);
 }
 
 
@@ -1214,32 +1391,173 @@ void ObjectManager::io_vtkFEMWriter(int tval)
 
 
 // *****************************************************************************
-/// \brief	Write out tip positions of flexible filaments
+/// \brief	Buffer the tip positions of flexible filaments
+///
+///			Records are written to Body_TipPositions.bin once
+///			L_BODY_BUFFER_STEPS write outs are held. Must be called by all ranks.
 ///
 ///	\param	tval		time value at which write out is taking place
 void ObjectManager::io_writeTipPositions(int tval) {
 
+	std::vector<double> &buf = bodySeries[eSeriesTips].buffer;
+
 	// Loop through FEM bodies which this rank owns
 	for (auto ib : idxFEM) {
 
-		// Create string and file streams
-		std::ofstream fout;
-		fout.open(GridUtils::path_str + "/Body_" + std::to_string(iBody[ib].id) + "_TipPositions.out", std::ios::app);
-		fout.precision(L_OUTPUT_PRECISION);
-
-		// Write out header
-		if (tval == 0)
-			fout << "Timestep\tt\tTipX\tTipY\tTipZ" << std::endl;
-
 		// Index of last markers
 		int idx = static_cast<int>(iBody[ib].markers.size()) - 1;
 
-		// Write out data
-		fout << tval << "\t" << tval * _Grids->dt << "\t" << iBody[ib].markers[idx].position[eXDirection] << "\t"
-														  << iBody[ib].markers[idx].position[eYDirection] << "\t"
-														  << iBody[ib].markers[idx].position[eZDirection] << std::endl;
+		_io_bodySeriesRecord(eSeriesTips, tval, iBody[ib].id, 1);
+		buf.push_back(iBody[ib].markers[idx].position[eXDirection]);
+		buf.push_back(iBody[ib].markers[idx].position[eYDirection]);
+		buf.push_back(iBody[ib].markers[idx].position[eZDirection]);
+	}
 
-		// Close file
-		fout.close();
+	_io_bodySeriesEndStep(eSeriesTips);
+}
+
+
+// *****************************************************************************
+/// \brief	Write out all buffered body time series
+///
+///			Called at the end of the run so that no buffered records are lost.
+///			Must be called by all ranks.
+void ObjectManager::io_bodySeriesFlush() {
+
+	for (int s = 0; s < eSeriesCount; s++)
+		_io_bodySeriesFlush(static_cast<eBodySeries>(s));
+}
+
+
+// *****************************************************************************
+/// \brief	Start a record in a body time series
+///
+///			The caller then appends numItems items of the series stride.
+///
+///	\param	s			series.
+///	\param	t			time step.
+///	\param	id			body ID.
+///	\param	numItems	number of items in the record.
+void ObjectManager::_io_bodySeriesRecord(eBodySeries s, int t, int id, size_t numItems) {
+
+	std::vector<double> &buf = bodySeries[s].buffer;
+	buf.push_back(static_cast<double>(t));
+	buf.push_back(static_cast<double>(id));
+	buf.push_back(static_cast<double>(numItems));
+}
+
+
+// *****************************************************************************
+/// \brief	Count a write out of a body time series and flush it when
+///			L_BODY_BUFFER_STEPS write outs have been buffered.
+///
+///	\param	s			series.
+void ObjectManager::_io_bodySeriesEndStep(eBodySeries s) {
+
+	if (++bodySeries[s].numSteps >= L_BODY_BUFFER_STEPS)
+		_io_bodySeriesFlush(s);
+}
+
+
+// *****************************************************************************
+/// \brief	Gather a body time series to rank 0 and append it to its file
+///
+///			Records are ordered by time step and body ID. If the series sums
+///			over ranks then records with the same time step and ID are added.
+///			The file starts with a header of "LUMABODY" (char[8]), the version,
+///			the stride (int32) and the time step size (double), followed by the
+///			records as time step, ID and number of items (int32) then the items
+///			(double). Nothing is written for a series which has never been
+///			recorded. Must be called by all ranks.
+///
+///	\param	s			series.
+void ObjectManager::_io_bodySeriesFlush(eBodySeries s) {
+
+	BodySeries &series = bodySeries[s];
+	if (series.numSteps == 0) return;
+	series.numSteps = 0;
+
+	// Gather to rank 0
+	std::vector<double> recvBuffer;
+#ifdef L_BUILD_FOR_MPI
+	int rank = GridUtils::safeGetRank();
+	MpiManager *mpim = MpiManager::getInstance();
+	int sendSize = static_cast<int>(series.buffer.size());
+	std::vector<int> recvSizes, recvDisps;
+	if (rank == 0) {
+		recvSizes.resize(mpim->num_ranks, 0);
+		recvDisps.resize(mpim->num_ranks, 0);
 	}
+	MPI_Gather(&sendSize, 1, MPI_INT, recvSizes.data(), 1, MPI_INT, 0, mpim->world_comm);
+	if (rank == 0) {
+		for (int r = 1; r < mpim->num_ranks; r++)
+			recvDisps[r] = recvDisps[r - 1] + recvSizes[r - 1];
+		recvBuffer.resize(std::accumulate(recvSizes.begin(), recvSizes.end(), 0));
+	}
+	MPI_Gatherv(series.buffer.data(), sendSize, MPI_DOUBLE, recvBuffer.data(),
+		recvSizes.data(), recvDisps.data(), MPI_DOUBLE, 0, mpim->world_comm);
+	series.buffer.clear();
+	if (rank != 0) return;
+#else
+	recvBuffer.swap(series.buffer);
+#endif
+	if (recvBuffer.empty() && !series.bFileStarted) return;
+
+	// Locate the records (ranks are in order so the sort keeps rank order within a key)
+	struct Record { int t, id, n; size_t start; };
+	std::vector<Record> records;
+	size_t pos = 0;
+	while (pos < recvBuffer.size()) {
+		Record r;
+		r.t = static_cast<int>(recvBuffer[pos]);
+		r.id = static_cast<int>(recvBuffer[pos + 1]);
+		r.n = static_cast<int>(recvBuffer[pos + 2]);
+		r.start = pos + 3;
+		records.push_back(r);
+		pos = r.start + static_cast<size_t>(r.n) * series.stride;
+	}
+	std::stable_sort(records.begin(), records.end(), [](const Record &a, const Record &b)
+	{
+		return (a.t != b.t) ? (a.t < b.t) : (a.id < b.id);
+	});
+
+	// Open the file (header on first write)
+	std::ofstream fout;
+	std::string path = GridUtils::path_str + "/" + series.fileName;
+	if (!series.bFileStarted) {
+		fout.open(path, std::ios::out | std::ios::binary);
+		const char tag[8] = { 'L', 'U', 'M', 'A', 'B', 'O', 'D', 'Y' };
+		int32_t header[2] = { 1, series.stride };
+		fout.write(tag, sizeof(tag));
+		fout.write(reinterpret_cast<const char*>(header), sizeof(header));
+		fout.write(reinterpret_cast<const char*>(&_Grids->dt), sizeof(double));
+		series.bFileStarted = true;
+	}
+	else {
+		fout.open(path, std::ios::out | std::ios::binary | std::ios::app);
+	}
+	if (!fout.is_open()) {
+		L_WARN("Could not open " + series.fileName + " for writing. Body output lost.", GridUtils::logfile);
+		return;
+	}
+
+	// Write records
+	std::vector<double> items;
+	for (size_t r = 0; r < records.size(); r++) {
+
+		const Record &rec = records[r];
+		items.assign(recvBuffer.begin() + rec.start, recvBuffer.begin() + rec.start + static_cast<size_t>(rec.n) * series.stride);
+
+		// Add records from other ranks with the same key
+		while (series.bSum && r + 1 < records.size() &&
+			records[r + 1].t == rec.t && records[r + 1].id == rec.id && records[r + 1].n == rec.n) {
+			r++;
+			for (size_t i = 0; i < items.size(); i++) items[i] += recvBuffer[records[r].start + i];
+		}
+
+		int32_t key[3] = { rec.t, rec.id, rec.n };
+		fout.write(reinterpret_cast<const char*>(key), sizeof(key));
+		fout.write(reinterpret_cast<const char*>(items.data()), static_cast<std::streamsize>(items.size() * sizeof(double)));
+	}
+	fout.close();
 }
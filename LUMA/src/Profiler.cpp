@@ -0,0 +1,384 @@
+/*
+* --------------------------------------------------------------
+*
+* ------ Lattice Boltzmann @ The University of Manchester ------
+*
+* -------------------------- L-U-M-A ---------------------------
+*
+* Copyright 2019 The University of Manchester
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.*
+*/
+
+#include "../inc/stdafx.h"
+#ifdef L_HW_COUNTERS
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+// Static variable declarations
+double Profiler::total[L_PROF_GRIDS][eProfPhases];
+long Profiler::calls[L_PROF_GRIDS][eProfPhases];
+const char *Profiler::names[eProfPhases] = {
+	"init/mpi",
+	"init/grids",
+	"step",
+	"step/lbm",
+	"step/stream_macro",
+	"step/collide",
+	"step/ibm/interpolate",
+	"step/ibm/force",
+	"step/ibm/spread",
+	"step/ibm/macro",
+	"step/ibm/support",
+	"step/ibm/epsilon",
+	"step/ibm/fem",
+	"mpi/pack",
+	"mpi/wait",
+	"mpi/unpack",
+	"io/text",
+	"io/fga",
+	"io/lite",
+	"io/hdf5",
+	"io/bodies",
+	"io/body_position",
+	"io/tips",
+	"io/forces",
+	"io/probes",
+	"io/restart"
+};
+#ifdef L_HW_COUNTERS
+long long Profiler::hwTotal[L_PROF_GRIDS][eProfPhases][eHwCounters];
+std::vector<int> Profiler::hwFd[eHwCounters];
+double Profiler::streamBandwidth = 0.0;
+#endif
+
+/// \brief	Adds a timed interval to a phase.
+///
+///	\param	phase	phase timed.
+///	\param	level	level of the grid on which the phase was performed.
+///	\param	region	region of the grid on which the phase was performed.
+///	\param	dt		duration of the interval in seconds.
+void Profiler::add(eProfPhase phase, int level, int region, double dt)
+{
+	int g = (level == 0) ? 0 : 1 + (level - 1) * L_NUM_REGIONS + region;
+	if (g < 0 || g >= L_PROF_GRIDS) return;
+	total[g][phase] += dt;
+	calls[g][phase]++;
+}
+
+/// \brief	Returns the time accumulated by a phase on this rank.
+///
+///	\param	phase	phase timed.
+///	\param	level	level of the grid on which the phase was performed.
+///	\param	region	region of the grid on which the phase was performed.
+///	\return	accumulated time in seconds (zero unless timings are logged).
+double Profiler::elapsed(eProfPhase phase, int level, int region)
+{
+	int g = (level == 0) ? 0 : 1 + (level - 1) * L_NUM_REGIONS + region;
+	if (g < 0 || g >= L_PROF_GRIDS) return 0.0;
+	return total[g][phase];
+}
+
+/// \brief	Gathers the phase times from all ranks and writes the report.
+///
+///			For each timer recorded on at least one rank, the number of
+///			ranks, the maximum number of calls and the min / mean / max of
+///			the accumulated time across those ranks are written to
+///			timings.json and timings.csv by rank 0. Must be called by all
+///			ranks.
+void Profiler::writeReport()
+{
+	const int n = L_PROF_GRIDS * eProfPhases;
+	int rank = GridUtils::safeGetRank();
+	int nRanks = 1;
+	std::vector<double> allTotal(&total[0][0], &total[0][0] + n);
+	std::vector<long> allCalls(&calls[0][0], &calls[0][0] + n);
+
+#ifdef L_BUILD_FOR_MPI
+	// Gather the timers of all ranks on rank 0
+	MpiManager *mpim = MpiManager::getInstance();
+	nRanks = mpim->num_ranks;
+	if (rank == 0)
+	{
+		allTotal.resize(static_cast<size_t>(n) * nRanks);
+		allCalls.resize(static_cast<size_t>(n) * nRanks);
+	}
+	MPI_Gather(&total[0][0], n, MPI_DOUBLE, allTotal.data(), n, MPI_DOUBLE, 0, mpim->world_comm);
+	MPI_Gather(&calls[0][0], n, MPI_LONG, allCalls.data(), n, MPI_LONG, 0, mpim->world_comm);
+#endif
+
+#ifdef L_HW_COUNTERS
+	_writeCounterReport(allTotal, nRanks);
+#endif
+
+	if (rank != 0) return;
+
+	std::ofstream json(GridUtils::path_str + "/timings.json", std::ios::out);
+	std::ofstream csv(GridUtils::path_str + "/timings.csv", std::ios::out);
+	json.precision(9);
+	csv.precision(9);
+	json << "{\n\t\"ranks\": " << nRanks << ",\n\t\"units\": \"s\",\n\t\"timers\": [";
+	csv << "level,region,phase,ranks,calls,min,mean,max" << std::endl;
+
+	bool bFirst = true;
+	for (int g = 0; g < L_PROF_GRIDS; ++g)
+	{
+		int level = (g == 0) ? 0 : 1 + (g - 1) / L_NUM_REGIONS;
+		int region = (g == 0) ? 0 : (g - 1) % L_NUM_REGIONS;
+
+		for (int p = 0; p < eProfPhases; ++p)
+		{
+			// Statistics over the ranks which recorded this timer
+			int nRec = 0;
+			long maxCalls = 0;
+			double tMin = 0.0, tMax = 0.0, tSum = 0.0;
+			for (int r = 0; r < nRanks; ++r)
+			{
+				size_t idx = static_cast<size_t>(r) * n + g * eProfPhases + p;
+				if (allCalls[idx] == 0) continue;
+				double tr = allTotal[idx];
+				if (nRec == 0 || tr < tMin) tMin = tr;
+				if (nRec == 0 || tr > tMax) tMax = tr;
+				tSum += tr;
+				maxCalls = std::max(maxCalls, allCalls[idx]);
+				nRec++;
+			}
+			if (nRec == 0) continue;
+
+			json << (bFirst ? "\n" : ",\n") << "\t\t{ \"level\": " << level << ", \"region\": " << region <<
+				", \"phase\": \"" << names[p] << "\", \"ranks\": " << nRec << ", \"calls\": " << maxCalls <<
+				", \"min\": " << tMin << ", \"mean\": " << tSum / nRec << ", \"max\": " << tMax << " }";
+			csv << level << "," << region << "," << names[p] << "," << nRec << "," << maxCalls << "," <<
+				tMin << "," << tSum / nRec << "," << tMax << std::endl;
+			bFirst = false;
+		}
+	}
+	json << "\n\t]\n}" << std::endl;
+
+	L_INFO("Phase timings written to timings.json and timings.csv.", GridUtils::logfile);
+}
+
+#ifdef L_HW_COUNTERS
+/// \brief	Opens the hardware counters and measures the memory bandwidth.
+///
+///			A counter only counts the thread which opens it so with OpenMP 
+///			each thread of the pool opens its own counters and the readings of
+///			all of them are summed. Threads started later are not counted. If 
+///			a counter cannot be opened (e.g. perf_event_paranoid forbids it) a
+///			warning is written and it reads zero. Must be called by all ranks.
+void Profiler::initCounters()
+{
+	const unsigned long long configs[eHwCounters] = {
+		PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES };
+	const char *counterNames[eHwCounters] = { "cycles", "instructions", "cache misses" };
+	int openErr[eHwCounters] = { 0, 0, 0 };
+
+	// Open the counters on every thread
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel
+#endif
+	{
+		int fd[eHwCounters], err[eHwCounters];
+		for (int c = 0; c < eHwCounters; ++c)
+		{
+			perf_event_attr attr;
+			std::memset(&attr, 0, sizeof(attr));
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.size = sizeof(attr);
+			attr.config = configs[c];
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+
+			fd[c] = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+			err[c] = (fd[c] < 0) ? errno : 0;
+		}
+
+#ifdef L_ENABLE_OPENMP
+#pragma omp critical
+#endif
+		for (int c = 0; c < eHwCounters; ++c)
+		{
+			if (fd[c] >= 0) hwFd[c].push_back(fd[c]);
+			else openErr[c] = err[c];
+		}
+	}
+
+	for (int c = 0; c < eHwCounters; ++c)
+	{
+		if (openErr[c] != 0)
+			L_WARN("Could not open hardware counter for " + std::string(counterNames[c]) +
+			" (" + std::strerror(openErr[c]) + "). " + (hwFd[c].empty() ? "It will read zero." : 
+			"Only the threads which opened it are counted."), GridUtils::logfile);
+	}
+
+	_measureBandwidth();
+}
+
+/// \brief	Measures the memory bandwidth with a STREAM triad.
+///
+///			All ranks run the triad at the same time, on all of their threads,
+///			so ranks sharing a node share its bandwidth as they do when running. The best of several
+///			repetitions is kept and 24 bytes are counted per element as STREAM
+///			does.
+void Profiler::_measureBandwidth()
+{
+	const size_t n = L_HW_STREAM_SIZE;
+	const int nReps = 5;
+	std::vector<double> a(n, 1.0), b(n, 2.0), c(n, 0.5);
+
+#ifdef L_BUILD_FOR_MPI
+	MPI_Barrier(MpiManager::getInstance()->world_comm);
+#endif
+
+	double best = 0.0;
+	for (int r = 0; r < nReps; ++r)
+	{
+		double t0 = now();
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
+#endif
+		for (size_t i = 0; i < n; ++i)
+			a[i] = b[i] + 3.0 * c[i];
+		double dt = now() - t0;
+		if (r == 0 || dt < best) best = dt;
+	}
+
+	// Use the result so the loop is not optimised away
+	if (a[n / 2] != 2.0 + 3.0 * 0.5) L_WARN("Bandwidth measurement produced an unexpected result.", GridUtils::logfile);
+
+	streamBandwidth = (best > 0.0) ? 3.0 * sizeof(double) * n / best : 0.0;
+	L_INFO("Measured memory bandwidth (STREAM triad) = " + std::to_string(streamBandwidth / 1e9) + " GB/s", GridUtils::logfile);
+}
+
+/// \brief	Reads the time and the hardware counters of all threads.
+///	\param	m	mark to fill in.
+void Profiler::mark(ProfMark &m)
+{
+	for (int c = 0; c < eHwCounters; ++c)
+	{
+		// Sum over the threads
+		m.hw[c] = 0;
+		for (int fd : hwFd[c])
+		{
+			long long count;
+			if (read(fd, &count, sizeof(long long)) == sizeof(long long)) m.hw[c] += count;
+		}
+	}
+	m.t = now();
+}
+
+/// \brief	Adds a timed interval and its counts to a phase.
+///
+///	\param	phase	phase timed.
+///	\param	level	level of the grid on which the phase was performed.
+///	\param	region	region of the grid on which the phase was performed.
+///	\param	start	mark taken at the start of the interval.
+void Profiler::add(eProfPhase phase, int level, int region, const ProfMark &start)
+{
+	ProfMark end;
+	mark(end);
+	add(phase, level, region, end.t - start.t);
+
+	int g = (level == 0) ? 0 : 1 + (level - 1) * L_NUM_REGIONS + region;
+	if (g < 0 || g >= L_PROF_GRIDS) return;
+	for (int c = 0; c < eHwCounters; ++c)
+		hwTotal[g][phase][c] += end.hw[c] - start.hw[c];
+}
+
+/// \brief	Gathers the counts from all ranks and writes hwcounters.csv.
+///
+///			For each phase with counts the totals across the ranks which
+///			recorded it are written together with the derived IPC, memory
+///			traffic (one cache line per last level miss), the achieved
+///			bandwidth per rank and its fraction of the measured bandwidth. The
+///			last column is a rough indication of what limits the phase: halo
+///			phases are communication bound, phases reaching half of the
+///			measured bandwidth are bandwidth bound and the rest are latency
+///			bound if their IPC is below one and compute bound otherwise.
+///			Must be called by all ranks.
+///
+///	\param	allTotal	phase times of all ranks as gathered by writeReport().
+///	\param	nRanks		number of ranks.
+void Profiler::_writeCounterReport(const std::vector<double> &allTotal, int nRanks)
+{
+	const int n = L_PROF_GRIDS * eProfPhases * eHwCounters;
+	const int nt = L_PROF_GRIDS * eProfPhases;
+	const double lineBytes = 64.0;
+	int rank = GridUtils::safeGetRank();
+	std::vector<long long> allHw(&hwTotal[0][0][0], &hwTotal[0][0][0] + n);
+	std::vector<double> allBandwidth(1, streamBandwidth);
+
+#ifdef L_BUILD_FOR_MPI
+	MpiManager *mpim = MpiManager::getInstance();
+	if (rank == 0)
+	{
+		allHw.resize(static_cast<size_t>(n) * nRanks);
+		allBandwidth.resize(nRanks);
+	}
+	MPI_Gather(&hwTotal[0][0][0], n, MPI_LONG_LONG, allHw.data(), n, MPI_LONG_LONG, 0, mpim->world_comm);
+	MPI_Gather(&streamBandwidth, 1, MPI_DOUBLE, allBandwidth.data(), 1, MPI_DOUBLE, 0, mpim->world_comm);
+#endif
+
+	if (rank != 0) return;
+
+	// Mean measured bandwidth per rank
+	double peak = std::accumulate(allBandwidth.begin(), allBandwidth.end(), 0.0) / nRanks;
+
+	std::ofstream csv(GridUtils::path_str + "/hwcounters.csv", std::ios::out);
+	csv.precision(9);
+	csv << "# measured bandwidth per rank (GB/s) = " << peak / 1e9 << std::endl;
+	csv << "level,region,phase,ranks,time,cycles,instructions,ipc,cache_misses,bytes,bandwidth,peak_fraction,bound" << std::endl;
+
+	for (int g = 0; g < L_PROF_GRIDS; ++g)
+	{
+		int level = (g == 0) ? 0 : 1 + (g - 1) / L_NUM_REGIONS;
+		int region = (g == 0) ? 0 : (g - 1) % L_NUM_REGIONS;
+
+		for (int p = 0; p < eProfPhases; ++p)
+		{
+			// Sum over the ranks which counted this phase
+			int nRec = 0;
+			double time = 0.0;
+			long long hw[eHwCounters] = { 0, 0, 0 };
+			for (int r = 0; r < nRanks; ++r)
+			{
+				size_t idx = static_cast<size_t>(r) * n + (g * eProfPhases + p) * eHwCounters;
+				if (allHw[idx + eHwCycles] == 0 && allHw[idx + eHwInstructions] == 0) continue;
+				for (int c = 0; c < eHwCounters; ++c) hw[c] += allHw[idx + c];
+				time += allTotal[static_cast<size_t>(r) * nt + g * eProfPhases + p];
+				nRec++;
+			}
+			if (nRec == 0) continue;
+
+			// Derived quantities (bandwidth is per rank)
+			double ipc = (hw[eHwCycles] > 0) ? static_cast<double>(hw[eHwInstructions]) / hw[eHwCycles] : 0.0;
+			double bytes = lineBytes * hw[eHwCacheMisses];
+			double bandwidth = (time > 0.0) ? bytes / time : 0.0;
+			double fraction = (peak > 0.0) ? bandwidth / peak : 0.0;
+			std::string bound =
+				(p == eProfMPIPack || p == eProfMPIWait || p == eProfMPIUnpack) ? "communication" :
+				(fraction >= 0.5) ? "bandwidth" :
+				(ipc < 1.0) ? "latency" : "compute";
+
+			csv << level << "," << region << "," << names[p] << "," << nRec << "," << time / nRec << "," <<
+				hw[eHwCycles] << "," << hw[eHwInstructions] << "," << ipc << "," << hw[eHwCacheMisses] << "," <<
+				bytes << "," << bandwidth / 1e9 << "," << fraction << "," << bound << std::endl;
+		}
+	}
+
+	L_INFO("Hardware counters written to hwcounters.csv.", GridUtils::logfile);
+}
+#endif
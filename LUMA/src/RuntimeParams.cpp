@@ -0,0 +1,321 @@
+/*
+* --------------------------------------------------------------
+*
+* ------ Lattice Boltzmann @ The University of Manchester ------
+*
+* -------------------------- L-U-M-A ---------------------------
+*
+* Copyright 2019 The University of Manchester
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.*
+*/
+
+#include "../inc/stdafx.h"
+
+// Static variable declarations (defaults are the values in definitions.h)
+int RuntimeParams::totalTimesteps = L_defaults::totalTimesteps;
+int RuntimeParams::gridOutFreq = L_defaults::gridOutFreq;
+int RuntimeParams::extraOutFreq = L_defaults::extraOutFreq;
+int RuntimeParams::restartOutFreq = L_defaults::restartOutFreq;
+int RuntimeParams::probeOutFreq = L_defaults::probeOutFreq;
+int RuntimeParams::outputPrecision = L_defaults::outputPrecision;
+double RuntimeParams::resolution = L_defaults::resolution;
+double RuntimeParams::timestep = L_defaults::timestep;
+double RuntimeParams::physicalU = L_defaults::physicalU;
+double RuntimeParams::physicalRho = L_defaults::physicalRho;
+double RuntimeParams::ux0 = L_defaults::ux0;
+double RuntimeParams::uy0 = L_defaults::uy0;
+double RuntimeParams::uz0 = L_defaults::uz0;
+double RuntimeParams::rhoIn = L_defaults::rhoIn;
+double RuntimeParams::re = L_defaults::re;
+double RuntimeParams::relax = L_defaults::relax;
+double RuntimeParams::cSmag = L_defaults::cSmag;
+double RuntimeParams::gravityForce = L_defaults::gravityForce;
+eType RuntimeParams::wall[6] = { L_defaults::wall[0], L_defaults::wall[1], L_defaults::wall[2],
+	L_defaults::wall[3], L_defaults::wall[4], L_defaults::wall[5] };
+int RuntimeParams::mpiCores[3] = { L_defaults::mpiCores[0], L_defaults::mpiCores[1], L_defaults::mpiCores[2] };
+int RuntimeParams::mpiSDMaxIter = L_defaults::mpiSDMaxIter;
+int RuntimeParams::mpiRebalanceFreq = L_defaults::mpiRebalanceFreq;
+double RuntimeParams::mpiRebalanceThreshold = L_defaults::mpiRebalanceThreshold;
+int RuntimeParams::regridFreq = L_defaults::regridFreq;
+double RuntimeParams::regridThreshold = L_defaults::regridThreshold;
+eCollisionModel RuntimeParams::collisionModel = L_defaults::collisionModel;
+eLogLevel RuntimeParams::logLevel = L_defaults::logLevel;
+double RuntimeParams::logFlushInterval = L_defaults::logFlushInterval;
+int RuntimeParams::logAggregate = L_defaults::logAggregate;
+std::string RuntimeParams::fileName;
+std::vector<std::string> RuntimeParams::changed;
+std::vector<std::string> RuntimeParams::unknown;
+std::vector<std::string> RuntimeParams::ignored;
+std::string RuntimeParams::lattice;
+
+/// \brief	Reads the run-time parameter file.
+///
+///			Called at the start of main before anything uses the parameters.
+///			The file is ./input/params.in unless a file name is given as the
+///			first command line argument. Each line is "NAME value" where NAME
+///			is the name of the macro in definitions.h. Blank lines and lines
+///			starting with # are skipped. The whole value must be understood
+///			and nothing may follow it on the line. Messages are kept until 
+///			report() is called since the logfile is not yet open.
+///
+///	\param	argc	number of command line arguments.
+///	\param	argv	command line arguments.
+void RuntimeParams::read(int argc, char* argv[])
+{
+	// Parameter tables
+	std::unordered_map<std::string, int*> intParams = {
+		{ "L_TOTAL_TIMESTEPS", &totalTimesteps },
+		{ "L_GRID_OUT_FREQ", &gridOutFreq },
+		{ "L_EXTRA_OUT_FREQ", &extraOutFreq },
+		{ "L_RESTART_OUT_FREQ", &restartOutFreq },
+		{ "L_PROBE_OUT_FREQ", &probeOutFreq },
+		{ "L_OUTPUT_PRECISION", &outputPrecision },
+		{ "L_MPI_XCORES", &mpiCores[eXDirection] },
+		{ "L_MPI_YCORES", &mpiCores[eYDirection] },
+		{ "L_MPI_ZCORES", &mpiCores[eZDirection] },
+		{ "L_MPI_SD_MAX_ITER", &mpiSDMaxIter },
+		{ "L_MPI_REBALANCE_FREQ", &mpiRebalanceFreq },
+		{ "L_REGRID_FREQ", &regridFreq },
+		{ "L_LOG_AGGREGATE", &logAggregate }
+	};
+	std::unordered_map<std::string, double*> doubleParams = {
+		{ "L_RESOLUTION", &resolution },
+		{ "L_TIMESTEP", &timestep },
+		{ "L_PHYSICAL_U", &physicalU },
+		{ "L_PHYSICAL_RHO", &physicalRho },
+		{ "L_UX0", &ux0 },
+		{ "L_UY0", &uy0 },
+		{ "L_UZ0", &uz0 },
+		{ "L_RHOIN", &rhoIn },
+		{ "L_RE", &re },
+		{ "L_RELAX", &relax },
+		{ "L_CSMAG", &cSmag },
+		{ "L_GRAVITY_FORCE", &gravityForce },
+		{ "L_MPI_REBALANCE_THRESHOLD", &mpiRebalanceThreshold },
+		{ "L_REGRID_THRESHOLD", &regridThreshold },
+		{ "L_LOG_FLUSH_INTERVAL", &logFlushInterval }
+	};
+	std::unordered_map<std::string, eType*> wallParams = {
+		{ "L_WALL_LEFT", &wall[eLeftWall] },
+		{ "L_WALL_RIGHT", &wall[eRightWall] },
+		{ "L_WALL_BOTTOM", &wall[eBottomWall] },
+		{ "L_WALL_TOP", &wall[eTopWall] },
+		{ "L_WALL_FRONT", &wall[eFrontWall] },
+		{ "L_WALL_BACK", &wall[eBackWall] }
+	};
+	std::unordered_map<std::string, eType> wallTypes = {
+		{ "eSolid", eSolid },
+		{ "eFluid", eFluid },
+		{ "eVelocity", eVelocity },
+		{ "ePressure", ePressure },
+		{ "eSlip", eSlip },
+		{ "eExtrapolateRight", eExtrapolateRight }
+	};
+	std::unordered_map<std::string, eCollisionModel> collisionModels = {
+		{ "BGK", eBGK },
+		{ "BGKSMAG", eBGKSmag },
+		{ "KBC", eKBC }
+	};
+	std::unordered_map<std::string, eLogLevel> logLevels = {
+		{ "DEBUG", eLogDebug },
+		{ "INFO", eLogInfo },
+		{ "WARNING", eLogWarn },
+		{ "ERROR", eLogError }
+	};
+
+	// Open file (a missing default file is not an error)
+	bool bRequested = (argc > 1);
+	fileName = bRequested ? argv[1] : "./input/params.in";
+	std::ifstream file(fileName, std::ios::in);
+	if (!file.is_open())
+	{
+		if (bRequested) unknown.push_back(fileName + " (file could not be opened)");
+		fileName.clear();
+		return;
+	}
+
+	// Read lines
+	std::string line, name, value;
+	while (std::getline(file, line))
+	{
+		std::istringstream iss(line);
+		if (!(iss >> name) || name[0] == '#') continue;
+		if (!(iss >> value))
+		{
+			unknown.push_back(line + " (no value)");
+			continue;
+		}
+		std::string extra;
+		if (iss >> extra)
+		{
+			unknown.push_back(line + " (text after value)");
+			continue;
+		}
+
+		// Parse value according to the parameter type (numbers must use the whole value)
+		std::istringstream vss(value);
+		bool bOK = false;
+		if (intParams.count(name))
+		{
+			bOK = static_cast<bool>(vss >> *intParams[name]);
+			vss >> std::ws;
+			bOK = bOK && vss.eof();
+		}
+		else if (doubleParams.count(name))
+		{
+			bOK = static_cast<bool>(vss >> *doubleParams[name]);
+			vss >> std::ws;
+			bOK = bOK && vss.eof();
+		}
+		else if (wallParams.count(name) && wallTypes.count(value))
+		{
+			*wallParams[name] = wallTypes[value];
+			bOK = true;
+		}
+		else if (name == "L_COLLISION_MODEL" && collisionModels.count(value))
+		{
+			collisionModel = collisionModels[value];
+			bOK = true;
+		}
+		else if (name == "L_LOG_LEVEL" && logLevels.count(value))
+		{
+			logLevel = logLevels[value];
+			bOK = true;
+		}
+		else if (name == "L_LATTICE" && (value == "D2Q9" || value == "D3Q19" || value == "D3Q27"))
+		{
+			lattice = value;
+			bOK = true;
+		}
+
+		if (bOK) changed.push_back(name + " = " + value);
+		else unknown.push_back(line);
+	}
+
+	// Restore parameters which have no meaning in 2D
+#if (L_DIMS != 3)
+	if (mpiCores[eZDirection] != 1 || uz0 != 0.0)
+	{
+		ignored.push_back("L_MPI_ZCORES / L_UZ0");
+		mpiCores[eZDirection] = 1;
+		uz0 = 0.0;
+	}
+#endif
+}
+
+/// \brief	Writes the run-time parameters to the logfile.
+///
+///			Exits if the parameter file contained lines which could not be
+///			understood, if a frequency, the resolution or a number of MPI 
+///			ranks is not positive or if the requested lattice, or the lattice
+///			needed by the requested collision model, is not the one compiled.
+void RuntimeParams::report()
+{
+	if (fileName.empty())
+		L_INFO("No run-time parameter file found. Using the values in definitions.h.", GridUtils::logfile);
+	else
+	{
+		L_INFO("Run-time parameters read from " + fileName + ":", GridUtils::logfile);
+		for (const std::string &s : changed)
+			L_INFO("   " + s, GridUtils::logfile);
+	}
+	for (const std::string &s : ignored)
+		L_WARN("Run-time parameter " + s + " ignored in 2D.", GridUtils::logfile);
+	L_INFO("Lattice = " + latticeName() + " (compile-time)", GridUtils::logfile);
+	L_INFO("Collision model = " + collisionModelName(), GridUtils::logfile);
+	L_INFO("Log level = " + logLevelName(), GridUtils::logfile);
+
+	// Unrecognised lines are fatal so that a typo does not silently run the defaults
+	if (!unknown.empty())
+	{
+		for (const std::string &s : unknown)
+			L_WARN("Could not understand run-time parameter: " + s, GridUtils::logfile);
+		L_ERROR("Run-time parameter file contains errors. Exiting.", GridUtils::logfile);
+	}
+
+	// These were fixed at compile time so nothing else checks them (the frequencies are divisors)
+	std::vector<std::pair<std::string, double>> positive = {
+		{ "L_GRID_OUT_FREQ", gridOutFreq },
+		{ "L_EXTRA_OUT_FREQ", extraOutFreq },
+		{ "L_RESTART_OUT_FREQ", restartOutFreq },
+		{ "L_PROBE_OUT_FREQ", probeOutFreq },
+		{ "L_MPI_REBALANCE_FREQ", mpiRebalanceFreq },
+		{ "L_REGRID_FREQ", regridFreq },
+		{ "L_RESOLUTION", resolution },
+		{ "L_MPI_XCORES", mpiCores[eXDirection] },
+		{ "L_MPI_YCORES", mpiCores[eYDirection] },
+		{ "L_MPI_ZCORES", mpiCores[eZDirection] }
+	};
+	bool bPositive = true;
+	for (const std::pair<std::string, double> &p : positive)
+	{
+		if (p.second > 0.0) continue;
+		L_WARN("Run-time parameter " + p.first + " must be positive.", GridUtils::logfile);
+		bPositive = false;
+	}
+	if (!bPositive)
+		L_ERROR("Run-time parameters out of range. Exiting.", GridUtils::logfile);
+
+	// The lattice is a compile-time choice so a different one needs another build
+	if (!lattice.empty() && lattice != latticeName())
+		L_ERROR("Run-time parameter L_LATTICE = " + lattice + " but this build uses " + latticeName() + 
+		". Set L_DIMS (and L_USE_KBC_COLLISION for D3Q27) and recompile. Exiting.", GridUtils::logfile);
+
+	// KBC in 3D requires the D3Q27 lattice which is a compile-time choice
+#if (L_DIMS == 3 && L_NUM_VELS != 27)
+	if (collisionModel == eKBC)
+		L_ERROR("KBC collision in 3D requires D3Q27. Define L_USE_KBC_COLLISION and recompile. Exiting.", GridUtils::logfile);
+#endif
+}
+
+/// \brief	Returns the name of the selected collision model.
+///	\return	name of the collision model.
+std::string RuntimeParams::collisionModelName()
+{
+	switch (collisionModel)
+	{
+	case eBGKSmag:
+		return "BGKSMAG";
+	case eKBC:
+		return "KBC";
+	default:
+		return "BGK";
+	}
+}
+
+
+/// \brief	Returns the name of the compiled lattice.
+///	\return	name of the lattice as used in the parameter file.
+std::string RuntimeParams::latticeName()
+{
+	return "D" + std::to_string(L_DIMS) + "Q" + std::to_string(L_NUM_VELS);
+}
+
+
+/// \brief	Returns the name of the selected log level.
+///	\return	name of the log level as used in the parameter file.
+std::string RuntimeParams::logLevelName()
+{
+	switch (logLevel)
+	{
+	case eLogDebug:
+		return "DEBUG";
+	case eLogWarn:
+		return "WARNING";
+	case eLogError:
+		return "ERROR";
+	default:
+		return "INFO";
+	}
+}
\ No newline at end of file
@@ -84,6 +84,9 @@ int main( int argc, char* argv[] )
 
 #endif
 
+	// Read the run-time parameters -- must be done before anything uses them
+	RuntimeParams::read(argc, argv);
+
 	// Reset the refined region z-limits if only 2D -- must be done before initialising the MPI manager
 #if (L_DIMS != 3 && L_NUM_LEVELS)
 	for (int i = 0; i < L_NUM_REGIONS; i++) {
@@ -103,11 +106,11 @@ int main( int argc, char* argv[] )
 	*/
 
     // Timing variables
-	clock_t t_start, secs;	// Wall clock variables
+	double t_start, secs;	// Wall clock variables
 	double outer_loop_time = 0.0; 
 
 	// Start clock to time initialisation
-	t_start = clock();
+	t_start = Profiler::now();
 
 	// Get the time and convert it to a serial stamp for the output directory creation
 	time_t curr_time = time(NULL);	// Current system date/time
@@ -147,13 +150,12 @@ int main( int argc, char* argv[] )
 
 	}
 
-	// Create application log file
+	// Create application log file (buffered by the Logger)
 	std::ofstream logfile;
-	logfile.open(GridUtils::path_str + "/log_rank" + std::to_string(rank) + ".log", std::ios::out);
 	GridUtils::logfile = &logfile;	// Pass logfile reference to GridUtils class
 
 	// TODO: Handle case when logfile doesn't open correctly
-	if (!logfile.is_open()) {
+	if (!Logger::attach(logfile, "log")) {
 		std::cout << "Logfile didn't open" << std::endl;
 	}
 
@@ -166,6 +168,14 @@ int main( int argc, char* argv[] )
 	time_str[strlen(time_str) - 1] = '\0';	// Overwrite extra newline character
     L_INFO("Simulation started at " + std::string(time_str), GridUtils::logfile);	// Write start time to log
 
+	// Report the run-time parameters
+	RuntimeParams::report();
+
+#ifdef L_HW_COUNTERS
+	// Start the hardware counters and measure the memory bandwidth
+	Profiler::initCounters();
+#endif
+
 	// Create the Grid Manager
 	GridManager *gm = GridManager::getInstance();
 
@@ -175,8 +185,11 @@ int main( int argc, char* argv[] )
 	
 	// Get time of MPI initialisation
 	MPI_Barrier(mpim->world_comm);
-	secs = clock() - t_start;
-	double mpi_initialise_time = ((double)secs)/CLOCKS_PER_SEC * 1000;
+	secs = Profiler::now() - t_start;
+	double mpi_initialise_time = secs * 1000;
+#ifdef L_LOG_TIMINGS
+	Profiler::add(eProfInitMPI, 0, 0, secs);
+#endif
 	L_INFO("MPI Topolgy initialised in " + std::to_string(mpi_initialise_time) + "ms.", GridUtils::logfile);
 #endif
 
@@ -184,7 +197,7 @@ int main( int argc, char* argv[] )
 #ifdef L_BUILD_FOR_MPI
 	MPI_Barrier(mpim->world_comm);
 #endif
-	t_start = clock();
+	t_start = Profiler::now();
 
 
 
@@ -236,11 +249,12 @@ int main( int argc, char* argv[] )
 
 		L_INFO("Initialising sub-grids...", GridUtils::logfile);
 
-#ifdef L_INIT_VELOCITY_FROM_FILE
-		/* Loading the initial velocity field from a file is incompatible with subgrids 
-		 * because there is no interpolator implemented yet. The input file must 
-		 * match the number of cells on the grid to which it is being read. */
-		L_ERROR("Loading the initial velocity field from a file is icompatible with subgrids. Exiting.", GridUtils::logfile);
+#if (defined L_INIT_VELOCITY_FROM_FILE && !defined L_INIT_VELOCITY_FROM_HDF5)
+		/* Loading the initial velocity field from an ASCII file is incompatible with 
+		 * subgrids because it is not interpolated. The input file must match the number 
+		 * of cells on the grid to which it is being read. Use L_INIT_VELOCITY_FROM_HDF5 
+		 * to interpolate a field onto every grid. */
+		L_ERROR("Loading the initial velocity field from an ASCII file is icompatible with subgrids. Use L_INIT_VELOCITY_FROM_HDF5 instead. Exiting.", GridUtils::logfile);
 #endif
 
 		// Loop over number of regions and add subgrids to Grids
@@ -291,6 +305,13 @@ int main( int argc, char* argv[] )
 #endif
 
 
+	/* All labels are now final so build the streaming masks and refinement maps.
+	 * With a sparse lattice this also allocates the populations so it comes 
+	 * before they are read from any restart file. */
+	Grids->LBM_initStreamMask();
+	Grids->LBM_initRefinedMaps();
+
+
 	/*
 	****************************************************************************
 	************************* INITIALISE FROM RESTART **************************
@@ -328,10 +349,17 @@ int main( int argc, char* argv[] )
 #ifdef L_BUILD_FOR_MPI
 	MPI_Barrier(mpim->world_comm);
 #endif
-	secs = clock() - t_start;
-	double obj_initialise_time = ((double)secs)/CLOCKS_PER_SEC * 1000;
+	secs = Profiler::now() - t_start;
+	double obj_initialise_time = secs * 1000;
+#ifdef L_LOG_TIMINGS
+	Profiler::add(eProfInitGrids, 0, 0, secs);
+#endif
 	L_INFO("Grid & Object Initialisation completed in " + std::to_string(obj_initialise_time) + "ms.", GridUtils::logfile);
 
+	// Report memory held by the grid fields on this rank
+	size_t gridBytes = Grids->io_memoryReport();
+	L_INFO("Total grid memory on this rank = " + std::to_string(gridBytes / (1024.0 * 1024.0)) + " MB", GridUtils::logfile);
+
 #ifdef L_BUILD_FOR_MPI
 	
 	// Compute buffer sizes
@@ -366,6 +394,11 @@ int main( int argc, char* argv[] )
 	objMan->io_vtkBodyWriter(Grids->t);
 #endif
 
+#ifdef L_VTU_BODY_WRITE
+	L_INFO("Writing out Bodies to VTU file...", GridUtils::logfile);
+	objMan->io_vtuBodyWriter(Grids->t);
+#endif
+
 #ifdef L_VTK_FEM_WRITE
 	L_INFO("Writing out FEM to VTK file...", GridUtils::logfile);
 	objMan->io_vtkFEMWriter(Grids->t);
@@ -383,20 +416,10 @@ int main( int argc, char* argv[] )
 #endif
 
 #ifdef L_PROBE_OUTPUT
-#ifdef L_BUILD_FOR_MPI
-	for (int n = 0; n < mpim->num_ranks; n++)
-#endif
-	{
-		// Wait for rank accessing the file and only access if this rank's turn
-#ifdef L_BUILD_FOR_MPI
-		MPI_Barrier(mpim->world_comm);
-		if (mpim->my_rank == n)
-#endif
-		{
-			L_INFO("Initial probe write out...", GridUtils::logfile);
-			Grids->io_probeOutput();
-		}
-	}
+	// Locate probes once then write initial values (collective)
+	L_INFO("Initialising probes and initial probe write out...", GridUtils::logfile);
+	Grids->io_initProbes();
+	Grids->io_probeOutput();
 #endif	// L_PROBE_OUTPUT
 
 #ifdef L_BUILD_FOR_MPI
@@ -428,7 +451,7 @@ int main( int argc, char* argv[] )
 
 #ifdef L_SHOW_TIME_TO_COMPLETE
 		// Start clock for timing outer loop
-		t_start = clock();
+		t_start = Profiler::now();
 #endif
 		if ((Grids->t + 1) % L_GRID_OUT_FREQ == 0 && rank == 0)
 			std::cout << "\rTime Step " << Grids->t + 1 << " of " << L_TOTAL_TIMESTEPS << " ------>" << std::flush;
@@ -459,36 +482,57 @@ int main( int argc, char* argv[] )
 
 #ifdef L_TEXTOUT
 			L_INFO("Writing out to <Grids.out>...", GridUtils::logfile);
+			L_PROF_START(t_text);
 			Grids->io_textout("START OF TIMESTEP");
+			L_PROF_STOP(t_text, eProfIOText, 0, 0);
 #endif
 #ifdef L_IO_FGA
 			L_INFO("Writing out to <.fga>...", GridUtils::logfile);
+			L_PROF_START(t_fga);
 			Grids->io_fgaout();
+			L_PROF_STOP(t_fga, eProfIOFga, 0, 0);
 #endif
 
 #ifdef L_IO_LITE
 			L_INFO("Writing out to IOLite file...", GridUtils::logfile);
+			L_PROF_START(t_lite);
 			Grids->io_lite(Grids->t,"");
+			L_PROF_STOP(t_lite, eProfIOLite, 0, 0);
 #endif
 
 #ifdef L_HDF5_OUTPUT
 			L_INFO("Writing out to HDF5 file...", GridUtils::logfile);
+			L_PROF_START(t_hdf5);
 			Grids->io_hdf5(Grids->t);
+			L_PROF_STOP(t_hdf5, eProfIOHDF5, 0, 0);
 #endif
 
 #ifdef L_VTK_BODY_WRITE
 			L_INFO("Writing out Bodies to VTK file...", GridUtils::logfile);
+			L_PROF_START(t_vtk);
 			objMan->io_vtkBodyWriter(Grids->t);
+			L_PROF_STOP(t_vtk, eProfIOBodies, 0, 0);
+#endif
+
+#ifdef L_VTU_BODY_WRITE
+			L_INFO("Writing out Bodies to VTU file...", GridUtils::logfile);
+			L_PROF_START(t_vtu);
+			objMan->io_vtuBodyWriter(Grids->t);
+			L_PROF_STOP(t_vtu, eProfIOBodies, 0, 0);
 #endif
 
 #ifdef L_VTK_FEM_WRITE
 			L_INFO("Writing out FEM to VTK file...", GridUtils::logfile);
+			L_PROF_START(t_vtkfem);
 			objMan->io_vtkFEMWriter(Grids->t);
+			L_PROF_STOP(t_vtkfem, eProfIOBodies, 0, 0);
 #endif
 
 #if (defined L_IBM_ON && defined L_IBBODY_TRACER)
 			L_INFO("Writing out flexible body position...", GridUtils::logfile);
+			L_PROF_START(t_pos);
 			objMan->io_writeBodyPosition(Grids->t);
+			L_PROF_STOP(t_pos, eProfIOBodyPosition, 0, 0);
 #endif
 
 		}
@@ -509,16 +553,22 @@ int main( int argc, char* argv[] )
 
 #ifdef L_WRITE_TIP_POSITIONS
 			L_INFO("Writing out tip positions...", GridUtils::logfile);
+			L_PROF_START(t_tips);
 			objMan->io_writeTipPositions(Grids->t);
+			L_PROF_STOP(t_tips, eProfIOTips, 0, 0);
 #endif
 
 #if (defined L_LD_OUT && defined L_GEOMETRY_FILE)
 			L_INFO("Writing out object lift and drag...", GridUtils::logfile);
+			L_PROF_START(t_forces);
 			objMan->io_writeForcesOnObjects(Grids->t);
+			L_PROF_STOP(t_forces, eProfIOForces, 0, 0);
 
 #ifdef L_IBM_ON
 			L_INFO("Writing out flexible body lift and drag...", GridUtils::logfile);
+			L_PROF_START(t_ld);
 			objMan->io_writeLiftDrag();
+			L_PROF_STOP(t_ld, eProfIOForces, 0, 0);
 #endif
 #endif
 		}
@@ -527,26 +577,39 @@ int main( int argc, char* argv[] )
 #ifdef L_PROBE_OUTPUT
 		if (Grids->t % L_PROBE_OUT_FREQ == 0)
 		{
-
-#ifdef L_BUILD_FOR_MPI
-			for (int n = 0; n < mpim->num_ranks; n++)
-#endif
-			{
-
-				// Wait for rank accessing the file and only access if this rank's turn
-#ifdef L_BUILD_FOR_MPI
-				MPI_Barrier(mpim->world_comm);
-				if (mpim->my_rank == n) 
+			// Buffer probe data (written out collectively when buffer is full)
+			L_INFO("Probe write out...", GridUtils::logfile);
+			L_PROF_START(t_probe);
+			Grids->io_probeOutput();
+			L_PROF_STOP(t_probe, eProfIOProbes, 0, 0);
+		}
 #endif
-				{
 
-					L_INFO("Probe write out...", GridUtils::logfile);
-					Grids->io_probeOutput();
 
-				}
+#if (defined L_BUILD_FOR_MPI && defined L_SD_CALIBRATE)
+		// Calibrate decomposition cost model once warmed up
+		if (Grids->t == L_SD_CALIBRATE_STEPS)
+		{
+			L_INFO("Calibrating decomposition cost model...", GridUtils::logfile);
+			mpim->mpi_SDCalibrate();
+		}
+#endif
 
-			}
+#if (defined L_BUILD_FOR_MPI && defined L_MPI_REBALANCE)
+		// Check measured load balance and redistribute the grid if required
+		if (Grids->t % L_MPI_REBALANCE_FREQ == 0)
+		{
+			L_INFO("Checking load balance...", GridUtils::logfile);
+			mpim->mpi_rebalance(Grids);
+		}
+#endif
 
+#ifdef L_BLOCK_AMR
+		// Refine and coarsen the blocks to follow the flow
+		if (Grids->t % L_REGRID_FREQ == 0)
+		{
+			L_INFO("Regridding...", GridUtils::logfile);
+			Grids->LBM_regrid();
 		}
 #endif
 
@@ -557,20 +620,30 @@ int main( int argc, char* argv[] )
 		if (Grids->t % L_RESTART_OUT_FREQ == 0)
 		{
 			// Write out
+			L_PROF_START(t_restart);
 			Grids->io_restart(eWrite);
+			L_PROF_STOP(t_restart, eProfIORestart, 0, 0);
 		}
 
 
 #ifdef L_SHOW_TIME_TO_COMPLETE
 		// Update outer loop time (inc. effects of writing out for accuracy)
 		outer_loop_time *= Grids->t - 1;
-		outer_loop_time += (static_cast<double>(clock() - t_start)) / CLOCKS_PER_SEC * 1000;
+		outer_loop_time += (Profiler::now() - t_start) * 1000;
 		outer_loop_time /= Grids->t;
 #endif
 
 	// Loop End
 	} while (Grids->t < L_TOTAL_TIMESTEPS);
 
+#ifdef L_PROBE_OUTPUT
+	// Write out any remaining buffered probe data
+	Grids->io_probeFlush();
+#endif
+
+	// Write out any remaining buffered body data
+	objMan->io_bodySeriesFlush();
+
 
 	/*
 	****************************************************************************
@@ -579,76 +652,8 @@ int main( int argc, char* argv[] )
 	*/
 
 #ifdef L_LOG_TIMINGS
-	// TIMINGS FILE //
-	/* Format is as follows:
-	 * Mpi Init Time --- Obj Init Time --- Time Step Time L0 --- MPI Time L0 --- etc.
-	 */
-
-	std::ofstream timings;
-
-	// Wait for rank accessing the file and only access if this rank's turn
-#ifdef L_BUILD_FOR_MPI
-	int num_ranks = mpim->num_ranks;
-#else
-	int num_ranks = 1;
-#endif
-
-	for (int n = 0; n < num_ranks; n++)
-	{
-		
-#ifdef L_BUILD_FOR_MPI
-		MPI_Barrier(mpim->world_comm);
-#endif
-		if (rank == n)
-		{
-			if (n == 0)	timings.open(GridUtils::path_str + "/timings.out",std::ios::out);
-			else timings.open(GridUtils::path_str + "/timings.out",std::ios::app);
-			GridObj* g = NULL;
-
-			// Put in initialisation times
-#ifdef L_BUILD_FOR_MPI
-			timings << mpi_initialise_time;
-#else
-			timings << 0;
-#endif
-			timings << "\t" << obj_initialise_time;
-
-			// Loop over expected grids
-			for (int lev = 0; lev <= L_NUM_LEVELS; lev++) {
-				for (int reg = 0; reg < L_NUM_REGIONS; reg++) {
-					
-					// Get the grid
-					g = NULL;
-					GridUtils::getGrid(Grids,lev,reg,g);
-
-					// If grid does not exist the put in a zero
-					if (g == NULL) {
-
-						timings << "\t" << 0 << "\t" << 0;
-
-					} else {
-
-						// Add time step time on this grid then mpi overhead time
-						timings << "\t" << g->timeav_timestep << "\t" << 
-#ifdef L_BUILD_FOR_MPI
-							g->timeav_mpi_overhead;
-#else
-							0;
-#endif	
-							
-
-					}
-
-				}
-			}
-
-		}
-
-		timings << std::endl;
-		timings.close();
-	}
-
-	// END TIMINGS FILE //
+	// Write the phase timings summary
+	Profiler::writeReport();
 #endif
 
 
@@ -656,6 +661,7 @@ int main( int argc, char* argv[] )
 	curr_time = time(NULL);			// Current system date/time and string buffer
 	time_str = ctime(&curr_time);	// Format as string
 	L_INFO("Simulation completed at " + std::string(time_str), GridUtils::logfile);		// Write end time to log file
+	Logger::close();
 	logfile.close();
 
 	// Destroy singletons
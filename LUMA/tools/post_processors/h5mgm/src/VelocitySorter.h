@@ -65,30 +65,30 @@ public:
 		H5Aread(input_aid, H5T_NATIVE_INT, &gridsize[0]);
 		H5Aclose(input_aid);
 
-		// Resize data matrix
+		// Allocate flat buffers (one entry per site)
 		totalSites = gridsize[0] * gridsize[1] * gridsize[2];
-		if (!xyzuvw) delete xyzuvw;
-		xyzuvw = new std::vector< std::vector<double> >();
-		xyzuvw->resize(totalSites, std::vector<double>(6, 0.0));
+		std::vector<double> X(totalSites, 0.0), Y(X), Z(X), UX(X), UY(X), UZ(X);
 
 		// Create input dataspace
 		hsize_t dims_input[1];
 		dims_input[0] = gridsize[0] * gridsize[1] * gridsize[2];
 		hid_t input_sid = H5Screate_simple(1, dims_input, NULL);
 
-		// Allocate buffers
-		std::vector<double> *Xunsorted = new std::vector<double>(totalSites, 0.0);
-		std::vector<double> *Yunsorted = new std::vector<double>(*Xunsorted);
-		std::vector<double> *Zunsorted = new std::vector<double>(*Xunsorted);
-		std::vector<double> *UXunsorted = new std::vector<double>(*Xunsorted);
-		std::vector<double> *UYunsorted = new std::vector<double>(*Xunsorted);
-		std::vector<double> *UZunsorted = new std::vector<double>(*Xunsorted);
-
 		// Read in X, Y and Z
-		readDataset("/XPos", TIME_STRING, input_fid, input_sid, H5T_NATIVE_DOUBLE, &(*Xunsorted)[0]);
-		readDataset("/YPos", TIME_STRING, input_fid, input_sid, H5T_NATIVE_DOUBLE, &(*Yunsorted)[0]);
+		readDataset("/XPos", TIME_STRING, input_fid, input_sid, H5T_NATIVE_DOUBLE, &X[0]);
+		readDataset("/YPos", TIME_STRING, input_fid, input_sid, H5T_NATIVE_DOUBLE, &Y[0]);
 		if (dimensions_p == 3)
-			readDataset("/ZPos", TIME_STRING, input_fid, input_sid, H5T_NATIVE_DOUBLE, &(*Zunsorted)[0]);
+			readDataset("/ZPos", TIME_STRING, input_fid, input_sid, H5T_NATIVE_DOUBLE, &Z[0]);
+
+		// Positions do not change so sort once (x then y then z) into a permutation
+		order.resize(totalSites);
+		for (size_t i = 0; i < totalSites; ++i) order[i] = i;
+		std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs)
+		{
+			if (X[lhs] != X[rhs]) return X[lhs] < X[rhs];
+			if (Y[lhs] != Y[rhs]) return Y[lhs] < Y[rhs];
+			return Z[lhs] < Z[rhs];
+		});
 
 		// Loop over timesteps
 		clock_t startTime;
@@ -103,38 +103,18 @@ public:
 			sortedFilename += "/sortedVelocity_" + std::to_string(t) + ".txt";
 
 			// Read in velocity arrays for this timestep
-			readDataset("/Ux", TIME_STRING, input_fid, input_sid, H5T_NATIVE_DOUBLE, &(*UXunsorted)[0]);
-			readDataset("/Uy", TIME_STRING, input_fid, input_sid, H5T_NATIVE_DOUBLE, &(*UYunsorted)[0]);
+			readDataset("/Ux", TIME_STRING, input_fid, input_sid, H5T_NATIVE_DOUBLE, &UX[0]);
+			readDataset("/Uy", TIME_STRING, input_fid, input_sid, H5T_NATIVE_DOUBLE, &UY[0]);
 			if (dimensions_p == 3)
-				readDataset("/Uz", TIME_STRING, input_fid, input_sid, H5T_NATIVE_DOUBLE, &(*UZunsorted)[0]);
-
-			// Pack information into format required (what a pain!)
-			for (int cell = 0; cell < totalSites; ++cell)
-			{
-				
-				*((xyzuvw->begin() + cell)->begin() + 0) = *(Xunsorted->begin() + cell);
-				*((xyzuvw->begin() + cell)->begin() + 1) = *(Yunsorted->begin() + cell);
-				*((xyzuvw->begin() + cell)->begin() + 2) = *(Zunsorted->begin() + cell);
-				*((xyzuvw->begin() + cell)->begin() + 3) = *(UXunsorted->begin() + cell);
-				*((xyzuvw->begin() + cell)->begin() + 4) = *(UYunsorted->begin() + cell);
-				*((xyzuvw->begin() + cell)->begin() + 5) = *(UZunsorted->begin() + cell);
-			}
+				readDataset("/Uz", TIME_STRING, input_fid, input_sid, H5T_NATIVE_DOUBLE, &UZ[0]);
 
-			// Sort data z then y then x
-			sortrows(*xyzuvw, 2);
-			sortrows(*xyzuvw, 1);
-			sortrows(*xyzuvw, 0);
-
-			// Write file
+			// Write file in sorted order
 			std::ofstream outfile;
 			outfile.open(sortedFilename, std::ios::out);
-			for (std::vector<double> &row : *xyzuvw)
+			for (size_t i : order)
 			{
-				for (double &val : row)
-				{
-					outfile << val << "\t";
-				}
-				outfile << std::endl;
+				outfile << X[i] << "\t" << Y[i] << "\t" << Z[i] << "\t" 
+					<< UX[i] << "\t" << UY[i] << "\t" << UZ[i] << "\t\n";
 			}
 			outfile.close();
 
@@ -162,8 +142,8 @@ public:
 	};
 
 private:
-	// Data arranged as X Y Z U V W column vectors
-	std::vector< std::vector<double> > *xyzuvw;
+	// Order in which sites are written (sorted by position)
+	std::vector<size_t> order;
 
 	// Others
 	size_t totalSites;
@@ -177,16 +157,4 @@ private:
 		H5Dclose(input_did);
 	};
 
-	// Method to perform a vector sort favouring value in column col
-	void sortrows(std::vector<std::vector<T>>& matrix, int col)
-	{
-		std::stable_sort(
-			matrix.begin(),
-			matrix.end(),
-			[col](const std::vector<T>& lhs, const std::vector<T>& rhs)
-		{
-			return lhs[col] < rhs[col];
-		});
-	};
-
 };
\ No newline at end of file
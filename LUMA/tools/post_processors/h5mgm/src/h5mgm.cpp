@@ -14,74 +14,263 @@
 */
 
 #include "VelocitySorter.h"
-#include "ThirdParty/vtkCleanUnstructuredGrid.h"
-
-// Method to construct a 3D polyhedron out of faces and add to an unstructured grid
-size_t addCell(vtkSmartPointer<vtkPoints> global_pts,
-	vtkSmartPointer<vtkUnstructuredGrid> grid,
-	std::vector<vtkIdType>& global_ids,
-	std::vector< std::vector<double> >& cell_pts,
-	int *point_count, int dimensions_p)
-{
 
-	// Local declarations
-	vtkSmartPointer<vtkCellArray> face_array = vtkSmartPointer<vtkCellArray>::New();
-	std::vector<vtkIdType> face_ids;
-	size_t status = 0;
+// Key identifying a mesh point by its position in units of half the finest spacing
+struct PointKey
+{
+	long long i, j, k;
+	bool operator==(const PointKey& other) const { return i == other.i && j == other.j && k == other.k; }
+};
 
-	// Add new points to global points and assign new id
-	for (size_t c = 0; c < cell_pts.size(); c++) {
-		global_pts->InsertNextPoint(cell_pts[c][0], cell_pts[c][1], cell_pts[c][2]);
-		global_ids.push_back(*point_count + c);
+struct PointKeyHash
+{
+	size_t operator()(const PointKey& key) const
+	{
+		return std::hash<long long>()(key.i) ^ (std::hash<long long>()(key.j) << 1) ^ (std::hash<long long>()(key.k) << 2);
 	}
+};
 
-	if (dimensions_p == 3)
-	{
+// Method to return the ID of a point at the given position, adding it if it does not yet exist
+vtkIdType getPointId(vtkSmartPointer<vtkPoints> global_pts,
+	std::unordered_map<PointKey, vtkIdType, PointKeyHash>& pointMap,
+	double dx_min, double x, double y, double z)
+{
+	double h = dx_min / 2.0;
+	PointKey key = { std::llround(x / h), std::llround(y / h), std::llround(z / h) };
+	auto it = pointMap.find(key);
+	if (it != pointMap.end()) return it->second;
+
+	vtkIdType id = global_pts->InsertNextPoint(x, y, z);
+	pointMap[key] = id;
+	return id;
+}
 
-		// Specify points that make up voxel in specific order
-		face_ids.push_back(*point_count + 0);
-		face_ids.push_back(*point_count + 4);
-		face_ids.push_back(*point_count + 2);
-		face_ids.push_back(*point_count + 6);
-		face_ids.push_back(*point_count + 1);
-		face_ids.push_back(*point_count + 5);
-		face_ids.push_back(*point_count + 3);
-		face_ids.push_back(*point_count + 7);
-		
-
-		// Update offset
-		*point_count += 8;
+// Method to read one chunk of the position vectors of a grid
+herr_t readPositionChunk(GridInfo& g, std::string TIME_STRING, hsize_t start, hsize_t count, int dimensions_p,
+	std::vector<double>& X, std::vector<double>& Y, std::vector<double>& Z)
+{
+	std::lock_guard<std::mutex> lock(h5mutex);
+	herr_t status = 0;
+	std::string names[3] = { "/XPos", "/YPos", "/ZPos" };
+	std::vector<double> *bufs[3] = { &X, &Y, &Z };
+	hid_t mem_sid = H5Screate_simple(1, &count, NULL);
+	for (int d = 0; d < dimensions_p && status == 0; d++) {
+		hid_t input_did = H5Dopen(g.fid, (TIME_STRING + names[d]).c_str(), H5P_DEFAULT);
+		if (input_did <= 0) { status = DATASET_READ_FAIL; break; }
+		hid_t file_sid = H5Dget_space(input_did);
+		status = selectSites(file_sid, start, count);
+		if (status >= 0) status = H5Dread(input_did, H5T_NATIVE_DOUBLE, mem_sid, file_sid, H5P_DEFAULT, &(*bufs[d])[0]);
+		H5Sclose(file_sid);
+		H5Dclose(input_did);
 	}
+	H5Sclose(mem_sid);
+	return status;
+}
+
+// Method to point a grid at the time group holding its positions and read its size.
+// A grid which has been regridded records its size on the time group, otherwise 
+// the size given for the file is used.
+herr_t setMeshTime(GridInfo& g, std::string TIME_STRING)
+{
+	herr_t status = 0;
+	hid_t input_aid;
+	g.meshTime = TIME_STRING;
+	g.gridsize[2] = 1;	// Set 3D dimension to 1, will get overwritten if actually 3D
+	if (H5Aexists_by_name(g.fid, TIME_STRING.c_str(), "GridSize", H5P_DEFAULT) > 0)
+		input_aid = H5Aopen_by_name(g.fid, TIME_STRING.c_str(), "GridSize", H5P_DEFAULT, H5P_DEFAULT);
 	else
-	{
+		input_aid = H5Aopen(g.fid, "GridSize", H5P_DEFAULT);
+	if (input_aid <= 0) { writeInfo("Cannot open attribute!", eHDF); return -1; }
+	status = H5Aread(input_aid, H5T_NATIVE_INT, g.gridsize);
+	if (status != 0) writeInfo("Cannot read attribute!", eHDF);
+	if (H5Aclose(input_aid) != 0) writeInfo("Cannot close attribute!", eHDF);
 
-		// Specify points that make up quad in specific order
-		face_ids.push_back(*point_count + 0);
-		face_ids.push_back(*point_count + 2);
-		face_ids.push_back(*point_count + 1);
-		face_ids.push_back(*point_count + 3);
+	g.totalSites = static_cast<hsize_t>(g.gridsize[0]) * g.gridsize[1] * g.gridsize[2];
 
-		// Update offset
-		*point_count += 4;
+	// Chunks are made of whole X-slabs
+	hsize_t slab = static_cast<hsize_t>(g.gridsize[1]) * g.gridsize[2];
+	g.chunkSites = std::min(g.totalSites, std::max<hsize_t>(1, H5MGM_CHUNK_SIZE / slab) * slab);
+	return status;
+}
 
-	}
+// Method to check whether a grid wrote its positions on a given time step
+bool hasPositions(GridInfo& g, std::string TIME_STRING)
+{
+	return H5Lexists(g.fid, TIME_STRING.c_str(), H5P_DEFAULT) > 0 &&
+		H5Lexists(g.fid, (TIME_STRING + "/XPos").c_str(), H5P_DEFAULT) > 0;
+}
 
-	// Update grid with new point list and add cell
-	grid->SetPoints(global_pts);
+// Method to build the merged mesh from the typing matrix of the given time step 
+// and the positions of each grid in the time group set by setMeshTime
+herr_t buildMesh(std::string TIME_STRING, int dimensions_p, std::vector<GridInfo>& grids,
+	vtkSmartPointer<vtkUnstructuredGrid> unstructuredGrid)
+{
+	herr_t status = 0;
 
-	if (dimensions_p == 3) {
-		grid->InsertNextCell(VTK_VOXEL, 8, &face_ids[0]);
-	}
-	else {
-		grid->InsertNextCell(VTK_PIXEL, 4, &face_ids[0]);
+	// Corner points are shared between cells (and grids) so are deduplicated 
+	// as they are created using their position in units of half the finest spacing
+	double dx_min = grids[0].dx;
+	for (GridInfo& g : grids) dx_min = std::min(dx_min, g.dx);
+	std::unordered_map<PointKey, vtkIdType, PointKeyHash> pointMap;
+
+	// Create VTK grid
+	unstructuredGrid->Allocate();
+
+	// Create VTK grid points
+	vtkSmartPointer<vtkPoints> points =
+		vtkSmartPointer<vtkPoints>::New();
+
+	for (GridInfo& g : grids) {
+
+		if (!g.active) continue;
+		std::cout << "Adding cells from L" << g.level << " R" << g.region << "..." << std::endl;
+		g.keep.assign(static_cast<size_t>(g.totalSites), 0);
+
+		// Read typing matrix to decide which sites to keep
+		status = readDatasetChunked<int>("/LatTyp", TIME_STRING, g, H5T_NATIVE_INT,
+			[&](hsize_t start, hsize_t n, const int *Type)
+		{
+			for (hsize_t c = 0; c < n; c++)
+				g.keep[start + c] = !isOnIgnoreList(static_cast<eType>(Type[c]));
+		});
+		if (status != 0)
+		{
+			writeInfo("Typing matrix read failed -- exiting early.", eFatal);
+			exit(EARLY_EXIT);
+		}
+
+		// Read positions in chunks and add a cell for each site kept
+		std::vector<double> X(static_cast<size_t>(g.chunkSites), 0.0);
+		std::vector<double> Y(X), Z(X);
+		int local_cell_count = 0;
+		for (hsize_t start = 0; start < g.totalSites && status == 0; start += g.chunkSites) {
+
+			// Read this chunk of each position vector
+			hsize_t count = std::min<hsize_t>(g.chunkSites, g.totalSites - start);
+			status = readPositionChunk(g, g.meshTime, start, count, dimensions_p, X, Y, Z);
+			if (status != 0) break;
+
+			for (hsize_t c = 0; c < count; c++) {
+
+				if (!g.keep[start + c]) continue;
+				local_cell_count++;
+
+				// Find or create the corner points and add the cell
+				vtkIdType ids[8];
+				if (dimensions_p == 3) {
+					for (int p = 0; p < 8; ++p) {
+						ids[p] = getPointId(points, pointMap, dx_min,
+							X[c] + e[0][p] * (g.dx / 2), Y[c] + e[1][p] * (g.dx / 2), Z[c] + e[2][p] * (g.dx / 2));
+					}
+					vtkIdType voxel[8] = { ids[0], ids[4], ids[2], ids[6], ids[1], ids[5], ids[3], ids[7] };
+					unstructuredGrid->InsertNextCell(VTK_VOXEL, 8, voxel);
+				}
+				else {
+					for (int p = 0; p < 4; ++p) {
+						ids[p] = getPointId(points, pointMap, dx_min,
+							X[c] + e2[0][p] * (g.dx / 2), Y[c] + e2[1][p] * (g.dx / 2), 0.0);
+					}
+					vtkIdType pixel[4] = { ids[0], ids[2], ids[1], ids[3] };
+					unstructuredGrid->InsertNextCell(VTK_PIXEL, 4, pixel);
+				}
+			}
+		}
+		if (status != 0)
+		{
+			writeInfo("Position vector read failed -- exiting early.", eFatal);
+			exit(EARLY_EXIT);
+		}
 
+		// Debug
+		std::cout << "Valid Cell Count  = " << local_cell_count << std::endl;
 	}
 
-	// Free face array (forces destructor to be called)
-	face_array = NULL;
+	unstructuredGrid->SetPoints(points);
+
+	// Debug
+	std::cout << "Total number of cells retained for merged mesh = " << unstructuredGrid->GetNumberOfCells() << std::endl;
+	std::cout << "Total number of points in merged mesh = " << points->GetNumberOfPoints() << std::endl;
 
 	return status;
+}
+
+// Method to add the data for one time step to a copy of the mesh and write it to file
+herr_t writeTimeStep(size_t t, std::string case_num, std::string path_str, int dimensions_p, int mpi_flag,
+	std::vector<GridInfo>& grids, vtkSmartPointer<vtkUnstructuredGrid> mesh)
+{
+	// Time string
+	std::string TIME_STRING = "/Time_" + std::to_string(t);
+
+	// Create filename
+	std::string vtkFilename = path_str + "/luma_" + case_num + "." + std::to_string(t);
+	if (bLegacy)
+		vtkFilename += ".vtk";
+	else
+		vtkFilename += ".vtu";
+
+	// Shallow copy shares the points and cells of the mesh but has its own cell data
+	vtkSmartPointer<vtkUnstructuredGrid> unstructuredGrid =
+		vtkSmartPointer<vtkUnstructuredGrid>::New();
+	unstructuredGrid->ShallowCopy(mesh);
+
+	// Add data
+	vtkSmartPointer<vtkIntArray> LatTyp = vtkSmartPointer<vtkIntArray>::New();
+	LatTyp->SetName("LatTyp");
+	herr_t status = addDataToGrid<int>("/LatTyp", TIME_STRING, grids, unstructuredGrid, H5T_NATIVE_INT, LatTyp);
+
+	// If no typing matrix then assume the time step is not available
+	if (status != 0) return DATASET_READ_FAIL;
+
+	// MPI block data is written with the positions
+	if (mpi_flag)
+	{
+		vtkSmartPointer<vtkIntArray> Block = vtkSmartPointer<vtkIntArray>::New();
+		Block->SetName("MpiBlockNumber");
+		status = addDataToGrid<int>("/MpiBlock", "", grids, unstructuredGrid, H5T_NATIVE_INT, Block);
+	}
+
+	// Remaining double data sets (missing data sets are simply not added)
+	std::vector<std::string> names = { "Rho", "Rho_TimeAv", "Ux", "Uy", "Ux_TimeAv", "Uy_TimeAv",
+		"UxUx_TimeAv", "UxUy_TimeAv", "UyUy_TimeAv", "VortZ", "QCriterion", "StrainRate", "WallShearStress" };
+	if (dimensions_p == 3)
+	{
+		names.insert(names.end(), { "Uz", "Uz_TimeAv", "UxUz_TimeAv", "UyUz_TimeAv", "UzUz_TimeAv", "VortX", "VortY" });
+	}
+	for (std::string& name : names)
+	{
+		vtkSmartPointer<vtkDoubleArray> array = vtkSmartPointer<vtkDoubleArray>::New();
+		array->SetName(name.c_str());
+		status = addDataToGrid<double>("/" + name, TIME_STRING, grids, unstructuredGrid, H5T_NATIVE_DOUBLE, array);
+	}
 
+	// Write grid to file
+	if (bLegacy)
+	{
+		vtkSmartPointer<vtkUnstructuredGridWriter> writer =
+			vtkSmartPointer<vtkUnstructuredGridWriter>::New();
+		writer->SetFileName(vtkFilename.c_str());
+		writer->SetFileTypeToBinary();
+#if VTK_MAJOR_VERSION <= 5
+		writer->SetInput(unstructuredGrid);
+#else
+		writer->SetInputData(unstructuredGrid);
+#endif
+		writer->Write();
+	}
+	else
+	{
+		vtkSmartPointer<vtkXMLUnstructuredGridWriter> writer =
+			vtkSmartPointer<vtkXMLUnstructuredGridWriter>::New();
+		writer->SetFileName(vtkFilename.c_str());
+#if VTK_MAJOR_VERSION <= 5
+		writer->SetInput(unstructuredGrid);
+#else
+		writer->SetInputData(unstructuredGrid);
+#endif
+		writer->Write();
+	}
+
+	return 0;
 }
 
 /* H5 Multi-Grid Merge Tool for post-processing HDF5 files written by LUMA */
@@ -119,6 +308,10 @@ int main(int argc, char* argv[])
 		{
 			bSorter = true;
 		}
+		else if (arg_str.compare(0, 8, "threads=") == 0)
+		{
+			numThreads = std::stoi(arg_str.substr(8));
+		}
 		else
 		{
 			case_num = std::string(argv[a]);
@@ -169,20 +362,13 @@ int main(int argc, char* argv[])
 	// Construct L0 filename
 	std::string IN_FILE_NAME("./hdf_R0N0.h5");
 
-	// Set T = 0 time string
-	std::string TIME_STRING = "/Time_0";
-
 	// Declarations
 	herr_t status = 0;
 	hid_t output_fid = NULL;
 	hid_t input_fid = NULL;
 	hid_t input_aid = NULL;
 	int dimensions_p, levels, regions, timesteps, out_every, mpi_flag;
-	double dx;
 	std::string VAR;
-	int* LatTyp = nullptr;
-	double *dummy_d = nullptr;
-	int *dummy_i = nullptr;
 
 	// Open L0 input file
 	input_fid = H5Fopen(IN_FILE_NAME.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
@@ -231,373 +417,154 @@ int main(int argc, char* argv[])
 	status = H5Aclose(input_aid);
 	if (status != 0) writeInfo("Cannot close attribute!", eHDF);
 
-	// Store basic data
-	int *gridsize = (int*)malloc(3 * sizeof(int));	// Space for grid size
-	gridsize[2] = 1;	// Set 3D dimension to 1, will get overwritten if actually 3D
-	int num_grids = ((levels - 1) * regions + 1);	// Total number of grids
-
 	// Close file
 	status = H5Fclose(input_fid);
 	if (status != 0) writeInfo("Cannot close file!", eHDF);
 
-	// Create cell node position list for VTK
-	std::vector< std::vector<double> > cell_points;
-	if (dimensions_p == 3) {
-		cell_points.resize(8, std::vector<double>(3));
-	}
-	else {
-		cell_points.resize(4, std::vector<double>(3));
-	}
-
-
-		
-
-	// Create VTK grid
-	vtkSmartPointer<vtkUnstructuredGrid> unstructuredGrid =
-		vtkSmartPointer<vtkUnstructuredGrid>::New();
-
-	// Create VTK grid points
-	vtkSmartPointer<vtkPoints> points =
-		vtkSmartPointer<vtkPoints>::New();
-
-	// Create point ID list
-	std::vector<vtkIdType> *pointIds = 
-		new std::vector<vtkIdType>();
-
-	// Total point count
-	int point_count = 0;
-		
-	// Status indicator
-	size_t res = 0;
-
-	std::cout << "Building mesh..." << std::endl;
-
-	// Loop 1 to get mesh details
+	// Open each grid file once and read its size and spacing
+	std::vector<GridInfo> grids;
 	for (int lev = 0; lev < levels; lev++) {
 		for (int reg = 0; reg < regions; reg++) {
 
 			// L0 doesn't have different regions
 			if (lev == 0 && reg != 0) continue;
 
-			// Debug
-			int local_point_count = 0;
-			std::cout << "Adding cells from L" << lev << " R" << reg << "..." << std::endl;			
+			GridInfo g;
+			g.level = lev;
+			g.region = reg;
+			g.active = false;
 
 			// Construct input file name
 			std::string IN_FILE_NAME("./hdf_R" + std::to_string(reg) + "N" + std::to_string(lev) + ".h5");
-			input_fid = H5Fopen(IN_FILE_NAME.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
-			if (input_fid <= 0) writeInfo("Cannot open input file!", eHDF);
-
-			// Get local grid size
-			input_aid = H5Aopen(input_fid, "GridSize", H5P_DEFAULT);
-			if (input_aid <= 0) writeInfo("Cannot open attribute!", eHDF);
-			status = H5Aread(input_aid, H5T_NATIVE_INT, gridsize);
-			if (status != 0) writeInfo("Cannot read attribute!", eHDF);
-			status = H5Aclose(input_aid);
-			if (status != 0) writeInfo("Cannot close attribute!", eHDF);
+			g.fid = H5Fopen(IN_FILE_NAME.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+			if (g.fid <= 0 && lev == 0)
+			{
+				writeInfo("Cannot open input file " + IN_FILE_NAME + " -- exiting early.", eFatal);
+				exit(EARLY_EXIT);
+			}
+			else if (g.fid <= 0)
+			{
+				// Block never created when regridding
+				std::cout << "No input file " << IN_FILE_NAME << " -- skipping grid." << std::endl;
+				continue;
+			}
 
 			// Get local dx
-			input_aid = H5Aopen(input_fid, "Dx", H5P_DEFAULT);
-			if (input_aid == NULL) writeInfo("Cannot open attribute!", eHDF);
-			status = H5Aread(input_aid, H5T_NATIVE_DOUBLE, &dx);
+			input_aid = H5Aopen(g.fid, "Dx", H5P_DEFAULT);
+			if (input_aid <= 0) writeInfo("Cannot open attribute!", eHDF);
+			status = H5Aread(input_aid, H5T_NATIVE_DOUBLE, &g.dx);
 			if (status != 0) writeInfo("Cannot read attribute!", eHDF);
 			status = H5Aclose(input_aid);
 			if (status != 0) writeInfo("Cannot close attribute!", eHDF);
 
-			// Allocate space for LatTyp data
-			int *Type = (int*)malloc((gridsize[0] * gridsize[1] * gridsize[2]) * sizeof(int));
-			if (Type == NULL) {
-				writeInfo("Not enough Memory!!!!", eFatal);
-				exit(EXIT_FAILURE);
-			}
-
-			// Allocate space for X, Y, Z coordinates
-			double *X = (double*)malloc((gridsize[0] * gridsize[1] * gridsize[2]) * sizeof(double));
-			if (X == NULL) {
-				writeInfo("Not enough Memory!!!!", eFatal);
-				exit(EXIT_FAILURE);
-			}
-			double *Y = (double*)malloc((gridsize[0] * gridsize[1] * gridsize[2]) * sizeof(double));
-			if (Y == NULL) {
-				writeInfo("Not enough Memory!!!!", eFatal);
-				exit(EXIT_FAILURE);
-			}
-			double *Z = (double*)malloc((gridsize[0] * gridsize[1] * gridsize[2]) * sizeof(double));
-			if (Z == NULL) {
-				writeInfo("Not enough Memory!!!!", eFatal);
-				exit(EXIT_FAILURE);
-			}
-
-			// Create input dataspace
-			hsize_t dims_input[1];
-			dims_input[0] = gridsize[0] * gridsize[1] * gridsize[2];
-			hid_t input_sid = H5Screate_simple(1, dims_input, NULL);
-			if (input_sid <= 0) writeInfo("Cannot create input dataspace!", eHDF);
+			grids.push_back(g);
+		}
+	}
 
-			// Open, read into buffers information required for mesh definition and close input datasets
-			status = readDataset("/LatTyp", TIME_STRING, input_fid, input_sid, H5T_NATIVE_INT, Type);
-			if (status != 0)
-			{
-				writeInfo("Typing matrix read failed -- exiting early.", eFatal);
-				exit(EARLY_EXIT);
-			}
-			status = readDataset("/XPos", TIME_STRING, input_fid, input_sid, H5T_NATIVE_DOUBLE, X);
-			if (status != 0)
-			{
-				writeInfo("X position vector read failed -- exiting early.", eFatal);
-				exit(EARLY_EXIT);
-			}
-			status = readDataset("/YPos", TIME_STRING, input_fid, input_sid, H5T_NATIVE_DOUBLE, Y);
+	// List of time steps to process
+	std::vector<size_t> steps;
+	for (size_t t = 0; t <= (size_t)timesteps; t += out_every) steps.push_back(t);
+
+	// A new mesh is needed from T = 0, from every time step on which a grid 
+	// wrote its positions again (e.g. after a regrid moved a refined block) and 
+	// from every time step on which a block was created or removed. Stops at the 
+	// first time step missing from L0 which is reported when it is converted.
+	std::vector<size_t> meshStarts;
+	std::vector<char> bPresent(grids.size(), 0);
+	for (size_t idx = 0; idx < steps.size(); idx++) {
+		std::string time_str = "/Time_" + std::to_string(steps[idx]);
+		if (H5Lexists(grids[0].fid, time_str.c_str(), H5P_DEFAULT) <= 0) break;
+		bool bNewMesh = (idx == 0);
+		for (size_t n = 0; n < grids.size(); n++) {
+			char bNow = (H5Lexists(grids[n].fid, time_str.c_str(), H5P_DEFAULT) > 0);
+			if (bNow != bPresent[n] || hasPositions(grids[n], time_str)) bNewMesh = true;
+			bPresent[n] = bNow;
+		}
+		if (bNewMesh) meshStarts.push_back(idx);
+	}
+	if (meshStarts.empty()) meshStarts.push_back(0);
+	meshStarts.push_back(steps.size());
+
+	// Time steps are converted concurrently by a pool of worker threads which 
+	// each take the next unprocessed time step. The mesh is shared by all.
+	if (numThreads <= 0) numThreads = std::max(1u, std::thread::hardware_concurrency());
+	numThreads = std::min(numThreads, static_cast<int>(steps.size()));
+	std::cout << "Using " << numThreads << " thread(s)..." << std::endl;
+
+	std::atomic<size_t> completed(0);
+	std::atomic<size_t> first_missing(steps.size());
+
+	// Build each mesh in turn and convert the time steps which use it
+	for (size_t m = 0; m + 1 < meshStarts.size() && first_missing == steps.size(); m++) {
+
+		// Point each grid present on this mesh at the last time group holding its positions
+		std::string mesh_str = "/Time_" + std::to_string(steps[meshStarts[m]]);
+		for (GridInfo& g : grids) {
+			g.active = (g.level == 0 || H5Lexists(g.fid, mesh_str.c_str(), H5P_DEFAULT) > 0);
+			if (!g.active) continue;
+			if (m == 0 || g.meshTime.empty() || hasPositions(g, mesh_str)) status = setMeshTime(g, mesh_str);
 			if (status != 0)
 			{
-				writeInfo("Y position vector read failed -- exiting early.", eFatal);
+				writeInfo("Grid size read failed -- exiting early.", eFatal);
 				exit(EARLY_EXIT);
 			}
-			if (dimensions_p == 3) {
-				status = readDataset("/ZPos", TIME_STRING, input_fid, input_sid, H5T_NATIVE_DOUBLE, Z);
-				if (status != 0)
-				{
-					writeInfo("Z position vector read failed -- exiting early.", eFatal);
-					exit(EARLY_EXIT);
-				}
-			}
-
-			// Loop over grid sites
-			for (int c = 0; c < gridsize[0] * gridsize[1] * gridsize[2]; c++) {
-
-				if (bLoud || c % 100000 == 0) {
-					std::cout << "\r" << "Examining cell " << std::to_string(c) << "/" <<
-						std::to_string(gridsize[0] * gridsize[1] * gridsize[2]) << std::flush;
-				}
-
-				// Ignore list
-				if (isOnIgnoreList(static_cast<eType>(Type[c]))) continue;
-
-				local_point_count++;
+		}
 
-				if (dimensions_p == 3) {
+		// Build the mesh from the typing matrix on its first time step
+		std::cout << "Building mesh for " << mesh_str.substr(1) << "..." << std::endl;
+		vtkSmartPointer<vtkUnstructuredGrid> unstructuredGrid =
+			vtkSmartPointer<vtkUnstructuredGrid>::New();
+		buildMesh(mesh_str, dimensions_p, grids, unstructuredGrid);
+		std::cout << "Adding data for each time step to mesh..." << std::endl;
 
-					// Find positions of corner points and store
-					for (int p = 0; p < 8; ++p) {
-						cell_points[p][0] = X[c] + e[0][p] * (dx / 2);
-						cell_points[p][1] = Y[c] + e[1][p] * (dx / 2);
-						cell_points[p][2] = Z[c] + e[2][p] * (dx / 2);
-					}
+		std::atomic<size_t> next_step(meshStarts[m]);
+		const size_t last_step = meshStarts[m + 1];
+		auto worker = [&]()
+		{
+			// Error stacks are per thread in thread-safe HDF5 builds
+			{
+				std::lock_guard<std::mutex> lock(h5mutex);
+				H5Eset_auto(H5E_DEFAULT, NULL, NULL);
+			}
 
-				}
-				else {
+			size_t idx;
+			while ((idx = next_step++) < last_step) {
 
-					// Find positions of corner points and store
-					for (int p = 0; p < 4; ++p) {
-						cell_points[p][0] = X[c] + e2[0][p] * (dx / 2);
-						cell_points[p][1] = Y[c] + e2[1][p] * (dx / 2);
-						cell_points[p][2] = 0.0;
-					}
+				// Skip steps after a missing one
+				if (idx > first_missing) continue;
 
+				if (writeTimeStep(steps[idx], case_num, path_str, dimensions_p, mpi_flag, grids, unstructuredGrid) == DATASET_READ_FAIL)
+				{
+					size_t current = first_missing;
+					while (idx < current && !first_missing.compare_exchange_weak(current, idx));
+					continue;
 				}
 
-				// Build cell from points and add to mesh
-				res = addCell(points, unstructuredGrid, *pointIds, cell_points, &point_count, dimensions_p);
-
+				// Print progress to screen
+				std::lock_guard<std::mutex> lock(logmutex);
+				std::cout << "\r" << std::to_string((int)(((float)(++completed) /
+					(float)(steps.size())) * 100.0f)) << "% complete." << std::flush;
 			}
-			std::cout << "\r" << "Examining cell " << std::to_string(gridsize[0] * gridsize[1] * gridsize[2]) << "/" <<
-				std::to_string(gridsize[0] * gridsize[1] * gridsize[2]) << std::flush;
-			std::cout << std::endl;
-
-			// Close input dataspace
-			status = H5Sclose(input_sid);
-			if (status != 0) writeInfo("Cannot close input dataspace!", eHDF);
-
-			// Close input file
-			status = H5Fclose(input_fid);
-			if (status != 0) writeInfo("Cannot close input file!", eHDF);
+		};
 
-			// Free memory
-			free(Type);
-			free(X);
-			free(Y);
-			free(Z);
-
-			// Debug
-			std::cout << "Valid Point Count  = " << local_point_count << std::endl;
-
-		}
+		std::vector<std::thread> pool;
+		for (int i = 0; i < numThreads; i++) pool.push_back(std::thread(worker));
+		for (std::thread& th : pool) th.join();
+		std::cout << std::endl;
 	}
 
-	// Delete pointIds as we are finished with them
-	delete pointIds;
-
-	// Debug
-	std::cout << "Total number of cells retained for merged mesh = " << unstructuredGrid->GetNumberOfCells() << std::endl;
-	std::cout << "Adding data for each time step to mesh..." << std::endl;
-
-	// Clean mesh to remove duplicate points (Paraview not VTK)
-	vtkSmartPointer<vtkCleanUnstructuredGrid> cleaner =
-		vtkSmartPointer<vtkCleanUnstructuredGrid>::New();
-	cleaner->SetInputData(unstructuredGrid);
-	cleaner->Update();
-
-	// Replace the unstructured grid with the cleaned version
-	unstructuredGrid->Reset();
-	unstructuredGrid = cleaner->GetOutput();
+	// Close input files
+	for (GridInfo& g : grids) {
+		status = H5Fclose(g.fid);
+		if (status != 0) writeInfo("Cannot close input file!", eHDF);
+	}
 
-	// Time loop and data addition
-	int count = 0;
-	for (size_t t = 0; t <= (size_t)timesteps; t += out_every)
+	// If no typing matrix then assume the time step is not available and exit
+	if (first_missing < steps.size())
 	{
-
-		// Create filename
-		std::string vtkFilename = path_str + "/luma_" + case_num + "." + std::to_string(t);
-		if (bLegacy)
-			vtkFilename += ".vtk";
-		else
-			vtkFilename += ".vtu";
-
-		// Add data
-		vtkSmartPointer<vtkIntArray> LatTyp = vtkSmartPointer<vtkIntArray>::New();
-		LatTyp->Allocate(unstructuredGrid->GetNumberOfCells());
-		LatTyp->SetName("LatTyp");
-		status = addDataToGrid("/LatTyp", TIME_STRING, levels, regions, gridsize, unstructuredGrid, dummy_i, H5T_NATIVE_INT, LatTyp);
-		
-		// If no typing matrix then assume the time step is not available and exit
-		if (status == DATASET_READ_FAIL)
-		{
-			writeInfo("Couldn't find time step " + std::to_string(t) + ". Read failed -- exiting early.", eFatal);
-			exit(EARLY_EXIT);
-		}
-
-		// MPI block data always read from Time_0
-		if (mpi_flag)
-		{
-			vtkSmartPointer<vtkIntArray> Block = vtkSmartPointer<vtkIntArray>::New();
-			Block->Allocate(unstructuredGrid->GetNumberOfCells());
-			Block->SetName("MpiBlockNumber");
-			status = addDataToGrid("/MpiBlock", "/Time_0", levels, regions, gridsize, unstructuredGrid, dummy_i, H5T_NATIVE_INT, Block);
-		}
-
-		vtkSmartPointer<vtkDoubleArray> RhoArray = vtkSmartPointer<vtkDoubleArray>::New();
-		RhoArray->Allocate(unstructuredGrid->GetNumberOfCells());
-		RhoArray->SetName("Rho");
-		status = addDataToGrid("/Rho", TIME_STRING, levels, regions, gridsize, unstructuredGrid, dummy_d, H5T_NATIVE_DOUBLE, RhoArray);
-
-		vtkSmartPointer<vtkDoubleArray> Rho_TimeAv = vtkSmartPointer<vtkDoubleArray>::New();
-		Rho_TimeAv->Allocate(unstructuredGrid->GetNumberOfCells());
-		Rho_TimeAv->SetName("Rho_TimeAv");
-		status = addDataToGrid("/Rho_TimeAv", TIME_STRING, levels, regions, gridsize, unstructuredGrid, dummy_d, H5T_NATIVE_DOUBLE, Rho_TimeAv);
-
-		vtkSmartPointer<vtkDoubleArray> Ux = vtkSmartPointer<vtkDoubleArray>::New();
-		Ux->Allocate(unstructuredGrid->GetNumberOfCells());
-		Ux->SetName("Ux");
-		status = addDataToGrid("/Ux", TIME_STRING, levels, regions, gridsize, unstructuredGrid, dummy_d, H5T_NATIVE_DOUBLE, Ux);
-
-		vtkSmartPointer<vtkDoubleArray> Uy = vtkSmartPointer<vtkDoubleArray>::New();
-		Uy->Allocate(unstructuredGrid->GetNumberOfCells());
-		Uy->SetName("Uy");
-		status = addDataToGrid("/Uy", TIME_STRING, levels, regions, gridsize, unstructuredGrid, dummy_d, H5T_NATIVE_DOUBLE, Uy);
-
-		vtkSmartPointer<vtkDoubleArray> Ux_TimeAv = vtkSmartPointer<vtkDoubleArray>::New();
-		Ux_TimeAv->Allocate(unstructuredGrid->GetNumberOfCells());
-		Ux_TimeAv->SetName("Ux_TimeAv");
-		status = addDataToGrid("/Ux_TimeAv", TIME_STRING, levels, regions, gridsize, unstructuredGrid, dummy_d, H5T_NATIVE_DOUBLE, Ux_TimeAv);
-
-		vtkSmartPointer<vtkDoubleArray> Uy_TimeAv = vtkSmartPointer<vtkDoubleArray>::New();
-		Uy_TimeAv->Allocate(unstructuredGrid->GetNumberOfCells());
-		Uy_TimeAv->SetName("Uy_TimeAv");
-		status = addDataToGrid("/Uy_TimeAv", TIME_STRING, levels, regions, gridsize, unstructuredGrid, dummy_d, H5T_NATIVE_DOUBLE, Uy_TimeAv);
-
-		vtkSmartPointer<vtkDoubleArray> UxUx_TimeAv = vtkSmartPointer<vtkDoubleArray>::New();
-		UxUx_TimeAv->Allocate(unstructuredGrid->GetNumberOfCells());
-		UxUx_TimeAv->SetName("UxUx_TimeAv");
-		status = addDataToGrid("/UxUx_TimeAv", TIME_STRING, levels, regions, gridsize, unstructuredGrid, dummy_d, H5T_NATIVE_DOUBLE, UxUx_TimeAv);
-
-		vtkSmartPointer<vtkDoubleArray> UxUy_TimeAv = vtkSmartPointer<vtkDoubleArray>::New();
-		UxUy_TimeAv->Allocate(unstructuredGrid->GetNumberOfCells());
-		UxUy_TimeAv->SetName("UxUy_TimeAv");
-		status = addDataToGrid("/UxUy_TimeAv", TIME_STRING, levels, regions, gridsize, unstructuredGrid, dummy_d, H5T_NATIVE_DOUBLE, UxUy_TimeAv);
-
-		vtkSmartPointer<vtkDoubleArray> UyUy_TimeAv = vtkSmartPointer<vtkDoubleArray>::New();
-		UyUy_TimeAv->Allocate(unstructuredGrid->GetNumberOfCells());
-		UyUy_TimeAv->SetName("UyUy_TimeAv");
-		status = addDataToGrid("/UyUy_TimeAv", TIME_STRING, levels, regions, gridsize, unstructuredGrid, dummy_d, H5T_NATIVE_DOUBLE, UyUy_TimeAv);
-
-		if (dimensions_p == 3)
-		{
-
-			vtkSmartPointer<vtkDoubleArray> Uz = vtkSmartPointer<vtkDoubleArray>::New();
-			Uz->Allocate(unstructuredGrid->GetNumberOfCells());
-			Uz->SetName("Uz");
-			status = addDataToGrid("/Uz", TIME_STRING, levels, regions, gridsize, unstructuredGrid, dummy_d, H5T_NATIVE_DOUBLE, Uz);
-
-			vtkSmartPointer<vtkDoubleArray> Uz_TimeAv = vtkSmartPointer<vtkDoubleArray>::New();
-			Uz_TimeAv->Allocate(unstructuredGrid->GetNumberOfCells());
-			Uz_TimeAv->SetName("Uz_TimeAv");
-			status = addDataToGrid("/Uz_TimeAv", TIME_STRING, levels, regions, gridsize, unstructuredGrid, dummy_d, H5T_NATIVE_DOUBLE, Uz_TimeAv);
-
-			vtkSmartPointer<vtkDoubleArray> UxUz_TimeAv = vtkSmartPointer<vtkDoubleArray>::New();
-			UxUz_TimeAv->Allocate(unstructuredGrid->GetNumberOfCells());
-			UxUz_TimeAv->SetName("UxUz_TimeAv");
-			status = addDataToGrid("/UxUz_TimeAv", TIME_STRING, levels, regions, gridsize, unstructuredGrid, dummy_d, H5T_NATIVE_DOUBLE, UxUz_TimeAv);
-
-			vtkSmartPointer<vtkDoubleArray> UyUz_TimeAv = vtkSmartPointer<vtkDoubleArray>::New();
-			UyUz_TimeAv->Allocate(unstructuredGrid->GetNumberOfCells());
-			UyUz_TimeAv->SetName("UyUz_TimeAv");
-			status = addDataToGrid("/UyUz_TimeAv", TIME_STRING, levels, regions, gridsize, unstructuredGrid, dummy_d, H5T_NATIVE_DOUBLE, UyUz_TimeAv);
-
-			vtkSmartPointer<vtkDoubleArray> UzUz_TimeAv = vtkSmartPointer<vtkDoubleArray>::New();
-			UzUz_TimeAv->Allocate(unstructuredGrid->GetNumberOfCells());
-			UzUz_TimeAv->SetName("UzUz_TimeAv");
-			status = addDataToGrid("/UzUz_TimeAv", TIME_STRING, levels, regions, gridsize, unstructuredGrid, dummy_d, H5T_NATIVE_DOUBLE, UzUz_TimeAv);
-		}
-
-		// Otherwise, must be simply a missing dataset so continue to next time step
-		TIME_STRING = "/Time_" + std::to_string(t + out_every);
-
-		// Print progress to screen
-		std::cout << "\r" << std::to_string((int)(((float)(t + out_every) / 
-			(float)(timesteps + out_every)) * 100.0f)) << "% complete." << std::flush;
-
-		// Write grid to file
-		void *writer = nullptr;
-		if (bLegacy)
-		{
-			vtkSmartPointer<vtkUnstructuredGridWriter> writer =
-				vtkSmartPointer<vtkUnstructuredGridWriter>::New();
-			writer->SetFileName(vtkFilename.c_str());
-			writer->SetFileTypeToBinary();
-			writer->SetFileName(vtkFilename.c_str());
-#if VTK_MAJOR_VERSION <= 5
-			writer->SetInput(unstructuredGrid);
-#else
-			writer->SetInputData(unstructuredGrid);
-#endif
-			writer->Write();
-		}
-		else
-		{
-			vtkSmartPointer<vtkXMLUnstructuredGridWriter> writer =
-				vtkSmartPointer<vtkXMLUnstructuredGridWriter>::New();
-			writer->SetFileName(vtkFilename.c_str());
-#if VTK_MAJOR_VERSION <= 5
-			writer->SetInput(unstructuredGrid);
-#else
-			writer->SetInputData(unstructuredGrid);
-#endif
-			writer->Write();
-		}
-
-		// Free the memory used (forces destructor call)
-		LatTyp = NULL;
-		RhoArray = NULL;
-		Rho_TimeAv = NULL;
-		Ux = NULL;
-		Uy = NULL;
-		Ux_TimeAv = NULL;
-		Uy_TimeAv = NULL;
-		UxUx_TimeAv = NULL;
-		UxUy_TimeAv = NULL;
-		UyUy_TimeAv = NULL;
+		writeInfo("Couldn't find time step " + std::to_string(steps[first_missing]) + ". Read failed -- exiting early.", eFatal);
+		exit(EARLY_EXIT);
 	}
 
 	return 0;
 }
-
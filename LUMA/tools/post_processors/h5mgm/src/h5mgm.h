@@ -15,7 +15,7 @@
 
 /* H5 Multi-Grid Merge Tool for post-processing HDF5 files written by LUMA */
 
-#define H5MGM_VERSION "0.3.2"
+#define H5MGM_VERSION "0.4.1"
 
 #include "hdf5.h"
 #define H5_BUILT_AS_DYNAMIC_LIB
@@ -27,6 +27,12 @@
 #include <vector>
 #include <algorithm>
 #include <fstream>
+#include <cmath>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <unordered_map>
 
 #ifdef _WIN32
 	#include <Windows.h>
@@ -47,6 +53,7 @@
 #define DATASET_READ_FAIL -321
 #define EARLY_EXIT 998
 #define H5MGM_OUTPUT_PATH "./postprocessedoutput"
+#define H5MGM_CHUNK_SIZE 1048576	// Approximate number of sites read from file in one go
 
 // Static variables
 static bool bQuiet = false;
@@ -55,6 +62,9 @@ static std::ofstream logfile;
 static bool bCutSolid = false;
 static bool bLegacy = false;
 static bool bSorter = false;
+static int numThreads = 0;
+static std::mutex h5mutex;		// HDF5 library is not assumed to be thread-safe so all calls are serialised
+static std::mutex logmutex;		// Guards log file and screen output from worker threads
 
 // Unit vectors for node positions on each cell
 const int e[3][8] =
@@ -107,6 +117,7 @@ void writeInfo(std::string info, eError type) {
 	}
 
 	// Perform appropriate action
+	std::lock_guard<std::mutex> lock(logmutex);
 	if (bQuiet == false)
 	{
 		// Write to log
@@ -127,7 +138,7 @@ bool isOnIgnoreList(eType cell_type)
 	if (
 		cell_type == eRefined ||
 		cell_type == eTransitionToCoarser ||
-		(bCutSolid = true && cell_type == eSolid)
+		(bCutSolid == true && cell_type == eSolid)
 		) return true;
 
 	return false;
@@ -154,110 +165,113 @@ static void secs2hms(T total_seconds, int *hms)
 		));
 }
 
-// Method to read a dataset with a given name into a buffer
+// Description of a single grid read from file
+struct GridInfo
+{
+	int level;							// Grid level
+	int region;							// Grid region
+	hid_t fid;							// Open HDF5 file handle (kept open for the whole run)
+	bool active;						// Grid wrote the time steps of the current mesh (blocks come and go when regridding)
+	std::string meshTime;				// Time group holding the positions of the grid in the current mesh
+	int gridsize[3];					// Local grid size
+	hsize_t totalSites;					// Number of sites in the file
+	hsize_t chunkSites;					// Number of sites read in one go (whole X-slabs)
+	double dx;							// Lattice spacing
+	std::vector<unsigned char> keep;	// Flag for each site indicating whether it is part of the merged mesh
+};
+
+// Method to select a block of sites in a dataset given as a flat start index and 
+// count. Datasets are stored with the grid dimensions so the block must be made up 
+// of whole slabs in the first (X) dimension, as is the case for GridInfo::chunkSites.
+inline herr_t selectSites(hid_t file_sid, hsize_t start, hsize_t count)
+{
+	hsize_t dims[3] = { 1, 1, 1 };
+	int ndims = H5Sget_simple_extent_dims(file_sid, dims, NULL);
+	if (ndims <= 0) return -1;
+	hsize_t slab = 1;
+	for (int d = 1; d < ndims; d++) slab *= dims[d];
+	hsize_t offset[3] = { start / slab, 0, 0 };
+	hsize_t block[3] = { count / slab, dims[1], dims[2] };
+	return H5Sselect_hyperslab(file_sid, H5S_SELECT_SET, offset, NULL, block, NULL);
+}
+
+// Method to read a dataset with a given name in chunks of g.chunkSites sites.
+// The callback is given the index of the first site in the chunk, the number of 
+// sites and the buffer. Only the HDF5 calls hold the lock so that other threads 
+// can process their data while this one waits for the next chunk.
 template <typename T>
-herr_t readDataset(std::string VAR, std::string TIME_STRING, hid_t input_fid, hid_t input_sid, hid_t H5Type, T *buffer) {
+herr_t readDatasetChunked(std::string VAR, std::string TIME_STRING, GridInfo& g, 
+	hid_t H5Type, std::function<void(hsize_t, hsize_t, const T*)> func) {
 
-	herr_t status;
+	herr_t status = 0;
 	std::string variable_string = TIME_STRING + VAR;
-	hid_t input_did = H5Dopen(input_fid, variable_string.c_str(), H5P_DEFAULT);
+	std::vector<T> buffer(static_cast<size_t>(g.chunkSites));
+
+	hid_t input_did, file_sid;
+	{
+		std::lock_guard<std::mutex> lock(h5mutex);
+		input_did = H5Dopen(g.fid, variable_string.c_str(), H5P_DEFAULT);
+		if (input_did > 0) file_sid = H5Dget_space(input_did);
+	}
 	if (input_did <= 0)
 	{
 		writeInfo("Cannot open input dataset: " + variable_string, eHDF);
 		return DATASET_READ_FAIL;
 	}
-	status = H5Dread(input_did, H5Type, input_sid, H5S_ALL, H5P_DEFAULT, buffer);
-	if (status != 0) writeInfo("Cannot read input dataset!", eHDF);
-	status = H5Dclose(input_did);
-	if (status != 0) writeInfo("Cannot close input dataset!", eHDF);
+
+	for (hsize_t start = 0; start < g.totalSites; start += g.chunkSites) {
+
+		hsize_t count = std::min<hsize_t>(g.chunkSites, g.totalSites - start);
+		{
+			std::lock_guard<std::mutex> lock(h5mutex);
+			hid_t mem_sid = H5Screate_simple(1, &count, NULL);
+			status = selectSites(file_sid, start, count);
+			if (status >= 0) status = H5Dread(input_did, H5Type, mem_sid, file_sid, H5P_DEFAULT, &buffer[0]);
+			H5Sclose(mem_sid);
+		}
+		if (status != 0)
+		{
+			writeInfo("Cannot read input dataset: " + variable_string, eHDF);
+			break;
+		}
+
+		// Process chunk
+		func(start, count, &buffer[0]);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(h5mutex);
+		H5Sclose(file_sid);
+		if (H5Dclose(input_did) != 0) writeInfo("Cannot close input dataset!", eHDF);
+	}
 
 	return status;
 
 }
 
-// Method to compile and add arrays of cell data to the mesh
+// Method to compile and add arrays of cell data to the mesh. The cells retained 
+// in the mesh are identified by the keep flags computed when the mesh was built.
+// An empty time string reads each grid from the time group of its positions.
 template<typename T, typename vtkT>
 herr_t addDataToGrid(std::string VAR, std::string TIME_STRING, 
-	int levels, int regions, int* gridsize, 
-	vtkSmartPointer<vtkUnstructuredGrid> grid, T *dummy, hid_t H5Type, 
-	vtkSmartPointer<vtkT> vtkArray) {
+	std::vector<GridInfo>& grids, vtkSmartPointer<vtkUnstructuredGrid> grid, 
+	hid_t H5Type, vtkSmartPointer<vtkT> vtkArray) {
 
 	// Array ID counter
-	int count = 0;
-
-	for (int lev = 0; lev < levels; lev++) {
-		for (int reg = 0; reg < regions; reg++) {
-
-			// L0 doesn't have different regions
-			if (lev == 0 && reg != 0) continue;
-
-			// Construct input file name
-			std::string IN_FILE_NAME("./hdf_R" + std::to_string(reg) + "N" + std::to_string(lev) + ".h5");
-			hid_t input_fid = H5Fopen(IN_FILE_NAME.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
-			if (input_fid <= 0) writeInfo("Cannot open input file!", eHDF);
-
-			// Get local grid size
-			hid_t input_aid = H5Aopen(input_fid, "GridSize", H5P_DEFAULT);
-			if (input_aid <= 0) writeInfo("Cannot open attribute!", eHDF);
-			herr_t status = H5Aread(input_aid, H5T_NATIVE_INT, gridsize);
-			if (status != 0) writeInfo("Cannot read attribute!", eHDF);
-			status = H5Aclose(input_aid);
-			if (status != 0) writeInfo("Cannot close attribute!", eHDF);
-
-			// Allocate space for typing matrix
-			int *Type = (int*)malloc((gridsize[0] * gridsize[1] * gridsize[2]) * sizeof(int));
-			if (Type == NULL)
-			{
-				writeInfo("Not enough Memory!!!!", eFatal);
-				exit(EXIT_FAILURE);
-			}
-
-			// Allocate space for data
-			T *data = (T*)malloc((gridsize[0] * gridsize[1] * gridsize[2]) * sizeof(T));
-			if (data == NULL)
-			{
-				writeInfo("Not enough Memory!!!!", eFatal);
-				exit(EXIT_FAILURE);
-			}
-
-			// Create input dataspace
-			hsize_t dims_input[1];
-			dims_input[0] = gridsize[0] * gridsize[1] * gridsize[2];
-			hid_t input_sid = H5Screate_simple(1, dims_input, NULL);
-			if (input_sid <= 0) writeInfo("Cannot create input dataspace!", eHDF);
-
-			// Read in the typing matrix
-			status = readDataset("/LatTyp", TIME_STRING, input_fid, input_sid, H5T_NATIVE_INT, Type);
-			if (status == DATASET_READ_FAIL) return status;
+	vtkIdType count = 0;
+	vtkArray->SetNumberOfTuples(grid->GetNumberOfCells());
 
-			// Open, read and close input dataset
-			status = readDataset(VAR, TIME_STRING, input_fid, input_sid, H5Type, data);
-			if (status == DATASET_READ_FAIL) return status;
+	for (GridInfo& g : grids) {
 
-			// Loop over grid sites
-			for (int c = 0; c < gridsize[0] * gridsize[1] * gridsize[2]; c++) {
-
-				// If not one of the include sites, ignore
-				if (isOnIgnoreList(static_cast<eType>(Type[c]))) continue;
-
-				// Insert data into array
-				vtkArray->InsertValue(count, data[c]);
-				count++;
+		if (!g.active) continue;
+		herr_t status = readDatasetChunked<T>(VAR, TIME_STRING.empty() ? g.meshTime : TIME_STRING, g, H5Type,
+			[&](hsize_t start, hsize_t n, const T *data)
+		{
+			for (hsize_t c = 0; c < n; c++) {
+				if (g.keep[start + c]) vtkArray->SetValue(count++, data[c]);
 			}
-
-			// Close input dataspace
-			status = H5Sclose(input_sid);
-			if (status != 0) writeInfo("Cannot close input dataspace!", eHDF);
-
-			// Close input file
-			status = H5Fclose(input_fid);
-			if (status != 0) writeInfo("Cannot close input file!", eHDF);
-
-			// Free memory
-			free(Type);
-			free(data);
-
-		}
+		});
+		if (status != 0) return status;
 	}
 
 	// Add complete data set to grid
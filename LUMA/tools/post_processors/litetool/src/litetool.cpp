@@ -0,0 +1,607 @@
+/*
+* --------------------------------------------------------------
+*
+* ------ Lattice Boltzmann @ The University of Manchester ------
+*
+* -------------------------- L-U-M-A ---------------------------
+*
+*  Copyright (C) The University of Manchester 2017
+*  E-mail contact: info@luma.manchester.ac.uk
+*
+* This software is for academic use only and not available for
+* further distribution commericially or otherwise without written consent.
+*
+*/
+
+#include "litetool.h"
+
+// Flag to skip refined and transition to coarser sites when merging
+static bool bCut = false;
+
+// Flag to write populations when merging
+static bool bFull = false;
+
+// Method to work out the number of lattice velocities and time averaged flag from a number of values
+static bool deduceLayout(int numValues, int& numVels, bool& hasTA)
+{
+	const int lattices[] = { 9, 15, 19, 27 };
+	for (int q : lattices)
+	{
+		if (numValues == LITE_NUM_BASE + 2 * q) { numVels = q; hasTA = false; return true; }
+		if (numValues == LITE_NUM_BASE + 2 * q + LITE_NUM_TA) { numVels = q; hasTA = true; return true; }
+	}
+	return false;
+}
+
+// Method to return the range of values in a row belonging to a field group
+static void fieldRange(const LiteBlock& b, int field, int& start, int& end)
+{
+	switch (field)
+	{
+	case eFieldPos:		start = 0; end = 3; break;
+	case eFieldRho:		start = 3; end = 4; break;
+	case eFieldU:		start = 4; end = 7; break;
+	case eFieldF:		start = LITE_NUM_BASE; end = start + b.numVels; break;
+	case eFieldFNew:	start = LITE_NUM_BASE + b.numVels; end = start + b.numVels; break;
+	case eFieldTA:		start = LITE_NUM_BASE + 2 * b.numVels; end = b.hasTA ? start + LITE_NUM_TA : start; break;
+	default:			start = 0; end = 0; break;
+	}
+}
+
+// Read an ASCII io_lite file. Lines not starting with a number (headers) are skipped.
+bool readTextBlock(LiteBlock& b)
+{
+	std::ifstream file(b.filename, std::ios::in);
+	if (!file.is_open()) { b.error = "could not open file"; return false; }
+
+	std::string line;
+	std::vector<double> row;
+	while (std::getline(file, line))
+	{
+		// Split line into numbers
+		row.clear();
+		const char *p = line.c_str();
+		char *endp;
+		while (true)
+		{
+			double val = std::strtod(p, &endp);
+			if (endp == p) break;
+			row.push_back(val);
+			p = endp;
+		}
+
+		// Skip headers and blank lines
+		while (*p == ' ' || *p == '\t' || *p == '\r') p++;
+		if (row.size() < 2 || *p != '\0') continue;
+
+		// Layout is set by the first data line
+		int numValues = static_cast<int>(row.size()) - 2;
+		if (b.numValues == 0)
+		{
+			if (!deduceLayout(numValues, b.numVels, b.hasTA))
+			{
+				b.error = "unrecognised number of columns (" + std::to_string(row.size()) + ")";
+				return false;
+			}
+			b.numValues = numValues;
+		}
+		else if (numValues != b.numValues)
+		{
+			b.error = "inconsistent number of columns";
+			return false;
+		}
+
+		b.rank.push_back(static_cast<int>(row[0]));
+		b.type.push_back(static_cast<int>(row[1]));
+		b.values.insert(b.values.end(), row.begin() + 2, row.end());
+	}
+	return true;
+}
+
+// Read a binary io_lite file
+bool readBinaryBlock(LiteBlock& b)
+{
+	std::ifstream file(b.filename, std::ios::in | std::ios::binary);
+	if (!file.is_open()) { b.error = "could not open file"; return false; }
+
+	// Header
+	char magic[8];
+	int32_t header[7];
+	double time;
+	int64_t nRecords;
+	file.read(magic, 8);
+	file.read(reinterpret_cast<char*>(header), sizeof(header));
+	file.read(reinterpret_cast<char*>(&time), sizeof(double));
+	file.read(reinterpret_cast<char*>(&nRecords), sizeof(int64_t));
+	if (!file || std::memcmp(magic, LITE_MAGIC, 8) != 0) { b.error = "not an io_lite binary file"; return false; }
+	if (header[0] != LITE_VERSION) { b.error = "unsupported version " + std::to_string(header[0]); return false; }
+
+	b.numVels = header[2];
+	b.numValues = header[3];
+	b.level = header[4];
+	b.region = header[5];
+	b.hasTA = (b.numValues == LITE_NUM_BASE + 2 * b.numVels + LITE_NUM_TA);
+	if (!b.hasTA && b.numValues != LITE_NUM_BASE + 2 * b.numVels) { b.error = "inconsistent header"; return false; }
+
+	// Records
+	size_t recordSize = 2 * sizeof(int32_t) + b.numValues * sizeof(double);
+	std::vector<char> buffer(recordSize * static_cast<size_t>(nRecords));
+	file.read(buffer.data(), buffer.size());
+	if (!file) { b.error = "file is truncated"; return false; }
+
+	b.rank.resize(nRecords);
+	b.type.resize(nRecords);
+	b.values.resize(nRecords * b.numValues);
+	for (int64_t n = 0; n < nRecords; n++)
+	{
+		const char *rec = &buffer[n * recordSize];
+		int32_t ids[2];
+		std::memcpy(ids, rec, sizeof(ids));
+		b.rank[n] = ids[0];
+		b.type[n] = ids[1];
+		std::memcpy(&b.values[n * b.numValues], rec + sizeof(ids), b.numValues * sizeof(double));
+	}
+	return true;
+}
+
+// Read all the io_lite files in a directory for a time step and sort the sites by global position
+bool readSet(const std::string& dir, int time, int numThreads, LiteSet& set)
+{
+	DIR *dp = opendir(dir.c_str());
+	if (dp == NULL) { std::cout << "Error: cannot open directory " << dir << std::endl; return false; }
+
+	// Find files (binary preferred if both exist)
+	std::map<std::string, LiteBlock> found;
+	struct dirent *entry;
+	while ((entry = readdir(dp)) != NULL)
+	{
+		int lev, reg, rnk, t, len = 0;
+		char ext[4] = { 0 };
+		std::string name(entry->d_name);
+		if (sscanf(entry->d_name, "io_lite.Lev%d.Reg%d.Rnk%d.%d.%3s%n", &lev, &reg, &rnk, &t, ext, &len) != 5) continue;
+		if (t != time || len != static_cast<int>(name.size())) continue;
+		std::string extension(ext);
+		if (extension != "dat" && extension != "bin") continue;
+
+		std::string key = name.substr(0, name.size() - 4);
+		if (found.count(key) && extension == "dat") continue;
+		LiteBlock& b = found[key];
+		b.filename = dir + "/" + name;
+		b.level = lev;
+		b.region = reg;
+	}
+	closedir(dp);
+
+	if (found.empty()) { std::cout << "Error: no io_lite files for time " << time << " in " << dir << std::endl; return false; }
+	for (auto& f : found) set.blocks.push_back(std::move(f.second));
+
+	// Ordering of sites by level, region, Z, Y, X then rank
+	auto less = [&set](const LiteSite& a, const LiteSite& b)
+	{
+		const LiteBlock& ba = set.blocks[a.block];
+		const LiteBlock& bb = set.blocks[b.block];
+		if (ba.level != bb.level) return ba.level < bb.level;
+		if (ba.region != bb.region) return ba.region < bb.region;
+		const double *ra = ba.row(a.row);
+		const double *rb = bb.row(b.row);
+		if (ra[2] != rb[2]) return ra[2] < rb[2];
+		if (ra[1] != rb[1]) return ra[1] < rb[1];
+		if (ra[0] != rb[0]) return ra[0] < rb[0];
+		return ba.rank[a.row] < bb.rank[b.row];
+	};
+
+	// Read and sort each file concurrently
+	std::vector< std::vector<LiteSite> > sorted(set.blocks.size());
+	std::atomic<size_t> next(0);
+	auto reader = [&]()
+	{
+		size_t n;
+		while ((n = next++) < set.blocks.size())
+		{
+			LiteBlock& b = set.blocks[n];
+			std::string::size_type dot = b.filename.rfind('.');
+			if (b.filename.compare(dot, 4, ".bin") == 0) readBinaryBlock(b);
+			else readTextBlock(b);
+			if (!b.error.empty()) continue;
+
+			sorted[n].resize(b.size());
+			for (size_t r = 0; r < b.size(); r++) sorted[n][r] = { static_cast<int>(n), r };
+			std::sort(sorted[n].begin(), sorted[n].end(), less);
+		}
+	};
+	std::vector<std::thread> pool;
+	for (int i = 0; i < numThreads; i++) pool.push_back(std::thread(reader));
+	for (std::thread& th : pool) th.join();
+
+	// Check files
+	bool ok = true;
+	for (LiteBlock& b : set.blocks)
+	{
+		if (!b.error.empty()) { std::cout << "Error: " << b.filename << ": " << b.error << std::endl; ok = false; }
+		else if (b.numVels != set.blocks[0].numVels || b.hasTA != set.blocks[0].hasTA)
+		{
+			std::cout << "Error: " << b.filename << " has a different layout to " << set.blocks[0].filename << std::endl;
+			ok = false;
+		}
+	}
+	if (!ok) return false;
+
+	// Merge the sorted files pairwise (each pass merges pairs concurrently)
+	while (sorted.size() > 1)
+	{
+		size_t half = sorted.size() / 2;
+		std::vector< std::vector<LiteSite> > merged(sorted.size() - half);
+		std::atomic<size_t> pair(0);
+		auto merger = [&]()
+		{
+			size_t n;
+			while ((n = pair++) < half)
+			{
+				std::vector<LiteSite>& a = sorted[2 * n];
+				std::vector<LiteSite>& b = sorted[2 * n + 1];
+				merged[n].resize(a.size() + b.size());
+				std::merge(a.begin(), a.end(), b.begin(), b.end(), merged[n].begin(), less);
+				std::vector<LiteSite>().swap(a);
+				std::vector<LiteSite>().swap(b);
+			}
+		};
+		pool.clear();
+		for (int i = 0; i < numThreads; i++) pool.push_back(std::thread(merger));
+		for (std::thread& th : pool) th.join();
+		if (sorted.size() % 2) merged.back().swap(sorted.back());
+		sorted.swap(merged);
+	}
+	set.sites.swap(sorted[0]);
+	return true;
+}
+
+// Write the merged sites as one Tecplot zone per grid
+int merge(const std::string& dir, int time, const std::string& outFile, int numThreads)
+{
+	LiteSet set;
+	if (!readSet(dir, time, numThreads, set)) return LITE_ERROR;
+	const LiteBlock& b0 = set.blocks[0];
+
+	std::ofstream tecfile(outFile, std::ios::out);
+	if (!tecfile.is_open()) { std::cout << "Error: cannot open " << outFile << std::endl; return LITE_ERROR; }
+	tecfile.precision(10);
+	tecfile.setf(std::ios::fixed);
+	tecfile.setf(std::ios::showpoint);
+
+	// Header
+	tecfile << "TITLE = LUMA io_lite data at time " << time << '\n';
+	tecfile << "FILETYPE = FULL\n";
+	tecfile << "VARIABLES = \"TYPE\" \"X\" \"Y\" \"Z\" \"RHO\" \"UX\" \"UY\" \"UZ\"";
+	if (bFull)
+	{
+		for (int v = 0; v < b0.numVels; v++) tecfile << " \"F" << v << "\"";
+		for (int v = 0; v < b0.numVels; v++) tecfile << " \"FNEW" << v << "\"";
+	}
+	if (b0.hasTA)
+		tecfile << " \"TA_RHO\" \"TA_UX\" \"TA_UY\" \"TA_UZ\" \"TA_UXUX\" \"TA_UXUY\" \"TA_UXUZ\" \"TA_UYUY\" \"TA_UYUZ\" \"TA_UZUZ\"";
+	tecfile << '\n';
+
+	// Zones
+	size_t n = 0;
+	while (n < set.sites.size())
+	{
+		const LiteBlock& first = set.blocks[set.sites[n].block];
+		size_t end = n;
+		std::vector<size_t> keep;
+		while (end < set.sites.size())
+		{
+			const LiteSite& s = set.sites[end];
+			const LiteBlock& b = set.blocks[s.block];
+			if (b.level != first.level || b.region != first.region) break;
+			if (!(bCut && (b.type[s.row] == 2 || b.type[s.row] == 3))) keep.push_back(end);
+			end++;
+		}
+
+		tecfile << "ZONE T = \"Lev" << first.level << " Reg" << first.region << "\"\n";
+		tecfile << "I = " << keep.size() << '\n';
+		tecfile << "DATAPACKING = POINT\n";
+		tecfile << "SOLUTIONTIME = " << time << '\n';
+		for (size_t k : keep)
+		{
+			const LiteSite& s = set.sites[k];
+			const LiteBlock& b = set.blocks[s.block];
+			const double *row = b.row(s.row);
+			int last = bFull ? b.numValues : LITE_NUM_BASE;
+			tecfile << b.type[s.row];
+			for (int v = 0; v < last; v++) tecfile << '\t' << row[v];
+			if (!bFull && b.hasTA)
+				for (int v = b.numValues - LITE_NUM_TA; v < b.numValues; v++) tecfile << '\t' << row[v];
+			tecfile << '\n';
+		}
+		n = end;
+	}
+
+	tecfile.close();
+	std::cout << "Merged " << set.blocks.size() << " files (" << set.sites.size() << " sites) into " << outFile << std::endl;
+	return LITE_PASS;
+}
+
+// Compare two sets of io_lite files site by site with a tolerance per field group
+int diff(const std::string& dirA, const std::string& dirB, int time, const double *tol, int numThreads)
+{
+	LiteSet setA, setB;
+	if (!readSet(dirA, time, numThreads, setA) || !readSet(dirB, time, numThreads, setB)) return LITE_ERROR;
+
+	const LiteBlock& a0 = setA.blocks[0];
+	const LiteBlock& b0 = setB.blocks[0];
+	if (a0.numVels != b0.numVels)
+	{
+		std::cout << "FAIL: different lattices (" << a0.numVels << " and " << b0.numVels << " velocities)" << std::endl;
+		return LITE_FAIL;
+	}
+	if (setA.sites.size() != setB.sites.size())
+	{
+		std::cout << "FAIL: different number of sites (" << setA.sites.size() << " and " << setB.sites.size() << ")" << std::endl;
+		return LITE_FAIL;
+	}
+
+	// Compare fields present in both sets concurrently over chunks of sites
+	bool compare[eFieldCount];
+	for (int f = 0; f < eFieldCount; f++) compare[f] = true;
+	compare[eFieldTA] = a0.hasTA && b0.hasTA;
+
+	std::vector< std::vector<double> > maxDiff(numThreads, std::vector<double>(eFieldCount, 0.0));
+	std::vector< std::vector<size_t> > worst(numThreads, std::vector<size_t>(eFieldCount, 0));
+	std::vector<size_t> badLevel(numThreads, 0);
+	size_t chunk = (setA.sites.size() + numThreads - 1) / numThreads;
+
+	auto worker = [&](int t)
+	{
+		size_t start = t * chunk;
+		size_t end = std::min(setA.sites.size(), start + chunk);
+		for (size_t n = start; n < end; n++)
+		{
+			const LiteSite& sa = setA.sites[n];
+			const LiteSite& sb = setB.sites[n];
+			const LiteBlock& ba = setA.blocks[sa.block];
+			const LiteBlock& bb = setB.blocks[sb.block];
+			if (ba.level != bb.level || ba.region != bb.region) { badLevel[t]++; continue; }
+
+			const double *ra = ba.row(sa.row);
+			const double *rb = bb.row(sb.row);
+			for (int f = 0; f < eFieldCount; f++)
+			{
+				if (!compare[f]) continue;
+				double d;
+				if (f == eFieldType) d = std::abs(ba.type[sa.row] - bb.type[sb.row]);
+				else
+				{
+					int s, e;
+					fieldRange(ba, f, s, e);
+					d = 0.0;
+					for (int v = s; v < e; v++) d = std::max(d, std::abs(ra[v] - rb[v]));
+				}
+				if (d > maxDiff[t][f] || d != d) { maxDiff[t][f] = d; worst[t][f] = n; }
+			}
+		}
+	};
+	std::vector<std::thread> pool;
+	for (int t = 0; t < numThreads; t++) pool.push_back(std::thread(worker, t));
+	for (std::thread& th : pool) th.join();
+
+	// Reduce and report
+	size_t mismatched = 0;
+	for (int t = 0; t < numThreads; t++) mismatched += badLevel[t];
+	if (mismatched > 0)
+	{
+		std::cout << "FAIL: " << mismatched << " sites belong to different grids" << std::endl;
+		return LITE_FAIL;
+	}
+
+	bool pass = true;
+	std::cout << "Compared " << setA.sites.size() << " sites (" << setA.blocks.size() << " and " << setB.blocks.size() << " files)" << std::endl;
+	for (int f = 0; f < eFieldCount; f++)
+	{
+		if (!compare[f]) { std::cout << "  " << liteFieldNames[f] << "\tnot compared" << std::endl; continue; }
+		double d = 0.0;
+		size_t at = 0;
+		for (int t = 0; t < numThreads; t++)
+			if (maxDiff[t][f] > d || maxDiff[t][f] != maxDiff[t][f]) { d = maxDiff[t][f]; at = worst[t][f]; }
+
+		bool ok = (d <= tol[f]);
+		pass = pass && ok;
+		std::cout << "  " << liteFieldNames[f] << "\tmax diff = " << d << "\ttol = " << tol[f] << "\t" << (ok ? "ok" : "FAIL");
+		if (!ok)
+		{
+			const LiteSite& s = setA.sites[at];
+			const LiteBlock& b = setA.blocks[s.block];
+			const double *row = b.row(s.row);
+			std::cout << "\t(Lev" << b.level << " Reg" << b.region << " at " << row[0] << ", " << row[1] << ", " << row[2] << ")";
+		}
+		std::cout << std::endl;
+	}
+	std::cout << (pass ? "PASS" : "FAIL") << std::endl;
+	return pass ? LITE_PASS : LITE_FAIL;
+}
+
+// Write a body series file (Body_Positions.bin etc.) as tab separated text with one line per item
+int series(const std::string& inFile, const std::string& outFile)
+{
+	std::ifstream file(inFile, std::ios::in | std::ios::binary);
+	if (!file.is_open()) { std::cout << "Error: cannot open " << inFile << std::endl; return LITE_ERROR; }
+
+	char magic[8];
+	int32_t header[2];
+	double dt;
+	file.read(magic, sizeof(magic));
+	file.read(reinterpret_cast<char*>(header), sizeof(header));
+	file.read(reinterpret_cast<char*>(&dt), sizeof(dt));
+	if (!file || std::strncmp(magic, BODY_MAGIC, 8) != 0 || header[0] != BODY_VERSION || header[1] <= 0)
+	{
+		std::cout << "Error: " << inFile << " is not a body series file" << std::endl;
+		return LITE_ERROR;
+	}
+	int stride = header[1];
+
+	std::ofstream out(outFile, std::ios::out);
+	if (!out.is_open()) { std::cout << "Error: cannot open " << outFile << std::endl; return LITE_ERROR; }
+	out.precision(10);
+	out << "Timestep\tTime\tID\tItem";
+	for (int v = 0; v < stride; v++) out << "\tV" << v;
+	out << '\n';
+
+	// Records of time step, ID and number of items followed by the items
+	int32_t key[3];
+	size_t numRecords = 0;
+	std::vector<double> items;
+	while (file.read(reinterpret_cast<char*>(key), sizeof(key)))
+	{
+		items.resize(static_cast<size_t>(key[2]) * stride);
+		if (!file.read(reinterpret_cast<char*>(items.data()), items.size() * sizeof(double)))
+		{
+			std::cout << "Error: " << inFile << " is truncated" << std::endl;
+			return LITE_ERROR;
+		}
+		for (int n = 0; n < key[2]; n++)
+		{
+			out << key[0] << '\t' << key[0] * dt << '\t' << key[1] << '\t' << n;
+			for (int v = 0; v < stride; v++) out << '\t' << items[n * stride + v];
+			out << '\n';
+		}
+		numRecords++;
+	}
+
+	std::cout << "Wrote " << numRecords << " records to " << outFile << std::endl;
+	return LITE_PASS;
+}
+
+// Write a probe file (probe.bin) as tab separated text with one line per probe and time step
+int probe(const std::string& inFile, const std::string& outFile)
+{
+	std::ifstream file(inFile, std::ios::in | std::ios::binary);
+	if (!file.is_open()) { std::cout << "Error: cannot open " << inFile << std::endl; return LITE_ERROR; }
+
+	// Header of number of probes and values per probe followed by the probe positions
+	int32_t header[2];
+	file.read(reinterpret_cast<char*>(header), sizeof(header));
+	if (!file || header[0] <= 0 || header[1] != PROBE_NUM_COMPS)
+	{
+		std::cout << "Error: " << inFile << " is not a probe file" << std::endl;
+		return LITE_ERROR;
+	}
+	int numProbes = header[0];
+	std::vector<double> pos(static_cast<size_t>(numProbes) * 3);
+	if (!file.read(reinterpret_cast<char*>(pos.data()), pos.size() * sizeof(double)))
+	{
+		std::cout << "Error: " << inFile << " is truncated" << std::endl;
+		return LITE_ERROR;
+	}
+
+	std::ofstream out(outFile, std::ios::out);
+	if (!out.is_open()) { std::cout << "Error: cannot open " << outFile << std::endl; return LITE_ERROR; }
+	out.precision(10);
+	out << "Timestep\tProbe\tX\tY\tZ\tux\tuy\tuz\trho\n";
+
+	// Records of time step followed by the values of every probe
+	int32_t step;
+	size_t numRecords = 0;
+	std::vector<double> values(static_cast<size_t>(numProbes) * PROBE_NUM_COMPS);
+	while (file.read(reinterpret_cast<char*>(&step), sizeof(step)))
+	{
+		if (!file.read(reinterpret_cast<char*>(values.data()), values.size() * sizeof(double)))
+		{
+			std::cout << "Error: " << inFile << " is truncated" << std::endl;
+			return LITE_ERROR;
+		}
+		for (int p = 0; p < numProbes; p++)
+		{
+			out << step << '\t' << p;
+			for (int d = 0; d < 3; d++) out << '\t' << pos[p * 3 + d];
+			for (int v = 0; v < PROBE_NUM_COMPS; v++) out << '\t' << values[p * PROBE_NUM_COMPS + v];
+			out << '\n';
+		}
+		numRecords++;
+	}
+
+	std::cout << "Wrote " << numRecords << " records of " << numProbes << " probes to " << outFile << std::endl;
+	return LITE_PASS;
+}
+
+// Parse a tolerance of the form FIELD:VALUE
+static bool parseTolerance(const std::string& str, double *tol)
+{
+	std::string::size_type colon = str.find(':');
+	if (colon == std::string::npos) return false;
+	std::string field = str.substr(0, colon);
+	double value = std::atof(str.substr(colon + 1).c_str());
+	if (field == "all")
+	{
+		for (int f = 0; f < eFieldCount; f++) tol[f] = value;
+		return true;
+	}
+	for (int f = 0; f < eFieldCount; f++)
+		if (field == liteFieldNames[f]) { tol[f] = value; return true; }
+	return false;
+}
+
+static void usage()
+{
+	std::cout << "Usage:" << std::endl;
+	std::cout << "  litetool merge <dir> <time> [out=FILE] [cut] [full] [threads=N]" << std::endl;
+	std::cout << "  litetool diff <dirA> <dirB> <time> [tol=FIELD:VALUE ...] [threads=N]" << std::endl;
+	std::cout << "  litetool series <file.bin> [out=FILE]" << std::endl;
+	std::cout << "  litetool probe <probe.bin> [out=FILE]" << std::endl;
+	std::cout << "  litetool version" << std::endl;
+	std::cout << "Fields: all type pos rho u f fnew ta" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2) { usage(); return LITE_ERROR; }
+	std::string command(argv[1]);
+
+	if (command == "version")
+	{
+		std::cout << "litetool Version " << LITETOOL_VERSION << std::endl;
+		return LITE_PASS;
+	}
+
+	// Options and positional arguments
+	int numThreads = 0;
+	std::string outFile;
+	double tol[eFieldCount];
+	for (int f = 0; f < eFieldCount; f++) tol[f] = 0.0;
+	std::vector<std::string> positional;
+	for (int a = 2; a < argc; a++)
+	{
+		std::string arg_str = std::string(argv[a]);
+		if (arg_str.compare(0, 8, "threads=") == 0) numThreads = std::atoi(arg_str.substr(8).c_str());
+		else if (arg_str.compare(0, 4, "out=") == 0) outFile = arg_str.substr(4);
+		else if (arg_str.compare(0, 4, "tol=") == 0)
+		{
+			if (!parseTolerance(arg_str.substr(4), tol)) { std::cout << "Error: bad tolerance " << arg_str << std::endl; return LITE_ERROR; }
+		}
+		else if (arg_str == "cut") bCut = true;
+		else if (arg_str == "full") bFull = true;
+		else positional.push_back(arg_str);
+	}
+	if (numThreads <= 0) numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+	if (command == "merge" && positional.size() == 2)
+	{
+		if (outFile.empty()) outFile = "./tecplot." + positional[1] + ".dat";
+		return merge(positional[0], std::atoi(positional[1].c_str()), outFile, numThreads);
+	}
+	else if (command == "diff" && positional.size() == 3)
+	{
+		return diff(positional[0], positional[1], std::atoi(positional[2].c_str()), tol, numThreads);
+	}
+	else if (command == "series" && positional.size() == 1)
+	{
+		if (outFile.empty()) outFile = positional[0].substr(0, positional[0].rfind('.')) + ".txt";
+		return series(positional[0], outFile);
+	}
+	else if (command == "probe" && positional.size() == 1)
+	{
+		if (outFile.empty()) outFile = positional[0].substr(0, positional[0].rfind('.')) + ".txt";
+		return probe(positional[0], outFile);
+	}
+
+	usage();
+	return LITE_ERROR;
+}
@@ -0,0 +1,105 @@
+/*
+* --------------------------------------------------------------
+*
+* ------ Lattice Boltzmann @ The University of Manchester ------
+*
+* -------------------------- L-U-M-A ---------------------------
+*
+*  Copyright (C) The University of Manchester 2017
+*  E-mail contact: info@luma.manchester.ac.uk
+*
+* This software is for academic use only and not available for
+* further distribution commericially or otherwise without written consent.
+*
+*/
+
+#ifndef LITETOOL_H
+#define LITETOOL_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <dirent.h>
+
+// Version
+#define LITETOOL_VERSION "0.1.0"
+
+// Exit codes
+#define LITE_PASS	0
+#define LITE_FAIL	1
+#define LITE_ERROR	2
+
+// Binary file header (matches GridObj::io_lite)
+#define LITE_MAGIC		"LUMALITE"
+#define LITE_VERSION	1
+
+// Body series file header (matches ObjectManager::_io_bodySeriesFlush)
+#define BODY_MAGIC		"LUMABODY"
+#define BODY_VERSION	1
+
+// Probe file values per probe (matches GridObj::io_probeFlush)
+#define PROBE_NUM_COMPS	4		///< ux, uy, uz, rho
+
+// Number of values written per site after rank and type
+#define LITE_NUM_BASE	7		///< X, Y, Z, rho, ux, uy, uz
+#define LITE_NUM_TA		10		///< Time averaged rho, u and u products
+
+// Field groups which tolerances can be set for
+enum eLiteField { eFieldType, eFieldPos, eFieldRho, eFieldU, eFieldF, eFieldFNew, eFieldTA, eFieldCount };
+static const char *liteFieldNames[eFieldCount] = { "type", "pos", "rho", "u", "f", "fnew", "ta" };
+
+/// Contents of one io_lite file (one level, region and rank)
+struct LiteBlock
+{
+	std::string filename;
+	int level = 0;
+	int region = 0;
+	int numVels = 0;				///< Number of lattice velocities (Q)
+	int numValues = 0;				///< Values per site after rank and type
+	bool hasTA = false;				///< Time averaged quantities present
+	std::vector<int> rank;			///< Rank of each site
+	std::vector<int> type;			///< Lattice type of each site
+	std::vector<double> values;		///< numValues values per site
+	std::string error;				///< Non-empty if the file could not be read
+
+	size_t size() const { return type.size(); }
+	const double *row(size_t n) const { return &values[n * numValues]; }
+};
+
+/// Reference to one site of a block used for sorting
+struct LiteSite
+{
+	int block;
+	size_t row;
+};
+
+/// Set of blocks written at one time step ordered by global position
+struct LiteSet
+{
+	std::vector<LiteBlock> blocks;
+	std::vector<LiteSite> sites;	///< Sorted by level, region, Z, Y, X then rank
+};
+
+// Readers
+bool readTextBlock(LiteBlock& b);
+bool readBinaryBlock(LiteBlock& b);
+bool readSet(const std::string& dir, int time, int numThreads, LiteSet& set);
+
+// Commands
+int merge(const std::string& dir, int time, const std::string& outFile, int numThreads);
+int diff(const std::string& dirA, const std::string& dirB, int time, const double *tol, int numThreads);
+int series(const std::string& inFile, const std::string& outFile);
+int probe(const std::string& inFile, const std::string& outFile);
+
+#endif